@@ -0,0 +1,40 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "base/function.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/synchronization/notification.h"
+#include "common/value.h"
+
+namespace cel {
+
+absl::StatusOr<Value> Function::InvokeContext::Await(
+    std::shared_ptr<ValueFuture> future) const {
+  if (!future->IsReady()) {
+    if (pending_ != nullptr) {
+      *pending_ = std::move(future);
+      return NullValue();
+    }
+    absl::Notification ready;
+    future->OnReady([&ready]() { ready.Notify(); });
+    ready.WaitForNotification();
+  }
+  return future->Get();
+}
+
+}  // namespace cel
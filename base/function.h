@@ -15,6 +15,9 @@
 #ifndef THIRD_PARTY_CEL_CPP_BASE_FUNCTION_H_
 #define THIRD_PARTY_CEL_CPP_BASE_FUNCTION_H_
 
+#include <memory>
+
+#include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "common/value.h"
@@ -22,6 +25,23 @@
 
 namespace cel {
 
+// Result of a function call that completes asynchronously (e.g. a lookup in a
+// cache service). See Function::InvokeContext::Await.
+class ValueFuture {
+ public:
+  virtual ~ValueFuture() = default;
+
+  // Whether the result is available.
+  virtual bool IsReady() const = 0;
+
+  // Registers a callback to run once the result is available. If it already
+  // is, the callback may run immediately on the calling thread.
+  virtual void OnReady(absl::AnyInvocable<void() &&> callback) = 0;
+
+  // Returns the result. Requires IsReady().
+  virtual absl::StatusOr<Value> Get() = 0;
+};
+
 // Interface for extension functions.
 //
 // The host for the CEL environment may provide implementations to define custom
@@ -38,14 +58,30 @@ class Function {
     explicit InvokeContext(cel::ValueManager& value_manager)
         : value_manager_(value_manager) {}
 
+    // If pending is non-null, the evaluation may be suspended on a call to
+    // Await: the future is stored there for the interpreter.
+    InvokeContext(cel::ValueManager& value_manager,
+                  std::shared_ptr<ValueFuture>* pending)
+        : value_manager_(value_manager), pending_(pending) {}
+
     // Return the value_factory defined for the evaluation invoking the
     // extension function.
     cel::ValueManager& value_factory() const { return value_manager_; }
 
+    // Returns the result of an asynchronous call.
+    //
+    // If the evaluation can be suspended (see cel::Program::EvaluateAsync) and
+    // the result isn't ready yet, this records the future and returns a
+    // placeholder that the function should return as is. Evaluation then
+    // yields to the caller and continues with the future's result once it is
+    // resumed. Otherwise, blocks until the result is ready.
+    absl::StatusOr<Value> Await(std::shared_ptr<ValueFuture> future) const;
+
     // TODO(uncreated-issue/24): Add accessors for getting attribute stack and mutable
     // value stack.
    private:
     cel::ValueManager& value_manager_;
+    std::shared_ptr<ValueFuture>* pending_ = nullptr;
   };
 
   // Attempt to evaluate an extension function based on the runtime arguments
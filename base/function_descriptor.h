@@ -30,9 +30,10 @@ namespace cel {
 class FunctionDescriptor final {
  public:
   FunctionDescriptor(absl::string_view name, bool receiver_style,
-                     std::vector<Kind> types, bool is_strict = true)
+                     std::vector<Kind> types, bool is_strict = true,
+                     bool is_expensive = false)
       : impl_(std::make_shared<Impl>(name, receiver_style, std::move(types),
-                                     is_strict)) {}
+                                     is_strict, is_expensive)) {}
 
   // Function name.
   const std::string& name() const { return impl_->name; }
@@ -50,6 +51,11 @@ class FunctionDescriptor final {
   // receive error or unknown values as arguments.
   bool is_strict() const { return impl_->is_strict; }
 
+  // if true, the function is expensive to call (e.g. crypto checks or large
+  // lookups). Runtimes configured with an executor may evaluate calls to
+  // expensive functions concurrently with independent sibling expressions.
+  bool is_expensive() const { return impl_->is_expensive; }
+
   // Helper for matching a descriptor. This tests that the shape is the same --
   // |other| accepts the same number and types of arguments and is the same call
   // style).
@@ -65,16 +71,18 @@ class FunctionDescriptor final {
  private:
   struct Impl final {
     Impl(absl::string_view name, bool receiver_style, std::vector<Kind> types,
-         bool is_strict)
+         bool is_strict, bool is_expensive)
         : name(name),
           types(std::move(types)),
           receiver_style(receiver_style),
-          is_strict(is_strict) {}
+          is_strict(is_strict),
+          is_expensive(is_expensive) {}
 
     std::string name;
     std::vector<Kind> types;
     bool receiver_style;
     bool is_strict;
+    bool is_expensive;
   };
 
   std::shared_ptr<const Impl> impl_;
@@ -509,6 +509,8 @@ class CelMapValueBuilder final : public MapValueBuilder {
 
   size_t Size() const override { return static_cast<size_t>(builder_->size()); }
 
+  void Reserve(size_t capacity) override { builder_->Reserve(capacity); }
+
   MapValue Build() && override {
     return common_internal::LegacyMapValue{
         reinterpret_cast<uintptr_t>(static_cast<CelMap*>(builder_))};
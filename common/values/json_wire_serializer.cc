@@ -0,0 +1,272 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/values/json_wire_serializer.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/base/attributes.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "common/casting.h"
+#include "common/json.h"
+#include "common/value.h"
+#include "common/value_kind.h"
+#include "common/value_manager.h"
+#include "internal/proto_wire.h"
+#include "internal/status_macros.h"
+
+namespace cel {
+
+namespace {
+
+using ::cel::internal::ProtoWireReverseEncoder;
+using ::cel::internal::ProtoWireTag;
+using ::cel::internal::ProtoWireType;
+
+inline constexpr absl::string_view kJsonTypeName = "google.protobuf.Value";
+inline constexpr absl::string_view kJsonArrayTypeName =
+    "google.protobuf.ListValue";
+inline constexpr absl::string_view kJsonObjectTypeName =
+    "google.protobuf.Struct";
+
+inline constexpr ProtoWireTag kValueNullValueFieldTag =
+    ProtoWireTag(1, ProtoWireType::kVarint);
+inline constexpr ProtoWireTag kValueBoolValueFieldTag =
+    ProtoWireTag(4, ProtoWireType::kVarint);
+inline constexpr ProtoWireTag kValueNumberValueFieldTag =
+    ProtoWireTag(2, ProtoWireType::kFixed64);
+inline constexpr ProtoWireTag kValueStringValueFieldTag =
+    ProtoWireTag(3, ProtoWireType::kLengthDelimited);
+inline constexpr ProtoWireTag kValueListValueFieldTag =
+    ProtoWireTag(6, ProtoWireType::kLengthDelimited);
+inline constexpr ProtoWireTag kValueStructValueFieldTag =
+    ProtoWireTag(5, ProtoWireType::kLengthDelimited);
+
+inline constexpr ProtoWireTag kListValueValuesFieldTag =
+    ProtoWireTag(1, ProtoWireType::kLengthDelimited);
+
+inline constexpr ProtoWireTag kStructFieldsFieldTag =
+    ProtoWireTag(1, ProtoWireType::kLengthDelimited);
+inline constexpr ProtoWireTag kStructFieldsEntryKeyFieldTag =
+    ProtoWireTag(1, ProtoWireType::kLengthDelimited);
+inline constexpr ProtoWireTag kStructFieldsEntryValueFieldTag =
+    ProtoWireTag(2, ProtoWireType::kLengthDelimited);
+
+// Writes the contents of `google.protobuf.Value`, `google.protobuf.ListValue`
+// and `google.protobuf.Struct` messages to a `ProtoWireReverseEncoder`. As the
+// encoder works back to front, every method writes its field's value before
+// its length and tag.
+class JsonWireWriter final {
+ public:
+  JsonWireWriter(ValueManager& value_manager, ProtoWireReverseEncoder& encoder)
+      : value_manager_(value_manager), encoder_(encoder) {}
+
+  absl::Status WriteValue(ValueView value) {
+    switch (value.kind()) {
+      case ValueKind::kNull:
+        encoder_.WriteVarint(0);
+        encoder_.WriteTag(kValueNullValueFieldTag);
+        return absl::OkStatus();
+      case ValueKind::kBool:
+        encoder_.WriteVarint(Cast<BoolValueView>(value).NativeValue() ? 1 : 0);
+        encoder_.WriteTag(kValueBoolValueFieldTag);
+        return absl::OkStatus();
+      case ValueKind::kInt: {
+        const int64_t number = Cast<IntValueView>(value).NativeValue();
+        if (number < kJsonMinInt || number > kJsonMaxInt) {
+          return WriteStringValue(absl::AlphaNum(number).Piece());
+        }
+        WriteNumberValue(static_cast<double>(number));
+        return absl::OkStatus();
+      }
+      case ValueKind::kUint: {
+        const uint64_t number = Cast<UintValueView>(value).NativeValue();
+        if (number > kJsonMaxUint) {
+          return WriteStringValue(absl::AlphaNum(number).Piece());
+        }
+        WriteNumberValue(static_cast<double>(number));
+        return absl::OkStatus();
+      }
+      case ValueKind::kDouble:
+        WriteNumberValue(Cast<DoubleValueView>(value).NativeValue());
+        return absl::OkStatus();
+      case ValueKind::kString:
+        return Cast<StringValueView>(value).NativeValue(
+            [this](const auto& string) -> absl::Status {
+              return WriteStringValue(string);
+            });
+      case ValueKind::kList: {
+        const size_t mark = encoder_.size();
+        CEL_RETURN_IF_ERROR(WriteListValue(Cast<ListValueView>(value)));
+        CEL_RETURN_IF_ERROR(encoder_.WriteLength(encoder_.size() - mark));
+        encoder_.WriteTag(kValueListValueFieldTag);
+        return absl::OkStatus();
+      }
+      case ValueKind::kMap: {
+        const size_t mark = encoder_.size();
+        CEL_RETURN_IF_ERROR(WriteStruct(Cast<MapValueView>(value)));
+        CEL_RETURN_IF_ERROR(encoder_.WriteLength(encoder_.size() - mark));
+        encoder_.WriteTag(kValueStructValueFieldTag);
+        return absl::OkStatus();
+      }
+      default:
+        // Structs, bytes, durations, timestamps and anything else follow
+        // their own `ConvertToJson`, which also produces the error for values
+        // that have no JSON representation.
+        break;
+    }
+    CEL_ASSIGN_OR_RETURN(auto json, value.ConvertToJson(value_manager_));
+    absl::Cord data;
+    CEL_RETURN_IF_ERROR(JsonToAnyValue(json, data));
+    encoder_.WriteBytes(data);
+    return absl::OkStatus();
+  }
+
+  absl::Status WriteListValue(ListValueView value) {
+    Value scratch;
+    for (size_t index = value.Size(); index > 0; --index) {
+      CEL_ASSIGN_OR_RETURN(auto element,
+                           value.Get(value_manager_, index - 1, scratch));
+      const size_t mark = encoder_.size();
+      CEL_RETURN_IF_ERROR(WriteValue(element));
+      CEL_RETURN_IF_ERROR(encoder_.WriteLength(encoder_.size() - mark));
+      encoder_.WriteTag(kListValueValuesFieldTag);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status WriteStruct(MapValueView value) {
+    // Keys of different kinds can collide once converted to strings, for
+    // example `1` and `'1'`. Only a single kind of key is written directly,
+    // which needs no bookkeeping to rule out duplicates; anything else is
+    // discarded and left to `ConvertToJsonObject`.
+    const size_t start = encoder_.size();
+    absl::optional<ValueKind> key_kind;
+    bool fallback = false;
+    CEL_RETURN_IF_ERROR(value.ForEach(
+        value_manager_,
+        [this, &key_kind, &fallback](
+            ValueView key, ValueView entry_value) -> absl::StatusOr<bool> {
+          switch (key.kind()) {
+            case ValueKind::kBool:
+            case ValueKind::kInt:
+            case ValueKind::kUint:
+            case ValueKind::kString:
+              if (!key_kind.has_value() || *key_kind == key.kind()) {
+                key_kind = key.kind();
+                break;
+              }
+              ABSL_FALLTHROUGH_INTENDED;
+            default:
+              fallback = true;
+              return false;
+          }
+          const size_t entry_mark = encoder_.size();
+          CEL_RETURN_IF_ERROR(WriteValue(entry_value));
+          CEL_RETURN_IF_ERROR(
+              encoder_.WriteLength(encoder_.size() - entry_mark));
+          encoder_.WriteTag(kStructFieldsEntryValueFieldTag);
+          const size_t key_mark = encoder_.size();
+          switch (key.kind()) {
+            case ValueKind::kBool:
+              encoder_.WriteBytes(Cast<BoolValueView>(key).NativeValue()
+                                      ? absl::string_view("true")
+                                      : absl::string_view("false"));
+              break;
+            case ValueKind::kInt:
+              encoder_.WriteBytes(
+                  absl::AlphaNum(Cast<IntValueView>(key).NativeValue())
+                      .Piece());
+              break;
+            case ValueKind::kUint:
+              encoder_.WriteBytes(
+                  absl::AlphaNum(Cast<UintValueView>(key).NativeValue())
+                      .Piece());
+              break;
+            default:
+              Cast<StringValueView>(key).NativeValue(
+                  [this](const auto& string) { encoder_.WriteBytes(string); });
+              break;
+          }
+          CEL_RETURN_IF_ERROR(encoder_.WriteLength(encoder_.size() - key_mark));
+          encoder_.WriteTag(kStructFieldsEntryKeyFieldTag);
+          CEL_RETURN_IF_ERROR(
+              encoder_.WriteLength(encoder_.size() - entry_mark));
+          encoder_.WriteTag(kStructFieldsFieldTag);
+          return true;
+        }));
+    if (fallback) {
+      encoder_.Truncate(start);
+      CEL_ASSIGN_OR_RETURN(auto json,
+                           value.ConvertToJsonObject(value_manager_));
+      absl::Cord data;
+      CEL_RETURN_IF_ERROR(JsonObjectToAnyValue(json, data));
+      encoder_.WriteBytes(data);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  void WriteNumberValue(double number) {
+    encoder_.WriteFixed64(number);
+    encoder_.WriteTag(kValueNumberValueFieldTag);
+  }
+
+  template <typename S>
+  absl::Status WriteStringValue(const S& string) {
+    encoder_.WriteBytes(string);
+    CEL_RETURN_IF_ERROR(encoder_.WriteLength(string.size()));
+    encoder_.WriteTag(kValueStringValueFieldTag);
+    return absl::OkStatus();
+  }
+
+  ValueManager& value_manager_;
+  ProtoWireReverseEncoder& encoder_;
+};
+
+}  // namespace
+
+absl::Status SerializeJsonValue(ValueManager& value_manager, ValueView value,
+                                absl::Cord& data) {
+  ProtoWireReverseEncoder encoder(kJsonTypeName, data);
+  CEL_RETURN_IF_ERROR(JsonWireWriter(value_manager, encoder).WriteValue(value));
+  encoder.Finish();
+  return absl::OkStatus();
+}
+
+absl::Status SerializeJsonListValue(ValueManager& value_manager,
+                                    ListValueView value, absl::Cord& data) {
+  ProtoWireReverseEncoder encoder(kJsonArrayTypeName, data);
+  CEL_RETURN_IF_ERROR(
+      JsonWireWriter(value_manager, encoder).WriteListValue(value));
+  encoder.Finish();
+  return absl::OkStatus();
+}
+
+absl::Status SerializeJsonStruct(ValueManager& value_manager,
+                                 MapValueView value, absl::Cord& data) {
+  ProtoWireReverseEncoder encoder(kJsonObjectTypeName, data);
+  CEL_RETURN_IF_ERROR(
+      JsonWireWriter(value_manager, encoder).WriteStruct(value));
+  encoder.Finish();
+  return absl::OkStatus();
+}
+
+}  // namespace cel
@@ -0,0 +1,52 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This header exposes utilities for serializing `cel::Value` directly as
+// `google.protobuf.Value`, `google.protobuf.ListValue`, and
+// `google.protobuf.Struct`, without first converting to `cel::Json`.
+
+#ifndef THIRD_PARTY_CEL_CPP_COMMON_VALUES_JSON_WIRE_SERIALIZER_H_
+#define THIRD_PARTY_CEL_CPP_COMMON_VALUES_JSON_WIRE_SERIALIZER_H_
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+
+namespace cel {
+
+// The functions below produce the same messages as converting with
+// `ConvertToJson` and serializing the result with `JsonToAnyValue` and
+// friends, except that map entries may be in a different order. Lists and
+// maps are walked once and encoded back to front, so length prefixes never
+// require a separate sizing pass or intermediate buffers. Values which do not
+// have a direct encoding, such as structs, bytes, durations and timestamps,
+// go through `ConvertToJson`. Errors are the same as `ConvertToJson`, and on
+// error `data` is left unchanged.
+
+// Serializes `value` as `google.protobuf.Value` and appends it to `data`.
+absl::Status SerializeJsonValue(ValueManager& value_manager, ValueView value,
+                                absl::Cord& data);
+
+// Serializes `value` as `google.protobuf.ListValue` and appends it to `data`.
+absl::Status SerializeJsonListValue(ValueManager& value_manager,
+                                    ListValueView value, absl::Cord& data);
+
+// Serializes `value` as `google.protobuf.Struct` and appends it to `data`.
+absl::Status SerializeJsonStruct(ValueManager& value_manager,
+                                 MapValueView value, absl::Cord& data);
+
+}  // namespace cel
+
+#endif  // THIRD_PARTY_CEL_CPP_COMMON_VALUES_JSON_WIRE_SERIALIZER_H_
@@ -0,0 +1,109 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks serializing a list of `state.range(0)` nested maps as
+// `google.protobuf.Value`, either through `Json` or directly. Throughput is
+// reported in serialized bytes.
+
+#include <cstddef>
+#include <utility>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "common/json.h"
+#include "common/memory.h"
+#include "common/type_reflector.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "common/values/json_wire_serializer.h"
+#include "internal/benchmark.h"
+#include "internal/testing.h"
+
+namespace cel {
+namespace {
+
+// A list of `size` maps, as produced by expressions such as
+// `items.map(i, {'id': i.id, 'name': i.name, 'tags': {'a': ..., 'b': ...},
+// 'scores': i.scores})`.
+Value MakeValue(ValueManager& value_manager, int size) {
+  auto list_builder =
+      value_manager.NewListValueBuilder(value_manager.GetDynListType());
+  ABSL_CHECK_OK(list_builder.status());
+  for (int i = 0; i < size; ++i) {
+    auto scores_builder =
+        value_manager.NewListValueBuilder(value_manager.GetDynListType());
+    ABSL_CHECK_OK(scores_builder.status());
+    for (int j = 0; j < 8; ++j) {
+      ABSL_CHECK_OK((*scores_builder)->Add(DoubleValue(i * 0.25 + j)));
+    }
+    auto tags_builder =
+        value_manager.NewMapValueBuilder(value_manager.GetDynDynMapType());
+    ABSL_CHECK_OK(tags_builder.status());
+    ABSL_CHECK_OK(
+        (*tags_builder)->Put(StringValue("a"), BoolValue(i % 2 == 0)));
+    ABSL_CHECK_OK(
+        (*tags_builder)->Put(StringValue("b"), StringValue("constant")));
+    auto map_builder =
+        value_manager.NewMapValueBuilder(value_manager.GetDynDynMapType());
+    ABSL_CHECK_OK(map_builder.status());
+    ABSL_CHECK_OK((*map_builder)->Put(StringValue("id"), IntValue(i)));
+    ABSL_CHECK_OK((*map_builder)->Put(
+        StringValue("name"), StringValue(absl::StrCat("item-", i))));
+    ABSL_CHECK_OK((*map_builder)->Put(StringValue("tags"),
+                                      std::move(**tags_builder).Build()));
+    ABSL_CHECK_OK((*map_builder)->Put(StringValue("scores"),
+                                      std::move(**scores_builder).Build()));
+    ABSL_CHECK_OK((*list_builder)->Add(std::move(**map_builder).Build()));
+  }
+  return std::move(**list_builder).Build();
+}
+
+void BM_SerializeViaJson(benchmark::State& state) {
+  auto memory_manager = MemoryManagerRef::ReferenceCounting();
+  auto value_manager = NewThreadCompatibleValueManager(
+      memory_manager, NewThreadCompatibleTypeReflector(memory_manager));
+  const Value value = MakeValue(*value_manager, state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    auto json = value.ConvertToJson(*value_manager);
+    ABSL_CHECK_OK(json.status());
+    absl::Cord data;
+    ABSL_CHECK_OK(JsonToAnyValue(*json, data));
+    bytes += data.size();
+    benchmark::DoNotOptimize(data);
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+void BM_SerializeJsonValue(benchmark::State& state) {
+  auto memory_manager = MemoryManagerRef::ReferenceCounting();
+  auto value_manager = NewThreadCompatibleValueManager(
+      memory_manager, NewThreadCompatibleTypeReflector(memory_manager));
+  const Value value = MakeValue(*value_manager, state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    absl::Cord data;
+    ABSL_CHECK_OK(SerializeJsonValue(*value_manager, value, data));
+    bytes += data.size();
+    benchmark::DoNotOptimize(data);
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_SerializeViaJson)->Range(1, 4096);
+BENCHMARK(BM_SerializeJsonValue)->Range(1, 4096);
+
+}  // namespace
+}  // namespace cel
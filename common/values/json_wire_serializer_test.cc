@@ -0,0 +1,227 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/values/json_wire_serializer.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "common/json.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "common/value_testing.h"
+#include "internal/proto_wire.h"
+#include "internal/status_macros.h"
+#include "internal/testing.h"
+
+namespace cel {
+namespace {
+
+using testing::Eq;
+using testing::UnorderedElementsAreArray;
+using cel::internal::StatusIs;
+
+class JsonWireSerializerTest
+    : public common_internal::ThreadCompatibleValueTest<> {
+ public:
+  template <typename... Args>
+  absl::StatusOr<ListValue> NewListValue(Args&&... args) {
+    CEL_ASSIGN_OR_RETURN(auto builder, value_manager().NewListValueBuilder(
+                                           type_factory().GetDynListType()));
+    (static_cast<void>(builder->Add(std::forward<Args>(args))), ...);
+    return std::move(*builder).Build();
+  }
+
+  absl::StatusOr<MapValue> NewMapValue(
+      std::vector<std::pair<Value, Value>> entries) {
+    CEL_ASSIGN_OR_RETURN(auto builder, value_manager().NewMapValueBuilder(
+                                           type_factory().GetDynDynMapType()));
+    for (auto& entry : entries) {
+      CEL_RETURN_IF_ERROR(
+          builder->Put(std::move(entry.first), std::move(entry.second)));
+    }
+    return std::move(*builder).Build();
+  }
+
+  // Serializes `value` through `ConvertToJson`, as `internal::SerializeValue`
+  // does.
+  absl::Cord SerializeViaJson(ValueView value) {
+    auto json = value.ConvertToJson(value_manager());
+    ABSL_CHECK_OK(json.status());
+    absl::Cord data;
+    ABSL_CHECK_OK(JsonToAnyValue(*json, data));
+    return data;
+  }
+};
+
+// Returns the encoded `google.protobuf.Struct.FieldsEntry` of `data`, which is
+// a serialized `google.protobuf.Struct`.
+std::vector<std::string> StructEntries(const absl::Cord& data) {
+  std::vector<std::string> entries;
+  internal::ProtoWireDecoder decoder("google.protobuf.Struct", data);
+  while (decoder.HasNext()) {
+    auto tag = decoder.ReadTag();
+    ABSL_CHECK_OK(tag.status());
+    ABSL_CHECK_EQ(tag->field_number(), 1);
+    auto entry = decoder.ReadLengthDelimited();
+    ABSL_CHECK_OK(entry.status());
+    entries.push_back(static_cast<std::string>(*entry));
+  }
+  decoder.EnsureFullyDecoded();
+  return entries;
+}
+
+TEST_P(JsonWireSerializerTest, Scalars) {
+  const std::vector<Value> values = {
+      NullValue(),
+      BoolValue(true),
+      BoolValue(false),
+      IntValue(-42),
+      IntValue(kJsonMaxInt + 1),
+      IntValue(kJsonMinInt - 1),
+      UintValue(42),
+      UintValue(kJsonMaxUint + 1),
+      DoubleValue(0.5),
+      StringValue("foo"),
+      StringValue(absl::Cord(std::string(10000, 'x'))),
+      BytesValue("bar"),
+      DurationValue(absl::Seconds(1)),
+      TimestampValue(absl::UnixEpoch()),
+  };
+  for (const auto& value : values) {
+    absl::Cord data;
+    ASSERT_OK(SerializeJsonValue(value_manager(), value, data));
+    EXPECT_EQ(data, SerializeViaJson(value)) << value;
+  }
+}
+
+TEST_P(JsonWireSerializerTest, NestedList) {
+  ASSERT_OK_AND_ASSIGN(auto inner,
+                       NewListValue(BoolValue(true), NullValue(),
+                                    StringValue("inner")));
+  ASSERT_OK_AND_ASSIGN(auto map, NewMapValue({{StringValue("k"), inner}}));
+  ASSERT_OK_AND_ASSIGN(auto list, NewListValue(IntValue(1), StringValue("a"),
+                                               inner, map, DoubleValue(2.5)));
+  absl::Cord data;
+  ASSERT_OK(SerializeJsonValue(value_manager(), list, data));
+  EXPECT_EQ(data, SerializeViaJson(list));
+
+  ASSERT_OK_AND_ASSIGN(auto json, list.ConvertToJsonArray(value_manager()));
+  absl::Cord expected;
+  ASSERT_OK(JsonArrayToAnyValue(json, expected));
+  data.Clear();
+  ASSERT_OK(SerializeJsonListValue(value_manager(), list, data));
+  EXPECT_EQ(data, expected);
+}
+
+TEST_P(JsonWireSerializerTest, LargeList) {
+  ASSERT_OK_AND_ASSIGN(auto builder, value_manager().NewListValueBuilder(
+                                         type_factory().GetDynListType()));
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_OK_AND_ASSIGN(auto element,
+                         NewListValue(IntValue(i), StringValue(absl::StrCat(
+                                                       "element-", i))));
+    ASSERT_OK(builder->Add(std::move(element)));
+  }
+  auto list = std::move(*builder).Build();
+  absl::Cord data;
+  ASSERT_OK(SerializeJsonValue(value_manager(), list, data));
+  EXPECT_EQ(data, SerializeViaJson(list));
+}
+
+TEST_P(JsonWireSerializerTest, Struct) {
+  ASSERT_OK_AND_ASSIGN(auto map, NewMapValue({
+                                     {StringValue("a"), IntValue(1)},
+                                     {StringValue("b"), StringValue("foo")},
+                                     {StringValue("c"), NullValue()},
+                                 }));
+  absl::Cord data;
+  ASSERT_OK(SerializeJsonStruct(value_manager(), map, data));
+  ASSERT_OK_AND_ASSIGN(auto json, map.ConvertToJsonObject(value_manager()));
+  absl::Cord expected;
+  ASSERT_OK(JsonObjectToAnyValue(json, expected));
+  EXPECT_THAT(StructEntries(data),
+              UnorderedElementsAreArray(StructEntries(expected)));
+}
+
+TEST_P(JsonWireSerializerTest, StructNonStringKeys) {
+  ASSERT_OK_AND_ASSIGN(auto map, NewMapValue({
+                                     {IntValue(1), BoolValue(true)},
+                                     {IntValue(-2), BoolValue(false)},
+                                 }));
+  absl::Cord data;
+  ASSERT_OK(SerializeJsonStruct(value_manager(), map, data));
+  ASSERT_OK_AND_ASSIGN(auto json, map.ConvertToJsonObject(value_manager()));
+  absl::Cord expected;
+  ASSERT_OK(JsonObjectToAnyValue(json, expected));
+  EXPECT_THAT(StructEntries(data),
+              UnorderedElementsAreArray(StructEntries(expected)));
+}
+
+TEST_P(JsonWireSerializerTest, StructMixedKeys) {
+  ASSERT_OK_AND_ASSIGN(auto map, NewMapValue({
+                                     {IntValue(1), StringValue("a")},
+                                     {StringValue("2"), StringValue("b")},
+                                 }));
+  absl::Cord data;
+  ASSERT_OK(SerializeJsonStruct(value_manager(), map, data));
+  ASSERT_OK_AND_ASSIGN(auto json, map.ConvertToJsonObject(value_manager()));
+  absl::Cord expected;
+  ASSERT_OK(JsonObjectToAnyValue(json, expected));
+  EXPECT_THAT(StructEntries(data),
+              UnorderedElementsAreArray(StructEntries(expected)));
+}
+
+TEST_P(JsonWireSerializerTest, StructConflictingKeys) {
+  ASSERT_OK_AND_ASSIGN(auto map, NewMapValue({
+                                     {IntValue(1), StringValue("a")},
+                                     {StringValue("1"), StringValue("b")},
+                                 }));
+  absl::Cord data("prefix");
+  EXPECT_THAT(SerializeJsonStruct(value_manager(), map, data),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_THAT(data, Eq("prefix"));
+}
+
+TEST_P(JsonWireSerializerTest, Unserializable) {
+  ASSERT_OK_AND_ASSIGN(
+      auto list,
+      NewListValue(IntValue(1), ErrorValue(absl::CancelledError("foo"))));
+  absl::Cord data("prefix");
+  EXPECT_THAT(SerializeJsonValue(value_manager(), list, data),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_THAT(data, Eq("prefix"));
+}
+
+TEST_P(JsonWireSerializerTest, Appends) {
+  absl::Cord data("prefix");
+  ASSERT_OK(SerializeJsonValue(value_manager(), BoolValue(true), data));
+  EXPECT_EQ(data, absl::StrCat("prefix", "\x20\x01"));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    JsonWireSerializerTest, JsonWireSerializerTest,
+    ::testing::Combine(::testing::Values(MemoryManagement::kPooling,
+                                         MemoryManagement::kReferenceCounting)),
+    JsonWireSerializerTest::ToString);
+
+}  // namespace
+}  // namespace cel
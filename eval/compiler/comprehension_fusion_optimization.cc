@@ -0,0 +1,187 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/compiler/comprehension_fusion_optimization.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "base/ast_internal/ast_impl.h"
+#include "base/ast_internal/expr.h"
+#include "base/builtins.h"
+#include "common/native_type.h"
+#include "eval/compiler/flat_expr_builder_extensions.h"
+#include "eval/eval/comprehension_step.h"
+#include "eval/eval/evaluator_core.h"
+#include "internal/casts.h"
+#include "internal/status_macros.h"
+#include "runtime/runtime_options.h"
+
+namespace google::api::expr::runtime {
+namespace {
+
+using ::cel::NativeTypeId;
+using ::cel::ast_internal::AstImpl;
+using ::cel::ast_internal::Comprehension;
+using ::cel::ast_internal::Expr;
+using ::cel::internal::down_cast;
+
+bool IsIdent(const Expr& expr, absl::string_view name) {
+  return expr.has_ident_expr() && expr.ident_expr().name() == name;
+}
+
+bool IsBoolConstant(const Expr& expr, bool value) {
+  return expr.has_const_expr() && expr.const_expr().has_bool_value() &&
+         expr.const_expr().bool_value() == value;
+}
+
+// Returns the single argument of a global call to `function`, or nullptr.
+const Expr* UnaryCallArg(const Expr& expr, absl::string_view function) {
+  if (!expr.has_call_expr() || expr.call_expr().has_target() ||
+      expr.call_expr().function() != function ||
+      expr.call_expr().args().size() != 1) {
+    return nullptr;
+  }
+  return &expr.call_expr().args()[0];
+}
+
+const Expr* NotStrictlyFalseArg(const Expr& expr) {
+  const Expr* arg = UnaryCallArg(expr, cel::builtin::kNotStrictlyFalse);
+  if (arg == nullptr) {
+    arg = UnaryCallArg(expr, cel::builtin::kNotStrictlyFalseDeprecated);
+  }
+  return arg;
+}
+
+// Matches the loop condition of a comprehension against the conditions
+// generated by the standard macros:
+//   all:                          @not_strictly_false(accu)
+//   exists:                       @not_strictly_false(!accu)
+//   exists_one, map, filter:      true
+absl::optional<FusedLoopCondition> MatchLoopCondition(
+    const Comprehension& comprehension) {
+  const Expr& condition = comprehension.loop_condition();
+  absl::string_view accu_var = comprehension.accu_var();
+  if (IsBoolConstant(condition, true)) {
+    return FusedLoopCondition::kNone;
+  }
+  const Expr* arg = NotStrictlyFalseArg(condition);
+  if (arg == nullptr) {
+    return absl::nullopt;
+  }
+  if (IsIdent(*arg, accu_var)) {
+    return FusedLoopCondition::kUntilFalse;
+  }
+  const Expr* negated = UnaryCallArg(*arg, cel::builtin::kNot);
+  if (negated != nullptr && IsIdent(*negated, accu_var)) {
+    return FusedLoopCondition::kUntilTrue;
+  }
+  return absl::nullopt;
+}
+
+class ComprehensionFusionOptimization : public ProgramOptimizer {
+ public:
+  absl::Status OnPreVisit(PlannerContext& context, const Expr& node) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status OnPostVisit(PlannerContext& context, const Expr& node) override {
+    if (!node.has_comprehension_expr() ||
+        context.options().unknown_processing !=
+            cel::UnknownProcessingOptions::kDisabled ||
+        context.options().max_recursion_depth != 0) {
+      return absl::OkStatus();
+    }
+    const Comprehension& comprehension = node.comprehension_expr();
+    absl::optional<FusedLoopCondition> loop_condition =
+        MatchLoopCondition(comprehension);
+    if (!loop_condition.has_value()) {
+      return absl::OkStatus();
+    }
+
+    // The plans of all of the parts must still be available, i.e. no other
+    // extension has rewritten the comprehension.
+    if (!context.IsSubplanInspectable(node) ||
+        !context.IsSubplanInspectable(comprehension.iter_range()) ||
+        !context.IsSubplanInspectable(comprehension.accu_init()) ||
+        !context.IsSubplanInspectable(comprehension.loop_condition()) ||
+        !context.IsSubplanInspectable(comprehension.loop_step()) ||
+        !context.IsSubplanInspectable(comprehension.result())) {
+      return absl::OkStatus();
+    }
+    // Plans of the parts are moved into the plan of the comprehension when it
+    // is rewritten (e.g. by the vectorized comprehension extension).
+    for (const Expr* part :
+         {&comprehension.iter_range(), &comprehension.accu_init(),
+          &comprehension.loop_condition(), &comprehension.loop_step(),
+          &comprehension.result()}) {
+      if (context.GetSubplan(*part).empty()) {
+        return absl::OkStatus();
+      }
+    }
+
+    CEL_ASSIGN_OR_RETURN(ExecutionPath iter_range,
+                         context.ExtractSubplan(comprehension.iter_range()));
+    CEL_ASSIGN_OR_RETURN(ExecutionPath accu_init,
+                         context.ExtractSubplan(comprehension.accu_init()));
+    CEL_ASSIGN_OR_RETURN(
+        ExecutionPath condition,
+        context.ExtractSubplan(comprehension.loop_condition()));
+    CEL_ASSIGN_OR_RETURN(ExecutionPath loop_step,
+                         context.ExtractSubplan(comprehension.loop_step()));
+    CEL_ASSIGN_OR_RETURN(ExecutionPath result,
+                         context.ExtractSubplan(comprehension.result()));
+    // What remains are the loop control steps:
+    //   ComprehensionInit, ComprehensionNext, ComprehensionCond, jump,
+    //   ComprehensionFinish
+    CEL_ASSIGN_OR_RETURN(ExecutionPath control, context.ExtractSubplan(node));
+    if (control.size() != 5 ||
+        control[1]->GetNativeTypeId() !=
+            NativeTypeId::For<ComprehensionNextStep>()) {
+      return absl::InternalError("unexpected plan for comprehension");
+    }
+    const auto& next_step =
+        down_cast<const ComprehensionNextStep&>(*control[1]);
+
+    // The standard macros return the accumulator, except for exists_one.
+    if (IsIdent(comprehension.result(), comprehension.accu_var())) {
+      result.clear();
+    }
+
+    ExecutionPath plan = std::move(iter_range);
+    plan.reserve(plan.size() + accu_init.size() + 2);
+    plan.push_back(std::move(control[0]));
+    for (auto& step : accu_init) {
+      plan.push_back(std::move(step));
+    }
+    plan.push_back(CreateFusedComprehensionStep(
+        next_step.iter_slot(), next_step.accu_slot(), *loop_condition,
+        context.options().short_circuiting, std::move(loop_step),
+        std::move(result), node.id()));
+    return context.ReplaceSubplan(node, std::move(plan));
+  }
+};
+
+}  // namespace
+
+ProgramOptimizerFactory CreateComprehensionFusionExtension() {
+  return [](PlannerContext& context, const AstImpl& ast) {
+    return std::make_unique<ComprehensionFusionOptimization>();
+  };
+}
+
+}  // namespace google::api::expr::runtime
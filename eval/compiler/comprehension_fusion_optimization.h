@@ -0,0 +1,40 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_COMPILER_COMPREHENSION_FUSION_OPTIMIZATION_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_COMPILER_COMPREHENSION_FUSION_OPTIMIZATION_H_
+
+#include "eval/compiler/flat_expr_builder_extensions.h"
+
+namespace google::api::expr::runtime {
+
+// Create a new extension for the FlatExprBuilder that plans the loop of
+// comprehensions with the standard macro shapes (`all`, `exists`,
+// `exists_one`, `map` and `filter`) as a single step.
+//
+// The loop condition is checked natively and the loop step and result
+// subprograms are evaluated directly by the fused step, replacing the
+// per-iteration next, condition and jump steps. Comprehensions with a constant
+// `true` loop condition (e.g. hand written folds) are fused the same way as
+// `map` and `filter`.
+//
+// Only applies to the flat plan (RuntimeOptions::max_recursion_depth == 0)
+// and is not applied when unknown processing is enabled. Comprehensions
+// already rewritten by another extension (e.g. vectorized comprehensions) are
+// left as is.
+ProgramOptimizerFactory CreateComprehensionFusionExtension();
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_COMPILER_COMPREHENSION_FUSION_OPTIMIZATION_H_
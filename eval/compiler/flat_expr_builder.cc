@@ -16,6 +16,7 @@
 
 #include "eval/compiler/flat_expr_builder.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
@@ -31,6 +32,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
@@ -45,28 +47,34 @@
 #include "base/ast_internal/expr.h"
 #include "base/builtins.h"
 #include "common/memory.h"
+#include "common/native_type.h"
 #include "common/value_manager.h"
 #include "common/values/legacy_value_manager.h"
 #include "eval/compiler/flat_expr_builder_extensions.h"
 #include "eval/compiler/resolver.h"
+#include "eval/eval/compiler_constant_step.h"
 #include "eval/eval/comprehension_step.h"
 #include "eval/eval/const_value_step.h"
 #include "eval/eval/container_access_step.h"
 #include "eval/eval/create_list_step.h"
 #include "eval/eval/create_struct_step.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 #include "eval/eval/function_step.h"
 #include "eval/eval/ident_step.h"
 #include "eval/eval/jump_step.h"
 #include "eval/eval/lazy_init_step.h"
 #include "eval/eval/logic_step.h"
+#include "eval/eval/parallel_evaluation.h"
 #include "eval/eval/select_step.h"
 #include "eval/eval/shadowable_value_step.h"
 #include "eval/eval/ternary_step.h"
 #include "eval/public/ast_traverse_native.h"
 #include "eval/public/ast_visitor_native.h"
 #include "eval/public/source_position_native.h"
+#include "internal/casts.h"
 #include "internal/status_macros.h"
+#include "runtime/executor.h"
 #include "runtime/internal/issue_collector.h"
 #include "runtime/runtime_issue.h"
 #include "runtime/runtime_options.h"
@@ -269,6 +277,14 @@ bool IsOptimizableListAppend(
          call_expr->args()[0].ident_expr().name() == accu_var;
 }
 
+// Whether an optimizable list append comprehension appends one element per
+// iteration (i.e. map() rather than filter()), so the accumulator ends up with
+// the size of the iteration range.
+bool IsListMapAppend(const cel::ast_internal::Comprehension* comprehension) {
+  return comprehension->loop_step().call_expr().function() ==
+         cel::builtin::kAdd;
+}
+
 bool IsBind(const cel::ast_internal::Comprehension* comprehension) {
   static constexpr absl::string_view kUnusedIterVar = "#unused";
 
@@ -328,6 +344,14 @@ class ComprehensionVisitor {
   size_t accu_slot_;
 };
 
+using RecursiveDependencies =
+    std::vector<std::unique_ptr<DirectExpressionStep>>;
+
+// Builds a direct step for a node given the direct steps for its dependencies
+// (in evaluation order).
+using RecursiveStepFactory = absl::AnyInvocable<
+    std::unique_ptr<DirectExpressionStep>(RecursiveDependencies)>;
+
 class FlatExprVisitor : public cel::ast_internal::AstVisitor {
  public:
   FlatExprVisitor(
@@ -350,6 +374,9 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
 
   void PreVisitExpr(const cel::ast_internal::Expr* expr,
                     const cel::ast_internal::SourcePosition*) override {
+    if (parallel_executor_ != nullptr) {
+      subtree_stack_.push_back(SubtreeInfo{});
+    }
     ValidateOrError(
         !absl::holds_alternative<absl::monostate>(expr->expr_kind()),
         "Invalid empty expression");
@@ -376,6 +403,9 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
 
   void PostVisitExpr(const cel::ast_internal::Expr* expr,
                      const cel::ast_internal::SourcePosition*) override {
+    if (parallel_executor_ != nullptr) {
+      ExitSubtree(expr);
+    }
     if (!progress_status_.ok()) {
       return;
     }
@@ -392,6 +422,8 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
       }
     }
 
+    MaybeSetRecursiveProgram(expr);
+
     program_builder_.ExitSubexpression(expr);
 
     if (!comprehension_stack_.empty() &&
@@ -449,6 +481,17 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
     return {-1, -1};
   }
 
+  // Returns the declared variable index for a free variable, assigning the
+  // next index on first reference.
+  size_t DeclareVariable(const std::string& name) {
+    auto [iter, inserted] = declared_variable_indexes_.try_emplace(
+        name, declared_variables_.size());
+    if (inserted) {
+      declared_variables_.push_back(name);
+    }
+    return iter->second;
+  }
+
   // Ident node handler.
   // Invoked after child nodes are processed.
   void PostVisitIdent(const cel::ast_internal::Ident* ident_expr,
@@ -506,10 +549,23 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
       return;
     } else if (slot.slot >= 0) {
       AddStep(CreateIdentStepForSlot(*ident_expr, slot.slot, expr->id()));
+      SetRecursiveStepFactory(
+          expr, /*num_dependencies=*/0,
+          [ident_expr, slot, expr](RecursiveDependencies) {
+            return CreateDirectSlotIdentStep(ident_expr->name(), slot.slot,
+                                             expr->id());
+          });
       return;
     }
 
-    AddStep(CreateIdentStep(*ident_expr, expr->id()));
+    size_t variable_index = DeclareVariable(path);
+    AddStep(CreateIdentStep(*ident_expr, variable_index, expr->id()));
+    SetRecursiveStepFactory(
+        expr, /*num_dependencies=*/0,
+        [ident_expr, variable_index, expr](RecursiveDependencies) {
+          return CreateDirectIdentStep(ident_expr->name(), variable_index,
+                                       expr->id());
+        });
   }
 
   void PreVisitSelect(const cel::ast_internal::Select* select_expr,
@@ -575,6 +631,13 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
     AddStep(CreateSelectStep(*select_expr, expr->id(),
                              options_.enable_empty_wrapper_null_unboxing,
                              value_factory_));
+    SetRecursiveStepFactory(
+        expr, /*num_dependencies=*/1,
+        [this, select_expr, expr](RecursiveDependencies deps) {
+          return CreateDirectSelectStep(
+              std::move(deps[0]), *select_expr, expr->id(),
+              options_.enable_empty_wrapper_null_unboxing, value_factory_);
+        });
   }
 
   // Call node handler group.
@@ -623,6 +686,7 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
     if (cond_visitor) {
       cond_visitor->PostVisit(expr);
       cond_visitor_stack_.pop();
+      SetRecursiveStepFactoryForCondition(call_expr, expr);
       return;
     }
 
@@ -667,8 +731,21 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
     auto lazy_overloads = resolver_.FindLazyOverloads(
         function, receiver_style, arguments_matcher, expr->id());
     if (!lazy_overloads.empty()) {
-      AddStep(CreateFunctionStep(*call_expr, expr->id(),
-                                 std::move(lazy_overloads)));
+      AddStep(CreateFunctionStep(*call_expr, expr->id(), lazy_overloads));
+      if (absl::c_any_of(lazy_overloads, [](const auto& overload) {
+            return overload.descriptor.is_expensive();
+          })) {
+        MarkExpensive();
+      }
+      SetRecursiveStepFactory(
+          expr, num_args,
+          [call_expr, expr, lazy_overloads = std::move(lazy_overloads),
+           forked = ForkCallDependencies(*call_expr)](
+              RecursiveDependencies deps) mutable {
+            return CreateDirectFunctionStep(
+                *call_expr, expr->id(), std::move(deps),
+                std::move(lazy_overloads), std::move(forked));
+          });
       return;
     }
 
@@ -689,7 +766,22 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
         return;
       }
     }
-    AddStep(CreateFunctionStep(*call_expr, expr->id(), std::move(overloads)));
+    AddStep(CreateFunctionStep(*call_expr, expr->id(), overloads));
+    if (absl::c_any_of(overloads, [](const auto& overload) {
+          return overload.descriptor.is_expensive();
+        })) {
+      MarkExpensive();
+    }
+    SetRecursiveStepFactory(
+        expr, num_args,
+        [call_expr, expr, overloads = std::move(overloads),
+         forked = ForkCallDependencies(*call_expr)](
+            RecursiveDependencies deps) mutable {
+          return CreateDirectFunctionStep(*call_expr, expr->id(),
+                                          std::move(deps),
+                                          std::move(overloads),
+                                          std::move(forked));
+        });
   }
 
   void PreVisitComprehension(
@@ -776,6 +868,9 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
     }
 
     record.visitor->PostVisit(expr);
+    if (parallel_executor_ != nullptr) {
+      subtree_stack_.back().has_comprehension = true;
+    }
 
     index_manager_.ReleaseSlots(record.slot_count);
     comprehension_stack_.pop_back();
@@ -878,7 +973,10 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
           comprehension_stack_.back();
       if (comprehension.is_optimizable_list_append &&
           &(comprehension.comprehension->accu_init()) == expr) {
-        AddStep(CreateCreateMutableListStep(*list_expr, expr->id()));
+        AddStep(CreateCreateMutableListStep(
+            *list_expr, expr->id(),
+            /*reserve_range_size=*/
+            IsListMapAppend(comprehension.comprehension)));
         return;
       }
     }
@@ -902,7 +1000,8 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
         ValidateOrError(entry.has_map_key(), "Map entry missing key");
         ValidateOrError(entry.has_value(), "Map entry missing value");
       }
-      AddStep(CreateCreateStructStepForMap(*struct_expr, expr->id()));
+      AddStep(CreateCreateStructStepForMap(*struct_expr, expr->id(),
+                                           options_.enable_compact_map_values));
       return;
     }
 
@@ -925,6 +1024,176 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
 
   absl::Status progress_status() const { return progress_status_; }
 
+  // Plans the recursive (direct) counterpart for a logical operator or a
+  // ternary.
+  void SetRecursiveStepFactoryForCondition(
+      const cel::ast_internal::Call* call_expr,
+      const cel::ast_internal::Expr* expr) {
+    const bool short_circuiting = options_.short_circuiting;
+    if (call_expr->function() == cel::builtin::kAnd) {
+      SetRecursiveStepFactory(
+          expr, /*num_dependencies=*/2,
+          [expr, short_circuiting, forked = ForkLogicalOperands(*call_expr)](
+              RecursiveDependencies deps) mutable {
+            return CreateDirectAndStep(std::move(deps[0]), std::move(deps[1]),
+                                       expr->id(), short_circuiting,
+                                       std::move(forked));
+          });
+    } else if (call_expr->function() == cel::builtin::kOr) {
+      SetRecursiveStepFactory(
+          expr, /*num_dependencies=*/2,
+          [expr, short_circuiting, forked = ForkLogicalOperands(*call_expr)](
+              RecursiveDependencies deps) mutable {
+            return CreateDirectOrStep(std::move(deps[0]), std::move(deps[1]),
+                                      expr->id(), short_circuiting,
+                                      std::move(forked));
+          });
+    } else if (call_expr->function() == cel::builtin::kTernary) {
+      SetRecursiveStepFactory(
+          expr, /*num_dependencies=*/3,
+          [expr, short_circuiting](RecursiveDependencies deps) {
+            return CreateDirectTernaryStep(
+                std::move(deps[0]), std::move(deps[1]), std::move(deps[2]),
+                expr->id(), short_circuiting);
+          });
+    }
+  }
+
+  // Marks the node currently being planned as calling an expensive function.
+  void MarkExpensive() {
+    if (parallel_executor_ != nullptr) {
+      subtree_stack_.back().expensive = true;
+    }
+  }
+
+  // Folds the subtree rooted at expr into its parent and remembers it if it
+  // may be forked.
+  void ExitSubtree(const cel::ast_internal::Expr* expr) {
+    SubtreeInfo info = subtree_stack_.back();
+    subtree_stack_.pop_back();
+    if (info.expensive && !info.has_comprehension) {
+      forkable_exprs_.insert(expr);
+    }
+    if (!subtree_stack_.empty()) {
+      subtree_stack_.back().expensive |= info.expensive;
+      subtree_stack_.back().has_comprehension |= info.has_comprehension;
+    }
+  }
+
+  // Decides which dependencies of a call to evaluate on the parallel executor.
+  //
+  // Only expensive, comprehension-free subtrees outside of comprehensions are
+  // forked, and only when there are at least two of them: the first one is
+  // still evaluated on the calling thread.
+  ForkedDependencies ForkCallDependencies(
+      const cel::ast_internal::Call& call_expr) {
+    if (parallel_executor_ == nullptr || !comprehension_stack_.empty()) {
+      return {};
+    }
+    std::vector<const cel::ast_internal::Expr*> deps;
+    deps.reserve(call_expr.args().size() + 1);
+    if (call_expr.has_target()) {
+      deps.push_back(&call_expr.target());
+    }
+    for (const cel::ast_internal::Expr& arg : call_expr.args()) {
+      deps.push_back(&arg);
+    }
+
+    ForkedDependencies forked;
+    forked.forked.resize(deps.size(), false);
+    bool seen_expensive = false;
+    bool any_forked = false;
+    for (size_t i = 0; i < deps.size(); ++i) {
+      if (!forkable_exprs_.contains(deps[i])) {
+        continue;
+      }
+      if (seen_expensive) {
+        forked.forked[i] = true;
+        any_forked = true;
+      }
+      seen_expensive = true;
+    }
+    if (!any_forked) {
+      return {};
+    }
+    forked.executor = parallel_executor_;
+    return forked;
+  }
+
+  // Decides which operands of '&&' or '||' to evaluate on the parallel
+  // executor. With short-circuiting, the right hand side must only run if the
+  // left hand side doesn't decide the result, so nothing is forked.
+  ForkedDependencies ForkLogicalOperands(
+      const cel::ast_internal::Call& call_expr) {
+    if (options_.short_circuiting) {
+      return {};
+    }
+    return ForkCallDependencies(call_expr);
+  }
+
+  // Registers how to build a recursive program for expr from the recursive
+  // programs of its dependencies. The factory is applied after the program
+  // optimizers have visited expr (see MaybeSetRecursiveProgram).
+  void SetRecursiveStepFactory(const cel::ast_internal::Expr* expr,
+                               size_t num_dependencies,
+                               RecursiveStepFactory factory) {
+    if (options_.max_recursion_depth == 0 || !progress_status_.ok() ||
+        PlanningSuppressed()) {
+      return;
+    }
+    recursive_step_expr_ = expr;
+    recursive_step_dependencies_ = num_dependencies;
+    recursive_step_factory_ = std::move(factory);
+  }
+
+  // Replaces the flat plan for expr with a recursive program if all of its
+  // dependencies are planned recursively (or are constants) and the result
+  // is within the configured depth limit. Otherwise, the flat plan is kept.
+  void MaybeSetRecursiveProgram(const cel::ast_internal::Expr* expr) {
+    if (recursive_step_expr_ != expr) {
+      return;
+    }
+    recursive_step_expr_ = nullptr;
+    RecursiveStepFactory factory = std::move(recursive_step_factory_);
+
+    ProgramBuilder::Subexpression* subexpression = program_builder_.current();
+    // Program optimizers may have replaced the plan for this node.
+    if (subexpression == nullptr || subexpression->IsFlattened() ||
+        subexpression->IsRecursive()) {
+      return;
+    }
+
+    std::vector<ProgramBuilder::Subexpression*> dependencies;
+    int depth = 1;
+    for (auto& element : subexpression->elements()) {
+      auto* child =
+          absl::get_if<std::unique_ptr<ProgramBuilder::Subexpression>>(
+              &element);
+      if (child == nullptr) {
+        continue;
+      }
+      int child_depth = RecursiveDepth(**child);
+      if (child_depth <= 0) {
+        return;
+      }
+      depth = std::max(depth, child_depth + 1);
+      dependencies.push_back(child->get());
+    }
+
+    if (dependencies.size() != recursive_step_dependencies_ ||
+        (options_.max_recursion_depth > 0 &&
+         depth > options_.max_recursion_depth)) {
+      return;
+    }
+
+    RecursiveDependencies deps;
+    deps.reserve(dependencies.size());
+    for (ProgramBuilder::Subexpression* dependency : dependencies) {
+      deps.push_back(ExtractRecursiveStep(*dependency));
+    }
+    subexpression->set_recursive_program(factory(std::move(deps)), depth);
+  }
+
   cel::ValueManager& value_factory() { return value_factory_; }
 
   // Mark a branch as suppressed. The visitor will continue as normal, but
@@ -978,10 +1247,19 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
 
   size_t slot_count() const { return index_manager_.max_slot_count(); }
 
+  // Free variables referenced by the plan, ordered by assigned index.
+  std::vector<std::string> ExtractDeclaredVariables() {
+    return std::move(declared_variables_);
+  }
+
   void AddOptimizer(std::unique_ptr<ProgramOptimizer> optimizer) {
     program_optimizers_.push_back(std::move(optimizer));
   }
 
+  void set_parallel_executor(std::shared_ptr<cel::Executor> executor) {
+    parallel_executor_ = std::move(executor);
+  }
+
   // Tests the boolean predicate, and if false produces an InvalidArgumentError
   // which concatenates the error_message and any optional message_parts as the
   // error status message.
@@ -1017,6 +1295,56 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
     return resume_from_suppressed_branch_ != nullptr;
   }
 
+  // Returns the constant step that subexpression consists of, or nullptr if it
+  // is anything else. Literals are planned as a single unflattened step;
+  // constants folded by an optimizer replace the flattened plan.
+  static const CompilerConstantStep* GetConstantStep(
+      const ProgramBuilder::Subexpression& subexpression) {
+    const ExpressionStep* step = nullptr;
+    if (subexpression.IsFlattened()) {
+      if (subexpression.flattened_elements().size() == 1) {
+        step = subexpression.flattened_elements()[0].get();
+      }
+    } else if (!subexpression.IsRecursive() &&
+               subexpression.elements().size() == 1) {
+      if (auto* element = absl::get_if<std::unique_ptr<ExpressionStep>>(
+              &subexpression.elements()[0]);
+          element != nullptr) {
+        step = element->get();
+      }
+    }
+    if (step == nullptr || step->GetNativeTypeId() !=
+                               cel::NativeTypeId::For<CompilerConstantStep>()) {
+      return nullptr;
+    }
+    return &cel::internal::down_cast<const CompilerConstantStep&>(*step);
+  }
+
+  // Returns the depth of the recursive program for subexpression, or 0 if it
+  // can't be evaluated recursively.
+  //
+  // Constants (literals or folded by an optimizer) are trivially recursive.
+  static int RecursiveDepth(
+      const ProgramBuilder::Subexpression& subexpression) {
+    if (subexpression.IsRecursive()) {
+      return subexpression.recursive_program().depth;
+    }
+    if (GetConstantStep(subexpression) != nullptr) {
+      return 1;
+    }
+    return 0;
+  }
+
+  static std::unique_ptr<DirectExpressionStep> ExtractRecursiveStep(
+      ProgramBuilder::Subexpression& subexpression) {
+    if (subexpression.IsRecursive()) {
+      return subexpression.ExtractRecursiveProgram().step;
+    }
+    const CompilerConstantStep* constant = GetConstantStep(subexpression);
+    ABSL_DCHECK(constant != nullptr);
+    return CreateConstValueDirectStep(constant->value(), constant->id());
+  }
+
   absl::Status MaybeExtractSubexpression(const cel::ast_internal::Expr* expr,
                                          ComprehensionStackRecord& record) {
     if (!record.is_optimizable_bind) {
@@ -1067,6 +1395,26 @@ class FlatExprVisitor : public cel::ast_internal::AstVisitor {
   ProgramBuilder& program_builder_;
   PlannerContext extension_context_;
   IndexManager index_manager_;
+
+  // Free variables in order of first reference, and the index assigned to
+  // each. Activations may bind values by these indices.
+  std::vector<std::string> declared_variables_;
+  absl::flat_hash_map<std::string, size_t> declared_variable_indexes_;
+
+  // Pending recursive plan for the node currently being post-visited.
+  const cel::ast_internal::Expr* recursive_step_expr_ = nullptr;
+  size_t recursive_step_dependencies_ = 0;
+  RecursiveStepFactory recursive_step_factory_;
+
+  // Executor for expensive, independent dependencies. Subtree tracking is
+  // only done if set.
+  struct SubtreeInfo {
+    bool expensive = false;
+    bool has_comprehension = false;
+  };
+  std::shared_ptr<cel::Executor> parallel_executor_;
+  std::vector<SubtreeInfo> subtree_stack_;
+  absl::flat_hash_set<const cel::ast_internal::Expr*> forkable_exprs_;
 };
 
 void BinaryCondVisitor::PreVisit(const cel::ast_internal::Expr* expr) {
@@ -1359,6 +1707,7 @@ absl::StatusOr<FlatExpression> FlatExprBuilder::CreateExpressionImpl(
   FlatExprVisitor visitor(resolver, options_, std::move(optimizers),
                           ast_impl.reference_map(), value_factory,
                           issue_collector, program_builder, extension_context);
+  visitor.set_parallel_executor(parallel_executor_);
 
   cel::ast_internal::TraversalOptions opts;
   opts.use_comprehension_callbacks = true;
@@ -1378,7 +1727,8 @@ absl::StatusOr<FlatExpression> FlatExprBuilder::CreateExpressionImpl(
 
   return FlatExpression(std::move(execution_path), std::move(subexpressions),
                         visitor.slot_count(),
-                        type_registry_.GetComposedTypeProvider(), options_);
+                        type_registry_.GetComposedTypeProvider(), options_,
+                        visitor.ExtractDeclaredVariables());
 }
 
 }  // namespace google::api::expr::runtime
@@ -27,6 +27,7 @@
 #include "eval/compiler/flat_expr_builder_extensions.h"
 #include "eval/eval/evaluator_core.h"
 #include "eval/public/cel_type_registry.h"
+#include "runtime/executor.h"
 #include "runtime/function_registry.h"
 #include "runtime/runtime_issue.h"
 #include "runtime/runtime_options.h"
@@ -71,6 +72,12 @@ class FlatExprBuilder {
     container_ = std::move(container);
   }
 
+  // Sets the executor used to evaluate independent calls to expensive
+  // functions concurrently. Only applies to recursively planned programs.
+  void set_parallel_executor(std::shared_ptr<cel::Executor> executor) {
+    parallel_executor_ = std::move(executor);
+  }
+
   // TODO(uncreated-issue/45): Add overload for cref AST. At the moment, all the users
   // can pass ownership of a freshly converted AST.
   absl::StatusOr<FlatExpression> CreateExpressionImpl(
@@ -88,6 +95,7 @@ class FlatExprBuilder {
   const cel::TypeRegistry& type_registry_;
   std::vector<std::unique_ptr<AstTransform>> ast_transforms_;
   std::vector<ProgramOptimizerFactory> program_optimizers_;
+  std::shared_ptr<cel::Executor> parallel_executor_;
 };
 
 }  // namespace google::api::expr::runtime
@@ -27,6 +27,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/variant.h"
 #include "base/ast_internal/expr.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 
 namespace google::api::expr::runtime {
@@ -41,6 +42,9 @@ size_t Subexpression::ComputeSize() const {
   if (IsFlattened()) {
     return flattened_elements().size();
   }
+  if (IsRecursive()) {
+    return 1;
+  }
   std::vector<const Subexpression*> to_expand{this};
   size_t size = 0;
   while (!to_expand.empty()) {
@@ -50,6 +54,10 @@ size_t Subexpression::ComputeSize() const {
       size += expr->flattened_elements().size();
       continue;
     }
+    if (expr->IsRecursive()) {
+      size += 1;
+      continue;
+    }
     for (const auto& elem : expr->elements()) {
       if (auto* child = absl::get_if<std::unique_ptr<Subexpression>>(&elem);
           child != nullptr) {
@@ -75,7 +83,7 @@ Subexpression::~Subexpression() {
 
 std::unique_ptr<Subexpression> Subexpression::ExtractChild(
     Subexpression* child) {
-  if (IsFlattened()) {
+  if (IsFlattened() || IsRecursive()) {
     return nullptr;
   }
   for (auto iter = elements().begin(); iter != elements().end(); ++iter) {
@@ -139,6 +147,12 @@ void Subexpression::Flatten() {
 
   std::vector<std::unique_ptr<const ExpressionStep>> flat;
 
+  if (IsRecursive()) {
+    flat.push_back(WrapDirectStep(ExtractRecursiveProgram().step));
+    program_ = std::move(flat);
+    return;
+  }
+
   std::vector<Record> flatten_stack;
 
   flatten_stack.push_back({this, 0});
@@ -151,6 +165,10 @@ void Subexpression::Flatten() {
       absl::c_move(subexpr->flattened_elements(), std::back_inserter(flat));
       continue;
     }
+    if (subexpr->IsRecursive()) {
+      flat.push_back(WrapDirectStep(subexpr->ExtractRecursiveProgram().step));
+      continue;
+    }
     size_t size = subexpr->elements().size();
     size_t i = offset;
     for (; i < size; ++i) {
@@ -173,6 +191,13 @@ void Subexpression::Flatten() {
   program_ = std::move(flat);
 }
 
+Subexpression::RecursiveProgram Subexpression::ExtractRecursiveProgram() {
+  ABSL_DCHECK(IsRecursive());
+  auto result = std::move(absl::get<RecursiveProgram>(program_));
+  program_.emplace<std::vector<Subexpression::Element>>();
+  return result;
+}
+
 bool Subexpression::ExtractTo(
     std::vector<std::unique_ptr<const ExpressionStep>>& out) {
   if (!IsFlattened()) {
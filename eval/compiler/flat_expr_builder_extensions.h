@@ -39,6 +39,7 @@
 #include "base/ast_internal/expr.h"
 #include "common/value_manager.h"
 #include "eval/compiler/resolver.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 #include "runtime/internal/issue_collector.h"
 #include "runtime/runtime_options.h"
@@ -77,6 +78,12 @@ class ProgramBuilder {
                                   std::unique_ptr<Subexpression>>;
 
    public:
+    // A subexpression planned as a single recursively evaluated step.
+    struct RecursiveProgram {
+      std::unique_ptr<DirectExpressionStep> step;
+      int depth;
+    };
+
     ~Subexpression();
 
     // Not copyable or movable.
@@ -87,6 +94,9 @@ class ProgramBuilder {
 
     // Add a program step at the current end of the subexpression.
     void AddStep(std::unique_ptr<ExpressionStep> step) {
+      if (IsRecursive()) {
+        Flatten();
+      }
       if (IsFlattened()) {
         flattened_elements().push_back(std::move(step));
       } else {
@@ -154,6 +164,30 @@ class ProgramBuilder {
           std::vector<std::unique_ptr<const ExpressionStep>>>(program_);
     }
 
+    bool IsRecursive() const {
+      return absl::holds_alternative<RecursiveProgram>(program_);
+    }
+
+    // Replace the subexpression (and any dependencies) with a recursively
+    // evaluated program.
+    void set_recursive_program(std::unique_ptr<DirectExpressionStep> step,
+                               int depth) {
+      program_ = RecursiveProgram{std::move(step), depth};
+    }
+
+    // Accessor for the recursive program.
+    //
+    // Value is undefined if the subexpression is not recursive.
+    const RecursiveProgram& recursive_program() const {
+      ABSL_DCHECK(IsRecursive());
+      return absl::get<RecursiveProgram>(program_);
+    }
+
+    // Extract the recursive program, transferring ownership to the caller.
+    //
+    // The subexpression is left empty.
+    RecursiveProgram ExtractRecursiveProgram();
+
     // Extract a flattened subexpression into the given vector. Transferring
     // ownership of the given steps.
     //
@@ -170,7 +204,8 @@ class ProgramBuilder {
     // This adds complexity, but supports swapping to a flat representation as
     // needed.
     absl::variant<std::vector<Element>,
-                  std::vector<std::unique_ptr<const ExpressionStep>>>
+                  std::vector<std::unique_ptr<const ExpressionStep>>,
+                  RecursiveProgram>
         program_;
 
     const cel::ast_internal::Expr* self_;
@@ -17,6 +17,7 @@
 #include "eval/compiler/flat_expr_builder.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <functional>
 #include <memory>
@@ -397,6 +398,122 @@ TEST(FlatExprBuilderTest, Shortcircuiting) {
   }
 }
 
+TEST(FlatExprBuilderTest, RecursivePlanShortcircuiting) {
+  Expr expr;
+  SourceInfo source_info;
+  auto call_expr = expr.mutable_call_expr();
+  call_expr->set_function("_||_");
+
+  auto arg1 = call_expr->add_args();
+  arg1->mutable_call_expr()->set_function("recorder1");
+
+  auto arg2 = call_expr->add_args();
+  arg2->mutable_call_expr()->set_function("recorder2");
+
+  Activation activation;
+  google::protobuf::Arena arena;
+
+  for (bool short_circuiting : {true, false}) {
+    cel::RuntimeOptions options;
+    options.short_circuiting = short_circuiting;
+    options.max_recursion_depth = -1;
+    CelExpressionBuilderFlatImpl builder(options);
+    auto builtin = RegisterBuiltinFunctions(builder.GetRegistry());
+
+    int count1 = 0;
+    int count2 = 0;
+
+    ASSERT_OK(builder.GetRegistry()->Register(
+        std::make_unique<RecorderFunction>("recorder1", &count1)));
+    ASSERT_OK(builder.GetRegistry()->Register(
+        std::make_unique<RecorderFunction>("recorder2", &count2)));
+
+    ASSERT_OK_AND_ASSIGN(auto cel_expr,
+                         builder.CreateExpression(&expr, &source_info));
+    ASSERT_OK_AND_ASSIGN(CelValue result,
+                         cel_expr->Evaluate(activation, &arena));
+
+    EXPECT_THAT(result, test::IsCelBool(true));
+    EXPECT_THAT(count1, Eq(1));
+    EXPECT_THAT(count2, Eq(short_circuiting ? 0 : 1));
+  }
+}
+
+TEST(FlatExprBuilderTest, RecursivePlanMatchesFlatPlan) {
+  ASSERT_OK_AND_ASSIGN(
+      ParsedExpr parsed_expr,
+      parser::Parse("(a + b) * c == 6 ? m.key.startsWith('x') : a > b"));
+
+  Activation activation;
+  google::protobuf::Arena arena;
+  activation.InsertValue("a", CelValue::CreateInt64(1));
+  activation.InsertValue("b", CelValue::CreateInt64(2));
+  activation.InsertValue("c", CelValue::CreateInt64(2));
+  std::vector<std::pair<CelValue, CelValue>> entries{
+      {CelValue::CreateStringView("key"), CelValue::CreateStringView("xyz")}};
+  ASSERT_OK_AND_ASSIGN(auto map,
+                       CreateContainerBackedMap(absl::MakeSpan(entries)));
+  activation.InsertValue("m", CelValue::CreateMap(map.get()));
+
+  // A negative limit plans the whole tree recursively; a limit of 2 forces
+  // the deeper subtrees back onto the flat plan.
+  for (int max_recursion_depth : {0, -1, 2}) {
+    cel::RuntimeOptions options;
+    options.max_recursion_depth = max_recursion_depth;
+    CelExpressionBuilderFlatImpl builder(options);
+    ASSERT_OK(RegisterBuiltinFunctions(builder.GetRegistry()));
+
+    ASSERT_OK_AND_ASSIGN(auto cel_expr,
+                         builder.CreateExpression(&parsed_expr.expr(),
+                                                  &parsed_expr.source_info()));
+    ASSERT_OK_AND_ASSIGN(CelValue result,
+                         cel_expr->Evaluate(activation, &arena));
+
+    EXPECT_THAT(result, test::IsCelBool(true)) << max_recursion_depth;
+  }
+}
+
+TEST(FlatExprBuilderTest, RecursivePlanIncludesLiteralOperands) {
+  Activation activation;
+  google::protobuf::Arena arena;
+  activation.InsertValue("a", CelValue::CreateInt64(5));
+  activation.InsertValue("s", CelValue::CreateStringView("xyz"));
+
+  for (absl::string_view expression :
+       {"a + 1 == 6", "s.startsWith('x')", "a == 6 || s.startsWith('x')"}) {
+    ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, parser::Parse(expression));
+
+    // Tracing reports every node of a flat plan, but only the root of a
+    // recursive one.
+    for (int max_recursion_depth : {0, -1}) {
+      cel::RuntimeOptions options;
+      options.max_recursion_depth = max_recursion_depth;
+      CelExpressionBuilderFlatImpl builder(options);
+      ASSERT_OK(RegisterBuiltinFunctions(builder.GetRegistry()));
+
+      ASSERT_OK_AND_ASSIGN(
+          auto cel_expr, builder.CreateExpression(&parsed_expr.expr(),
+                                                  &parsed_expr.source_info()));
+      int traced = 0;
+      ASSERT_OK_AND_ASSIGN(
+          CelValue result,
+          cel_expr->Trace(activation, &arena,
+                          [&traced](int64_t, const CelValue&,
+                                    google::protobuf::Arena*) {
+                            ++traced;
+                            return absl::OkStatus();
+                          }));
+
+      EXPECT_THAT(result, test::IsCelBool(true)) << expression;
+      if (max_recursion_depth == 0) {
+        EXPECT_GT(traced, 1) << expression;
+      } else {
+        EXPECT_EQ(traced, 1) << expression;
+      }
+    }
+  }
+}
+
 TEST(FlatExprBuilderTest, ShortcircuitingComprehension) {
   Expr expr;
   SourceInfo source_info;
@@ -0,0 +1,175 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "eval/compiler/indexed_list_membership_optimization.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/optional.h"
+#include "base/ast_internal/ast_impl.h"
+#include "base/ast_internal/expr.h"
+#include "base/builtins.h"
+#include "common/casting.h"
+#include "common/native_type.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "eval/compiler/flat_expr_builder_extensions.h"
+#include "eval/eval/compiler_constant_step.h"
+#include "eval/eval/evaluator_core.h"
+#include "internal/casts.h"
+#include "internal/status_macros.h"
+#include "runtime/indexed_list_value.h"
+#include "runtime/internal/convert_constant.h"
+
+namespace google::api::expr::runtime {
+namespace {
+
+using ::cel::ListValue;
+using ::cel::NativeTypeId;
+using ::cel::Value;
+using ::cel::ast_internal::AstImpl;
+using ::cel::ast_internal::Expr;
+using ::cel::ast_internal::Reference;
+using ::cel::internal::down_cast;
+using ::cel::runtime_internal::ConvertConstant;
+
+using ReferenceMap = absl::flat_hash_map<int64_t, Reference>;
+
+bool IsListMembership(const Expr& expr, const ReferenceMap& reference_map) {
+  if (!expr.has_call_expr()) {
+    return false;
+  }
+  const auto& call_expr = expr.call_expr();
+  if (call_expr.has_target() || call_expr.args().size() != 2) {
+    return false;
+  }
+  if (call_expr.function() != cel::builtin::kIn &&
+      call_expr.function() != cel::builtin::kInFunction &&
+      call_expr.function() != cel::builtin::kInDeprecated) {
+    return false;
+  }
+
+  // The indexed list behaves like the original for any overload, so
+  // parse-only expressions are optimized too. For checked expressions, skip
+  // calls resolved to other overloads.
+  auto reference = reference_map.find(expr.id());
+  if (reference == reference_map.end()) {
+    return true;
+  }
+  for (const auto& overload_id : reference->second.overload_id()) {
+    if (overload_id == "in_list") {
+      return true;
+    }
+  }
+  return false;
+}
+
+class IndexedListMembershipOptimization : public ProgramOptimizer {
+ public:
+  IndexedListMembershipOptimization(const ReferenceMap& reference_map,
+                                    size_t min_list_size)
+      : reference_map_(reference_map), min_list_size_(min_list_size) {}
+
+  absl::Status OnPreVisit(PlannerContext& context, const Expr& node) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status OnPostVisit(PlannerContext& context, const Expr& node) override {
+    if (context.options().max_recursion_depth != 0 ||
+        !context.options().enable_heterogeneous_equality ||
+        !IsListMembership(node, reference_map_)) {
+      return absl::OkStatus();
+    }
+
+    const Expr& list_expr = node.call_expr().args().back();
+    if (!context.IsSubplanInspectable(list_expr) ||
+        context.GetSubplan(list_expr).empty()) {
+      // This subexpression was already optimized, nothing to do.
+      return absl::OkStatus();
+    }
+
+    CEL_ASSIGN_OR_RETURN(absl::optional<ListValue> list,
+                         GetConstantList(context, list_expr));
+    if (!list.has_value() || list->Size() < min_list_size_) {
+      return absl::OkStatus();
+    }
+
+    CEL_ASSIGN_OR_RETURN(
+        ListValue indexed_list,
+        cel::NewIndexedListValue(context.value_factory(), *std::move(list)));
+
+    ExecutionPath new_plan;
+    new_plan.push_back(std::make_unique<CompilerConstantStep>(
+        std::move(indexed_list), list_expr.id(), /*comes_from_ast=*/true));
+    return context.ReplaceSubplan(list_expr, std::move(new_plan));
+  }
+
+ private:
+  // Returns the value of expr if it is a constant list, either folded at plan
+  // time or a literal with only constant elements.
+  absl::StatusOr<absl::optional<ListValue>> GetConstantList(
+      PlannerContext& context, const Expr& expr) const {
+    ExecutionPathView plan = context.GetSubplan(expr);
+    if (plan.size() == 1 && plan[0]->GetNativeTypeId() ==
+                                NativeTypeId::For<CompilerConstantStep>()) {
+      const auto& constant = down_cast<const CompilerConstantStep&>(*plan[0]);
+      if (auto list = cel::As<ListValue>(constant.value()); list) {
+        return list;
+      }
+      return absl::nullopt;
+    }
+
+    if (!expr.has_list_expr() ||
+        !expr.list_expr().optional_indices().empty()) {
+      return absl::nullopt;
+    }
+    for (const Expr& element : expr.list_expr().elements()) {
+      if (!element.has_const_expr()) {
+        return absl::nullopt;
+      }
+    }
+
+    cel::ValueManager& value_factory = context.value_factory();
+    CEL_ASSIGN_OR_RETURN(
+        auto builder,
+        value_factory.NewListValueBuilder(value_factory.GetDynListType()));
+    builder->Reserve(expr.list_expr().elements().size());
+    for (const Expr& element : expr.list_expr().elements()) {
+      CEL_ASSIGN_OR_RETURN(
+          Value value, ConvertConstant(element.const_expr(), value_factory));
+      CEL_RETURN_IF_ERROR(builder->Add(std::move(value)));
+    }
+    return std::move(*builder).Build();
+  }
+
+  const ReferenceMap& reference_map_;
+  const size_t min_list_size_;
+};
+
+}  // namespace
+
+ProgramOptimizerFactory CreateIndexedListMembershipExtension(
+    size_t min_list_size) {
+  return [=](PlannerContext& context, const AstImpl& ast) {
+    return std::make_unique<IndexedListMembershipOptimization>(
+        ast.reference_map(), min_list_size);
+  };
+}
+
+}  // namespace google::api::expr::runtime
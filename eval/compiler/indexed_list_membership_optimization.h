@@ -0,0 +1,35 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_COMPILER_INDEXED_LIST_MEMBERSHIP_OPTIMIZATION_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_COMPILER_INDEXED_LIST_MEMBERSHIP_OPTIMIZATION_H_
+
+#include <cstddef>
+
+#include "eval/compiler/flat_expr_builder_extensions.h"
+
+namespace google::api::expr::runtime {
+
+// Create a new extension for the FlatExprBuilder that replaces constant lists
+// used as the right hand side of the 'in' operator with a hash indexed copy
+// (see cel::NewIndexedListValue), so membership tests don't scan the list.
+//
+// Applies to list literals with only constant elements and to lists computed
+// by constant folding, with at least min_list_size elements. Requires
+// heterogeneous equality and only applies to the flat (non-recursive) plan.
+ProgramOptimizerFactory CreateIndexedListMembershipExtension(
+    size_t min_list_size);
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_COMPILER_INDEXED_LIST_MEMBERSHIP_OPTIMIZATION_H_
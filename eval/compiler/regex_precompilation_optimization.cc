@@ -19,22 +19,29 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "base/ast_internal/ast_impl.h"
 #include "base/ast_internal/expr.h"
 #include "base/builtins.h"
+#include "base/kind.h"
 #include "common/native_type.h"
 #include "common/value.h"
 #include "eval/compiler/flat_expr_builder_extensions.h"
 #include "eval/eval/compiler_constant_step.h"
 #include "eval/eval/evaluator_core.h"
+#include "eval/eval/function_step.h"
+#include "eval/eval/regex_extension_step.h"
 #include "eval/eval/regex_match_step.h"
 #include "internal/casts.h"
 #include "internal/status_macros.h"
+#include "re2/re2.h"
 
 namespace google::api::expr::runtime {
 namespace {
@@ -48,6 +55,16 @@ using cel::internal::down_cast;
 
 using ReferenceMap = absl::flat_hash_map<int64_t, Reference>;
 
+using RegexExtensionStepFactory =
+    absl::StatusOr<std::unique_ptr<ExpressionStep>> (*)(
+        std::shared_ptr<const RE2>, std::unique_ptr<const ExpressionStep>,
+        int64_t);
+
+// Function names from extensions/regex_functions.h.
+constexpr absl::string_view kRegexExtract = "re.extract";
+constexpr absl::string_view kRegexCapture = "re.capture";
+constexpr absl::string_view kRegexCaptureN = "re.captureN";
+
 bool IsFunctionOverload(const Expr& expr, absl::string_view function,
                         absl::string_view overload, size_t arity,
                         const ReferenceMap& reference_map) {
@@ -87,7 +104,7 @@ class RegexProgramBuilder final {
       : max_program_size_(max_program_size) {}
 
   absl::StatusOr<std::shared_ptr<const RE2>> BuildRegexProgram(
-      std::string pattern) {
+      std::string pattern, absl::string_view function) {
     auto existing = programs_.find(pattern);
     if (existing != programs_.end()) {
       if (auto program = existing->second.lock(); program) {
@@ -100,8 +117,8 @@ class RegexProgramBuilder final {
       return absl::InvalidArgumentError("exceeded RE2 max program size");
     }
     if (!program->ok()) {
-      return absl::InvalidArgumentError(
-          "invalid_argument unsupported RE2 pattern for matches");
+      return absl::InvalidArgumentError(absl::StrCat(
+          "invalid_argument unsupported RE2 pattern for ", function));
     }
     programs_.insert({std::move(pattern), program});
     return program;
@@ -126,11 +143,15 @@ class RegexPrecompilationOptimization : public ProgramOptimizer {
   absl::Status OnPostVisit(PlannerContext& context, const Expr& node) override {
     // Check that this is the correct matches overload instead of a user defined
     // overload.
-    if (!IsFunctionOverload(node, cel::builtin::kRegexMatch, "matches_string",
+    if (IsFunctionOverload(node, cel::builtin::kRegexMatch, "matches_string",
                             2, reference_map_)) {
-      return absl::OkStatus();
+      return PrecompileMatches(context, node);
     }
+    return PrecompileExtensionCall(context, node);
+  }
 
+ private:
+  absl::Status PrecompileMatches(PlannerContext& context, const Expr& node) {
     const Call& call_expr = node.call_expr();
     const Expr& pattern_expr = call_expr.args().back();
 
@@ -140,8 +161,9 @@ class RegexPrecompilationOptimization : public ProgramOptimizer {
       return absl::OkStatus();
     }
 
-    CEL_ASSIGN_OR_RETURN(auto program, regex_program_builder_.BuildRegexProgram(
-                                           std::move(pattern).value()));
+    CEL_ASSIGN_OR_RETURN(auto program,
+                         regex_program_builder_.BuildRegexProgram(
+                             std::move(pattern).value(), "matches"));
 
     const Expr& subject_expr =
         call_expr.has_target() ? call_expr.target() : call_expr.args().front();
@@ -159,7 +181,101 @@ class RegexPrecompilationOptimization : public ProgramOptimizer {
     return context.ReplaceSubplan(node, std::move(new_plan));
   }
 
- private:
+  // Precompiles the pattern of re.extract, re.capture and re.captureN calls
+  // from the regex extension. The original function step is kept as the
+  // fallback for non-string arguments, so only calls bound to an eager string
+  // overload are rewritten.
+  absl::Status PrecompileExtensionCall(PlannerContext& context,
+                                       const Expr& node) {
+    // The extension steps are flat, so they would prevent planning this node
+    // and its ancestors recursively.
+    if (context.options().max_recursion_depth != 0 || !node.has_call_expr() ||
+        node.call_expr().has_target()) {
+      return absl::OkStatus();
+    }
+    const Call& call_expr = node.call_expr();
+    const std::string& function = call_expr.function();
+    size_t arity;
+    RegexExtensionStepFactory factory;
+    if (function == kRegexExtract) {
+      arity = 3;
+      factory = &CreateRegexExtractStep;
+    } else if (function == kRegexCapture) {
+      arity = 2;
+      factory = &CreateRegexCaptureStep;
+    } else if (function == kRegexCaptureN) {
+      arity = 2;
+      factory = &CreateRegexCaptureNStep;
+    } else {
+      return absl::OkStatus();
+    }
+    if (call_expr.args().size() != arity) {
+      return absl::OkStatus();
+    }
+
+    std::vector<cel::Kind> kinds(arity, cel::Kind::kString);
+    if (context.resolver()
+            .FindOverloads(function, /*receiver_style=*/false, kinds,
+                           node.id())
+            .empty() ||
+        !context.resolver()
+             .FindLazyOverloads(function, /*receiver_style=*/false, kinds,
+                                node.id())
+             .empty()) {
+      return absl::OkStatus();
+    }
+
+    absl::optional<std::string> pattern =
+        GetConstantString(context, call_expr.args()[1]);
+    if (!pattern.has_value()) {
+      return absl::OkStatus();
+    }
+
+    ExecutionPathView plan = context.GetSubplan(node);
+    if (plan.empty() || plan.back()->id() != node.id() ||
+        !IsFunctionStep(*plan.back())) {
+      // Already rewritten by another extension, or folded into a constant.
+      return absl::OkStatus();
+    }
+
+    CEL_ASSIGN_OR_RETURN(auto program,
+                         regex_program_builder_.BuildRegexProgram(
+                             std::move(pattern).value(), function));
+    CEL_RETURN_IF_ERROR(
+        ValidateCaptureGroups(context, call_expr, function, *program));
+
+    CEL_ASSIGN_OR_RETURN(ExecutionPath new_plan, context.ExtractSubplan(node));
+    std::unique_ptr<const ExpressionStep> fallback = std::move(new_plan.back());
+    CEL_ASSIGN_OR_RETURN(
+        new_plan.back(),
+        factory(std::move(program), std::move(fallback), node.id()));
+    return context.ReplaceSubplan(node, std::move(new_plan));
+  }
+
+  // Reports calls which could only ever evaluate to an error because the
+  // pattern has too few capturing groups.
+  absl::Status ValidateCaptureGroups(PlannerContext& context,
+                                     const Call& call_expr,
+                                     absl::string_view function,
+                                     const RE2& program) const {
+    if (function == kRegexExtract) {
+      absl::optional<std::string> rewrite =
+          GetConstantString(context, call_expr.args()[2]);
+      std::string error;
+      if (rewrite.has_value() &&
+          !program.CheckRewriteString(*rewrite, &error)) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("invalid rewrite for ", function, ": ", error));
+      }
+      return absl::OkStatus();
+    }
+    if (program.NumberOfCapturingGroups() <= 0) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "capturing groups were not found in the regex for ", function));
+    }
+    return absl::OkStatus();
+  }
+
   absl::optional<std::string> GetConstantString(
       PlannerContext& context, const cel::ast_internal::Expr& expr) const {
     if (expr.has_const_expr() && expr.const_expr().has_string_value()) {
@@ -20,7 +20,11 @@
 namespace google::api::expr::runtime {
 
 // Create a new extension for the FlatExprBuilder that precompiles constant
-// regular expressions used in the standard 'Match' function.
+// regular expressions used in the standard 'Match' function and in the
+// re.extract, re.capture and re.captureN extension functions.
+//
+// Invalid patterns, and extension calls that can never succeed because the
+// pattern lacks capturing groups, are reported as planning errors.
 ProgramOptimizerFactory CreateRegexPrecompilationExtension(
     int regex_max_program_size);
 
@@ -0,0 +1,138 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/compiler/time_zone_precompilation_optimization.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "base/ast_internal/ast_impl.h"
+#include "base/ast_internal/expr.h"
+#include "base/kind.h"
+#include "common/native_type.h"
+#include "common/value.h"
+#include "eval/compiler/flat_expr_builder_extensions.h"
+#include "eval/eval/compiler_constant_step.h"
+#include "eval/eval/evaluator_core.h"
+#include "eval/eval/function_step.h"
+#include "eval/eval/timestamp_accessor_step.h"
+#include "internal/casts.h"
+#include "internal/status_macros.h"
+#include "runtime/internal/time_zone_cache.h"
+#include "runtime/internal/timestamp_accessors.h"
+
+namespace google::api::expr::runtime {
+namespace {
+
+using ::cel::NativeTypeId;
+using ::cel::ast_internal::AstImpl;
+using ::cel::ast_internal::Call;
+using ::cel::ast_internal::Expr;
+using ::cel::internal::down_cast;
+using ::cel::runtime_internal::FindTimestampAccessor;
+using ::cel::runtime_internal::ParseTimeZone;
+using ::cel::runtime_internal::TimestampAccessor;
+
+absl::optional<std::string> GetConstantString(PlannerContext& context,
+                                              const Expr& expr) {
+  if (expr.has_const_expr() && expr.const_expr().has_string_value()) {
+    return expr.const_expr().string_value();
+  }
+
+  ExecutionPathView plan = context.GetSubplan(expr);
+  if (plan.size() == 1 && plan[0]->GetNativeTypeId() ==
+                              NativeTypeId::For<CompilerConstantStep>()) {
+    const auto& constant = down_cast<const CompilerConstantStep&>(*plan[0]);
+    if (constant.value()->Is<cel::StringValue>()) {
+      return constant.value()->As<cel::StringValue>().ToString();
+    }
+  }
+
+  return absl::nullopt;
+}
+
+class TimeZonePrecompilationOptimization : public ProgramOptimizer {
+ public:
+  absl::Status OnPreVisit(PlannerContext& context, const Expr& node) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status OnPostVisit(PlannerContext& context, const Expr& node) override {
+    // Specialized steps are flat, so they would prevent planning this node
+    // and its ancestors recursively.
+    if (context.options().max_recursion_depth != 0 || !node.has_call_expr()) {
+      return absl::OkStatus();
+    }
+    const Call& call_expr = node.call_expr();
+    if (!call_expr.has_target() || call_expr.args().size() != 1) {
+      return absl::OkStatus();
+    }
+    TimestampAccessor accessor = FindTimestampAccessor(call_expr.function());
+    if (accessor == nullptr) {
+      return absl::OkStatus();
+    }
+
+    // Only replace the standard eagerly bound overload.
+    const std::vector<cel::Kind> kinds = {cel::Kind::kTimestamp,
+                                          cel::Kind::kString};
+    if (context.resolver()
+            .FindOverloads(call_expr.function(), /*receiver_style=*/true,
+                           kinds, node.id())
+            .empty() ||
+        !context.resolver()
+             .FindLazyOverloads(call_expr.function(), /*receiver_style=*/true,
+                                kinds, node.id())
+             .empty()) {
+      return absl::OkStatus();
+    }
+
+    absl::optional<std::string> tz =
+        GetConstantString(context, call_expr.args().front());
+    if (!tz.has_value()) {
+      return absl::OkStatus();
+    }
+    auto time_zone = ParseTimeZone(*tz);
+    if (!time_zone.ok()) {
+      return absl::OkStatus();
+    }
+
+    ExecutionPathView plan = context.GetSubplan(node);
+    if (plan.empty() || plan.back()->id() != node.id() ||
+        !IsFunctionStep(*plan.back())) {
+      // Already rewritten by another extension, or folded into a constant.
+      return absl::OkStatus();
+    }
+
+    CEL_ASSIGN_OR_RETURN(ExecutionPath new_plan, context.ExtractSubplan(node));
+    std::unique_ptr<const ExpressionStep> fallback = std::move(new_plan.back());
+    new_plan.back() = CreateTimestampAccessorStep(
+        accessor, *std::move(tz), *std::move(time_zone), std::move(fallback),
+        node.id());
+    return context.ReplaceSubplan(node, std::move(new_plan));
+  }
+};
+
+}  // namespace
+
+ProgramOptimizerFactory CreateTimeZonePrecompilationExtension() {
+  return [](PlannerContext& context, const AstImpl& ast) {
+    return std::make_unique<TimeZonePrecompilationOptimization>();
+  };
+}
+
+}  // namespace google::api::expr::runtime
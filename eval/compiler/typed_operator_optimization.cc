@@ -0,0 +1,137 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/compiler/typed_operator_optimization.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "base/ast_internal/ast_impl.h"
+#include "base/ast_internal/expr.h"
+#include "base/builtins.h"
+#include "base/kind.h"
+#include "eval/compiler/flat_expr_builder_extensions.h"
+#include "eval/compiler/resolver.h"
+#include "eval/eval/evaluator_core.h"
+#include "eval/eval/function_step.h"
+#include "eval/eval/typed_operator_step.h"
+#include "internal/status_macros.h"
+#include "runtime/function_overload_reference.h"
+
+namespace google::api::expr::runtime {
+namespace {
+
+using cel::ast_internal::AstImpl;
+using cel::ast_internal::Call;
+using cel::ast_internal::Expr;
+using cel::ast_internal::Reference;
+
+using ReferenceMap = absl::flat_hash_map<int64_t, Reference>;
+
+// Whether calls to `function` are resolved to the eagerly bound builtins for
+// every operand kind the specialized steps handle. A user provided overload
+// (e.g. over dyn, or replacing the builtins when they aren't registered)
+// must not be bypassed by the inlined implementation.
+bool IsStandardOperator(const Resolver& resolver, absl::string_view function,
+                        int64_t expr_id) {
+  if (!resolver
+           .FindLazyOverloads(function, /*receiver_style=*/false,
+                              {cel::Kind::kAny, cel::Kind::kAny}, expr_id)
+           .empty()) {
+    return false;
+  }
+  std::vector<cel::Kind> kinds = {cel::Kind::kInt, cel::Kind::kUint};
+  if (function != cel::builtin::kModulo) {
+    kinds.push_back(cel::Kind::kDouble);
+  }
+  for (cel::Kind kind : kinds) {
+    std::vector<cel::FunctionOverloadReference> overloads =
+        resolver.FindOverloads(function, /*receiver_style=*/false,
+                               {kind, kind}, expr_id);
+    if (overloads.size() != 1 ||
+        overloads.front().descriptor.types() !=
+            std::vector<cel::Kind>{kind, kind}) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class TypedOperatorOptimization : public ProgramOptimizer {
+ public:
+  explicit TypedOperatorOptimization(const ReferenceMap& reference_map)
+      : reference_map_(reference_map) {}
+
+  absl::Status OnPreVisit(PlannerContext& context, const Expr& node) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status OnPostVisit(PlannerContext& context, const Expr& node) override {
+    // Specialized steps are flat, so they would prevent planning this node
+    // and its ancestors recursively.
+    if (context.options().max_recursion_depth != 0 || !node.has_call_expr()) {
+      return absl::OkStatus();
+    }
+    const Call& call_expr = node.call_expr();
+    if (call_expr.has_target() || call_expr.args().size() != 2) {
+      return absl::OkStatus();
+    }
+
+    auto reference = reference_map_.find(node.id());
+    if (reference == reference_map_.end() ||
+        reference->second.overload_id().size() != 1) {
+      return absl::OkStatus();
+    }
+    TypedOperatorStepFactory factory =
+        FindTypedOperatorStepFactory(reference->second.overload_id().front());
+    if (factory == nullptr) {
+      return absl::OkStatus();
+    }
+
+    if (!IsStandardOperator(context.resolver(), call_expr.function(),
+                            node.id())) {
+      return absl::OkStatus();
+    }
+
+    ExecutionPathView plan = context.GetSubplan(node);
+    if (plan.empty() || plan.back()->id() != node.id() ||
+        !IsFunctionStep(*plan.back())) {
+      // Already rewritten by another extension, or folded into a constant.
+      return absl::OkStatus();
+    }
+
+    CEL_ASSIGN_OR_RETURN(ExecutionPath new_plan, context.ExtractSubplan(node));
+    std::unique_ptr<const ExpressionStep> fallback = std::move(new_plan.back());
+    new_plan.back() = factory(std::move(fallback), node.id());
+    return context.ReplaceSubplan(node, std::move(new_plan));
+  }
+
+ private:
+  const ReferenceMap& reference_map_;
+};
+
+}  // namespace
+
+ProgramOptimizerFactory CreateTypedOperatorExtension() {
+  return [](PlannerContext& context, const AstImpl& ast) {
+    return std::make_unique<TypedOperatorOptimization>(ast.reference_map());
+  };
+}
+
+}  // namespace google::api::expr::runtime
@@ -0,0 +1,369 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/compiler/vectorized_comprehension_optimization.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "base/ast_internal/ast_impl.h"
+#include "base/ast_internal/expr.h"
+#include "base/builtins.h"
+#include "base/kind.h"
+#include "eval/compiler/flat_expr_builder_extensions.h"
+#include "eval/compiler/resolver.h"
+#include "eval/eval/evaluator_core.h"
+#include "eval/eval/vectorized_comprehension_step.h"
+#include "internal/status_macros.h"
+#include "runtime/runtime_options.h"
+
+namespace google::api::expr::runtime {
+namespace {
+
+using ::cel::ast_internal::AstImpl;
+using ::cel::ast_internal::Call;
+using ::cel::ast_internal::Comprehension;
+using ::cel::ast_internal::Expr;
+
+bool IsIdent(const Expr& expr, absl::string_view name) {
+  return expr.has_ident_expr() && expr.ident_expr().name() == name;
+}
+
+bool IsCall(const Expr& expr, absl::string_view function, size_t arg_count) {
+  return expr.has_call_expr() && !expr.call_expr().has_target() &&
+         expr.call_expr().function() == function &&
+         expr.call_expr().args().size() == arg_count;
+}
+
+bool IsBoolConstant(const Expr& expr, bool value) {
+  return expr.has_const_expr() && expr.const_expr().has_bool_value() &&
+         expr.const_expr().bool_value() == value;
+}
+
+bool IsIntConstant(const Expr& expr, int64_t value) {
+  return expr.has_const_expr() && expr.const_expr().has_int64_value() &&
+         expr.const_expr().int64_value() == value;
+}
+
+// Matches `@not_strictly_false(arg)`, returning `arg`.
+const Expr* NotStrictlyFalseArg(const Expr& expr) {
+  if (!IsCall(expr, cel::builtin::kNotStrictlyFalse, 1) &&
+      !IsCall(expr, cel::builtin::kNotStrictlyFalseDeprecated, 1)) {
+    return nullptr;
+  }
+  return &expr.call_expr().args()[0];
+}
+
+bool IsEmptyList(const Expr& expr) {
+  return expr.has_list_expr() && expr.list_expr().elements().empty();
+}
+
+// Matches `accu + [element]`, returning the element.
+const Expr* ListAppendElement(const Expr& expr, absl::string_view accu_var) {
+  if (!IsCall(expr, cel::builtin::kAdd, 2) ||
+      !IsIdent(expr.call_expr().args()[0], accu_var)) {
+    return nullptr;
+  }
+  const Expr& list = expr.call_expr().args()[1];
+  if (!list.has_list_expr() || list.list_expr().elements().size() != 1 ||
+      !list.list_expr().optional_indices().empty()) {
+    return nullptr;
+  }
+  return &list.list_expr().elements()[0];
+}
+
+// Matches `cond ? <then> : accu`, returning `cond` and `<then>`.
+bool MatchAccumulateIf(const Expr& expr, absl::string_view accu_var,
+                       const Expr*& condition, const Expr*& then) {
+  if (!IsCall(expr, cel::builtin::kTernary, 3) ||
+      !IsIdent(expr.call_expr().args()[2], accu_var)) {
+    return false;
+  }
+  condition = &expr.call_expr().args()[0];
+  then = &expr.call_expr().args()[1];
+  return true;
+}
+
+absl::optional<VectorizedOperator> FindOperator(absl::string_view function,
+                                               bool arithmetic) {
+  struct Entry {
+    absl::string_view function;
+    VectorizedOperator op;
+  };
+  static constexpr Entry kComparisons[] = {
+      {cel::builtin::kLess, VectorizedOperator::kLess},
+      {cel::builtin::kLessOrEqual, VectorizedOperator::kLessOrEqual},
+      {cel::builtin::kGreater, VectorizedOperator::kGreater},
+      {cel::builtin::kGreaterOrEqual, VectorizedOperator::kGreaterOrEqual},
+      {cel::builtin::kEqual, VectorizedOperator::kEqual},
+      {cel::builtin::kInequal, VectorizedOperator::kInequal},
+  };
+  static constexpr Entry kArithmetic[] = {
+      {cel::builtin::kAdd, VectorizedOperator::kAdd},
+      {cel::builtin::kSubtract, VectorizedOperator::kSubtract},
+      {cel::builtin::kMultiply, VectorizedOperator::kMultiply},
+      {cel::builtin::kDivide, VectorizedOperator::kDivide},
+  };
+  for (const Entry& entry :
+       arithmetic ? absl::MakeConstSpan(kArithmetic)
+                  : absl::MakeConstSpan(kComparisons)) {
+    if (entry.function == function) {
+      return entry.op;
+    }
+  }
+  return absl::nullopt;
+}
+
+// Returns the comparison equivalent to `op` with swapped operands.
+VectorizedOperator SwapOperands(VectorizedOperator op) {
+  switch (op) {
+    case VectorizedOperator::kLess:
+      return VectorizedOperator::kGreater;
+    case VectorizedOperator::kLessOrEqual:
+      return VectorizedOperator::kGreaterOrEqual;
+    case VectorizedOperator::kGreater:
+      return VectorizedOperator::kLess;
+    case VectorizedOperator::kGreaterOrEqual:
+      return VectorizedOperator::kLessOrEqual;
+    default:
+      return op;
+  }
+}
+
+struct MatchedComprehension {
+  VectorizedMacro macro;
+  VectorizedLambda lambda;
+  // Name of the function applied by the lambda.
+  absl::string_view function;
+  // Loop invariant operand of the lambda.
+  const Expr* operand;
+};
+
+// Matches `elem <op> operand` or `operand <op> elem` where operand is a
+// numeric constant or a variable other than the comprehension variables.
+bool MatchLambda(const Expr& expr, const Comprehension& comprehension,
+                 bool arithmetic, MatchedComprehension& match) {
+  if (!expr.has_call_expr() || expr.call_expr().has_target() ||
+      expr.call_expr().args().size() != 2) {
+    return false;
+  }
+  const Call& call = expr.call_expr();
+  absl::optional<VectorizedOperator> op =
+      FindOperator(call.function(), arithmetic);
+  if (!op.has_value()) {
+    return false;
+  }
+  bool element_on_right = IsIdent(call.args()[1], comprehension.iter_var());
+  if (!element_on_right && !IsIdent(call.args()[0], comprehension.iter_var())) {
+    return false;
+  }
+  const Expr& operand = call.args()[element_on_right ? 0 : 1];
+  if (operand.has_const_expr()) {
+    if (!operand.const_expr().has_int64_value() &&
+        !operand.const_expr().has_uint64_value() &&
+        !operand.const_expr().has_double_value()) {
+      return false;
+    }
+  } else if (!operand.has_ident_expr() ||
+             operand.ident_expr().name() == comprehension.iter_var() ||
+             operand.ident_expr().name() == comprehension.accu_var()) {
+    return false;
+  }
+
+  match.function = call.function();
+  match.operand = &operand;
+  match.lambda.op = *op;
+  match.lambda.element_on_right = element_on_right;
+  if (!arithmetic && element_on_right) {
+    match.lambda.op = SwapOperands(*op);
+    match.lambda.element_on_right = false;
+  }
+  return true;
+}
+
+// Matches the comprehensions generated by the standard macros:
+//   all:        init true, condition @not_strictly_false(accu),
+//               step accu && pred, result accu
+//   exists:     init false, condition @not_strictly_false(!accu),
+//               step accu || pred, result accu
+//   exists_one: init 0, condition true, step pred ? accu + 1 : accu,
+//               result accu == 1
+//   filter:     init [], condition true, step pred ? accu + [elem] : accu,
+//               result accu
+//   map:        init [], condition true, step accu + [fn], result accu
+absl::optional<MatchedComprehension> MatchComprehension(
+    const Comprehension& comprehension) {
+  absl::string_view accu_var = comprehension.accu_var();
+  const Expr& init = comprehension.accu_init();
+  const Expr& condition = comprehension.loop_condition();
+  const Expr& step = comprehension.loop_step();
+  const Expr& result = comprehension.result();
+
+  MatchedComprehension match;
+  const Expr* lambda = nullptr;
+  bool arithmetic = false;
+  const Expr* then = nullptr;
+  if (IsBoolConstant(init, true)) {
+    const Expr* arg = NotStrictlyFalseArg(condition);
+    if (arg == nullptr || !IsIdent(*arg, accu_var) ||
+        !IsCall(step, cel::builtin::kAnd, 2) ||
+        !IsIdent(step.call_expr().args()[0], accu_var)) {
+      return absl::nullopt;
+    }
+    match.macro = VectorizedMacro::kAll;
+    lambda = &step.call_expr().args()[1];
+  } else if (IsBoolConstant(init, false)) {
+    const Expr* arg = NotStrictlyFalseArg(condition);
+    if (arg == nullptr || !IsCall(*arg, cel::builtin::kNot, 1) ||
+        !IsIdent(arg->call_expr().args()[0], accu_var) ||
+        !IsCall(step, cel::builtin::kOr, 2) ||
+        !IsIdent(step.call_expr().args()[0], accu_var)) {
+      return absl::nullopt;
+    }
+    match.macro = VectorizedMacro::kExists;
+    lambda = &step.call_expr().args()[1];
+  } else if (IsIntConstant(init, 0)) {
+    if (!IsBoolConstant(condition, true) ||
+        !MatchAccumulateIf(step, accu_var, lambda, then) ||
+        !IsCall(*then, cel::builtin::kAdd, 2) ||
+        !IsIdent(then->call_expr().args()[0], accu_var) ||
+        !IsIntConstant(then->call_expr().args()[1], 1) ||
+        !IsCall(result, cel::builtin::kEqual, 2) ||
+        !IsIdent(result.call_expr().args()[0], accu_var) ||
+        !IsIntConstant(result.call_expr().args()[1], 1)) {
+      return absl::nullopt;
+    }
+    match.macro = VectorizedMacro::kExistsOne;
+  } else if (IsEmptyList(init)) {
+    if (!IsBoolConstant(condition, true)) {
+      return absl::nullopt;
+    }
+    if (MatchAccumulateIf(step, accu_var, lambda, then)) {
+      const Expr* element = ListAppendElement(*then, accu_var);
+      if (element == nullptr ||
+          !IsIdent(*element, comprehension.iter_var())) {
+        return absl::nullopt;
+      }
+      match.macro = VectorizedMacro::kFilter;
+    } else {
+      lambda = ListAppendElement(step, accu_var);
+      match.macro = VectorizedMacro::kMap;
+      arithmetic = true;
+    }
+  } else {
+    return absl::nullopt;
+  }
+  if (match.macro != VectorizedMacro::kExistsOne &&
+      !IsIdent(result, accu_var)) {
+    return absl::nullopt;
+  }
+  if (lambda == nullptr ||
+      !MatchLambda(*lambda, comprehension, arithmetic, match)) {
+    return absl::nullopt;
+  }
+  return match;
+}
+
+// Whether calls to `function` are resolved to the eagerly bound builtins for
+// all numeric operands.
+bool IsBuiltinOperator(const Resolver& resolver, absl::string_view function,
+                       int64_t expr_id) {
+  if (!resolver
+           .FindLazyOverloads(function, /*receiver_style=*/false,
+                              {cel::Kind::kAny, cel::Kind::kAny}, expr_id)
+           .empty()) {
+    return false;
+  }
+  for (cel::Kind kind :
+       {cel::Kind::kInt, cel::Kind::kUint, cel::Kind::kDouble}) {
+    if (resolver.FindOverloads(function, /*receiver_style=*/false,
+                               {kind, kind}, expr_id)
+            .empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class VectorizedComprehensionOptimization : public ProgramOptimizer {
+ public:
+  absl::Status OnPreVisit(PlannerContext& context, const Expr& node) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status OnPostVisit(PlannerContext& context, const Expr& node) override {
+    if (!node.has_comprehension_expr() ||
+        context.options().unknown_processing !=
+            cel::UnknownProcessingOptions::kDisabled ||
+        context.options().max_recursion_depth != 0) {
+      return absl::OkStatus();
+    }
+    const Comprehension& comprehension = node.comprehension_expr();
+    absl::optional<MatchedComprehension> match =
+        MatchComprehension(comprehension);
+    if (!match.has_value() ||
+        !IsBuiltinOperator(context.resolver(), match->function, node.id())) {
+      return absl::OkStatus();
+    }
+
+    if (!context.IsSubplanInspectable(node) ||
+        !context.IsSubplanInspectable(comprehension.iter_range()) ||
+        !context.IsSubplanInspectable(*match->operand)) {
+      return absl::OkStatus();
+    }
+    // The operand must be planned as a single step, e.g. not a lazily
+    // initialized cel.bind variable.
+    ExecutionPathView operand_plan = context.GetSubplan(*match->operand);
+    if (operand_plan.size() != 1 ||
+        operand_plan.front()->id() != match->operand->id()) {
+      return absl::OkStatus();
+    }
+    const ExpressionStep* operand = operand_plan.front().get();
+
+    CEL_ASSIGN_OR_RETURN(ExecutionPath plan,
+                         context.ExtractSubplan(comprehension.iter_range()));
+    if (plan.empty()) {
+      // Already rewritten by another extension.
+      return absl::OkStatus();
+    }
+    // The regular comprehension steps, evaluated for any other range.
+    CEL_ASSIGN_OR_RETURN(ExecutionPath fallback, context.ExtractSubplan(node));
+
+    plan.reserve(plan.size() + fallback.size() + 1);
+    plan.push_back(CreateVectorizedComprehensionStep(
+        match->macro, match->lambda, operand,
+        context.options().short_circuiting,
+        static_cast<int>(fallback.size()), node.id()));
+    for (auto& step : fallback) {
+      plan.push_back(std::move(step));
+    }
+    return context.ReplaceSubplan(node, std::move(plan));
+  }
+};
+
+}  // namespace
+
+ProgramOptimizerFactory CreateVectorizedComprehensionExtension() {
+  return [](PlannerContext& context, const AstImpl& ast) {
+    return std::make_unique<VectorizedComprehensionOptimization>();
+  };
+}
+
+}  // namespace google::api::expr::runtime
@@ -0,0 +1,41 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_COMPILER_VECTORIZED_COMPREHENSION_OPTIMIZATION_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_COMPILER_VECTORIZED_COMPREHENSION_OPTIMIZATION_H_
+
+#include "eval/compiler/flat_expr_builder_extensions.h"
+
+namespace google::api::expr::runtime {
+
+// Create a new extension for the FlatExprBuilder that evaluates simple numeric
+// comprehensions over primitive lists (cel::PrimitiveListValue) with data
+// parallel kernels.
+//
+// Applies to the standard macros whose lambda compares the element with, or
+// (for `map`) combines it arithmetically with, a constant or a variable, e.g.
+// `xs.all(x, x > 0)`, `xs.filter(x, x < limit)` or `xs.map(x, x * 2)`. Any
+// other range, or results that would be errors (e.g. integer overflow), are
+// evaluated by the regular plan.
+//
+// Assumes the standard definitions of the comparison and arithmetic
+// operators. Only applies to the flat plan
+// (RuntimeOptions::max_recursion_depth == 0) and is not applied when unknown
+// processing is enabled. Must be registered before the comprehension fusion
+// extension to take effect; fused comprehensions are not vectorized.
+ProgramOptimizerFactory CreateVectorizedComprehensionExtension();
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_COMPILER_VECTORIZED_COMPREHENSION_OPTIMIZATION_H_
@@ -13,6 +13,11 @@
 // limitations under the License.
 #include "eval/eval/compiler_constant_step.h"
 
+#include "absl/status/status.h"
+#include "common/value.h"
+#include "eval/eval/attribute_trail.h"
+#include "eval/eval/evaluator_core.h"
+
 namespace google::api::expr::runtime {
 
 absl::Status CompilerConstantStep::Evaluate(ExecutionFrame* frame) const {
@@ -21,4 +26,18 @@ absl::Status CompilerConstantStep::Evaluate(ExecutionFrame* frame) const {
   return absl::OkStatus();
 }
 
+Instruction CompilerConstantStep::GetInstruction() const {
+  Instruction instruction = ExpressionStepBase::GetInstruction();
+  instruction.opcode = Opcode::kConstant;
+  instruction.constant = &value_;
+  return instruction;
+}
+
+absl::Status DirectCompilerConstantStep::Evaluate(
+    ExecutionFrame& frame, cel::Value& result,
+    AttributeTrail& attribute) const {
+  result = value_;
+  return absl::OkStatus();
+}
+
 }  // namespace google::api::expr::runtime
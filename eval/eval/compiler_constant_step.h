@@ -16,7 +16,12 @@
 
 #include <utility>
 
+#include "absl/status/status.h"
 #include "common/native_type.h"
+#include "common/value.h"
+#include "eval/eval/attribute_trail.h"
+#include "eval/eval/direct_expression_step.h"
+#include "eval/eval/evaluator_core.h"
 #include "eval/eval/expression_step_base.h"
 
 namespace google::api::expr::runtime {
@@ -37,6 +42,30 @@ class CompilerConstantStep : public ExpressionStepBase {
     return cel::NativeTypeId::For<CompilerConstantStep>();
   }
 
+  Instruction GetInstruction() const override;
+
+  const cel::Value& value() const { return value_; }
+
+ private:
+  cel::Value value_;
+};
+
+// DirectExpressionStep implementation that returns a constant value.
+//
+// Overrides NativeTypeId() to allow the FlatExprBuilder and extensions to
+// inspect the underlying value.
+class DirectCompilerConstantStep : public DirectExpressionStep {
+ public:
+  DirectCompilerConstantStep(cel::Value value, int64_t expr_id)
+      : DirectExpressionStep(expr_id), value_(std::move(value)) {}
+
+  absl::Status Evaluate(ExecutionFrame& frame, cel::Value& result,
+                        AttributeTrail& attribute) const override;
+
+  cel::NativeTypeId GetNativeTypeId() const override {
+    return cel::NativeTypeId::For<DirectCompilerConstantStep>();
+  }
+
   const cel::Value& value() const { return value_; }
 
  private:
@@ -295,6 +295,168 @@ absl::Status ComprehensionCondStep::Evaluate(ExecutionFrame* frame) const {
   return absl::OkStatus();
 }
 
+Instruction ComprehensionCondStep::GetInstruction() const {
+  Instruction instruction = ExpressionStepBase::GetInstruction();
+  instruction.opcode = Opcode::kComprehensionCond;
+  instruction.condition = shortcircuiting_;
+  instruction.jump_offset = jump_offset_;
+  return instruction;
+}
+
+namespace {
+
+// Sets the value of a comprehension slot, reusing the slot if it is already
+// engaged.
+void SetSlotValue(ComprehensionSlots& slots, size_t index, Value value) {
+  if (ComprehensionSlots::Slot* slot = slots.Get(index); slot != nullptr) {
+    slot->value = std::move(value);
+    return;
+  }
+  slots.Set(index, std::move(value));
+}
+
+template <FusedLoopCondition kLoopCondition>
+class FusedComprehensionStep : public ExpressionStepBase {
+ public:
+  FusedComprehensionStep(size_t iter_slot, size_t accu_slot,
+                         bool short_circuiting, ExecutionPath loop_step,
+                         ExecutionPath result, int64_t expr_id)
+      : ExpressionStepBase(expr_id),
+        iter_slot_(iter_slot),
+        accu_slot_(accu_slot),
+        short_circuiting_(short_circuiting),
+        loop_step_(std::move(loop_step)),
+        result_(std::move(result)) {}
+
+  absl::Status Evaluate(ExecutionFrame* frame) const override;
+
+  size_t EmbeddedStepCount() const override {
+    size_t count = 0;
+    for (const auto& step : loop_step_) {
+      count += 1 + step->EmbeddedStepCount();
+    }
+    for (const auto& step : result_) {
+      count += 1 + step->EmbeddedStepCount();
+    }
+    return count;
+  }
+
+ private:
+  // Equivalent to the macro's loop condition evaluating to false.
+  static bool ShouldStop(const Value& accu) {
+    switch (kLoopCondition) {
+      case FusedLoopCondition::kNone:
+        return false;
+      case FusedLoopCondition::kUntilTrue:
+        return accu->Is<cel::BoolValue>() &&
+               accu.As<cel::BoolValue>().NativeValue();
+      case FusedLoopCondition::kUntilFalse:
+        return accu->Is<cel::BoolValue>() &&
+               !accu.As<cel::BoolValue>().NativeValue();
+    }
+    return false;
+  }
+
+  size_t iter_slot_;
+  size_t accu_slot_;
+  bool short_circuiting_;
+  ExecutionPath loop_step_;
+  ExecutionPath result_;
+};
+
+template <FusedLoopCondition kLoopCondition>
+absl::Status FusedComprehensionStep<kLoopCondition>::Evaluate(
+    ExecutionFrame* frame) const {
+  enum {
+    POS_ITER_RANGE,
+    POS_CURRENT_INDEX,
+    POS_ACCU_INIT,
+  };
+  constexpr int kStackSize = 3;
+  if (!frame->value_stack().HasEnough(kStackSize)) {
+    return absl::Status(absl::StatusCode::kInternal, "Value stack underflow");
+  }
+  const Value& iter_range = frame->value_stack().GetSpan(
+      kStackSize)[POS_ITER_RANGE];
+  if (!iter_range->Is<cel::ListValue>()) {
+    Value result = iter_range;
+    if (!result->Is<cel::ErrorValue>() && !result->Is<cel::UnknownValue>()) {
+      result = frame->value_factory().CreateErrorValue(
+          CreateNoMatchingOverloadError("<iter_range>"));
+    }
+    frame->value_stack().PopAndPush(kStackSize, std::move(result));
+    return absl::OkStatus();
+  }
+  cel::ListValue iter_range_list = iter_range.As<cel::ListValue>();
+  const size_t size = iter_range_list.Size();
+
+  ComprehensionSlots& slots = frame->comprehension_slots();
+  slots.Set(accu_slot_, std::move(frame->value_stack().Peek()));
+  frame->value_stack().Pop(1);
+
+  // Each pass corresponds to one evaluation of ComprehensionNextStep, so the
+  // iteration budget is consumed exactly as in the unfused loop.
+  for (size_t index = 0;; ++index) {
+    CEL_RETURN_IF_ERROR(frame->IncrementIterations());
+    if (index >= size) {
+      break;
+    }
+    CEL_ASSIGN_OR_RETURN(Value element,
+                         iter_range_list.Get(frame->value_factory(), index));
+    SetSlotValue(slots, iter_slot_, std::move(element));
+    if (short_circuiting_ && ShouldStop(slots.Get(accu_slot_)->value)) {
+      break;
+    }
+    CEL_RETURN_IF_ERROR(frame->EvaluateSubplan(loop_step_));
+    SetSlotValue(slots, accu_slot_, std::move(frame->value_stack().Peek()));
+    frame->value_stack().Pop(1);
+  }
+  slots.ClearSlot(iter_slot_);
+
+  Value result;
+  if (result_.empty()) {
+    result = std::move(slots.Get(accu_slot_)->value);
+  } else {
+    CEL_RETURN_IF_ERROR(frame->EvaluateSubplan(result_));
+    result = std::move(frame->value_stack().Peek());
+    frame->value_stack().Pop(1);
+  }
+  slots.ClearSlot(accu_slot_);
+
+  if (frame->enable_comprehension_list_append() &&
+      MutableListValue::Is(result)) {
+    MutableListValue& list_value = MutableListValue::Cast(result);
+    CEL_ASSIGN_OR_RETURN(result, std::move(list_value).Build());
+  }
+  frame->value_stack().PopAndPush(kStackSize - 1, std::move(result));
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+std::unique_ptr<ExpressionStep> CreateFusedComprehensionStep(
+    size_t iter_slot, size_t accu_slot, FusedLoopCondition loop_condition,
+    bool short_circuiting, ExecutionPath loop_step, ExecutionPath result,
+    int64_t expr_id) {
+  switch (loop_condition) {
+    case FusedLoopCondition::kUntilTrue:
+      return std::make_unique<
+          FusedComprehensionStep<FusedLoopCondition::kUntilTrue>>(
+          iter_slot, accu_slot, short_circuiting, std::move(loop_step),
+          std::move(result), expr_id);
+    case FusedLoopCondition::kUntilFalse:
+      return std::make_unique<
+          FusedComprehensionStep<FusedLoopCondition::kUntilFalse>>(
+          iter_slot, accu_slot, short_circuiting, std::move(loop_step),
+          std::move(result), expr_id);
+    case FusedLoopCondition::kNone:
+      break;
+  }
+  return std::make_unique<FusedComprehensionStep<FusedLoopCondition::kNone>>(
+      iter_slot, accu_slot, short_circuiting, std::move(loop_step),
+      std::move(result), expr_id);
+}
+
 std::unique_ptr<ExpressionStep> CreateComprehensionFinishStep(size_t accu_slot,
                                                               int64_t expr_id) {
   return std::make_unique<ComprehensionFinish>(accu_slot, expr_id);
@@ -6,6 +6,7 @@
 #include <memory>
 
 #include "absl/status/status.h"
+#include "common/native_type.h"
 #include "eval/eval/evaluator_core.h"
 #include "eval/eval/expression_step_base.h"
 
@@ -18,8 +19,15 @@ class ComprehensionNextStep : public ExpressionStepBase {
   void set_jump_offset(int offset);
   void set_error_jump_offset(int offset);
 
+  size_t iter_slot() const { return iter_slot_; }
+  size_t accu_slot() const { return accu_slot_; }
+
   absl::Status Evaluate(ExecutionFrame* frame) const override;
 
+  cel::NativeTypeId GetNativeTypeId() const override {
+    return cel::NativeTypeId::For<ComprehensionNextStep>();
+  }
+
  private:
   size_t iter_slot_;
   size_t accu_slot_;
@@ -37,6 +45,8 @@ class ComprehensionCondStep : public ExpressionStepBase {
 
   absl::Status Evaluate(ExecutionFrame* frame) const override;
 
+  Instruction GetInstruction() const override;
+
  private:
   size_t iter_slot_;
   size_t accu_slot_;
@@ -45,6 +55,32 @@ class ComprehensionCondStep : public ExpressionStepBase {
   bool shortcircuiting_;
 };
 
+// Loop conditions of the standard comprehension macros that a fused
+// comprehension step checks natively instead of evaluating a subprogram.
+enum class FusedLoopCondition {
+  // `true` (map, filter, exists_one): iterate over the whole range.
+  kNone,
+  // `@not_strictly_false(!accu)` (exists): stop once the accumulator is true.
+  kUntilTrue,
+  // `@not_strictly_false(accu)` (all): stop once the accumulator is false.
+  kUntilFalse,
+};
+
+// Creates a step that runs a comprehension loop to completion.
+//
+// Replaces the ComprehensionNextStep, loop condition, ComprehensionCondStep,
+// loop jump and ComprehensionFinish steps: the loop_step subprogram is
+// evaluated once per element, followed by the result subprogram. An empty
+// result subprogram means the result is the accumulator.
+//
+// Expects the stack as left by the ComprehensionInit step and accu_init.
+// Stack size before: 3.
+// Stack size after: 1.
+std::unique_ptr<ExpressionStep> CreateFusedComprehensionStep(
+    size_t iter_slot, size_t accu_slot, FusedLoopCondition loop_condition,
+    bool short_circuiting, ExecutionPath loop_step, ExecutionPath result,
+    int64_t expr_id);
+
 // Creates a cleanup step for the comprehension.
 // Removes the comprehension context then pushes the 'result' sub expression to
 // the top of the stack.
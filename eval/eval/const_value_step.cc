@@ -9,6 +9,7 @@
 #include "common/value.h"
 #include "common/value_manager.h"
 #include "eval/eval/compiler_constant_step.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 #include "internal/status_macros.h"
 #include "runtime/internal/convert_constant.h"
@@ -34,4 +35,10 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateConstValueStep(
                                                 expr_id, comes_from_ast);
 }
 
+std::unique_ptr<DirectExpressionStep> CreateConstValueDirectStep(
+    cel::Value value, int64_t expr_id) {
+  return std::make_unique<DirectCompilerConstantStep>(std::move(value),
+                                                      expr_id);
+}
+
 }  // namespace google::api::expr::runtime
@@ -8,6 +8,7 @@
 #include "base/ast_internal/expr.h"
 #include "common/value.h"
 #include "common/value_manager.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 
 namespace google::api::expr::runtime {
@@ -23,6 +24,10 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateConstValueStep(
     const cel::ast_internal::Constant&, int64_t expr_id,
     cel::ValueManager& value_factory, bool comes_from_ast = true);
 
+// Factory method for a directly evaluated Constant Value expression step.
+std::unique_ptr<DirectExpressionStep> CreateConstValueDirectStep(
+    cel::Value value, int64_t expr_id);
+
 }  // namespace google::api::expr::runtime
 
 #endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_CONST_VALUE_STEP_H_
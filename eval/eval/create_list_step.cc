@@ -1,5 +1,6 @@
 #include "eval/eval/create_list_step.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <utility>
@@ -25,18 +26,37 @@ using ::cel::runtime_internal::MutableListValue;
 
 class CreateListStep : public ExpressionStepBase {
  public:
-  CreateListStep(int64_t expr_id, int list_size, bool immutable)
+  CreateListStep(int64_t expr_id, int list_size, bool immutable,
+                 bool reserve_range_size = false)
       : ExpressionStepBase(expr_id),
         list_size_(list_size),
-        immutable_(immutable) {}
+        immutable_(immutable),
+        reserve_range_size_(reserve_range_size) {}
 
   absl::Status Evaluate(ExecutionFrame* frame) const override;
 
  private:
+  // Returns the number of elements to reserve in the list builder.
+  size_t Capacity(ExecutionFrame* frame) const;
+
   int list_size_;
   bool immutable_;
+  bool reserve_range_size_;
 };
 
+size_t CreateListStep::Capacity(ExecutionFrame* frame) const {
+  size_t capacity = list_size_;
+  // As a comprehension accumulator, the list is created with the iteration
+  // range and the current index below it on the stack.
+  if (reserve_range_size_ && frame->value_stack().HasEnough(list_size_ + 2)) {
+    const cel::Value& range = frame->value_stack().GetSpan(list_size_ + 2)[0];
+    if (range->Is<cel::ListValue>()) {
+      capacity += range.As<cel::ListValue>().Size();
+    }
+  }
+  return capacity;
+}
+
 absl::Status CreateListStep::Evaluate(ExecutionFrame* frame) const {
   if (list_size_ < 0) {
     return absl::Status(absl::StatusCode::kInternal,
@@ -76,7 +96,7 @@ absl::Status CreateListStep::Evaluate(ExecutionFrame* frame) const {
                        frame->value_manager().NewListValueBuilder(
                            frame->value_manager().GetDynListType()));
 
-  builder->Reserve(args.size());
+  builder->Reserve(Capacity(frame));
   for (auto& arg : args) {
     CEL_RETURN_IF_ERROR(builder->Add(std::move(arg)));
   }
@@ -101,9 +121,11 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateCreateListStep(
 }
 
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateCreateMutableListStep(
-    const cel::ast_internal::CreateList& create_list_expr, int64_t expr_id) {
+    const cel::ast_internal::CreateList& create_list_expr, int64_t expr_id,
+    bool reserve_range_size) {
   return std::make_unique<CreateListStep>(
-      expr_id, create_list_expr.elements().size(), /*immutable=*/false);
+      expr_id, create_list_expr.elements().size(), /*immutable=*/false,
+      reserve_range_size);
 }
 
 }  // namespace google::api::expr::runtime
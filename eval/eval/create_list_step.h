@@ -17,8 +17,13 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateCreateListStep(
 // Factory method for CreateList which constructs a mutable list as the list
 // construction step is generated by a macro AST rewrite rather than by a user
 // entered expression.
+//
+// If `reserve_range_size`, the list is expected to be the accumulator of a
+// comprehension appending one element per iteration (e.g. map()), and
+// capacity for the size of the iteration range is reserved up front.
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateCreateMutableListStep(
-    const cel::ast_internal::CreateList& create_list_expr, int64_t expr_id);
+    const cel::ast_internal::CreateList& create_list_expr, int64_t expr_id,
+    bool reserve_range_size = false);
 
 }  // namespace google::api::expr::runtime
 
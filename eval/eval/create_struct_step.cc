@@ -31,6 +31,7 @@
 #include "extensions/protobuf/memory_manager.h"
 #include "internal/overflow.h"
 #include "internal/status_macros.h"
+#include "runtime/compact_map_value.h"
 
 namespace google::api::expr::runtime {
 
@@ -75,8 +76,11 @@ class CreateStructStepForStruct final : public ExpressionStepBase {
 // `CreateStruct` implementation for map.
 class CreateStructStepForMap final : public ExpressionStepBase {
  public:
-  CreateStructStepForMap(int64_t expr_id, size_t entry_count)
-      : ExpressionStepBase(expr_id), entry_count_(entry_count) {}
+  CreateStructStepForMap(int64_t expr_id, size_t entry_count,
+                         bool compact_map)
+      : ExpressionStepBase(expr_id),
+        entry_count_(entry_count),
+        compact_map_(compact_map) {}
 
   absl::Status Evaluate(ExecutionFrame* frame) const override;
 
@@ -84,6 +88,7 @@ class CreateStructStepForMap final : public ExpressionStepBase {
   absl::StatusOr<Value> DoEvaluate(ExecutionFrame* frame) const;
 
   size_t entry_count_;
+  bool compact_map_;
 };
 
 absl::StatusOr<Value> CreateStructStepForStruct::DoEvaluate(
@@ -150,8 +155,14 @@ absl::StatusOr<Value> CreateStructStepForMap::DoEvaluate(
     }
   }
 
-  CEL_ASSIGN_OR_RETURN(auto builder, frame->value_manager().NewMapValueBuilder(
-                                         cel::MapTypeView{}));
+  cel::Unique<cel::MapValueBuilder> builder;
+  if (compact_map_) {
+    builder = cel::NewCompactMapValueBuilder(frame->memory_manager(),
+                                             cel::MapType(cel::MapTypeView{}));
+  } else {
+    CEL_ASSIGN_OR_RETURN(builder, frame->value_manager().NewMapValueBuilder(
+                                      cel::MapTypeView{}));
+  }
   builder->Reserve(entry_count_);
 
   for (size_t i = 0; i < entry_count_; i += 1) {
@@ -203,11 +214,11 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateCreateStructStepForStruct(
 }
 
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateCreateStructStepForMap(
-    const cel::ast_internal::CreateStruct& create_struct_expr,
-    int64_t expr_id) {
+    const cel::ast_internal::CreateStruct& create_struct_expr, int64_t expr_id,
+    bool compact_map) {
   // Make map-creating step.
   return std::make_unique<CreateStructStepForMap>(
-      expr_id, create_struct_expr.entries().size());
+      expr_id, create_struct_expr.entries().size(), compact_map);
 }
 
 }  // namespace google::api::expr::runtime
@@ -21,8 +21,12 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateCreateStructStepForStruct(
     int64_t expr_id, cel::TypeManager& type_manager);
 
 // Creates an `ExpressionStep` which performs `CreateStruct` for a map.
+//
+// If `compact_map`, the map is built as a compact map value (see
+// runtime/compact_map_value.h) instead of through the value manager.
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateCreateStructStepForMap(
-    const cel::ast_internal::CreateStruct& create_struct_expr, int64_t expr_id);
+    const cel::ast_internal::CreateStruct& create_struct_expr, int64_t expr_id,
+    bool compact_map = false);
 
 }  // namespace google::api::expr::runtime
 
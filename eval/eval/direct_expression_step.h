@@ -0,0 +1,90 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_EVAL_DIRECT_EXPRESSION_STEP_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_EVAL_DIRECT_EXPRESSION_STEP_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "common/native_type.h"
+#include "common/value.h"
+#include "eval/eval/attribute_trail.h"
+#include "eval/eval/evaluator_core.h"
+
+namespace google::api::expr::runtime {
+
+// Represents a directly evaluated CEL expression.
+//
+// Direct steps evaluate their dependencies recursively and return the result
+// to the caller instead of communicating through the value stack. This avoids
+// the stack bookkeeping of the flat plan at the cost of native recursion, so
+// the planner bounds the depth of recursive subprograms (see
+// cel::RuntimeOptions::max_recursion_depth).
+class DirectExpressionStep {
+ public:
+  explicit DirectExpressionStep(int64_t expr_id) : expr_id_(expr_id) {}
+
+  DirectExpressionStep(const DirectExpressionStep&) = delete;
+  DirectExpressionStep& operator=(const DirectExpressionStep&) = delete;
+
+  virtual ~DirectExpressionStep() = default;
+
+  int64_t expr_id() const { return expr_id_; }
+
+  // Evaluates the subexpression, writing the resulting value and its
+  // attribute trail to the out parameters.
+  //
+  // A non-ok status is an unrecoverable error, CEL errors are returned as
+  // cel::ErrorValue results.
+  virtual absl::Status Evaluate(ExecutionFrame& frame, cel::Value& result,
+                                AttributeTrail& attribute) const = 0;
+
+  virtual cel::NativeTypeId GetNativeTypeId() const {
+    return cel::NativeTypeId();
+  }
+
+ private:
+  int64_t expr_id_;
+};
+
+// Adapts a direct step to the stack machine: evaluates the recursive
+// subprogram and pushes its result.
+class WrappedDirectStep : public ExpressionStep {
+ public:
+  WrappedDirectStep(std::unique_ptr<DirectExpressionStep> impl, int64_t expr_id)
+      : ExpressionStep(expr_id, /*comes_from_ast=*/true),
+        impl_(std::move(impl)) {}
+
+  absl::Status Evaluate(ExecutionFrame* frame) const override;
+
+  cel::NativeTypeId GetNativeTypeId() const override {
+    return cel::NativeTypeId::For<WrappedDirectStep>();
+  }
+
+  const DirectExpressionStep* wrapped() const { return impl_.get(); }
+
+ private:
+  std::unique_ptr<DirectExpressionStep> impl_;
+};
+
+// Factory method for wrapping a direct step for the stack machine.
+std::unique_ptr<ExpressionStep> WrapDirectStep(
+    std::unique_ptr<DirectExpressionStep> impl);
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_DIRECT_EXPRESSION_STEP_H_
@@ -19,6 +19,7 @@
 #include <utility>
 
 #include "absl/base/optimization.h"
+#include "absl/cleanup/cleanup.h"
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/status/status.h"
@@ -26,11 +27,13 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "absl/utility/utility.h"
 #include "base/type_provider.h"
 #include "common/memory.h"
 #include "common/value.h"
 #include "common/value_manager.h"
+#include "eval/eval/comprehension_slots.h"
 #include "internal/status_macros.h"
 #include "runtime/activation_interface.h"
 
@@ -39,16 +42,16 @@ namespace google::api::expr::runtime {
 FlatExpressionEvaluatorState::FlatExpressionEvaluatorState(
     size_t value_stack_size, size_t comprehension_slot_count,
     const cel::TypeProvider& type_provider,
-    cel::MemoryManagerRef memory_manager)
-    : value_stack_(value_stack_size),
+    cel::MemoryManagerRef memory_manager, bool enable_attribute_tracking)
+    : value_stack_(value_stack_size, enable_attribute_tracking),
       comprehension_slots_(comprehension_slot_count),
       managed_value_factory_(absl::in_place, type_provider, memory_manager),
       value_factory_(&managed_value_factory_->get()) {}
 
 FlatExpressionEvaluatorState::FlatExpressionEvaluatorState(
     size_t value_stack_size, size_t comprehension_slot_count,
-    cel::ValueManager& value_factory)
-    : value_stack_(value_stack_size),
+    cel::ValueManager& value_factory, bool enable_attribute_tracking)
+    : value_stack_(value_stack_size, enable_attribute_tracking),
       comprehension_slots_(comprehension_slot_count),
       managed_value_factory_(absl::nullopt),
       value_factory_(&value_factory) {}
@@ -58,6 +61,23 @@ void FlatExpressionEvaluatorState::Reset() {
   comprehension_slots_.Reset();
 }
 
+void FlatExpressionEvaluatorState::set_value_factory(
+    cel::ValueManager& value_factory) {
+  Reset();
+  managed_value_factory_.reset();
+  value_factory_ = &value_factory;
+}
+
+void ExecutionFrame::Return() {
+  ABSL_DCHECK(!call_stack_.empty());
+  const SubFrame& frame = call_stack_.back();
+  pc_ = frame.return_pc;
+  execution_path_ = frame.return_expression;
+  instructions_ = frame.return_instructions;
+  ABSL_DCHECK_EQ(value_stack().size(), frame.expected_stack_size);
+  call_stack_.pop_back();
+}
+
 const ExpressionStep* ExecutionFrame::Next() {
   while (true) {
     const size_t end_pos = execution_path_.size();
@@ -69,11 +89,7 @@ const ExpressionStep* ExecutionFrame::Next() {
     }
     if (ABSL_PREDICT_TRUE(pc_ == end_pos)) {
       if (!call_stack_.empty()) {
-        pc_ = call_stack_.back().return_pc;
-        execution_path_ = call_stack_.back().return_expression;
-        ABSL_DCHECK_EQ(value_stack().size(),
-                       call_stack_.back().expected_stack_size);
-        call_stack_.pop_back();
+        Return();
         continue;
       }
     } else {
@@ -120,11 +136,244 @@ class EvaluationStatus final {
 
 }  // namespace
 
+absl::Status ExecutionFrame::EvaluateInstructions() {
+  while (true) {
+    if (ABSL_PREDICT_FALSE(pc_ >= instructions_.size())) {
+      if (pc_ == instructions_.size() && !call_stack_.empty()) {
+        Return();
+        continue;
+      }
+      if (pc_ > instructions_.size()) {
+        ABSL_LOG(ERROR)
+            << "Attempting to step beyond the end of execution path.";
+      }
+      return absl::OkStatus();
+    }
+
+    const Instruction& instruction = instructions_[pc_++];
+    // Handled cases continue to the next instruction. Anything else breaks
+    // out of the switch and is evaluated by the originating step.
+    switch (instruction.opcode) {
+      case Opcode::kConstant:
+        value_stack().Push(*instruction.constant);
+        continue;
+      case Opcode::kSlot: {
+        if (enable_attribute_tracking()) {
+          break;
+        }
+        const ComprehensionSlots::Slot* slot =
+            comprehension_slots().Get(instruction.index);
+        if (slot == nullptr) {
+          break;
+        }
+        value_stack().Push(slot->value, slot->attribute);
+        continue;
+      }
+      case Opcode::kIdent: {
+        // Unknown and missing attribute checks need the attribute trail.
+        if (enable_attribute_tracking()) {
+          break;
+        }
+        cel::Value scratch;
+        absl::StatusOr<absl::optional<cel::ValueView>> value =
+            modern_activation().FindVariableAt(
+                value_factory(), instruction.index, *instruction.name,
+                scratch);
+        if (!value.ok()) {
+          return std::move(value).status();
+        }
+        // Let the step report the missing variable.
+        if (!value->has_value()) {
+          break;
+        }
+        value_stack().Push(cel::Value{**value});
+        continue;
+      }
+      case Opcode::kSelect: {
+        if (enable_attribute_tracking() ||
+            ABSL_PREDICT_FALSE(!value_stack().HasEnough(1))) {
+          break;
+        }
+        const cel::Value& arg = value_stack().Peek();
+        cel::Value scratch;
+        absl::StatusOr<cel::ValueView> field;
+        if (arg->Is<cel::StructValue>()) {
+          field = arg.As<cel::StructValue>().GetFieldByName(
+              value_factory(), *instruction.name, scratch,
+              instruction.unboxing_option);
+        } else if (arg->Is<cel::MapValue>()) {
+          field = arg.As<cel::MapValue>().Get(value_factory(),
+                                              *instruction.field, scratch);
+        } else {
+          // Errors, unknowns and invalid operands.
+          break;
+        }
+        if (!field.ok()) {
+          return std::move(field).status();
+        }
+        value_stack().PopAndPush(cel::Value{*field});
+        continue;
+      }
+      case Opcode::kJump:
+        if (EvaluationStatus status(JumpTo(instruction.jump_offset));
+            !status.ok()) {
+          return std::move(status).Consume();
+        }
+        continue;
+      case Opcode::kCondJump: {
+        if (ABSL_PREDICT_FALSE(!value_stack().HasEnough(1))) {
+          break;
+        }
+        const cel::Value& value = value_stack().Peek();
+        const bool should_jump =
+            value->Is<cel::BoolValue>() &&
+            instruction.condition == value.As<cel::BoolValue>().NativeValue();
+        if (!instruction.leave_on_stack) {
+          value_stack().Pop(1);
+        }
+        if (should_jump) {
+          if (EvaluationStatus status(JumpTo(instruction.jump_offset));
+              !status.ok()) {
+            return std::move(status).Consume();
+          }
+        }
+        continue;
+      }
+      case Opcode::kBoolCheckJump:
+        if (ABSL_PREDICT_TRUE(value_stack().HasEnough(1)) &&
+            value_stack().Peek()->Is<cel::BoolValue>()) {
+          continue;
+        }
+        break;
+      case Opcode::kAnd:
+      case Opcode::kOr: {
+        if (ABSL_PREDICT_FALSE(!value_stack().HasEnough(2))) {
+          break;
+        }
+        absl::Span<const cel::Value> args = value_stack().GetSpan(2);
+        if (!args[0]->Is<cel::BoolValue>() || !args[1]->Is<cel::BoolValue>()) {
+          break;
+        }
+        const bool lhs = args[0].As<cel::BoolValue>().NativeValue();
+        const bool rhs = args[1].As<cel::BoolValue>().NativeValue();
+        value_stack().PopAndPush(
+            2, cel::BoolValue(instruction.opcode == Opcode::kAnd ? lhs && rhs
+                                                                 : lhs || rhs));
+        continue;
+      }
+      case Opcode::kTernary: {
+        if (ABSL_PREDICT_FALSE(!value_stack().HasEnough(3))) {
+          break;
+        }
+        absl::Span<const cel::Value> args = value_stack().GetSpan(3);
+        if (!args[0]->Is<cel::BoolValue>()) {
+          break;
+        }
+        cel::Value result =
+            args[args[0].As<cel::BoolValue>().NativeValue() ? 1 : 2];
+        value_stack().PopAndPush(3, std::move(result));
+        continue;
+      }
+      case Opcode::kComprehensionCond: {
+        if (ABSL_PREDICT_FALSE(!value_stack().HasEnough(3)) ||
+            !value_stack().Peek()->Is<cel::BoolValue>()) {
+          break;
+        }
+        const bool loop_condition =
+            value_stack().Peek().As<cel::BoolValue>().NativeValue();
+        value_stack().Pop(1);
+        if (!loop_condition && instruction.condition) {
+          if (EvaluationStatus status(JumpTo(instruction.jump_offset));
+              !status.ok()) {
+            return std::move(status).Consume();
+          }
+        }
+        continue;
+      }
+      case Opcode::kGeneric:
+        break;
+    }
+
+    if (EvaluationStatus status(instruction.step->Evaluate(this));
+        !status.ok()) {
+      return std::move(status).Consume();
+    }
+  }
+}
+
 absl::StatusOr<cel::Value> ExecutionFrame::Evaluate(
     EvaluationListener listener) {
-  const size_t initial_stack_size = value_stack().size();
+  initial_stack_size_ = value_stack().size();
+  return Run(std::move(listener));
+}
 
-  if (!listener) {
+absl::StatusOr<cel::Value> ExecutionFrame::Resume() {
+  ABSL_DCHECK(suspended());
+  ABSL_DCHECK(pending_->IsReady());
+  std::shared_ptr<cel::ValueFuture> pending = std::move(pending_);
+  CEL_ASSIGN_OR_RETURN(cel::Value result, pending->Get());
+  // The suspended call pushed a placeholder for its result.
+  if (!value_stack().HasEnough(1)) {
+    return absl::InternalError("Value stack underflow");
+  }
+  value_stack().PopAndPush(1, std::move(result));
+  return Run(EvaluationListener());
+}
+
+absl::Status ExecutionFrame::EvaluateSubplan(ExecutionPathView subplan) {
+  const size_t return_pc = pc_;
+  const ExecutionPathView return_expression = execution_path_;
+  const InstructionPathView return_instructions = instructions_;
+  const size_t call_depth = call_stack_.size();
+  const bool enable_suspension = enable_suspension_;
+  pc_ = 0UL;
+  execution_path_ = subplan;
+  instructions_ = InstructionPathView();
+  enable_suspension_ = false;
+
+  absl::Status status;
+  while (true) {
+    if (ABSL_PREDICT_TRUE(pc_ < execution_path_.size())) {
+      const ExpressionStep* step = execution_path_[pc_++].get();
+      status = step->Evaluate(this);
+      if (ABSL_PREDICT_FALSE(!status.ok())) {
+        break;
+      }
+      if (listener_ != nullptr && step->comes_from_ast() &&
+          !value_stack().empty()) {
+        status =
+            (*listener_)(step->id(), value_stack().Peek(), value_factory());
+        if (!status.ok()) {
+          break;
+        }
+      }
+      continue;
+    }
+    // Return from lazily evaluated subexpressions called by the subplan.
+    if (pc_ == execution_path_.size() && call_stack_.size() > call_depth) {
+      Return();
+      continue;
+    }
+    break;
+  }
+
+  pc_ = return_pc;
+  execution_path_ = return_expression;
+  instructions_ = return_instructions;
+  enable_suspension_ = enable_suspension;
+  return status;
+}
+
+absl::StatusOr<cel::Value> ExecutionFrame::Run(EvaluationListener listener) {
+  const size_t initial_stack_size = initial_stack_size_;
+  listener_ = listener ? &listener : nullptr;
+  absl::Cleanup reset_listener = [this]() { listener_ = nullptr; };
+
+  if (!listener && !instruction_subexpressions_.empty()) {
+    if (EvaluationStatus status(EvaluateInstructions()); !status.ok()) {
+      return std::move(status).Consume();
+    }
+  } else if (!listener) {
     for (const ExpressionStep* expr = Next();
          ABSL_PREDICT_TRUE(expr != nullptr); expr = Next()) {
       if (EvaluationStatus status(expr->Evaluate(this)); !status.ok()) {
@@ -168,16 +417,63 @@ absl::StatusOr<cel::Value> ExecutionFrame::Evaluate(
   return value;
 }
 
+void FlatExpression::LowerInstructions() {
+  instructions_.reserve(path_.size());
+  for (const auto& step : path_) {
+    instructions_.push_back(step->GetInstruction());
+  }
+
+  // Subexpressions are views into the main path (see FlatExprBuilder), so the
+  // lowered subexpressions share their offsets into the instruction array. If
+  // that doesn't hold, fall back to evaluating the steps directly.
+  const auto* path_begin = path_.data();
+  const auto* path_end = path_.data() + path_.size();
+  instruction_subexpressions_.reserve(subexpressions_.size());
+  for (const ExecutionPathView& subexpression : subexpressions_) {
+    if (subexpression.empty()) {
+      instruction_subexpressions_.push_back(InstructionPathView());
+      continue;
+    }
+    const auto* begin = subexpression.data();
+    const auto* end = subexpression.data() + subexpression.size();
+    if (begin < path_begin || end > path_end) {
+      instructions_.clear();
+      instruction_subexpressions_.clear();
+      return;
+    }
+    instruction_subexpressions_.push_back(
+        absl::MakeConstSpan(instructions_)
+            .subspan(begin - path_begin, subexpression.size()));
+  }
+}
+
+size_t FlatExpression::ValueStackSize(ExecutionPathView path) {
+  size_t size = path.size();
+  for (const auto& step : path) {
+    size += step->EmbeddedStepCount();
+  }
+  return size;
+}
+
 FlatExpressionEvaluatorState FlatExpression::MakeEvaluatorState(
     cel::MemoryManagerRef manager) const {
-  return FlatExpressionEvaluatorState(path_.size(), comprehension_slots_size_,
-                                      type_provider_, manager);
+  return FlatExpressionEvaluatorState(
+      value_stack_size_, comprehension_slots_size_, type_provider_, manager,
+      ExecutionFrame::AttributeTrackingEnabled(options_));
 }
 
 FlatExpressionEvaluatorState FlatExpression::MakeEvaluatorState(
     cel::ValueManager& value_factory) const {
-  return FlatExpressionEvaluatorState(path_.size(), comprehension_slots_size_,
-                                      value_factory);
+  return FlatExpressionEvaluatorState(
+      value_stack_size_, comprehension_slots_size_, value_factory,
+      ExecutionFrame::AttributeTrackingEnabled(options_));
+}
+
+std::unique_ptr<FlatExpressionEvaluatorState>
+FlatExpression::MakeEvaluatorStatePtr(cel::ValueManager& value_factory) const {
+  return std::make_unique<FlatExpressionEvaluatorState>(
+      value_stack_size_, comprehension_slots_size_, value_factory,
+      ExecutionFrame::AttributeTrackingEnabled(options_));
 }
 
 absl::StatusOr<cel::Value> FlatExpression::EvaluateWithCallback(
@@ -185,9 +481,22 @@ absl::StatusOr<cel::Value> FlatExpression::EvaluateWithCallback(
     FlatExpressionEvaluatorState& state) const {
   state.Reset();
 
-  ExecutionFrame frame(subexpressions_, activation, options_, state);
+  ExecutionFrame frame(subexpressions_, instruction_subexpressions_,
+                       activation, options_, state);
 
   return frame.Evaluate(std::move(listener));
 }
 
+std::unique_ptr<ExecutionFrame> FlatExpression::MakeSuspendableFrame(
+    const cel::ActivationInterface& activation,
+    FlatExpressionEvaluatorState& state) const {
+  state.Reset();
+
+  auto frame = std::make_unique<ExecutionFrame>(
+      subexpressions_, instruction_subexpressions_, activation, options_,
+      state);
+  frame->set_enable_suspension(true);
+  return frame;
+}
+
 }  // namespace google::api::expr::runtime
@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -28,6 +29,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "base/function.h"
 #include "base/type_provider.h"
 #include "common/memory.h"
 #include "common/native_type.h"
@@ -50,6 +52,72 @@ class ExecutionFrame;
 
 using EvaluationListener = cel::TraceableProgram::EvaluationListener;
 
+class ExpressionStep;
+
+// Operation codes for the direct dispatch evaluation loop.
+//
+// See cel::RuntimeOptions::enable_direct_dispatch.
+enum class Opcode : uint8_t {
+  // Evaluated with a virtual call to ExpressionStep::Evaluate.
+  kGeneric,
+  // Push a constant value.
+  kConstant,
+  // Push the value of a comprehension slot.
+  kSlot,
+  // Push the value of a variable from the activation.
+  kIdent,
+  // Replace the struct or map on the top of the stack with one of its fields.
+  kSelect,
+  // Unconditional jump.
+  kJump,
+  // Jump if the top of the stack is the given boolean.
+  kCondJump,
+  // Jump if the top of the stack is not a boolean.
+  kBoolCheckJump,
+  // Logical operators.
+  kAnd,
+  kOr,
+  // Ternary selection (non-short-circuiting ternary).
+  kTernary,
+  // Comprehension loop condition.
+  kComprehensionCond,
+};
+
+// Compact representation of an ExpressionStep for the direct dispatch loop.
+//
+// Operands are only meaningful for the opcodes that use them. The originating
+// step is always retained so the loop can fall back to ExpressionStep::Evaluate
+// for any case that isn't handled inline (e.g. errors and unknowns).
+struct Instruction {
+  Opcode opcode = Opcode::kGeneric;
+  // kCondJump: the value that triggers the jump.
+  // kComprehensionCond: whether the loop short-circuits.
+  bool condition = false;
+  // kCondJump: whether the tested value is left on the stack.
+  bool leave_on_stack = false;
+  // kJump, kCondJump, kComprehensionCond: offset applied after the pc
+  // increment (see ExecutionFrame::JumpTo).
+  int jump_offset = 0;
+  // kSlot: the comprehension slot index.
+  // kIdent: the declared variable index (see
+  // cel::ActivationInterface::FindVariableAt).
+  size_t index = 0;
+  // kConstant: the value to push. Owned by step.
+  const cel::Value* constant = nullptr;
+  // kIdent: the variable name.
+  // kSelect: the field name. Owned by step.
+  const std::string* name = nullptr;
+  // kSelect: the field name as a map key. Owned by step.
+  const cel::StringValue* field = nullptr;
+  // kSelect: how unset wrapper type fields are presented.
+  cel::ProtoWrapperTypeOptions unboxing_option =
+      cel::ProtoWrapperTypeOptions::kUnsetProtoDefault;
+  const ExpressionStep* step = nullptr;
+};
+
+using InstructionPath = std::vector<Instruction>;
+using InstructionPathView = absl::Span<const Instruction>;
+
 // Class Expression represents single execution step.
 class ExpressionStep {
  public:
@@ -88,6 +156,22 @@ class ExpressionStep {
     return cel::NativeTypeId();
   }
 
+  // Returns the instruction used to execute this step in the direct dispatch
+  // evaluation loop.
+  //
+  // Only core steps with simple behavior should override this. The default is
+  // a generic instruction that calls Evaluate.
+  virtual Instruction GetInstruction() const {
+    Instruction instruction;
+    instruction.step = this;
+    return instruction;
+  }
+
+  // Returns the number of steps owned and evaluated by this step outside of
+  // the execution path (e.g. the subprograms of a fused comprehension loop),
+  // including their own embedded steps. Used to size the value stack.
+  virtual size_t EmbeddedStepCount() const { return 0; }
+
  private:
   const int64_t id_;
   const bool comes_from_ast_;
@@ -101,17 +185,25 @@ using ExecutionPathView =
 // evaluation. This can be reused to save on allocations.
 class FlatExpressionEvaluatorState {
  public:
+  // If enable_attribute_tracking is false, the value stack doesn't retain
+  // attribute trails.
   FlatExpressionEvaluatorState(size_t value_stack_size,
                                size_t comprehension_slot_count,
                                const cel::TypeProvider& type_provider,
-                               cel::MemoryManagerRef memory_manager);
+                               cel::MemoryManagerRef memory_manager,
+                               bool enable_attribute_tracking = true);
 
   FlatExpressionEvaluatorState(size_t value_stack_size,
                                size_t comprehension_slot_count,
-                               cel::ValueManager& value_factory);
+                               cel::ValueManager& value_factory,
+                               bool enable_attribute_tracking = true);
 
   void Reset();
 
+  // Rebind the state to a different value factory (e.g. one per request),
+  // keeping the allocated stack and slots. Any held values are cleared.
+  void set_value_factory(cel::ValueManager& value_factory);
+
   EvaluatorStack& value_stack() { return value_stack_; }
 
   ComprehensionSlots& comprehension_slots() { return comprehension_slots_; }
@@ -164,6 +256,17 @@ class ExecutionFrame {
                  const cel::ActivationInterface& activation,
                  const cel::RuntimeOptions& options,
                  FlatExpressionEvaluatorState& state)
+      : ExecutionFrame(subexpressions, /*instruction_subexpressions=*/{},
+                       activation, options, state) {}
+
+  // instruction_subexpressions are the lowered forms of subexpressions for the
+  // direct dispatch loop. If empty, steps are evaluated through the
+  // ExpressionStep interface.
+  ExecutionFrame(
+      absl::Span<const ExecutionPathView> subexpressions,
+      absl::Span<const InstructionPathView> instruction_subexpressions,
+      const cel::ActivationInterface& activation,
+      const cel::RuntimeOptions& options, FlatExpressionEvaluatorState& state)
       : pc_(0UL),
         execution_path_(subexpressions[0]),
         activation_(activation),
@@ -174,16 +277,51 @@ class ExecutionFrame {
                            state_.value_factory()),
         max_iterations_(options_.comprehension_max_iterations),
         iterations_(0),
-        subexpressions_(subexpressions) {
+        subexpressions_(subexpressions),
+        instruction_subexpressions_(instruction_subexpressions) {
     ABSL_DCHECK(!subexpressions.empty());
+    ABSL_DCHECK(instruction_subexpressions.empty() ||
+                instruction_subexpressions.size() == subexpressions.size());
+    if (!instruction_subexpressions_.empty()) {
+      instructions_ = instruction_subexpressions_[0];
+    }
   }
 
   // Returns next expression to evaluate.
   const ExpressionStep* Next();
 
   // Evaluate the execution frame to completion.
+  //
+  // If suspension is enabled and a function call awaits a pending result,
+  // evaluation stops after that call and an Unavailable status is returned
+  // with suspended() set. Use Resume to continue once the result is ready.
   absl::StatusOr<cel::Value> Evaluate(EvaluationListener listener);
 
+  // Continue a suspended evaluation with the awaited function result. The
+  // program counter, call stack and value stack are as they were when the
+  // evaluation suspended. Listeners are not supported for suspendable
+  // evaluations.
+  absl::StatusOr<cel::Value> Resume();
+
+  // Allow function calls to suspend the evaluation (see
+  // cel::Function::InvokeContext::Await). Only steps evaluated by this frame's
+  // loop can suspend; recursively planned (direct) steps block instead.
+  void set_enable_suspension(bool enable_suspension) {
+    enable_suspension_ = enable_suspension;
+  }
+
+  // Where a function call stores the future it awaits, or null if the
+  // evaluation can't be suspended.
+  std::shared_ptr<cel::ValueFuture>* pending_slot() {
+    return enable_suspension_ ? &pending_ : nullptr;
+  }
+
+  // Whether the evaluation is suspended on a pending function result.
+  bool suspended() const { return pending_ != nullptr; }
+
+  // The future the evaluation is suspended on. Requires suspended().
+  cel::ValueFuture& pending() const { return *pending_; }
+
   // Intended for use in builtin shortcutting operations.
   //
   // Offset applies after normal pc increment. For example, JumpTo(0) is a
@@ -216,20 +354,42 @@ class ExecutionFrame {
     ABSL_DCHECK_GE(return_pc, 0);
     ABSL_DCHECK_LE(return_pc, static_cast<int>(execution_path_.size()));
     call_stack_.push_back(SubFrame{static_cast<size_t>(return_pc),
-                                   value_stack().size() + 1, execution_path_});
+                                   value_stack().size() + 1, execution_path_,
+                                   instructions_});
     pc_ = 0UL;
     execution_path_ = subexpression;
+    if (!instruction_subexpressions_.empty()) {
+      instructions_ = instruction_subexpressions_[subexpression_index];
+    }
   }
 
+  // Evaluate `subplan` to completion in the context of this frame, leaving its
+  // result on top of the value stack.
+  //
+  // Intended for steps that run a subprogram repeatedly (e.g. a fused
+  // comprehension loop). Jumps in the subplan are relative to its start. The
+  // evaluation can't be suspended while the subplan runs; function calls that
+  // await a result block instead.
+  absl::Status EvaluateSubplan(ExecutionPathView subplan);
+
+  // Whether an evaluation listener observes the steps of this evaluation.
+  bool has_listener() const { return listener_ != nullptr; }
+
   EvaluatorStack& value_stack() { return state_.value_stack(); }
   ComprehensionSlots& comprehension_slots() {
     return state_.comprehension_slots();
   }
 
   bool enable_attribute_tracking() const {
-    return options_.unknown_processing !=
+    return AttributeTrackingEnabled(options_);
+  }
+
+  // Whether evaluation with the given options needs attribute trails (for
+  // unknowns or missing attribute errors).
+  static bool AttributeTrackingEnabled(const cel::RuntimeOptions& options) {
+    return options.unknown_processing !=
                cel::UnknownProcessingOptions::kDisabled ||
-           options_.enable_missing_attribute_errors;
+           options.enable_missing_attribute_errors;
   }
 
   bool enable_unknowns() const {
@@ -273,6 +433,8 @@ class ExecutionFrame {
     return activation_;
   }
 
+  const cel::RuntimeOptions& options() const { return options_; }
+
   // Increment iterations and return an error if the iteration budget is
   // exceeded
   absl::Status IncrementIterations() {
@@ -287,13 +449,38 @@ class ExecutionFrame {
     return absl::OkStatus();
   }
 
+  // Same as calling IncrementIterations() `count` times, for steps that
+  // evaluate several comprehension iterations at once.
+  absl::Status IncrementIterations(size_t count) {
+    if (max_iterations_ == 0 || count == 0) {
+      return absl::OkStatus();
+    }
+    if (count >= static_cast<size_t>(max_iterations_ - iterations_)) {
+      iterations_ = max_iterations_;
+      return absl::Status(absl::StatusCode::kInternal,
+                          "Iteration budget exceeded");
+    }
+    iterations_ += static_cast<int>(count);
+    return absl::OkStatus();
+  }
+
  private:
   struct SubFrame {
     size_t return_pc;
     size_t expected_stack_size;
     ExecutionPathView return_expression;
+    InstructionPathView return_instructions;
   };
 
+  // Restore the caller's state after a subexpression call completes.
+  void Return();
+
+  // Evaluate the lowered instructions to completion (direct dispatch).
+  absl::Status EvaluateInstructions();
+
+  // Run the evaluation loop from the current pc to completion.
+  absl::StatusOr<cel::Value> Run(EvaluationListener listener);
+
   size_t pc_;  // pc_ - Program Counter. Current position on execution path.
   ExecutionPathView execution_path_;
   const cel::ActivationInterface& activation_;
@@ -303,7 +490,15 @@ class ExecutionFrame {
   const int max_iterations_;
   int iterations_;
   absl::Span<const ExecutionPathView> subexpressions_;
+  absl::Span<const InstructionPathView> instruction_subexpressions_;
+  InstructionPathView instructions_;
   std::vector<SubFrame> call_stack_;
+  size_t initial_stack_size_ = 0;
+  // The listener of the running evaluation, if any. Also notified for steps
+  // evaluated by EvaluateSubplan.
+  EvaluationListener* listener_ = nullptr;
+  bool enable_suspension_ = false;
+  std::shared_ptr<cel::ValueFuture> pending_;
 };
 
 // A flattened representation of the input CEL AST.
@@ -319,18 +514,32 @@ class FlatExpression {
         subexpressions_({path_}),
         comprehension_slots_size_(comprehension_slots_size),
         type_provider_(type_provider),
-        options_(options) {}
+        options_(options) {
+    value_stack_size_ = ValueStackSize(path_);
+    if (options_.enable_direct_dispatch) {
+      LowerInstructions();
+    }
+  }
 
+  // declared_variables lists the free variables whose ident steps were
+  // assigned an index, in index order.
   FlatExpression(ExecutionPath path,
                  std::vector<ExecutionPathView> subexpressions,
                  size_t comprehension_slots_size,
                  const cel::TypeProvider& type_provider,
-                 const cel::RuntimeOptions& options)
+                 const cel::RuntimeOptions& options,
+                 std::vector<std::string> declared_variables = {})
       : path_(std::move(path)),
         subexpressions_(std::move(subexpressions)),
         comprehension_slots_size_(comprehension_slots_size),
         type_provider_(type_provider),
-        options_(options) {}
+        options_(options),
+        declared_variables_(std::move(declared_variables)) {
+    value_stack_size_ = ValueStackSize(path_);
+    if (options_.enable_direct_dispatch) {
+      LowerInstructions();
+    }
+  }
 
   // Move-only
   FlatExpression(FlatExpression&&) = default;
@@ -343,6 +552,11 @@ class FlatExpression {
   FlatExpressionEvaluatorState MakeEvaluatorState(
       cel::ValueManager& value_factory) const;
 
+  // Heap allocated evaluator state for callers that keep it across
+  // evaluations (the state itself is not movable).
+  std::unique_ptr<FlatExpressionEvaluatorState> MakeEvaluatorStatePtr(
+      cel::ValueManager& value_factory) const;
+
   // Evaluate the expression.
   //
   // A status may be returned if an unexpected error occurs. Recoverable errors
@@ -355,14 +569,42 @@ class FlatExpression {
       const cel::ActivationInterface& activation, EvaluationListener listener,
       FlatExpressionEvaluatorState& state) const;
 
+  // Create a frame for an evaluation that may be suspended on pending function
+  // results (see ExecutionFrame::Resume). The state is reset. The activation
+  // and state must outlive the frame.
+  std::unique_ptr<ExecutionFrame> MakeSuspendableFrame(
+      const cel::ActivationInterface& activation,
+      FlatExpressionEvaluatorState& state) const;
+
   const ExecutionPath& path() const { return path_; }
 
+  // Free variables referenced by the expression, in declared index order.
+  absl::Span<const std::string> declared_variables() const {
+    return declared_variables_;
+  }
+
+  // Lowered instructions for the direct dispatch loop. Empty if direct
+  // dispatch is disabled.
+  const InstructionPath& instructions() const { return instructions_; }
+
  private:
+  // Lower the execution path to the instruction array used by the direct
+  // dispatch loop.
+  void LowerInstructions();
+
+  // Upper bound of the value stack size needed to evaluate path: each step
+  // pushes at most one value.
+  static size_t ValueStackSize(ExecutionPathView path);
+
   ExecutionPath path_;
+  size_t value_stack_size_ = 0;
   std::vector<ExecutionPathView> subexpressions_;
   size_t comprehension_slots_size_;
   const cel::TypeProvider& type_provider_;
   cel::RuntimeOptions options_;
+  InstructionPath instructions_;
+  std::vector<InstructionPathView> instruction_subexpressions_;
+  std::vector<std::string> declared_variables_;
 };
 
 }  // namespace google::api::expr::runtime
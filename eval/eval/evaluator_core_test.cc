@@ -7,6 +7,7 @@
 #include "base/type_provider.h"
 #include "eval/compiler/cel_expression_builder_flat_impl.h"
 #include "eval/eval/cel_expression_flat_impl.h"
+#include "eval/eval/compiler_constant_step.h"
 #include "eval/internal/interop.h"
 #include "eval/public/activation.h"
 #include "eval/public/builtin_func_registrar.h"
@@ -107,6 +108,37 @@ TEST(EvaluatorCoreTest, SimpleEvaluatorTest) {
   EXPECT_THAT(value.Int64OrDie(), Eq(2));
 }
 
+TEST(EvaluatorCoreTest, DirectDispatchEvaluatorTest) {
+  ExecutionPath path;
+  path.push_back(std::make_unique<CompilerConstantStep>(
+      cel::IntValue(0), /*expr_id=*/-1, /*comes_from_ast=*/false));
+  path.push_back(std::make_unique<FakeIncrementExpressionStep>());
+  path.push_back(std::make_unique<FakeIncrementExpressionStep>());
+
+  cel::RuntimeOptions options;
+  options.enable_direct_dispatch = true;
+  FlatExpression flat_expression(std::move(path), 0,
+                                 cel::TypeProvider::Builtin(), options);
+
+  ASSERT_THAT(flat_expression.instructions(), testing::SizeIs(3));
+  EXPECT_EQ(flat_expression.instructions()[0].opcode, Opcode::kConstant);
+  EXPECT_EQ(flat_expression.instructions()[1].opcode, Opcode::kGeneric);
+  EXPECT_EQ(flat_expression.instructions()[1].step,
+            flat_expression.path()[1].get());
+
+  CelExpressionFlatImpl impl(std::move(flat_expression));
+
+  Activation activation;
+  google::protobuf::Arena arena;
+
+  auto status = impl.Evaluate(activation, &arena);
+  EXPECT_OK(status);
+
+  auto value = status.value();
+  EXPECT_TRUE(value.IsInt64());
+  EXPECT_THAT(value.Int64OrDie(), Eq(2));
+}
+
 class MockTraceCallback {
  public:
   MOCK_METHOD(void, Call,
@@ -1,11 +1,62 @@
 #include "eval/eval/evaluator_stack.h"
 
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "common/value.h"
+#include "eval/eval/attribute_trail.h"
+
 namespace google::api::expr::runtime {
 
-void EvaluatorStack::Clear() {
-  stack_.clear();
-  attribute_stack_.clear();
-  current_size_ = 0;
+EvaluatorStack::~EvaluatorStack() {
+  Clear();
+  if (values_ == nullptr) {
+    return;
+  }
+  std::allocator<cel::Value>().deallocate(values_, capacity_);
+  if (attributes_ != nullptr) {
+    std::allocator<AttributeTrail>().deallocate(attributes_, capacity_);
+  }
+}
+
+const AttributeTrail& EvaluatorStack::EmptyAttributeTrail() {
+  static const absl::NoDestructor<AttributeTrail> kEmptyTrail;
+  return *kEmptyTrail;
+}
+
+void EvaluatorStack::Clear() { Pop(current_size_); }
+
+void EvaluatorStack::Reserve(size_t size) {
+  if (size <= capacity_) {
+    return;
+  }
+  cel::Value* values = std::allocator<cel::Value>().allocate(size);
+  for (size_t i = 0; i < current_size_; ++i) {
+    ::new (static_cast<void*>(values + i)) cel::Value(std::move(values_[i]));
+    std::destroy_at(values_ + i);
+  }
+  if (values_ != nullptr) {
+    std::allocator<cel::Value>().deallocate(values_, capacity_);
+  }
+  values_ = values;
+
+  if (track_attributes_) {
+    AttributeTrail* attributes =
+        std::allocator<AttributeTrail>().allocate(size);
+    for (size_t i = 0; i < current_size_; ++i) {
+      ::new (static_cast<void*>(attributes + i))
+          AttributeTrail(std::move(attributes_[i]));
+      std::destroy_at(attributes_ + i);
+    }
+    if (attributes_ != nullptr) {
+      std::allocator<AttributeTrail>().deallocate(attributes_, capacity_);
+    }
+    attributes_ = attributes;
+  }
+  capacity_ = size;
 }
 
 }  // namespace google::api::expr::runtime
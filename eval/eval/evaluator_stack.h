@@ -2,8 +2,9 @@
 #define THIRD_PARTY_CEL_CPP_EVAL_EVAL_EVALUATOR_STACK_H_
 
 #include <cstddef>
+#include <memory>
+#include <new>
 #include <utility>
-#include <vector>
 
 #include "absl/base/optimization.h"
 #include "absl/log/absl_log.h"
@@ -14,15 +15,27 @@
 namespace google::api::expr::runtime {
 
 // CelValue stack.
-// Implementation is based on vector to allow passing parameters from
-// stack as Span<>.
+// Implementation is based on fixed-capacity raw storage to allow passing
+// parameters from stack as Span<>. Elements are placement constructed on Push
+// and destroyed on Pop.
+//
+// If attribute tracking is disabled (no unknowns or missing attribute errors),
+// no attribute storage is allocated: pushed attribute trails are dropped,
+// PeekAttribute returns an empty trail and GetAttributeSpan an empty span.
 class EvaluatorStack {
  public:
-  explicit EvaluatorStack(size_t max_size)
-      : max_size_(max_size), current_size_(0) {
+  explicit EvaluatorStack(size_t max_size, bool track_attributes = true)
+      : max_size_(max_size),
+        current_size_(0),
+        track_attributes_(track_attributes) {
     Reserve(max_size);
   }
 
+  EvaluatorStack(const EvaluatorStack&) = delete;
+  EvaluatorStack& operator=(const EvaluatorStack&) = delete;
+
+  ~EvaluatorStack();
+
   // Return the current stack size.
   size_t size() const { return current_size_; }
 
@@ -35,6 +48,9 @@ class EvaluatorStack {
   // Attributes stack size.
   size_t attribute_size() const { return current_size_; }
 
+  // Returns true if pushed attribute trails are retained.
+  bool track_attributes() const { return track_attributes_; }
+
   // Check that stack has enough elements.
   bool HasEnough(size_t size) const { return current_size_ >= size; }
 
@@ -49,20 +65,23 @@ class EvaluatorStack {
       ABSL_LOG(FATAL) << "Requested span size (" << size
                       << ") exceeds current stack size: " << current_size_;
     }
-    return absl::Span<const cel::Value>(stack_.data() + current_size_ - size,
-                                        size);
+    return absl::Span<const cel::Value>(values_ + current_size_ - size, size);
   }
 
   // Gets the last size attribute trails of the stack.
   // Checking that stack has enough elements is caller's responsibility.
   // Please note that calls to Push may invalidate returned Span object.
+  // Without attribute tracking the span is empty.
   absl::Span<const AttributeTrail> GetAttributeSpan(size_t size) const {
     if (ABSL_PREDICT_FALSE(!HasEnough(size))) {
       ABSL_LOG(FATAL) << "Requested span size (" << size
                       << ") exceeds current stack size: " << current_size_;
     }
-    return absl::Span<const AttributeTrail>(
-        attribute_stack_.data() + current_size_ - size, size);
+    if (!track_attributes_) {
+      return absl::Span<const AttributeTrail>();
+    }
+    return absl::Span<const AttributeTrail>(attributes_ + current_size_ - size,
+                                            size);
   }
 
   // Peeks the last element of the stack.
@@ -71,7 +90,7 @@ class EvaluatorStack {
     if (ABSL_PREDICT_FALSE(empty())) {
       ABSL_LOG(FATAL) << "Peeking on empty EvaluatorStack";
     }
-    return stack_[current_size_ - 1];
+    return values_[current_size_ - 1];
   }
 
   // Peeks the last element of the stack.
@@ -80,7 +99,7 @@ class EvaluatorStack {
     if (ABSL_PREDICT_FALSE(empty())) {
       ABSL_LOG(FATAL) << "Peeking on empty EvaluatorStack";
     }
-    return stack_[current_size_ - 1];
+    return values_[current_size_ - 1];
   }
 
   // Peeks the last element of the attribute stack.
@@ -89,7 +108,10 @@ class EvaluatorStack {
     if (ABSL_PREDICT_FALSE(empty())) {
       ABSL_LOG(FATAL) << "Peeking on empty EvaluatorStack";
     }
-    return attribute_stack_[current_size_ - 1];
+    if (!track_attributes_) {
+      return EmptyAttributeTrail();
+    }
+    return attributes_[current_size_ - 1];
   }
 
   // Clears the last size elements of the stack.
@@ -100,9 +122,11 @@ class EvaluatorStack {
                       << ") than the current stack size: " << current_size_;
     }
     while (size > 0) {
-      stack_.pop_back();
-      attribute_stack_.pop_back();
       current_size_--;
+      std::destroy_at(values_ + current_size_);
+      if (track_attributes_) {
+        std::destroy_at(attributes_ + current_size_);
+      }
       size--;
     }
   }
@@ -114,8 +138,15 @@ class EvaluatorStack {
     if (ABSL_PREDICT_FALSE(current_size_ >= max_size())) {
       ABSL_LOG(ERROR) << "No room to push more elements on to EvaluatorStack";
     }
-    stack_.push_back(std::move(value));
-    attribute_stack_.push_back(std::move(attribute));
+    if (ABSL_PREDICT_FALSE(current_size_ >= capacity_)) {
+      Reserve(capacity_ == 0 ? 1 : capacity_ * 2);
+    }
+    ::new (static_cast<void*>(values_ + current_size_))
+        cel::Value(std::move(value));
+    if (track_attributes_) {
+      ::new (static_cast<void*>(attributes_ + current_size_))
+          AttributeTrail(std::move(attribute));
+    }
     current_size_++;
   }
 
@@ -125,8 +156,10 @@ class EvaluatorStack {
       return;
     }
     Pop(size - 1);
-    stack_[current_size_ - 1] = std::move(value);
-    attribute_stack_[current_size_ - 1] = std::move(attribute);
+    values_[current_size_ - 1] = std::move(value);
+    if (track_attributes_) {
+      attributes_[current_size_ - 1] = std::move(attribute);
+    }
   }
 
   // Replace element on the top of the stack.
@@ -152,16 +185,19 @@ class EvaluatorStack {
   }
 
  private:
-  // Preallocate stack.
-  void Reserve(size_t size) {
-    stack_.reserve(size);
-    attribute_stack_.reserve(size);
-  }
+  // Shared trail returned by PeekAttribute without attribute tracking.
+  static const AttributeTrail& EmptyAttributeTrail();
+
+  // Grow storage to hold at least size elements, moving any held elements.
+  void Reserve(size_t size);
 
-  std::vector<cel::Value> stack_;
-  std::vector<AttributeTrail> attribute_stack_;
+  cel::Value* values_ = nullptr;
+  // Only allocated with attribute tracking.
+  AttributeTrail* attributes_ = nullptr;
+  size_t capacity_ = 0;
   size_t max_size_;
   size_t current_size_;
+  bool track_attributes_;
 };
 
 }  // namespace google::api::expr::runtime
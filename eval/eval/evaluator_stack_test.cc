@@ -8,6 +8,7 @@
 #include "common/value_manager.h"
 #include "common/values/legacy_value_manager.h"
 #include "extensions/protobuf/memory_manager.h"
+#include "internal/benchmark.h"
 #include "internal/testing.h"
 
 namespace google::api::expr::runtime {
@@ -90,6 +91,96 @@ TEST(EvaluatorStackTest, Clear) {
   ASSERT_TRUE(stack.empty());
 }
 
+TEST(EvaluatorStackTest, AttributeTrackingDisabled) {
+  google::protobuf::Arena arena;
+  auto manager = ProtoMemoryManagerRef(&arena);
+  cel::common_internal::LegacyValueManager value_factory(
+      manager, TypeProvider::Builtin());
+  EvaluatorStack stack(10, /*track_attributes=*/false);
+
+  stack.Push(value_factory.CreateIntValue(1), AttributeTrail("a"));
+  stack.Push(value_factory.CreateIntValue(2), AttributeTrail("b"));
+  ASSERT_EQ(stack.size(), 2);
+  ASSERT_EQ(stack.size(), stack.attribute_size());
+
+  EXPECT_EQ(stack.Peek().As<cel::IntValue>().NativeValue(), 2);
+  EXPECT_TRUE(stack.PeekAttribute().empty());
+  EXPECT_TRUE(stack.GetAttributeSpan(2).empty());
+
+  stack.PopAndPush(2, value_factory.CreateIntValue(3), AttributeTrail("c"));
+  ASSERT_EQ(stack.size(), 1);
+  EXPECT_EQ(stack.Peek().As<cel::IntValue>().NativeValue(), 3);
+  EXPECT_TRUE(stack.PeekAttribute().empty());
+}
+
+TEST(EvaluatorStackTest, GrowsPastMaxSize) {
+  google::protobuf::Arena arena;
+  auto manager = ProtoMemoryManagerRef(&arena);
+  cel::common_internal::LegacyValueManager value_factory(
+      manager, TypeProvider::Builtin());
+
+  for (bool track_attributes : {true, false}) {
+    EvaluatorStack stack(2, track_attributes);
+    for (int i = 0; i < 5; ++i) {
+      stack.Push(value_factory.CreateIntValue(i), AttributeTrail("name"));
+    }
+    ASSERT_EQ(stack.size(), 5);
+
+    absl::Span<const cel::Value> values = stack.GetSpan(5);
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_EQ(values[i].As<cel::IntValue>().NativeValue(), i);
+    }
+    EXPECT_EQ(stack.PeekAttribute().empty(), !track_attributes);
+
+    stack.Clear();
+    ASSERT_TRUE(stack.empty());
+  }
+}
+
+void BM_EvaluatorStackPushPop(benchmark::State& state) {
+  google::protobuf::Arena arena;
+  auto manager = ProtoMemoryManagerRef(&arena);
+  cel::common_internal::LegacyValueManager value_factory(
+      manager, TypeProvider::Builtin());
+  const bool track_attributes = state.range(0) != 0;
+  EvaluatorStack stack(16, track_attributes);
+  cel::Value value = value_factory.CreateIntValue(1);
+
+  for (auto _ : state) {
+    for (int i = 0; i < 16; ++i) {
+      stack.Push(value);
+    }
+    for (int i = 0; i < 8; ++i) {
+      stack.PopAndPush(2, value);
+    }
+    benchmark::DoNotOptimize(stack.Peek());
+    stack.Clear();
+  }
+}
+
+BENCHMARK(BM_EvaluatorStackPushPop)->Arg(0)->Arg(1);
+
+void BM_EvaluatorStackPushWithAttribute(benchmark::State& state) {
+  google::protobuf::Arena arena;
+  auto manager = ProtoMemoryManagerRef(&arena);
+  cel::common_internal::LegacyValueManager value_factory(
+      manager, TypeProvider::Builtin());
+  const bool track_attributes = state.range(0) != 0;
+  EvaluatorStack stack(16, track_attributes);
+  cel::Value value = value_factory.CreateIntValue(1);
+  AttributeTrail trail("name");
+
+  for (auto _ : state) {
+    for (int i = 0; i < 16; ++i) {
+      stack.Push(value, trail);
+    }
+    benchmark::DoNotOptimize(stack.GetAttributeSpan(16));
+    stack.Clear();
+  }
+}
+
+BENCHMARK(BM_EvaluatorStackPushWithAttribute)->Arg(0)->Arg(1);
+
 }  // namespace
 
 }  // namespace google::api::expr::runtime
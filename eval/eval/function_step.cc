@@ -1,6 +1,7 @@
 #include "eval/eval/function_step.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -8,6 +9,8 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/optimization.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -16,10 +19,13 @@
 #include "base/function.h"
 #include "base/function_descriptor.h"
 #include "base/kind.h"
+#include "common/native_type.h"
 #include "common/value.h"
 #include "eval/eval/attribute_trail.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 #include "eval/eval/expression_step_base.h"
+#include "eval/eval/parallel_evaluation.h"
 #include "eval/internal/errors.h"
 #include "internal/status_macros.h"
 #include "runtime/activation_interface.h"
@@ -120,6 +126,55 @@ std::string ToLegacyKindName(absl::string_view type_name) {
   return std::string(type_name);
 }
 
+// Per-step inline cache of the last resolved overload.
+//
+// Call sites almost always see the same argument kinds, so remembering the
+// overload matched for the last kind tuple skips comparing the arguments
+// against every candidate. The entry packs the argument kinds (8 bits each,
+// offset by one so an empty cache never matches) above the matched overload
+// index into a single word, so it can be shared by concurrent evaluations
+// without locking. A kind mismatch simply resolves and replaces the entry.
+class OverloadCache {
+ public:
+  static constexpr size_t kMaxArguments = 6;
+
+  // Returns the cache key for the argument kinds, or nullopt if the
+  // arguments can't be cached.
+  static absl::optional<uint64_t> Key(absl::Span<const cel::Value> arguments) {
+    if (arguments.size() > kMaxArguments) {
+      return absl::nullopt;
+    }
+    uint64_t key = 0;
+    for (size_t i = 0; i < arguments.size(); ++i) {
+      uint64_t kind = static_cast<uint64_t>(arguments[i]->kind()) + 1;
+      key |= kind << (kIndexBits + 8 * i);
+    }
+    return key;
+  }
+
+  // Returns the cached overload index for key, or -1 on a miss.
+  int Lookup(uint64_t key) const {
+    uint64_t entry = entry_.load(std::memory_order_relaxed);
+    if (entry == 0 || (entry & ~kIndexMask) != key) {
+      return -1;
+    }
+    return static_cast<int>(entry & kIndexMask) - 1;
+  }
+
+  void Store(uint64_t key, size_t index) const {
+    if (index + 1 > kIndexMask) {
+      return;
+    }
+    entry_.store(key | (index + 1), std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr int kIndexBits = 16;
+  static constexpr uint64_t kIndexMask = (uint64_t{1} << kIndexBits) - 1;
+
+  mutable std::atomic<uint64_t> entry_{0};
+};
+
 // Simple wrapper around a function resolution result. A function call should
 // resolve to a single function implementation and a descriptor or none.
 using ResolveResult = absl::optional<cel::FunctionOverloadReference>;
@@ -138,6 +193,10 @@ class AbstractFunctionStep : public ExpressionStepBase {
 
   absl::Status Evaluate(ExecutionFrame* frame) const override;
 
+  cel::NativeTypeId GetNativeTypeId() const override {
+    return cel::NativeTypeId::For<AbstractFunctionStep>();
+  }
+
   // Handles overload resolution and updating result appropriately.
   // Shouldn't update frame state.
   //
@@ -145,7 +204,13 @@ class AbstractFunctionStep : public ExpressionStepBase {
   // evaluation state or forwarded from an extension function. Errors where
   // evaluation can reasonably condition are returned in the result as a
   // cel::ErrorValue.
-  absl::StatusOr<Value> DoEvaluate(ExecutionFrame* frame) const;
+  //
+  // If pending is non-null, the invoked function may store a future there to
+  // suspend the evaluation (see cel::Function::InvokeContext::Await).
+  absl::StatusOr<Value> DoEvaluate(
+      ExecutionFrame* frame, absl::Span<const cel::Value> input_args,
+      absl::Span<const AttributeTrail> input_attrs,
+      std::shared_ptr<cel::ValueFuture>* pending = nullptr) const;
 
   virtual absl::StatusOr<ResolveResult> ResolveFunction(
       absl::Span<const cel::Value> args, const ExecutionFrame* frame) const = 0;
@@ -156,15 +221,13 @@ class AbstractFunctionStep : public ExpressionStepBase {
 };
 
 absl::StatusOr<Value> AbstractFunctionStep::DoEvaluate(
-    ExecutionFrame* frame) const {
-  // Create Span object that contains input arguments to the function.
-  auto input_args = frame->value_stack().GetSpan(num_arguments_);
-
+    ExecutionFrame* frame, absl::Span<const cel::Value> input_args,
+    absl::Span<const AttributeTrail> input_attrs,
+    std::shared_ptr<cel::ValueFuture>* pending) const {
   std::vector<cel::Value> unknowns_args;
   // Preprocess args. If an argument is partially unknown, convert it to an
   // unknown attribute set.
   if (frame->enable_unknowns()) {
-    auto input_attrs = frame->value_stack().GetAttributeSpan(num_arguments_);
     unknowns_args = CheckForPartialUnknowns(frame, input_args, input_attrs);
     input_args = absl::MakeConstSpan(unknowns_args);
   }
@@ -176,7 +239,7 @@ absl::StatusOr<Value> AbstractFunctionStep::DoEvaluate(
   // Overload found and is allowed to consume the arguments.
   if (matched_function.has_value() &&
       ShouldAcceptOverload(matched_function->descriptor, input_args)) {
-    FunctionEvaluationContext context(frame->value_factory());
+    FunctionEvaluationContext context(frame->value_factory(), pending);
 
     CEL_ASSIGN_OR_RETURN(Value result, matched_function->implementation.Invoke(
                                            context, input_args));
@@ -233,10 +296,20 @@ absl::Status AbstractFunctionStep::Evaluate(ExecutionFrame* frame) const {
   // DoEvaluate may return a status for non-recoverable errors  (e.g.
   // unexpected typing, illegal expression state). Application errors that can
   // reasonably be handled as a cel error will appear in the result value.
-  CEL_ASSIGN_OR_RETURN(auto result, DoEvaluate(frame));
+  CEL_ASSIGN_OR_RETURN(
+      auto result,
+      DoEvaluate(frame, frame->value_stack().GetSpan(num_arguments_),
+                 frame->value_stack().GetAttributeSpan(num_arguments_),
+                 frame->pending_slot()));
 
   frame->value_stack().PopAndPush(num_arguments_, std::move(result));
 
+  if (ABSL_PREDICT_FALSE(frame->suspended())) {
+    // The result is a placeholder, replaced when the frame is resumed.
+    return absl::UnavailableError(
+        "evaluation suspended on a pending function result");
+  }
+
   return absl::OkStatus();
 }
 
@@ -253,14 +326,27 @@ class EagerFunctionStep : public AbstractFunctionStep {
 
  private:
   std::vector<cel::FunctionOverloadReference> overloads_;
+  OverloadCache cache_;
 };
 
 absl::StatusOr<ResolveResult> EagerFunctionStep::ResolveFunction(
     absl::Span<const cel::Value> input_args,
     const ExecutionFrame* frame) const {
+  // The candidate overloads are fixed at plan time, so the match only depends
+  // on the argument kinds.
+  absl::optional<uint64_t> key = OverloadCache::Key(input_args);
+  if (key.has_value()) {
+    int cached = cache_.Lookup(*key);
+    if (ABSL_PREDICT_TRUE(cached >= 0)) {
+      return ResolveResult(overloads_[cached]);
+    }
+  }
+
   ResolveResult result = absl::nullopt;
+  size_t matched_index = 0;
 
-  for (const auto& overload : overloads_) {
+  for (size_t i = 0; i < overloads_.size(); ++i) {
+    const auto& overload = overloads_[i];
     if (ArgumentKindsMatch(overload.descriptor, input_args)) {
       // More than one overload matches our arguments.
       if (result.has_value()) {
@@ -269,8 +355,13 @@ absl::StatusOr<ResolveResult> EagerFunctionStep::ResolveFunction(
       }
 
       result.emplace(overload);
+      matched_index = i;
     }
   }
+
+  if (result.has_value() && key.has_value()) {
+    cache_.Store(*key, matched_index);
+  }
   return result;
 }
 
@@ -333,8 +424,75 @@ absl::StatusOr<ResolveResult> LazyFunctionStep::ResolveFunction(
   return result;
 }
 
+// Direct implementation of a function call.
+//
+// Arguments are evaluated recursively into locals, then overload resolution
+// and invocation are delegated to the equivalent stack machine step.
+class DirectFunctionStep : public DirectExpressionStep {
+ public:
+  DirectFunctionStep(int64_t expr_id,
+                     std::vector<std::unique_ptr<DirectExpressionStep>> args,
+                     std::unique_ptr<AbstractFunctionStep> call,
+                     ForkedDependencies forked)
+      : DirectExpressionStep(expr_id),
+        args_(std::move(args)),
+        call_(std::move(call)),
+        forked_(std::move(forked)) {}
+
+  absl::Status Evaluate(ExecutionFrame& frame, Value& result,
+                        AttributeTrail& attribute) const override {
+    // Most calls are unary or binary, avoid allocating for those.
+    absl::InlinedVector<Value, 2> args(args_.size());
+    absl::InlinedVector<AttributeTrail, 2> attrs(args_.size());
+    if (forked_.enabled()) {
+      CEL_RETURN_IF_ERROR(EvaluateForked(frame, absl::MakeSpan(args),
+                                         absl::MakeSpan(attrs)));
+    } else {
+      for (size_t i = 0; i < args_.size(); ++i) {
+        CEL_RETURN_IF_ERROR(args_[i]->Evaluate(frame, args[i], attrs[i]));
+      }
+    }
+    CEL_ASSIGN_OR_RETURN(result, call_->DoEvaluate(&frame, args, attrs));
+    return absl::OkStatus();
+  }
+
+ private:
+  // Starts the forked arguments on the executor and evaluates the rest inline.
+  // Errors are reported in argument order, matching sequential evaluation.
+  absl::Status EvaluateForked(ExecutionFrame& frame, absl::Span<Value> args,
+                              absl::Span<AttributeTrail> attrs) const {
+    std::vector<absl::optional<ForkedEvaluation>> pending(args_.size());
+    for (size_t i = 0; i < args_.size(); ++i) {
+      if (forked_.forked[i]) {
+        pending[i].emplace(*args_[i], frame, *forked_.executor);
+      }
+    }
+    absl::Status status;
+    for (size_t i = 0; i < args_.size(); ++i) {
+      absl::Status arg_status =
+          pending[i].has_value() ? pending[i]->Join(args[i], attrs[i])
+                                 : args_[i]->Evaluate(frame, args[i], attrs[i]);
+      if (!arg_status.ok()) {
+        status = std::move(arg_status);
+        break;
+      }
+    }
+    // Remaining forked arguments are cancelled when pending goes out of scope.
+    return status;
+  }
+
+  std::vector<std::unique_ptr<DirectExpressionStep>> args_;
+  std::unique_ptr<AbstractFunctionStep> call_;
+  ForkedDependencies forked_;
+};
+
 }  // namespace
 
+bool IsFunctionStep(const ExpressionStep& step) {
+  return step.GetNativeTypeId() ==
+         cel::NativeTypeId::For<AbstractFunctionStep>();
+}
+
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateFunctionStep(
     const cel::ast_internal::Call& call_expr, int64_t expr_id,
     std::vector<cel::FunctionRegistry::LazyOverload> lazy_overloads) {
@@ -355,4 +513,32 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateFunctionStep(
                                              num_args, expr_id);
 }
 
+std::unique_ptr<DirectExpressionStep> CreateDirectFunctionStep(
+    const cel::ast_internal::Call& call_expr, int64_t expr_id,
+    std::vector<std::unique_ptr<DirectExpressionStep>> args,
+    std::vector<cel::FunctionRegistry::LazyOverload> lazy_overloads,
+    ForkedDependencies forked) {
+  bool receiver_style = call_expr.has_target();
+  size_t num_args = args.size();
+  auto call = std::make_unique<LazyFunctionStep>(
+      call_expr.function(), num_args, receiver_style,
+      std::move(lazy_overloads), expr_id);
+  return std::make_unique<DirectFunctionStep>(expr_id, std::move(args),
+                                              std::move(call),
+                                              std::move(forked));
+}
+
+std::unique_ptr<DirectExpressionStep> CreateDirectFunctionStep(
+    const cel::ast_internal::Call& call_expr, int64_t expr_id,
+    std::vector<std::unique_ptr<DirectExpressionStep>> args,
+    std::vector<cel::FunctionOverloadReference> overloads,
+    ForkedDependencies forked) {
+  size_t num_args = args.size();
+  auto call = std::make_unique<EagerFunctionStep>(
+      std::move(overloads), call_expr.function(), num_args, expr_id);
+  return std::make_unique<DirectFunctionStep>(expr_id, std::move(args),
+                                              std::move(call),
+                                              std::move(forked));
+}
+
 }  // namespace google::api::expr::runtime
@@ -7,7 +7,10 @@
 
 #include "absl/status/statusor.h"
 #include "base/ast_internal/expr.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
+#include "eval/eval/parallel_evaluation.h"
+#include "runtime/function_overload_reference.h"
 #include "runtime/function_registry.h"
 
 namespace google::api::expr::runtime {
@@ -25,6 +28,31 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateFunctionStep(
     const cel::ast_internal::Call& call, int64_t expr_id,
     std::vector<cel::FunctionOverloadReference> overloads);
 
+// Returns whether `step` was created by one of the `CreateFunctionStep`
+// overloads above. Program optimizers use this to check that the last step of
+// a call's subplan is still the call itself, and not e.g. a constant it was
+// folded into.
+bool IsFunctionStep(const ExpressionStep& step);
+
+// Factory method for a directly evaluated Call where the function will be
+// resolved at runtime (lazily) from an input Activation.
+//
+// Arguments marked in `forked` are started on its executor before the others
+// are evaluated.
+std::unique_ptr<DirectExpressionStep> CreateDirectFunctionStep(
+    const cel::ast_internal::Call& call, int64_t expr_id,
+    std::vector<std::unique_ptr<DirectExpressionStep>> args,
+    std::vector<cel::FunctionRegistry::LazyOverload> lazy_overloads,
+    ForkedDependencies forked = {});
+
+// Factory method for a directly evaluated Call where the function has been
+// statically resolved.
+std::unique_ptr<DirectExpressionStep> CreateDirectFunctionStep(
+    const cel::ast_internal::Call& call, int64_t expr_id,
+    std::vector<std::unique_ptr<DirectExpressionStep>> args,
+    std::vector<cel::FunctionOverloadReference> overloads,
+    ForkedDependencies forked = {});
+
 }  // namespace google::api::expr::runtime
 
 #endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_FUNCTION_STEP_H_
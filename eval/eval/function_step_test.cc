@@ -495,6 +495,51 @@ TEST_P(FunctionStepTest, LazyFunctionOverloadingTest) {
   EXPECT_TRUE(value.BoolOrDie());
 }
 
+// The same step sees different argument kinds across evaluations.
+TEST_P(FunctionStepTest, OverloadResolutionFollowsArgumentKinds) {
+  ExecutionPath path;
+  CelFunctionRegistry registry;
+  ASSERT_OK(registry.Register(
+      PortableUnaryFunctionAdapter<int64_t, int64_t>::Create(
+          "Floor", false,
+          [](google::protobuf::Arena*, int64_t val) { return val; })));
+  ASSERT_OK(registry.Register(
+      PortableUnaryFunctionAdapter<int64_t, double>::Create(
+          "Floor", false, [](google::protobuf::Arena*, double val) -> int64_t {
+            return std::floor(val);
+          })));
+
+  Ident ident("x");
+  Call call;
+  call.mutable_args().emplace_back();
+  call.set_function("Floor");
+
+  ASSERT_OK_AND_ASSIGN(auto step0, CreateIdentStep(ident, GetExprId()));
+  ASSERT_OK_AND_ASSIGN(auto step1, MakeTestFunctionStep(call, registry));
+
+  path.push_back(std::move(step0));
+  path.push_back(std::move(step1));
+
+  std::unique_ptr<CelExpressionFlatImpl> impl = GetExpression(std::move(path));
+
+  google::protobuf::Arena arena;
+  for (CelValue x :
+       {CelValue::CreateInt64(3), CelValue::CreateDouble(2.5),
+        CelValue::CreateDouble(4.5), CelValue::CreateInt64(7),
+        CelValue::CreateUint64(1)}) {
+    Activation activation;
+    activation.InsertValue("x", x);
+    ASSERT_OK_AND_ASSIGN(CelValue value, impl->Evaluate(activation, &arena));
+    if (x.IsUint64()) {
+      EXPECT_TRUE(value.IsError());
+      continue;
+    }
+    ASSERT_TRUE(value.IsInt64());
+    EXPECT_EQ(value.Int64OrDie(),
+              x.IsInt64() ? x.Int64OrDie() : std::floor(x.DoubleOrDie()));
+  }
+}
+
 // Test situation when no overloads match input arguments during evaluation
 // and at least one of arguments is error.
 TEST_P(FunctionStepTest,
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -11,6 +12,7 @@
 #include "absl/strings/str_cat.h"
 #include "eval/eval/attribute_trail.h"
 #include "eval/eval/comprehension_slots.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 #include "eval/eval/expression_step_base.h"
 #include "eval/internal/errors.h"
@@ -25,75 +27,153 @@ using ::cel::ValueView;
 using ::cel::runtime_internal::CreateError;
 using ::cel::runtime_internal::CreateMissingAttributeError;
 
-class IdentStep : public ExpressionStepBase {
- public:
-  IdentStep(absl::string_view name, int64_t expr_id)
-      : ExpressionStepBase(expr_id), name_(name) {}
-
-  absl::Status Evaluate(ExecutionFrame* frame) const override;
-
- private:
-  struct IdentResult {
-    ValueView value;
-    AttributeTrail trail;
-  };
-
-  absl::StatusOr<IdentResult> DoEvaluate(ExecutionFrame* frame,
-                                         Value& scratch) const;
+// Index for identifiers that weren't assigned a declared variable index. Never
+// matches an activation's variable, so lookups fall back to the name.
+constexpr size_t kNoVariableIndex = std::numeric_limits<size_t>::max();
 
-  std::string name_;
+struct IdentResult {
+  ValueView value;
+  AttributeTrail trail;
 };
 
-absl::StatusOr<IdentStep::IdentResult> IdentStep::DoEvaluate(
-    ExecutionFrame* frame, Value& scratch) const {
+// Resolves the identifier from the activation, applying the configured
+// unknown and missing attribute checks.
+absl::StatusOr<IdentResult> LookupIdent(const std::string& name,
+                                        size_t variable_index,
+                                        ExecutionFrame& frame,
+                                        Value& scratch) {
   IdentResult result;
   // Populate trails if either MissingAttributeError or UnknownPattern
   // is enabled.
-  if (frame->enable_missing_attribute_errors() || frame->enable_unknowns()) {
-    result.trail = AttributeTrail(name_);
+  if (frame.enable_missing_attribute_errors() || frame.enable_unknowns()) {
+    result.trail = AttributeTrail(name);
   }
 
-  if (frame->enable_missing_attribute_errors() && !name_.empty() &&
-      frame->attribute_utility().CheckForMissingAttribute(result.trail)) {
-    scratch = frame->value_factory().CreateErrorValue(
-        CreateMissingAttributeError(name_));
+  if (frame.enable_missing_attribute_errors() && !name.empty() &&
+      frame.attribute_utility().CheckForMissingAttribute(result.trail)) {
+    scratch = frame.value_factory().CreateErrorValue(
+        CreateMissingAttributeError(name));
     result.value = scratch;
     return result;
   }
 
-  if (frame->enable_unknowns()) {
-    if (frame->attribute_utility().CheckForUnknown(result.trail, false)) {
+  if (frame.enable_unknowns()) {
+    if (frame.attribute_utility().CheckForUnknown(result.trail, false)) {
       scratch =
-          frame->attribute_utility().CreateUnknownSet(result.trail.attribute());
+          frame.attribute_utility().CreateUnknownSet(result.trail.attribute());
       result.value = scratch;
       return result;
     }
   }
 
-  CEL_ASSIGN_OR_RETURN(auto value, frame->modern_activation().FindVariable(
-                                       frame->value_factory(), name_, scratch));
+  CEL_ASSIGN_OR_RETURN(auto value,
+                       frame.modern_activation().FindVariableAt(
+                           frame.value_factory(), variable_index, name,
+                           scratch));
 
   if (value.has_value()) {
     result.value = *value;
     return result;
   }
 
-  scratch = frame->value_factory().CreateErrorValue(CreateError(
-      absl::StrCat("No value with name \"", name_, "\" found in Activation")));
+  scratch = frame.value_factory().CreateErrorValue(CreateError(
+      absl::StrCat("No value with name \"", name, "\" found in Activation")));
   result.value = scratch;
 
   return result;
 }
 
+// Resolves a comprehension variable from its assigned slot.
+absl::Status LookupSlot(const std::string& name, size_t slot_index,
+                        ExecutionFrame& frame, Value& result,
+                        AttributeTrail& attribute) {
+  const ComprehensionSlots::Slot* slot =
+      frame.comprehension_slots().Get(slot_index);
+  if (slot == nullptr) {
+    return absl::InternalError(
+        absl::StrCat("Comprehension variable accessed out of scope: ", name));
+  }
+
+  attribute = slot->attribute;
+
+  if (frame.enable_missing_attribute_errors() &&
+      frame.attribute_utility().CheckForMissingAttribute(attribute)) {
+    CEL_ASSIGN_OR_RETURN(std::string attribute_string,
+                         attribute.attribute().AsString());
+    result = frame.value_factory().CreateErrorValue(
+        CreateMissingAttributeError(std::move(attribute_string)));
+    attribute = AttributeTrail();
+    return absl::OkStatus();
+  }
+
+  if (frame.enable_unknowns()) {
+    if (frame.attribute_utility().CheckForUnknown(attribute, false)) {
+      result =
+          frame.attribute_utility().CreateUnknownSet(attribute.attribute());
+      attribute = AttributeTrail();
+      return absl::OkStatus();
+    }
+  }
+
+  result = slot->value;
+  return absl::OkStatus();
+}
+
+class IdentStep : public ExpressionStepBase {
+ public:
+  IdentStep(absl::string_view name, size_t variable_index, int64_t expr_id)
+      : ExpressionStepBase(expr_id),
+        name_(name),
+        variable_index_(variable_index) {}
+
+  absl::Status Evaluate(ExecutionFrame* frame) const override;
+
+  Instruction GetInstruction() const override {
+    Instruction instruction = ExpressionStepBase::GetInstruction();
+    instruction.opcode = Opcode::kIdent;
+    instruction.index = variable_index_;
+    instruction.name = &name_;
+    return instruction;
+  }
+
+ private:
+  std::string name_;
+  size_t variable_index_;
+};
+
 absl::Status IdentStep::Evaluate(ExecutionFrame* frame) const {
   Value scratch;
-  CEL_ASSIGN_OR_RETURN(IdentResult result, DoEvaluate(frame, scratch));
+  CEL_ASSIGN_OR_RETURN(IdentResult result,
+                       LookupIdent(name_, variable_index_, *frame, scratch));
 
   frame->value_stack().Push(Value{result.value}, std::move(result.trail));
 
   return absl::OkStatus();
 }
 
+class DirectIdentStep : public DirectExpressionStep {
+ public:
+  DirectIdentStep(absl::string_view name, size_t variable_index,
+                  int64_t expr_id)
+      : DirectExpressionStep(expr_id),
+        name_(name),
+        variable_index_(variable_index) {}
+
+  absl::Status Evaluate(ExecutionFrame& frame, Value& result,
+                        AttributeTrail& attribute) const override {
+    Value scratch;
+    CEL_ASSIGN_OR_RETURN(IdentResult ident,
+                         LookupIdent(name_, variable_index_, frame, scratch));
+    result = Value{ident.value};
+    attribute = std::move(ident.trail);
+    return absl::OkStatus();
+  }
+
+ private:
+  std::string name_;
+  size_t variable_index_;
+};
+
 class SlotStep : public ExpressionStepBase {
  public:
   SlotStep(absl::string_view name, size_t slot_index, int64_t expr_id)
@@ -101,6 +181,13 @@ class SlotStep : public ExpressionStepBase {
 
   absl::Status Evaluate(ExecutionFrame* frame) const override;
 
+  Instruction GetInstruction() const override {
+    Instruction instruction = ExpressionStepBase::GetInstruction();
+    instruction.opcode = Opcode::kSlot;
+    instruction.index = slot_index_;
+    return instruction;
+  }
+
  private:
   std::string name_;
 
@@ -108,42 +195,44 @@ class SlotStep : public ExpressionStepBase {
 };
 
 absl::Status SlotStep::Evaluate(ExecutionFrame* frame) const {
-  const ComprehensionSlots::Slot* slot =
-      frame->comprehension_slots().Get(slot_index_);
-  if (slot == nullptr) {
-    return absl::InternalError(
-        absl::StrCat("Comprehension variable accessed out of scope: ", name_));
-  }
+  Value result;
+  AttributeTrail attribute;
+  CEL_RETURN_IF_ERROR(
+      LookupSlot(name_, slot_index_, *frame, result, attribute));
 
-  const auto& attribute_trail = slot->attribute;
+  frame->value_stack().Push(std::move(result), std::move(attribute));
+  return absl::OkStatus();
+}
 
-  if (frame->enable_missing_attribute_errors() &&
-      frame->attribute_utility().CheckForMissingAttribute(attribute_trail)) {
-    CEL_ASSIGN_OR_RETURN(std::string attribute,
-                         attribute_trail.attribute().AsString());
-    frame->value_stack().Push(frame->value_factory().CreateErrorValue(
-        CreateMissingAttributeError(std::move(attribute))));
-    return absl::OkStatus();
-  }
+class DirectSlotStep : public DirectExpressionStep {
+ public:
+  DirectSlotStep(absl::string_view name, size_t slot_index, int64_t expr_id)
+      : DirectExpressionStep(expr_id), name_(name), slot_index_(slot_index) {}
 
-  if (frame->enable_unknowns()) {
-    if (frame->attribute_utility().CheckForUnknown(attribute_trail, false)) {
-      auto unknown_set = frame->attribute_utility().CreateUnknownSet(
-          attribute_trail.attribute());
-      frame->value_stack().Push(std::move(unknown_set));
-      return absl::OkStatus();
-    }
+  absl::Status Evaluate(ExecutionFrame& frame, Value& result,
+                        AttributeTrail& attribute) const override {
+    return LookupSlot(name_, slot_index_, frame, result, attribute);
   }
 
-  frame->value_stack().Push(slot->value, attribute_trail);
-  return absl::OkStatus();
-}
+ private:
+  std::string name_;
+
+  size_t slot_index_;
+};
 
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateIdentStep(
     const cel::ast_internal::Ident& ident_expr, int64_t expr_id) {
-  return std::make_unique<IdentStep>(ident_expr.name(), expr_id);
+  return std::make_unique<IdentStep>(ident_expr.name(), kNoVariableIndex,
+                                     expr_id);
+}
+
+absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateIdentStep(
+    const cel::ast_internal::Ident& ident_expr, size_t variable_index,
+    int64_t expr_id) {
+  return std::make_unique<IdentStep>(ident_expr.name(), variable_index,
+                                     expr_id);
 }
 
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateIdentStepForSlot(
@@ -152,4 +241,21 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateIdentStepForSlot(
   return std::make_unique<SlotStep>(ident_expr.name(), slot_index, expr_id);
 }
 
+std::unique_ptr<DirectExpressionStep> CreateDirectIdentStep(
+    absl::string_view identifier, int64_t expr_id) {
+  return std::make_unique<DirectIdentStep>(identifier, kNoVariableIndex,
+                                           expr_id);
+}
+
+std::unique_ptr<DirectExpressionStep> CreateDirectIdentStep(
+    absl::string_view identifier, size_t variable_index, int64_t expr_id) {
+  return std::make_unique<DirectIdentStep>(identifier, variable_index,
+                                           expr_id);
+}
+
+std::unique_ptr<DirectExpressionStep> CreateDirectSlotIdentStep(
+    absl::string_view identifier, size_t slot_index, int64_t expr_id) {
+  return std::make_unique<DirectSlotStep>(identifier, slot_index, expr_id);
+}
+
 }  // namespace google::api::expr::runtime
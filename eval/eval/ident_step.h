@@ -1,11 +1,14 @@
 #ifndef THIRD_PARTY_CEL_CPP_EVAL_EVAL_IDENT_STEP_H_
 #define THIRD_PARTY_CEL_CPP_EVAL_EVAL_IDENT_STEP_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "base/ast_internal/expr.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 
 namespace google::api::expr::runtime {
@@ -14,11 +17,31 @@ namespace google::api::expr::runtime {
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateIdentStep(
     const cel::ast_internal::Ident& ident, int64_t expr_id);
 
+// Factory method for Ident that was assigned a declared variable index at plan
+// time (see cel::ActivationInterface::FindVariableAt).
+absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateIdentStep(
+    const cel::ast_internal::Ident& ident, size_t variable_index,
+    int64_t expr_id);
+
 // Factory method for identifier that has been assigned to a slot.
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateIdentStepForSlot(
     const cel::ast_internal::Ident& ident_expr, size_t slot_index,
     int64_t expr_id);
 
+// Factory method for a directly evaluated Ident.
+std::unique_ptr<DirectExpressionStep> CreateDirectIdentStep(
+    absl::string_view identifier, int64_t expr_id);
+
+// Factory method for a directly evaluated Ident that was assigned a declared
+// variable index.
+std::unique_ptr<DirectExpressionStep> CreateDirectIdentStep(
+    absl::string_view identifier, size_t variable_index, int64_t expr_id);
+
+// Factory method for a directly evaluated identifier that has been assigned to
+// a slot.
+std::unique_ptr<DirectExpressionStep> CreateDirectSlotIdentStep(
+    absl::string_view identifier, size_t slot_index, int64_t expr_id);
+
 }  // namespace google::api::expr::runtime
 
 #endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_IDENT_STEP_H_
@@ -29,6 +29,10 @@ class JumpStep : public JumpStepBase {
   absl::Status Evaluate(ExecutionFrame* frame) const override {
     return Jump(frame);
   }
+
+  Instruction GetInstruction() const override {
+    return MakeJumpInstruction(Opcode::kJump);
+  }
 };
 
 class CondJumpStep : public JumpStepBase {
@@ -62,6 +66,13 @@ class CondJumpStep : public JumpStepBase {
     return absl::OkStatus();
   }
 
+  Instruction GetInstruction() const override {
+    Instruction instruction = MakeJumpInstruction(Opcode::kCondJump);
+    instruction.condition = jump_condition_;
+    instruction.leave_on_stack = leave_on_stack_;
+    return instruction;
+  }
+
  private:
   const bool jump_condition_;
   const bool leave_on_stack_;
@@ -103,6 +114,10 @@ class BoolCheckJumpStep : public JumpStepBase {
 
     return absl::OkStatus();
   }
+
+  Instruction GetInstruction() const override {
+    return MakeJumpInstruction(Opcode::kBoolCheckJump);
+  }
 };
 
 }  // namespace
@@ -25,6 +25,20 @@ class JumpStepBase : public ExpressionStepBase {
     return frame->JumpTo(jump_offset_.value());
   }
 
+ protected:
+  const absl::optional<int>& jump_offset() const { return jump_offset_; }
+
+  // Returns an instruction with the given opcode if the jump offset is set.
+  // Otherwise, returns a generic instruction so evaluation reports the error.
+  Instruction MakeJumpInstruction(Opcode opcode) const {
+    Instruction instruction = ExpressionStepBase::GetInstruction();
+    if (jump_offset_.has_value()) {
+      instruction.opcode = opcode;
+      instruction.jump_offset = *jump_offset_;
+    }
+    return instruction;
+  }
+
  private:
   absl::optional<int> jump_offset_;
 };
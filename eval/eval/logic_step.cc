@@ -6,11 +6,18 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "base/builtins.h"
 #include "common/value.h"
+#include "eval/eval/attribute_trail.h"
+#include "eval/eval/direct_expression_step.h"
+#include "eval/eval/evaluator_core.h"
 #include "eval/eval/expression_step_base.h"
+#include "eval/eval/parallel_evaluation.h"
 #include "eval/internal/errors.h"
+#include "internal/status_macros.h"
+#include "runtime/executor.h"
 
 namespace google::api::expr::runtime {
 
@@ -23,72 +30,78 @@ using ::cel::Value;
 using ::cel::ValueView;
 using ::cel::runtime_internal::CreateNoMatchingOverloadError;
 
-class LogicalOpStep : public ExpressionStepBase {
- public:
-  enum class OpType { AND, OR };
-
-  // Constructs FunctionStep that uses overloads specified.
-  LogicalOpStep(OpType op_type, int64_t expr_id)
-      : ExpressionStepBase(expr_id), op_type_(op_type) {
-    shortcircuit_ = (op_type_ == OpType::OR);
-  }
-
-  absl::Status Evaluate(ExecutionFrame* frame) const override;
-
- private:
-  ValueView Calculate(ExecutionFrame* frame, absl::Span<const Value> args,
-                      Value& scratch) const {
-    bool bool_args[2];
-    bool has_bool_args[2];
-
-    for (size_t i = 0; i < args.size(); i++) {
-      has_bool_args[i] = args[i]->Is<BoolValue>();
-      if (has_bool_args[i]) {
-        bool_args[i] = args[i].As<BoolValue>().NativeValue();
-        if (bool_args[i] == shortcircuit_) {
-          return BoolValueView{bool_args[i]};
-        }
+enum class OpType { AND, OR };
+
+// Computes the result of the logical operator given both evaluated operands.
+ValueView Calculate(OpType op_type, ExecutionFrame& frame,
+                    absl::Span<const Value> args, Value& scratch) {
+  const bool shortcircuit = (op_type == OpType::OR);
+  bool bool_args[2];
+  bool has_bool_args[2];
+
+  for (size_t i = 0; i < args.size(); i++) {
+    has_bool_args[i] = args[i]->Is<BoolValue>();
+    if (has_bool_args[i]) {
+      bool_args[i] = args[i].As<BoolValue>().NativeValue();
+      if (bool_args[i] == shortcircuit) {
+        return BoolValueView{bool_args[i]};
       }
     }
+  }
 
-    if (has_bool_args[0] && has_bool_args[1]) {
-      switch (op_type_) {
-        case OpType::AND:
-          return BoolValueView{bool_args[0] && bool_args[1]};
-        case OpType::OR:
-          return BoolValueView{bool_args[0] || bool_args[1]};
-      }
+  if (has_bool_args[0] && has_bool_args[1]) {
+    switch (op_type) {
+      case OpType::AND:
+        return BoolValueView{bool_args[0] && bool_args[1]};
+      case OpType::OR:
+        return BoolValueView{bool_args[0] || bool_args[1]};
     }
+  }
 
-    // As opposed to regular function, logical operation treat Unknowns with
-    // higher precedence than error. This is due to the fact that after Unknown
-    // is resolved to actual value, it may short-circuit and thus hide the
-    // error.
-    if (frame->enable_unknowns()) {
-      // Check if unknown?
-      absl::optional<cel::UnknownValue> unknown_set =
-          frame->attribute_utility().MergeUnknowns(args);
-      if (unknown_set.has_value()) {
-        scratch = *unknown_set;
-        return scratch;
-      }
+  // As opposed to regular function, logical operation treat Unknowns with
+  // higher precedence than error. This is due to the fact that after Unknown
+  // is resolved to actual value, it may short-circuit and thus hide the
+  // error.
+  if (frame.enable_unknowns()) {
+    // Check if unknown?
+    absl::optional<cel::UnknownValue> unknown_set =
+        frame.attribute_utility().MergeUnknowns(args);
+    if (unknown_set.has_value()) {
+      scratch = *unknown_set;
+      return scratch;
     }
+  }
 
-    if (args[0]->Is<cel::ErrorValue>()) {
-      return args[0];
-    } else if (args[1]->Is<cel::ErrorValue>()) {
-      return args[1];
-    }
+  if (args[0]->Is<cel::ErrorValue>()) {
+    return args[0];
+  } else if (args[1]->Is<cel::ErrorValue>()) {
+    return args[1];
+  }
+
+  // Fallback.
+  scratch =
+      frame.value_factory().CreateErrorValue(CreateNoMatchingOverloadError(
+          (op_type == OpType::OR) ? cel::builtin::kOr : cel::builtin::kAnd));
+  return scratch;
+}
+
+class LogicalOpStep : public ExpressionStepBase {
+ public:
+  // Constructs FunctionStep that uses overloads specified.
+  LogicalOpStep(OpType op_type, int64_t expr_id)
+      : ExpressionStepBase(expr_id), op_type_(op_type) {}
+
+  absl::Status Evaluate(ExecutionFrame* frame) const override;
 
-    // Fallback.
-    scratch =
-        frame->value_factory().CreateErrorValue(CreateNoMatchingOverloadError(
-            (op_type_ == OpType::OR) ? cel::builtin::kOr : cel::builtin::kAnd));
-    return scratch;
+  Instruction GetInstruction() const override {
+    Instruction instruction = ExpressionStepBase::GetInstruction();
+    instruction.opcode =
+        (op_type_ == OpType::AND) ? Opcode::kAnd : Opcode::kOr;
+    return instruction;
   }
 
+ private:
   const OpType op_type_;
-  bool shortcircuit_;
 };
 
 absl::Status LogicalOpStep::Evaluate(ExecutionFrame* frame) const {
@@ -100,22 +113,97 @@ absl::Status LogicalOpStep::Evaluate(ExecutionFrame* frame) const {
   // Create Span object that contains input arguments to the function.
   auto args = frame->value_stack().GetSpan(2);
   Value scratch;
-  auto result = Calculate(frame, args, scratch);
+  auto result = Calculate(op_type_, *frame, args, scratch);
   frame->value_stack().PopAndPush(args.size(), Value{result});
 
   return absl::OkStatus();
 }
 
+// Direct implementation of a logical operator.
+//
+// The right hand side is only evaluated if the left hand side doesn't decide
+// the result (unless short-circuiting is disabled). Without short-circuiting,
+// the right hand side may be forked to run alongside the left hand side.
+class DirectLogicalOpStep : public DirectExpressionStep {
+ public:
+  DirectLogicalOpStep(OpType op_type, std::unique_ptr<DirectExpressionStep> lhs,
+                      std::unique_ptr<DirectExpressionStep> rhs,
+                      bool shortcircuiting, int64_t expr_id,
+                      ForkedDependencies forked)
+      : DirectExpressionStep(expr_id),
+        op_type_(op_type),
+        lhs_(std::move(lhs)),
+        rhs_(std::move(rhs)),
+        shortcircuiting_(shortcircuiting),
+        fork_rhs_(!shortcircuiting && forked.enabled() &&
+                  forked.forked.size() == 2 && forked.forked[1]),
+        executor_(std::move(forked.executor)) {}
+
+  absl::Status Evaluate(ExecutionFrame& frame, Value& result,
+                        AttributeTrail& attribute) const override {
+    absl::optional<ForkedEvaluation> forked_rhs;
+    if (fork_rhs_) {
+      forked_rhs.emplace(*rhs_, frame, *executor_);
+    }
+
+    Value args[2];
+    AttributeTrail lhs_attr;
+    CEL_RETURN_IF_ERROR(lhs_->Evaluate(frame, args[0], lhs_attr));
+    if (shortcircuiting_ && args[0]->Is<BoolValue>() &&
+        args[0].As<BoolValue>().NativeValue() == (op_type_ == OpType::OR)) {
+      result = std::move(args[0]);
+      return absl::OkStatus();
+    }
+
+    AttributeTrail rhs_attr;
+    if (forked_rhs.has_value()) {
+      CEL_RETURN_IF_ERROR(forked_rhs->Join(args[1], rhs_attr));
+    } else {
+      CEL_RETURN_IF_ERROR(rhs_->Evaluate(frame, args[1], rhs_attr));
+    }
+
+    Value scratch;
+    result = Value{Calculate(op_type_, frame, args, scratch)};
+    return absl::OkStatus();
+  }
+
+ private:
+  const OpType op_type_;
+  std::unique_ptr<DirectExpressionStep> lhs_;
+  std::unique_ptr<DirectExpressionStep> rhs_;
+  bool shortcircuiting_;
+  bool fork_rhs_;
+  std::shared_ptr<cel::Executor> executor_;
+};
+
 }  // namespace
 
 // Factory method for "And" Execution step
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateAndStep(int64_t expr_id) {
-  return std::make_unique<LogicalOpStep>(LogicalOpStep::OpType::AND, expr_id);
+  return std::make_unique<LogicalOpStep>(OpType::AND, expr_id);
 }
 
 // Factory method for "Or" Execution step
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateOrStep(int64_t expr_id) {
-  return std::make_unique<LogicalOpStep>(LogicalOpStep::OpType::OR, expr_id);
+  return std::make_unique<LogicalOpStep>(OpType::OR, expr_id);
+}
+
+std::unique_ptr<DirectExpressionStep> CreateDirectAndStep(
+    std::unique_ptr<DirectExpressionStep> lhs,
+    std::unique_ptr<DirectExpressionStep> rhs, int64_t expr_id,
+    bool shortcircuiting, ForkedDependencies forked) {
+  return std::make_unique<DirectLogicalOpStep>(OpType::AND, std::move(lhs),
+                                               std::move(rhs), shortcircuiting,
+                                               expr_id, std::move(forked));
+}
+
+std::unique_ptr<DirectExpressionStep> CreateDirectOrStep(
+    std::unique_ptr<DirectExpressionStep> lhs,
+    std::unique_ptr<DirectExpressionStep> rhs, int64_t expr_id,
+    bool shortcircuiting, ForkedDependencies forked) {
+  return std::make_unique<DirectLogicalOpStep>(OpType::OR, std::move(lhs),
+                                               std::move(rhs), shortcircuiting,
+                                               expr_id, std::move(forked));
 }
 
 }  // namespace google::api::expr::runtime
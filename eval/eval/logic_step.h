@@ -5,7 +5,9 @@
 #include <memory>
 
 #include "absl/status/statusor.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
+#include "eval/eval/parallel_evaluation.h"
 
 namespace google::api::expr::runtime {
 
@@ -15,6 +17,21 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateAndStep(int64_t expr_id);
 // Factory method for "Or" Execution step
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateOrStep(int64_t expr_id);
 
+// Factory method for a directly evaluated "And".
+//
+// If `forked` marks the right hand side, it is started on the executor
+// alongside the left hand side.
+std::unique_ptr<DirectExpressionStep> CreateDirectAndStep(
+    std::unique_ptr<DirectExpressionStep> lhs,
+    std::unique_ptr<DirectExpressionStep> rhs, int64_t expr_id,
+    bool shortcircuiting, ForkedDependencies forked = {});
+
+// Factory method for a directly evaluated "Or".
+std::unique_ptr<DirectExpressionStep> CreateDirectOrStep(
+    std::unique_ptr<DirectExpressionStep> lhs,
+    std::unique_ptr<DirectExpressionStep> rhs, int64_t expr_id,
+    bool shortcircuiting, ForkedDependencies forked = {});
+
 }  // namespace google::api::expr::runtime
 
 #endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_LOGIC_STEP_H_
@@ -0,0 +1,95 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/eval/parallel_evaluation.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "common/value.h"
+#include "eval/eval/attribute_trail.h"
+#include "eval/eval/direct_expression_step.h"
+#include "eval/eval/evaluator_core.h"
+#include "runtime/executor.h"
+
+namespace google::api::expr::runtime {
+
+struct ForkedEvaluation::State {
+  // Direct steps don't use the value stack, and comprehensions (the only users
+  // of slots) are never forked.
+  State(const DirectExpressionStep& step, ExecutionFrame& parent)
+      : step(step),
+        evaluator_state(/*value_stack_size=*/0, /*comprehension_slot_count=*/0,
+                        parent.value_manager().type_provider(),
+                        parent.memory_manager(),
+                        parent.enable_attribute_tracking()),
+        frame(ExecutionPathView(), parent.modern_activation(), parent.options(),
+              evaluator_state) {}
+
+  // Set by whichever thread runs the evaluation (or cancels it) first.
+  bool Claim() { return !claimed.exchange(true, std::memory_order_acq_rel); }
+
+  void Run() { status = step.Evaluate(frame, result, attribute); }
+
+  const DirectExpressionStep& step;
+  FlatExpressionEvaluatorState evaluator_state;
+  ExecutionFrame frame;
+  std::atomic<bool> claimed{false};
+  // Notified when an executor thread finishes the evaluation.
+  absl::Notification done;
+  absl::Status status;
+  cel::Value result;
+  AttributeTrail attribute;
+};
+
+ForkedEvaluation::ForkedEvaluation(const DirectExpressionStep& step,
+                                   ExecutionFrame& frame,
+                                   cel::Executor& executor)
+    : state_(std::make_shared<State>(step, frame)) {
+  executor.Schedule([state = state_]() {
+    if (!state->Claim()) {
+      return;
+    }
+    state->Run();
+    state->done.Notify();
+  });
+}
+
+absl::Status ForkedEvaluation::Join(cel::Value& result,
+                                    AttributeTrail& attribute) {
+  std::shared_ptr<State> state = std::move(state_);
+  if (state->Claim()) {
+    state->Run();
+  } else {
+    state->done.WaitForNotification();
+  }
+  result = std::move(state->result);
+  attribute = std::move(state->attribute);
+  return std::move(state->status);
+}
+
+void ForkedEvaluation::Cancel() {
+  if (state_ == nullptr) {
+    return;
+  }
+  std::shared_ptr<State> state = std::move(state_);
+  if (!state->Claim()) {
+    state->done.WaitForNotification();
+  }
+}
+
+}  // namespace google::api::expr::runtime
@@ -0,0 +1,77 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Utilities for evaluating independent direct steps concurrently.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_EVAL_PARALLEL_EVALUATION_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_EVAL_PARALLEL_EVALUATION_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "common/value.h"
+#include "eval/eval/attribute_trail.h"
+#include "eval/eval/direct_expression_step.h"
+#include "eval/eval/evaluator_core.h"
+#include "runtime/executor.h"
+
+namespace google::api::expr::runtime {
+
+// Dependencies of a direct step to evaluate concurrently on an executor.
+struct ForkedDependencies {
+  // Executor for forked dependencies. If null, every dependency is evaluated
+  // on the calling thread.
+  std::shared_ptr<cel::Executor> executor;
+  // forked[i] is true if dependency i should be started on the executor.
+  std::vector<bool> forked;
+
+  bool enabled() const { return executor != nullptr; }
+};
+
+// Evaluation of a direct step started on an executor.
+//
+// The forked step is evaluated in a frame of its own, sharing only the
+// activation, options and memory manager of the caller's ExecutionFrame. In
+// particular it gets its own value manager, since the caller's (including its
+// type caches) is generally only thread compatible. The evaluation must be
+// joined or cancelled before the caller's frame goes away; the destructor
+// cancels if neither happened.
+class ForkedEvaluation {
+ public:
+  ForkedEvaluation(const DirectExpressionStep& step, ExecutionFrame& frame,
+                   cel::Executor& executor);
+
+  ForkedEvaluation(ForkedEvaluation&&) = default;
+  ForkedEvaluation& operator=(ForkedEvaluation&&) = delete;
+
+  ~ForkedEvaluation() { Cancel(); }
+
+  // Waits for the result. If no executor thread has started the evaluation
+  // yet, it is run on the calling thread instead.
+  absl::Status Join(cel::Value& result, AttributeTrail& attribute);
+
+  // Drops the result. Waits if the evaluation is already running, otherwise
+  // prevents it from starting.
+  void Cancel();
+
+ private:
+  struct State;
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_PARALLEL_EVALUATION_H_
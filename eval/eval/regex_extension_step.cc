@@ -0,0 +1,191 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/eval/regex_extension_step.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/optimization.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "common/type.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "eval/eval/evaluator_core.h"
+#include "eval/eval/expression_step_base.h"
+#include "internal/status_macros.h"
+#include "re2/re2.h"
+
+namespace google::api::expr::runtime {
+
+namespace {
+
+using ::cel::StringValue;
+using ::cel::Value;
+using ::cel::ValueManager;
+
+// Error messages match the function implementations in
+// extensions/regex_functions.cc.
+
+struct ExtractOp {
+  static constexpr size_t kArguments = 3;
+
+  explicit ExtractOp(const RE2&) {}
+
+  absl::StatusOr<Value> operator()(ValueManager& value_factory, const RE2& re,
+                                   absl::Span<const Value> args) const {
+    std::string target_scratch;
+    std::string rewrite_scratch;
+    absl::string_view target =
+        args[0].As<StringValue>().NativeString(target_scratch);
+    absl::string_view rewrite =
+        args[2].As<StringValue>().NativeString(rewrite_scratch);
+    std::string output;
+    if (!RE2::Extract(target, re, rewrite, &output)) {
+      return value_factory.CreateErrorValue(absl::InvalidArgumentError(
+          "Unable to extract string for the given regex"));
+    }
+    return value_factory.CreateUncheckedStringValue(std::move(output));
+  }
+};
+
+struct CaptureOp {
+  static constexpr size_t kArguments = 2;
+
+  explicit CaptureOp(const RE2&) {}
+
+  absl::StatusOr<Value> operator()(ValueManager& value_factory, const RE2& re,
+                                   absl::Span<const Value> args) const {
+    std::string scratch;
+    absl::string_view target = args[0].As<StringValue>().NativeString(scratch);
+    std::string output;
+    if (!RE2::FullMatch(target, re, &output)) {
+      return value_factory.CreateErrorValue(absl::InvalidArgumentError(
+          "Unable to capture groups for the given regex"));
+    }
+    return value_factory.CreateUncheckedStringValue(std::move(output));
+  }
+};
+
+struct CaptureNOp {
+  static constexpr size_t kArguments = 2;
+
+  // Names of the capturing groups, or their index if unnamed, resolved once
+  // for all evaluations.
+  explicit CaptureNOp(const RE2& re) {
+    const auto& named_groups = re.CapturingGroupNames();
+    for (int index = 1; index <= re.NumberOfCapturingGroups(); ++index) {
+      auto it = named_groups.find(index);
+      group_names.push_back(it != named_groups.end() ? it->second
+                                                     : absl::StrCat(index));
+    }
+  }
+
+  absl::StatusOr<Value> operator()(ValueManager& value_factory, const RE2& re,
+                                   absl::Span<const Value> args) const {
+    std::string scratch;
+    absl::string_view target = args[0].As<StringValue>().NativeString(scratch);
+    const int group_count = static_cast<int>(group_names.size());
+    std::vector<std::string> captured(group_count);
+    std::vector<RE2::Arg> arg_storage(group_count);
+    std::vector<RE2::Arg*> argv(group_count);
+    for (int i = 0; i < group_count; ++i) {
+      arg_storage[i] = &captured[i];
+      argv[i] = &arg_storage[i];
+    }
+    if (!RE2::FullMatchN(target, re, argv.data(), group_count)) {
+      return value_factory.CreateErrorValue(absl::InvalidArgumentError(
+          "Unable to capture groups for the given regex"));
+    }
+    CEL_ASSIGN_OR_RETURN(auto builder,
+                         value_factory.NewMapValueBuilder(cel::MapTypeView{}));
+    builder->Reserve(group_count);
+    for (int i = 0; i < group_count; ++i) {
+      CEL_RETURN_IF_ERROR(builder->Put(
+          value_factory.CreateUncheckedStringValue(group_names[i]),
+          value_factory.CreateUncheckedStringValue(std::move(captured[i]))));
+    }
+    return std::move(*builder).Build();
+  }
+
+  std::vector<std::string> group_names;
+};
+
+template <typename Op>
+class RegexExtensionStep final : public ExpressionStepBase {
+ public:
+  RegexExtensionStep(std::shared_ptr<const RE2> re2,
+                     std::unique_ptr<const ExpressionStep> fallback,
+                     int64_t expr_id)
+      : ExpressionStepBase(expr_id),
+        re2_(std::move(re2)),
+        op_(*re2_),
+        fallback_(std::move(fallback)) {}
+
+  absl::Status Evaluate(ExecutionFrame* frame) const override {
+    if (ABSL_PREDICT_FALSE(!frame->value_stack().HasEnough(Op::kArguments) ||
+                           frame->enable_unknowns())) {
+      return fallback_->Evaluate(frame);
+    }
+    absl::Span<const Value> args =
+        frame->value_stack().GetSpan(Op::kArguments);
+    for (const Value& arg : args) {
+      if (ABSL_PREDICT_FALSE(!arg->Is<StringValue>())) {
+        return fallback_->Evaluate(frame);
+      }
+    }
+    CEL_ASSIGN_OR_RETURN(Value result,
+                         op_(frame->value_factory(), *re2_, args));
+    frame->value_stack().PopAndPush(Op::kArguments, std::move(result));
+    return absl::OkStatus();
+  }
+
+ private:
+  const std::shared_ptr<const RE2> re2_;
+  const Op op_;
+  std::unique_ptr<const ExpressionStep> fallback_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateRegexExtractStep(
+    std::shared_ptr<const RE2> re2,
+    std::unique_ptr<const ExpressionStep> fallback, int64_t expr_id) {
+  return std::make_unique<RegexExtensionStep<ExtractOp>>(
+      std::move(re2), std::move(fallback), expr_id);
+}
+
+absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateRegexCaptureStep(
+    std::shared_ptr<const RE2> re2,
+    std::unique_ptr<const ExpressionStep> fallback, int64_t expr_id) {
+  return std::make_unique<RegexExtensionStep<CaptureOp>>(
+      std::move(re2), std::move(fallback), expr_id);
+}
+
+absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateRegexCaptureNStep(
+    std::shared_ptr<const RE2> re2,
+    std::unique_ptr<const ExpressionStep> fallback, int64_t expr_id) {
+  return std::make_unique<RegexExtensionStep<CaptureNOp>>(
+      std::move(re2), std::move(fallback), expr_id);
+}
+
+}  // namespace google::api::expr::runtime
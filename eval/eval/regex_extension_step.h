@@ -0,0 +1,52 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_EVAL_REGEX_EXTENSION_STEP_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_EVAL_REGEX_EXTENSION_STEP_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "eval/eval/evaluator_core.h"
+#include "re2/re2.h"
+
+namespace google::api::expr::runtime {
+
+// Steps for the regex extension functions (see extensions/regex_functions.h)
+// called with a pattern that was compiled at plan time.
+//
+// The steps consume the same arguments as the original call, including the
+// constant pattern. Unless all of the arguments are strings, evaluation is
+// deferred to `fallback`, the original function step, so that errors and
+// unknowns propagate as before.
+
+// re.extract(target, pattern, rewrite)
+absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateRegexExtractStep(
+    std::shared_ptr<const RE2> re2,
+    std::unique_ptr<const ExpressionStep> fallback, int64_t expr_id);
+
+// re.capture(target, pattern)
+absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateRegexCaptureStep(
+    std::shared_ptr<const RE2> re2,
+    std::unique_ptr<const ExpressionStep> fallback, int64_t expr_id);
+
+// re.captureN(target, pattern)
+absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateRegexCaptureNStep(
+    std::shared_ptr<const RE2> re2,
+    std::unique_ptr<const ExpressionStep> fallback, int64_t expr_id);
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_REGEX_EXTENSION_STEP_H_
@@ -14,6 +14,8 @@
 #include "common/type.h"
 #include "common/value.h"
 #include "common/value_manager.h"
+#include "eval/eval/attribute_trail.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 #include "eval/eval/expression_step_base.h"
 #include "eval/internal/errors.h"
@@ -100,23 +102,40 @@ ValueView TestOnlySelect(const MapValue& map, const StringValue& field_name,
   return *presence;
 }
 
-}  // namespace
-
-// SelectStep performs message field access specified by Expr::Select
-// message.
-class SelectStep : public ExpressionStepBase {
+// Applies a field selection (or presence test) to an evaluated operand.
+//
+// Shared between the stack machine and direct implementations.
+class SelectOperation {
  public:
-  SelectStep(StringValue value, bool test_field_presence, int64_t expr_id,
-             bool enable_wrapper_type_null_unboxing)
-      : ExpressionStepBase(expr_id),
-        field_value_(std::move(value)),
+  SelectOperation(StringValue value, bool test_field_presence,
+                  bool enable_wrapper_type_null_unboxing)
+      : field_value_(std::move(value)),
         field_(field_value_.ToString()),
         test_field_presence_(test_field_presence),
         unboxing_option_(enable_wrapper_type_null_unboxing
                              ? ProtoWrapperTypeOptions::kUnsetNull
                              : ProtoWrapperTypeOptions::kUnsetProtoDefault) {}
 
-  absl::Status Evaluate(ExecutionFrame* frame) const override;
+  // Computes the result of the select for arg (with attribute trail).
+  //
+  // result and result_trail are updated with the selected value or a
+  // cel::ErrorValue.
+  absl::Status Apply(ExecutionFrame& frame, const Value& arg,
+                     const AttributeTrail& trail, Value& result,
+                     AttributeTrail& result_trail) const;
+
+  // Returns the instruction for a step applying this operation in the direct
+  // dispatch loop. Presence tests are left to the step.
+  Instruction GetInstruction(Instruction instruction) const {
+    if (test_field_presence_) {
+      return instruction;
+    }
+    instruction.opcode = Opcode::kSelect;
+    instruction.name = &field_;
+    instruction.field = &field_value_;
+    instruction.unboxing_option = unboxing_option_;
+    return instruction;
+  }
 
  private:
   cel::StringValue field_value_;
@@ -125,47 +144,38 @@ class SelectStep : public ExpressionStepBase {
   ProtoWrapperTypeOptions unboxing_option_;
 };
 
-absl::Status SelectStep::Evaluate(ExecutionFrame* frame) const {
-  if (!frame->value_stack().HasEnough(1)) {
-    return absl::Status(absl::StatusCode::kInternal,
-                        "No arguments supplied for Select-type expression");
-  }
-
-  const Value& arg = frame->value_stack().Peek();
-  const AttributeTrail& trail = frame->value_stack().PeekAttribute();
-
+absl::Status SelectOperation::Apply(ExecutionFrame& frame, const Value& arg,
+                                    const AttributeTrail& trail, Value& result,
+                                    AttributeTrail& result_trail) const {
   if (arg->Is<UnknownValue>() || arg->Is<ErrorValue>()) {
     // Bubble up unknowns and errors.
+    result = arg;
+    result_trail = trail;
     return absl::OkStatus();
   }
 
-  AttributeTrail result_trail;
+  result_trail = AttributeTrail();
 
   // Handle unknown resolution.
-  if (frame->enable_unknowns() || frame->enable_missing_attribute_errors()) {
+  if (frame.enable_unknowns() || frame.enable_missing_attribute_errors()) {
     result_trail = trail.Step(&field_);
   }
 
   if (arg->Is<NullValue>()) {
-    frame->value_stack().PopAndPush(
-        frame->value_factory().CreateErrorValue(
-            cel::runtime_internal::CreateError("Message is NULL")),
-        std::move(result_trail));
+    result = frame.value_factory().CreateErrorValue(
+        cel::runtime_internal::CreateError("Message is NULL"));
     return absl::OkStatus();
   }
 
   if (!(arg->Is<MapValue>() || arg->Is<StructValue>())) {
-    frame->value_stack().PopAndPush(
-        frame->value_factory().CreateErrorValue(InvalidSelectTargetError()),
-        std::move(result_trail));
+    result = frame.value_factory().CreateErrorValue(InvalidSelectTargetError());
     return absl::OkStatus();
   }
 
   absl::optional<Value> marked_attribute_check =
-      CheckForMarkedAttributes(result_trail, frame);
+      CheckForMarkedAttributes(result_trail, &frame);
   if (marked_attribute_check.has_value()) {
-    frame->value_stack().PopAndPush(std::move(marked_attribute_check).value(),
-                                    std::move(result_trail));
+    result = std::move(marked_attribute_check).value();
     return absl::OkStatus();
   }
 
@@ -173,16 +183,15 @@ absl::Status SelectStep::Evaluate(ExecutionFrame* frame) const {
 
   // Handle test only Select.
   if (test_field_presence_) {
+    result_trail = AttributeTrail();
     switch (arg->kind()) {
       case ValueKind::kMap:
-        frame->value_stack().PopAndPush(
-            Value{TestOnlySelect(arg.As<MapValue>(), field_value_,
-                                 frame->value_factory(), result_scratch)});
+        result = Value{TestOnlySelect(arg.As<MapValue>(), field_value_,
+                                      frame.value_factory(), result_scratch)};
         return absl::OkStatus();
       case ValueKind::kMessage:
-        frame->value_stack().PopAndPush(
-            Value{TestOnlySelect(arg.As<StructValue>(), field_,
-                                 frame->value_factory(), result_scratch)});
+        result = Value{TestOnlySelect(arg.As<StructValue>(), field_,
+                                      frame.value_factory(), result_scratch)};
         return absl::OkStatus();
       default:
         // Control flow should have returned earlier.
@@ -194,17 +203,17 @@ absl::Status SelectStep::Evaluate(ExecutionFrame* frame) const {
   // Select steps can be applied to either maps or messages
   switch (arg->kind()) {
     case ValueKind::kStruct: {
-      CEL_ASSIGN_OR_RETURN(auto result, arg.As<StructValue>().GetFieldByName(
-                                            frame->value_factory(), field_,
-                                            result_scratch, unboxing_option_));
-      frame->value_stack().PopAndPush(Value{result}, std::move(result_trail));
+      CEL_ASSIGN_OR_RETURN(auto value, arg.As<StructValue>().GetFieldByName(
+                                           frame.value_factory(), field_,
+                                           result_scratch, unboxing_option_));
+      result = Value{value};
       return absl::OkStatus();
     }
     case ValueKind::kMap: {
       CEL_ASSIGN_OR_RETURN(
-          auto result, arg.As<MapValue>().Get(frame->value_factory(),
-                                              field_value_, result_scratch));
-      frame->value_stack().PopAndPush(Value{result}, std::move(result_trail));
+          auto value, arg.As<MapValue>().Get(frame.value_factory(),
+                                             field_value_, result_scratch));
+      result = Value{value};
       return absl::OkStatus();
     }
     default:
@@ -213,6 +222,73 @@ absl::Status SelectStep::Evaluate(ExecutionFrame* frame) const {
   }
 }
 
+class DirectSelectStep : public DirectExpressionStep {
+ public:
+  DirectSelectStep(std::unique_ptr<DirectExpressionStep> operand,
+                   StringValue value, bool test_field_presence,
+                   int64_t expr_id, bool enable_wrapper_type_null_unboxing)
+      : DirectExpressionStep(expr_id),
+        operand_(std::move(operand)),
+        operation_(std::move(value), test_field_presence,
+                   enable_wrapper_type_null_unboxing) {}
+
+  absl::Status Evaluate(ExecutionFrame& frame, Value& result,
+                        AttributeTrail& attribute) const override {
+    Value arg;
+    AttributeTrail trail;
+    CEL_RETURN_IF_ERROR(operand_->Evaluate(frame, arg, trail));
+    return operation_.Apply(frame, arg, trail, result, attribute);
+  }
+
+ private:
+  std::unique_ptr<DirectExpressionStep> operand_;
+  SelectOperation operation_;
+};
+
+}  // namespace
+
+// SelectStep performs message field access specified by Expr::Select
+// message.
+class SelectStep : public ExpressionStepBase {
+ public:
+  SelectStep(StringValue value, bool test_field_presence, int64_t expr_id,
+             bool enable_wrapper_type_null_unboxing)
+      : ExpressionStepBase(expr_id),
+        operation_(std::move(value), test_field_presence,
+                   enable_wrapper_type_null_unboxing) {}
+
+  absl::Status Evaluate(ExecutionFrame* frame) const override;
+
+  Instruction GetInstruction() const override {
+    return operation_.GetInstruction(ExpressionStepBase::GetInstruction());
+  }
+
+ private:
+  SelectOperation operation_;
+};
+
+absl::Status SelectStep::Evaluate(ExecutionFrame* frame) const {
+  if (!frame->value_stack().HasEnough(1)) {
+    return absl::Status(absl::StatusCode::kInternal,
+                        "No arguments supplied for Select-type expression");
+  }
+
+  const Value& arg = frame->value_stack().Peek();
+  const AttributeTrail& trail = frame->value_stack().PeekAttribute();
+
+  if (arg->Is<UnknownValue>() || arg->Is<ErrorValue>()) {
+    // Bubble up unknowns and errors.
+    return absl::OkStatus();
+  }
+
+  Value result;
+  AttributeTrail result_trail;
+  CEL_RETURN_IF_ERROR(
+      operation_.Apply(*frame, arg, trail, result, result_trail));
+  frame->value_stack().PopAndPush(std::move(result), std::move(result_trail));
+  return absl::OkStatus();
+}
+
 // Factory method for Select - based Execution step
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateSelectStep(
     const cel::ast_internal::Select& select_expr, int64_t expr_id,
@@ -222,4 +298,14 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateSelectStep(
       select_expr.test_only(), expr_id, enable_wrapper_type_null_unboxing);
 }
 
+std::unique_ptr<DirectExpressionStep> CreateDirectSelectStep(
+    std::unique_ptr<DirectExpressionStep> operand,
+    const cel::ast_internal::Select& select_expr, int64_t expr_id,
+    bool enable_wrapper_type_null_unboxing, cel::ValueManager& value_factory) {
+  return std::make_unique<DirectSelectStep>(
+      std::move(operand),
+      value_factory.CreateUncheckedStringValue(select_expr.field()),
+      select_expr.test_only(), expr_id, enable_wrapper_type_null_unboxing);
+}
+
 }  // namespace google::api::expr::runtime
@@ -8,6 +8,7 @@
 #include "absl/strings/string_view.h"
 #include "base/ast_internal/expr.h"
 #include "common/value_manager.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 
 namespace google::api::expr::runtime {
@@ -17,6 +18,12 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateSelectStep(
     const cel::ast_internal::Select& select_expr, int64_t expr_id,
     bool enable_wrapper_type_null_unboxing, cel::ValueManager& value_factory);
 
+// Factory method for a directly evaluated Select.
+std::unique_ptr<DirectExpressionStep> CreateDirectSelectStep(
+    std::unique_ptr<DirectExpressionStep> operand,
+    const cel::ast_internal::Select& select_expr, int64_t expr_id,
+    bool enable_wrapper_type_null_unboxing, cel::ValueManager& value_factory);
+
 }  // namespace google::api::expr::runtime
 
 #endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_SELECT_STEP_H_
@@ -1,6 +1,7 @@
 #include "eval/eval/select_step.h"
 
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -51,6 +52,7 @@ using testutil::EqualsProto;
 struct RunExpressionOptions {
   bool enable_unknowns = false;
   bool enable_wrapper_type_null_unboxing = false;
+  bool enable_direct_dispatch = false;
 };
 
 // Simple implementation LegacyTypeAccessApis / LegacyTypeInfoApis that allows
@@ -113,6 +115,7 @@ class SelectStepTest : public testing::Test {
       runtime_options.unknown_processing =
           cel::UnknownProcessingOptions::kAttributeOnly;
     }
+    runtime_options.enable_direct_dispatch = options.enable_direct_dispatch;
     CelExpressionFlatImpl cel_expr(
         FlatExpression(std::move(path), /*comprehension_slot_count=*/0,
                        TypeProvider::Builtin(), runtime_options));
@@ -162,12 +165,15 @@ class SelectStepTest : public testing::Test {
   cel::common_internal::LegacyValueManager value_factory_;
 };
 
-class SelectStepConformanceTest : public SelectStepTest,
-                                  public testing::WithParamInterface<bool> {};
+// Parameterized on whether unknowns and direct dispatch are enabled.
+class SelectStepConformanceTest
+    : public SelectStepTest,
+      public testing::WithParamInterface<std::tuple<bool, bool>> {};
 
 TEST_P(SelectStepConformanceTest, SelectMessageIsNull) {
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(static_cast<const TestMessage*>(nullptr),
@@ -178,7 +184,8 @@ TEST_P(SelectStepConformanceTest, SelectMessageIsNull) {
 
 TEST_P(SelectStepConformanceTest, SelectTargetNotStructOrMap) {
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -195,7 +202,8 @@ TEST_P(SelectStepConformanceTest, SelectTargetNotStructOrMap) {
 TEST_P(SelectStepConformanceTest, PresenseIsFalseTest) {
   TestMessage message;
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "bool_value", true, options));
@@ -206,7 +214,8 @@ TEST_P(SelectStepConformanceTest, PresenseIsFalseTest) {
 
 TEST_P(SelectStepConformanceTest, PresenseIsTrueTest) {
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   TestMessage message;
   message.set_bool_value(true);
 
@@ -221,7 +230,8 @@ TEST_P(SelectStepConformanceTest, ExtensionsPresenceIsTrueTest) {
   TestExtensions* nested = exts.MutableExtension(nested_ext);
   nested->set_name("nested");
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -235,7 +245,8 @@ TEST_P(SelectStepConformanceTest, ExtensionsPresenceIsTrueTest) {
 TEST_P(SelectStepConformanceTest, ExtensionsPresenceIsFalseTest) {
   TestExtensions exts;
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -248,7 +259,8 @@ TEST_P(SelectStepConformanceTest, ExtensionsPresenceIsFalseTest) {
 
 TEST_P(SelectStepConformanceTest, MapPresenseIsFalseTest) {
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   std::string key1 = "key1";
   std::vector<std::pair<CelValue, CelValue>> key_values{
       {CelValue::CreateString(&key1), CelValue::CreateInt64(1)}};
@@ -265,7 +277,8 @@ TEST_P(SelectStepConformanceTest, MapPresenseIsFalseTest) {
 
 TEST_P(SelectStepConformanceTest, MapPresenseIsTrueTest) {
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   std::string key1 = "key1";
   std::vector<std::pair<CelValue, CelValue>> key_values{
       {CelValue::CreateString(&key1), CelValue::CreateInt64(1)}};
@@ -345,7 +358,8 @@ TEST_P(SelectStepConformanceTest, FieldIsNotPresentInProtoTest) {
   TestMessage message;
 
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "fake_field", false, options));
   ASSERT_TRUE(result.IsError());
@@ -355,7 +369,8 @@ TEST_P(SelectStepConformanceTest, FieldIsNotPresentInProtoTest) {
 TEST_P(SelectStepConformanceTest, FieldIsNotSetTest) {
   TestMessage message;
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "bool_value", false, options));
@@ -368,7 +383,8 @@ TEST_P(SelectStepConformanceTest, SimpleBoolTest) {
   TestMessage message;
   message.set_bool_value(true);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "bool_value", false, options));
@@ -381,7 +397,8 @@ TEST_P(SelectStepConformanceTest, SimpleInt32Test) {
   TestMessage message;
   message.set_int32_value(1);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "int32_value", false, options));
@@ -394,7 +411,8 @@ TEST_P(SelectStepConformanceTest, SimpleInt64Test) {
   TestMessage message;
   message.set_int64_value(1);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "int64_value", false, options));
@@ -406,7 +424,8 @@ TEST_P(SelectStepConformanceTest, SimpleUInt32Test) {
   TestMessage message;
   message.set_uint32_value(1);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "uint32_value", false, options));
@@ -419,7 +438,8 @@ TEST_P(SelectStepConformanceTest, SimpleUint64Test) {
   TestMessage message;
   message.set_uint64_value(1);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "uint64_value", false, options));
@@ -433,7 +453,8 @@ TEST_P(SelectStepConformanceTest, SimpleStringTest) {
   std::string value = "test";
   message.set_string_value(value);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "string_value", false, options));
@@ -446,7 +467,8 @@ TEST_P(SelectStepConformanceTest, WrapperTypeNullUnboxingEnabledTest) {
   TestMessage message;
   message.mutable_string_wrapper_value()->set_value("test");
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   options.enable_wrapper_type_null_unboxing = true;
 
   ASSERT_OK_AND_ASSIGN(
@@ -464,7 +486,8 @@ TEST_P(SelectStepConformanceTest, WrapperTypeNullUnboxingDisabledTest) {
   TestMessage message;
   message.mutable_string_wrapper_value()->set_value("test");
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   options.enable_wrapper_type_null_unboxing = false;
 
   ASSERT_OK_AND_ASSIGN(
@@ -484,7 +507,8 @@ TEST_P(SelectStepConformanceTest, SimpleBytesTest) {
   std::string value = "test";
   message.set_bytes_value(value);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "bytes_value", false, options));
@@ -499,7 +523,8 @@ TEST_P(SelectStepConformanceTest, SimpleMessageTest) {
   message2->set_int32_value(1);
   message2->set_string_value("test");
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result, RunExpression(&message, "message_value",
                                                       false, options));
@@ -512,7 +537,8 @@ TEST_P(SelectStepConformanceTest, GlobalExtensionsIntTest) {
   TestExtensions exts;
   exts.SetExtension(int32_ext, 42);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&exts, "google.api.expr.runtime.int32_ext",
@@ -527,7 +553,8 @@ TEST_P(SelectStepConformanceTest, GlobalExtensionsMessageTest) {
   TestExtensions* nested = exts.MutableExtension(nested_ext);
   nested->set_name("nested");
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -541,7 +568,8 @@ TEST_P(SelectStepConformanceTest, GlobalExtensionsMessageTest) {
 TEST_P(SelectStepConformanceTest, GlobalExtensionsMessageUnsetTest) {
   TestExtensions exts;
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -558,7 +586,8 @@ TEST_P(SelectStepConformanceTest, GlobalExtensionsWrapperTest) {
       exts.MutableExtension(int32_wrapper_ext);
   wrapper->set_value(42);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -573,7 +602,8 @@ TEST_P(SelectStepConformanceTest, GlobalExtensionsWrapperUnsetTest) {
   TestExtensions exts;
   RunExpressionOptions options;
   options.enable_wrapper_type_null_unboxing = true;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -587,7 +617,8 @@ TEST_P(SelectStepConformanceTest, MessageExtensionsEnumTest) {
   TestExtensions exts;
   exts.SetExtension(TestMessageExtensions::enum_ext, TestExtEnum::TEST_EXT_1);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -604,7 +635,8 @@ TEST_P(SelectStepConformanceTest, MessageExtensionsRepeatedStringTest) {
   exts.AddExtension(TestMessageExtensions::repeated_string_exts, "test1");
   exts.AddExtension(TestMessageExtensions::repeated_string_exts, "test2");
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -621,7 +653,8 @@ TEST_P(SelectStepConformanceTest, MessageExtensionsRepeatedStringTest) {
 TEST_P(SelectStepConformanceTest, MessageExtensionsRepeatedStringUnsetTest) {
   TestExtensions exts;
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -641,7 +674,8 @@ TEST_P(SelectStepConformanceTest, NullMessageAccessor) {
   message2->set_int32_value(1);
   message2->set_string_value("test");
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   CelValue value = CelValue::CreateMessageWrapper(
       CelValue::MessageWrapper(&message, TrivialTypeInfo::GetInstance()));
 
@@ -668,7 +702,8 @@ TEST_P(SelectStepConformanceTest, CustomAccessor) {
   message2->set_int32_value(1);
   message2->set_string_value("test");
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   testing::NiceMock<MockAccessor> accessor;
   CelValue value = CelValue::CreateMessageWrapper(
       CelValue::MessageWrapper(&message, &accessor));
@@ -698,7 +733,8 @@ TEST_P(SelectStepConformanceTest, CustomAccessorErrorHandling) {
   message2->set_int32_value(1);
   message2->set_string_value("test");
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   testing::NiceMock<MockAccessor> accessor;
   CelValue value = CelValue::CreateMessageWrapper(
       CelValue::MessageWrapper(&message, &accessor));
@@ -728,7 +764,8 @@ TEST_P(SelectStepConformanceTest, SimpleEnumTest) {
   TestMessage message;
   message.set_enum_value(TestMessage::TEST_ENUM_1);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "enum_value", false, options));
@@ -742,7 +779,8 @@ TEST_P(SelectStepConformanceTest, SimpleListTest) {
   message.add_int32_list(1);
   message.add_int32_list(2);
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(&message, "int32_list", false, options));
@@ -758,7 +796,8 @@ TEST_P(SelectStepConformanceTest, SimpleMapTest) {
   (*map_field)["test0"] = 1;
   (*map_field)["test1"] = 2;
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(
       CelValue result,
@@ -779,7 +818,8 @@ TEST_P(SelectStepConformanceTest, MapSimpleInt32Test) {
                        absl::Span<std::pair<CelValue, CelValue>>(key_values))
                        .value();
   RunExpressionOptions options;
-  options.enable_unknowns = GetParam();
+  options.enable_unknowns = std::get<0>(GetParam());
+  options.enable_direct_dispatch = std::get<1>(GetParam());
 
   ASSERT_OK_AND_ASSIGN(CelValue result,
                        RunExpression(map_value.get(), "key1", false, options));
@@ -813,9 +853,10 @@ TEST_P(SelectStepConformanceTest, CelErrorAsArgument) {
   CelError error = absl::CancelledError();
 
   cel::RuntimeOptions options;
-  if (GetParam()) {
+  if (std::get<0>(GetParam())) {
     options.unknown_processing = cel::UnknownProcessingOptions::kAttributeOnly;
   }
+  options.enable_direct_dispatch = std::get<1>(GetParam());
   CelExpressionFlatImpl cel_expr(
       FlatExpression(std::move(path), /*comprehension_slot_count=*/0,
                      TypeProvider::Builtin(), options));
@@ -827,6 +868,49 @@ TEST_P(SelectStepConformanceTest, CelErrorAsArgument) {
   EXPECT_THAT(*result.ErrorOrDie(), Eq(error));
 }
 
+TEST_F(SelectStepTest, DirectDispatchLowersFieldSelection) {
+  Expr expr;
+  auto& select = expr.mutable_select_expr();
+  select.set_field("field");
+  Expr& expr0 = select.mutable_operand();
+  expr0.mutable_ident_expr().set_name("target");
+
+  Expr test_only_expr;
+  auto& test_only_select = test_only_expr.mutable_select_expr();
+  test_only_select.set_field("field");
+  test_only_select.set_test_only(true);
+
+  ExecutionPath path;
+  ASSERT_OK_AND_ASSIGN(auto step0,
+                       CreateIdentStep(expr0.ident_expr(), expr0.id()));
+  ASSERT_OK_AND_ASSIGN(
+      auto step1, CreateSelectStep(select, expr.id(),
+                                   /*enable_wrapper_type_null_unboxing=*/true,
+                                   value_factory_));
+  ASSERT_OK_AND_ASSIGN(
+      auto step2, CreateSelectStep(test_only_select, test_only_expr.id(),
+                                   /*enable_wrapper_type_null_unboxing=*/true,
+                                   value_factory_));
+  path.push_back(std::move(step0));
+  path.push_back(std::move(step1));
+  path.push_back(std::move(step2));
+
+  cel::RuntimeOptions options;
+  options.enable_direct_dispatch = true;
+  FlatExpression flat_expression(std::move(path),
+                                 /*comprehension_slot_count=*/0,
+                                 TypeProvider::Builtin(), options);
+
+  ASSERT_THAT(flat_expression.instructions(), testing::SizeIs(3));
+  EXPECT_EQ(flat_expression.instructions()[0].opcode, Opcode::kIdent);
+  EXPECT_EQ(*flat_expression.instructions()[0].name, "target");
+  EXPECT_EQ(flat_expression.instructions()[1].opcode, Opcode::kSelect);
+  EXPECT_EQ(*flat_expression.instructions()[1].name, "field");
+  EXPECT_EQ(flat_expression.instructions()[1].unboxing_option,
+            ProtoWrapperTypeOptions::kUnsetNull);
+  EXPECT_EQ(flat_expression.instructions()[2].opcode, Opcode::kGeneric);
+}
+
 TEST_F(SelectStepTest, DisableMissingAttributeOK) {
   TestMessage message;
   message.set_bool_value(true);
@@ -1022,7 +1106,7 @@ TEST_F(SelectStepTest, UnknownPatternResolvesToUnknown) {
 }
 
 INSTANTIATE_TEST_SUITE_P(UnknownsEnabled, SelectStepConformanceTest,
-                         testing::Bool());
+                         testing::Combine(testing::Bool(), testing::Bool()));
 
 }  // namespace
 
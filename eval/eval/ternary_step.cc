@@ -7,8 +7,12 @@
 #include "absl/status/statusor.h"
 #include "base/builtins.h"
 #include "common/value.h"
+#include "eval/eval/attribute_trail.h"
+#include "eval/eval/direct_expression_step.h"
+#include "eval/eval/evaluator_core.h"
 #include "eval/eval/expression_step_base.h"
 #include "eval/internal/errors.h"
+#include "internal/status_macros.h"
 
 namespace google::api::expr::runtime {
 
@@ -27,6 +31,12 @@ class TernaryStep : public ExpressionStepBase {
   explicit TernaryStep(int64_t expr_id) : ExpressionStepBase(expr_id) {}
 
   absl::Status Evaluate(ExecutionFrame* frame) const override;
+
+  Instruction GetInstruction() const override {
+    Instruction instruction = ExpressionStepBase::GetInstruction();
+    instruction.opcode = Opcode::kTernary;
+    return instruction;
+  }
 };
 
 absl::Status TernaryStep::Evaluate(ExecutionFrame* frame) const {
@@ -70,6 +80,59 @@ absl::Status TernaryStep::Evaluate(ExecutionFrame* frame) const {
   return absl::OkStatus();
 }
 
+// Direct implementation of the ternary operator.
+//
+// Only the selected branch is evaluated unless short-circuiting is disabled.
+class DirectTernaryStep : public DirectExpressionStep {
+ public:
+  DirectTernaryStep(std::unique_ptr<DirectExpressionStep> condition,
+                    std::unique_ptr<DirectExpressionStep> left,
+                    std::unique_ptr<DirectExpressionStep> right,
+                    bool shortcircuiting, int64_t expr_id)
+      : DirectExpressionStep(expr_id),
+        condition_(std::move(condition)),
+        left_(std::move(left)),
+        right_(std::move(right)),
+        shortcircuiting_(shortcircuiting) {}
+
+  absl::Status Evaluate(ExecutionFrame& frame, cel::Value& result,
+                        AttributeTrail& attribute) const override {
+    cel::Value condition;
+    AttributeTrail condition_attr;
+    CEL_RETURN_IF_ERROR(condition_->Evaluate(frame, condition, condition_attr));
+
+    // Errors and unknowns on the condition are forwarded as the result.
+    if (condition->Is<cel::ErrorValue>() ||
+        condition->Is<cel::UnknownValue>()) {
+      result = std::move(condition);
+      attribute = std::move(condition_attr);
+      return absl::OkStatus();
+    }
+
+    if (!condition->Is<cel::BoolValue>()) {
+      result = frame.value_factory().CreateErrorValue(
+          CreateNoMatchingOverloadError(kTernary));
+      return absl::OkStatus();
+    }
+
+    const bool select_left = condition.As<cel::BoolValue>().NativeValue();
+    if (!shortcircuiting_) {
+      // Exhaustive evaluation: the other branch is evaluated and discarded.
+      cel::Value unused;
+      AttributeTrail unused_attr;
+      CEL_RETURN_IF_ERROR((select_left ? right_ : left_)
+                              ->Evaluate(frame, unused, unused_attr));
+    }
+    return (select_left ? left_ : right_)->Evaluate(frame, result, attribute);
+  }
+
+ private:
+  std::unique_ptr<DirectExpressionStep> condition_;
+  std::unique_ptr<DirectExpressionStep> left_;
+  std::unique_ptr<DirectExpressionStep> right_;
+  bool shortcircuiting_;
+};
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateTernaryStep(
@@ -77,4 +140,14 @@ absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateTernaryStep(
   return std::make_unique<TernaryStep>(expr_id);
 }
 
+std::unique_ptr<DirectExpressionStep> CreateDirectTernaryStep(
+    std::unique_ptr<DirectExpressionStep> condition,
+    std::unique_ptr<DirectExpressionStep> left,
+    std::unique_ptr<DirectExpressionStep> right, int64_t expr_id,
+    bool shortcircuiting) {
+  return std::make_unique<DirectTernaryStep>(
+      std::move(condition), std::move(left), std::move(right), shortcircuiting,
+      expr_id);
+}
+
 }  // namespace google::api::expr::runtime
@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include "absl/status/statusor.h"
+#include "eval/eval/direct_expression_step.h"
 #include "eval/eval/evaluator_core.h"
 
 namespace google::api::expr::runtime {
@@ -12,6 +13,13 @@ namespace google::api::expr::runtime {
 absl::StatusOr<std::unique_ptr<ExpressionStep>> CreateTernaryStep(
     int64_t expr_id);
 
+// Factory method for a directly evaluated ternary (_?_:_).
+std::unique_ptr<DirectExpressionStep> CreateDirectTernaryStep(
+    std::unique_ptr<DirectExpressionStep> condition,
+    std::unique_ptr<DirectExpressionStep> left,
+    std::unique_ptr<DirectExpressionStep> right, int64_t expr_id,
+    bool shortcircuiting);
+
 }  // namespace google::api::expr::runtime
 
 #endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_TERNARY_STEP_H_
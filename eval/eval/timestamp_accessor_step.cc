@@ -0,0 +1,91 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/eval/timestamp_accessor_step.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/optimization.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "common/value.h"
+#include "eval/eval/evaluator_core.h"
+#include "eval/eval/expression_step_base.h"
+#include "runtime/internal/time_zone_cache.h"
+#include "runtime/internal/timestamp_accessors.h"
+
+namespace google::api::expr::runtime {
+
+namespace {
+
+using ::cel::IntValue;
+using ::cel::StringValue;
+using ::cel::TimestampValue;
+using ::cel::Value;
+using ::cel::runtime_internal::ResolvedTimeZone;
+using ::cel::runtime_internal::TimestampAccessor;
+
+class TimestampAccessorStep final : public ExpressionStepBase {
+ public:
+  TimestampAccessorStep(TimestampAccessor accessor, std::string time_zone_name,
+                        ResolvedTimeZone time_zone,
+                        std::unique_ptr<const ExpressionStep> fallback,
+                        int64_t expr_id)
+      : ExpressionStepBase(expr_id),
+        accessor_(accessor),
+        time_zone_name_(std::move(time_zone_name)),
+        time_zone_(std::move(time_zone)),
+        fallback_(std::move(fallback)) {}
+
+  absl::Status Evaluate(ExecutionFrame* frame) const override {
+    if (ABSL_PREDICT_FALSE(!frame->value_stack().HasEnough(2) ||
+                           frame->enable_unknowns())) {
+      return fallback_->Evaluate(frame);
+    }
+    absl::Span<const Value> args = frame->value_stack().GetSpan(2);
+    // The time zone operand is expected to be the constant the step was
+    // created for, but anything else on the stack is still handled correctly.
+    if (ABSL_PREDICT_FALSE(
+            !args[0]->Is<TimestampValue>() || !args[1]->Is<StringValue>() ||
+            !args[1].As<StringValue>().Equals(time_zone_name_))) {
+      return fallback_->Evaluate(frame);
+    }
+    IntValue result(accessor_(
+        time_zone_.At(args[0].As<TimestampValue>().NativeValue())));
+    frame->value_stack().PopAndPush(2, std::move(result));
+    return absl::OkStatus();
+  }
+
+ private:
+  const TimestampAccessor accessor_;
+  const std::string time_zone_name_;
+  const ResolvedTimeZone time_zone_;
+  std::unique_ptr<const ExpressionStep> fallback_;
+};
+
+}  // namespace
+
+std::unique_ptr<ExpressionStep> CreateTimestampAccessorStep(
+    TimestampAccessor accessor, std::string time_zone_name,
+    ResolvedTimeZone time_zone, std::unique_ptr<const ExpressionStep> fallback,
+    int64_t expr_id) {
+  return std::make_unique<TimestampAccessorStep>(
+      accessor, std::move(time_zone_name), std::move(time_zone),
+      std::move(fallback), expr_id);
+}
+
+}  // namespace google::api::expr::runtime
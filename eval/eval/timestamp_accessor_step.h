@@ -0,0 +1,44 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_EVAL_TIMESTAMP_ACCESSOR_STEP_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_EVAL_TIMESTAMP_ACCESSOR_STEP_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "eval/eval/evaluator_core.h"
+#include "runtime/internal/time_zone_cache.h"
+#include "runtime/internal/timestamp_accessors.h"
+
+namespace google::api::expr::runtime {
+
+// Creates a step for a timestamp accessor call with a constant time zone
+// argument, e.g. `ts.getHours('America/New_York')`, using the time zone
+// resolved at plan time from time_zone_name.
+//
+// The step consumes the same arguments as the original call (the timestamp
+// and the time zone string). Arguments of any other kind (e.g. errors or
+// unknowns), or a time zone string other than time_zone_name, are handled by
+// fallback, the generic function step for the call.
+std::unique_ptr<ExpressionStep> CreateTimestampAccessorStep(
+    cel::runtime_internal::TimestampAccessor accessor,
+    std::string time_zone_name,
+    cel::runtime_internal::ResolvedTimeZone time_zone,
+    std::unique_ptr<const ExpressionStep> fallback, int64_t expr_id);
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_TIMESTAMP_ACCESSOR_STEP_H_
@@ -0,0 +1,281 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/eval/typed_operator_step.h"
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/base/optimization.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "eval/eval/evaluator_core.h"
+#include "eval/eval/expression_step_base.h"
+#include "internal/overflow.h"
+
+namespace google::api::expr::runtime {
+
+namespace {
+
+using ::cel::BoolValue;
+using ::cel::DoubleValue;
+using ::cel::IntValue;
+using ::cel::UintValue;
+using ::cel::Value;
+using ::cel::ValueManager;
+
+// Value type holding operands of the given native type.
+template <typename T>
+struct OperandTraits;
+
+template <>
+struct OperandTraits<int64_t> {
+  using ValueType = IntValue;
+};
+
+template <>
+struct OperandTraits<uint64_t> {
+  using ValueType = UintValue;
+};
+
+template <>
+struct OperandTraits<double> {
+  using ValueType = DoubleValue;
+};
+
+Value CheckedResult(ValueManager& value_factory,
+                    absl::StatusOr<int64_t> result) {
+  if (!result.ok()) {
+    return value_factory.CreateErrorValue(std::move(result).status());
+  }
+  return IntValue(*result);
+}
+
+Value CheckedResult(ValueManager& value_factory,
+                    absl::StatusOr<uint64_t> result) {
+  if (!result.ok()) {
+    return value_factory.CreateErrorValue(std::move(result).status());
+  }
+  return UintValue(*result);
+}
+
+// Operators, matching runtime/standard/arithmetic_functions.cc and
+// runtime/standard/comparison_functions.cc.
+struct AddOp {
+  template <typename T>
+  Value operator()(ValueManager& value_factory, T lhs, T rhs) const {
+    if constexpr (std::is_same_v<T, double>) {
+      return DoubleValue(lhs + rhs);
+    } else {
+      return CheckedResult(value_factory, cel::internal::CheckedAdd(lhs, rhs));
+    }
+  }
+};
+
+struct SubOp {
+  template <typename T>
+  Value operator()(ValueManager& value_factory, T lhs, T rhs) const {
+    if constexpr (std::is_same_v<T, double>) {
+      return DoubleValue(lhs - rhs);
+    } else {
+      return CheckedResult(value_factory, cel::internal::CheckedSub(lhs, rhs));
+    }
+  }
+};
+
+struct MulOp {
+  template <typename T>
+  Value operator()(ValueManager& value_factory, T lhs, T rhs) const {
+    if constexpr (std::is_same_v<T, double>) {
+      return DoubleValue(lhs * rhs);
+    } else {
+      return CheckedResult(value_factory, cel::internal::CheckedMul(lhs, rhs));
+    }
+  }
+};
+
+struct DivOp {
+  template <typename T>
+  Value operator()(ValueManager& value_factory, T lhs, T rhs) const {
+    if constexpr (std::is_same_v<T, double>) {
+      // Division by zero results in +/- inf.
+      return DoubleValue(lhs / rhs);
+    } else {
+      return CheckedResult(value_factory, cel::internal::CheckedDiv(lhs, rhs));
+    }
+  }
+};
+
+struct ModOp {
+  template <typename T>
+  Value operator()(ValueManager& value_factory, T lhs, T rhs) const {
+    return CheckedResult(value_factory, cel::internal::CheckedMod(lhs, rhs));
+  }
+};
+
+struct LessOp {
+  template <typename T>
+  Value operator()(ValueManager&, T lhs, T rhs) const {
+    return BoolValue(lhs < rhs);
+  }
+};
+
+struct LessEqualsOp {
+  template <typename T>
+  Value operator()(ValueManager&, T lhs, T rhs) const {
+    return BoolValue(lhs <= rhs);
+  }
+};
+
+struct GreaterOp {
+  template <typename T>
+  Value operator()(ValueManager&, T lhs, T rhs) const {
+    return BoolValue(lhs > rhs);
+  }
+};
+
+struct GreaterEqualsOp {
+  template <typename T>
+  Value operator()(ValueManager&, T lhs, T rhs) const {
+    return BoolValue(lhs >= rhs);
+  }
+};
+
+// Binary operator on two operands of type T.
+template <typename T, typename Op>
+class TypedBinaryOperatorStep final : public ExpressionStepBase {
+ public:
+  using ValueType = typename OperandTraits<T>::ValueType;
+
+  TypedBinaryOperatorStep(std::unique_ptr<const ExpressionStep> fallback,
+                          int64_t expr_id)
+      : ExpressionStepBase(expr_id), fallback_(std::move(fallback)) {}
+
+  absl::Status Evaluate(ExecutionFrame* frame) const override {
+    // With unknowns enabled, operands may be partially unknown through their
+    // attributes; leave that to the generic step.
+    if (ABSL_PREDICT_FALSE(!frame->value_stack().HasEnough(2) ||
+                           frame->enable_unknowns())) {
+      return fallback_->Evaluate(frame);
+    }
+    absl::Span<const Value> args = frame->value_stack().GetSpan(2);
+    if (ABSL_PREDICT_FALSE(!args[0]->Is<ValueType>() ||
+                           !args[1]->Is<ValueType>())) {
+      return fallback_->Evaluate(frame);
+    }
+    Value result = Op()(frame->value_factory(),
+                        args[0].As<ValueType>().NativeValue(),
+                        args[1].As<ValueType>().NativeValue());
+    frame->value_stack().PopAndPush(2, std::move(result));
+    return absl::OkStatus();
+  }
+
+ private:
+  std::unique_ptr<const ExpressionStep> fallback_;
+};
+
+using AddIntIntStep = TypedBinaryOperatorStep<int64_t, AddOp>;
+using AddUintUintStep = TypedBinaryOperatorStep<uint64_t, AddOp>;
+using AddDoubleDoubleStep = TypedBinaryOperatorStep<double, AddOp>;
+using SubIntIntStep = TypedBinaryOperatorStep<int64_t, SubOp>;
+using SubUintUintStep = TypedBinaryOperatorStep<uint64_t, SubOp>;
+using SubDoubleDoubleStep = TypedBinaryOperatorStep<double, SubOp>;
+using MulIntIntStep = TypedBinaryOperatorStep<int64_t, MulOp>;
+using MulUintUintStep = TypedBinaryOperatorStep<uint64_t, MulOp>;
+using MulDoubleDoubleStep = TypedBinaryOperatorStep<double, MulOp>;
+using DivIntIntStep = TypedBinaryOperatorStep<int64_t, DivOp>;
+using DivUintUintStep = TypedBinaryOperatorStep<uint64_t, DivOp>;
+using DivDoubleDoubleStep = TypedBinaryOperatorStep<double, DivOp>;
+using ModIntIntStep = TypedBinaryOperatorStep<int64_t, ModOp>;
+using ModUintUintStep = TypedBinaryOperatorStep<uint64_t, ModOp>;
+using LessIntIntStep = TypedBinaryOperatorStep<int64_t, LessOp>;
+using LessUintUintStep = TypedBinaryOperatorStep<uint64_t, LessOp>;
+using LessDoubleDoubleStep = TypedBinaryOperatorStep<double, LessOp>;
+using LessEqualsIntIntStep = TypedBinaryOperatorStep<int64_t, LessEqualsOp>;
+using LessEqualsUintUintStep = TypedBinaryOperatorStep<uint64_t, LessEqualsOp>;
+using LessEqualsDoubleDoubleStep =
+    TypedBinaryOperatorStep<double, LessEqualsOp>;
+using GreaterIntIntStep = TypedBinaryOperatorStep<int64_t, GreaterOp>;
+using GreaterUintUintStep = TypedBinaryOperatorStep<uint64_t, GreaterOp>;
+using GreaterDoubleDoubleStep = TypedBinaryOperatorStep<double, GreaterOp>;
+using GreaterEqualsIntIntStep =
+    TypedBinaryOperatorStep<int64_t, GreaterEqualsOp>;
+using GreaterEqualsUintUintStep =
+    TypedBinaryOperatorStep<uint64_t, GreaterEqualsOp>;
+using GreaterEqualsDoubleDoubleStep =
+    TypedBinaryOperatorStep<double, GreaterEqualsOp>;
+
+template <typename StepT>
+std::unique_ptr<ExpressionStep> CreateStep(
+    std::unique_ptr<const ExpressionStep> fallback, int64_t expr_id) {
+  return std::make_unique<StepT>(std::move(fallback), expr_id);
+}
+
+using FactoryMap =
+    absl::flat_hash_map<absl::string_view, TypedOperatorStepFactory>;
+
+const FactoryMap& GetFactories() {
+  // Overload ids as declared by the type checker's standard environment.
+  static const absl::NoDestructor<FactoryMap> kFactories(FactoryMap{
+      {"add_int64", &CreateStep<AddIntIntStep>},
+      {"add_uint64", &CreateStep<AddUintUintStep>},
+      {"add_double", &CreateStep<AddDoubleDoubleStep>},
+      {"subtract_int64", &CreateStep<SubIntIntStep>},
+      {"subtract_uint64", &CreateStep<SubUintUintStep>},
+      {"subtract_double", &CreateStep<SubDoubleDoubleStep>},
+      {"multiply_int64", &CreateStep<MulIntIntStep>},
+      {"multiply_uint64", &CreateStep<MulUintUintStep>},
+      {"multiply_double", &CreateStep<MulDoubleDoubleStep>},
+      {"divide_int64", &CreateStep<DivIntIntStep>},
+      {"divide_uint64", &CreateStep<DivUintUintStep>},
+      {"divide_double", &CreateStep<DivDoubleDoubleStep>},
+      {"modulo_int64", &CreateStep<ModIntIntStep>},
+      {"modulo_uint64", &CreateStep<ModUintUintStep>},
+      {"less_int64", &CreateStep<LessIntIntStep>},
+      {"less_uint64", &CreateStep<LessUintUintStep>},
+      {"less_double", &CreateStep<LessDoubleDoubleStep>},
+      {"less_equals_int64", &CreateStep<LessEqualsIntIntStep>},
+      {"less_equals_uint64", &CreateStep<LessEqualsUintUintStep>},
+      {"less_equals_double", &CreateStep<LessEqualsDoubleDoubleStep>},
+      {"greater_int64", &CreateStep<GreaterIntIntStep>},
+      {"greater_uint64", &CreateStep<GreaterUintUintStep>},
+      {"greater_double", &CreateStep<GreaterDoubleDoubleStep>},
+      {"greater_equals_int64", &CreateStep<GreaterEqualsIntIntStep>},
+      {"greater_equals_uint64", &CreateStep<GreaterEqualsUintUintStep>},
+      {"greater_equals_double", &CreateStep<GreaterEqualsDoubleDoubleStep>},
+  });
+  return *kFactories;
+}
+
+}  // namespace
+
+TypedOperatorStepFactory FindTypedOperatorStepFactory(
+    absl::string_view overload_id) {
+  const FactoryMap& factories = GetFactories();
+  auto it = factories.find(overload_id);
+  if (it == factories.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+}  // namespace google::api::expr::runtime
@@ -0,0 +1,44 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_EVAL_TYPED_OPERATOR_STEP_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_EVAL_TYPED_OPERATOR_STEP_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "eval/eval/evaluator_core.h"
+
+namespace google::api::expr::runtime {
+
+// Factory for a step applying a builtin arithmetic or comparison operator to
+// operands of a statically known type.
+//
+// The step reads both operands from the value stack and computes the result
+// inline, skipping overload resolution. Results (including overflow and
+// division by zero errors) match the standard function implementations.
+// Operands of any other kind (e.g. errors or unknowns) are handled by
+// fallback, the generic function step for the call.
+using TypedOperatorStepFactory = std::unique_ptr<ExpressionStep> (*)(
+    std::unique_ptr<const ExpressionStep> fallback, int64_t expr_id);
+
+// Returns the step factory for a checked overload id (e.g. "add_int64" or
+// "less_double"), or nullptr if there is no specialized step for it.
+TypedOperatorStepFactory FindTypedOperatorStepFactory(
+    absl::string_view overload_id);
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_TYPED_OPERATOR_STEP_H_
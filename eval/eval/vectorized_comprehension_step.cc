@@ -0,0 +1,392 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/eval/vectorized_comprehension_step.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/base/config.h"
+#include "absl/base/nullability.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "absl/types/variant.h"
+#include "common/value.h"
+#include "eval/eval/evaluator_core.h"
+#include "eval/eval/jump_step.h"
+#include "internal/overflow.h"
+#include "internal/status_macros.h"
+#include "runtime/primitive_list_value.h"
+
+namespace google::api::expr::runtime {
+
+namespace {
+
+using ::cel::BoolValue;
+using ::cel::DoubleValue;
+using ::cel::IntValue;
+using ::cel::ListValue;
+using ::cel::PrimitiveListValue;
+using ::cel::UintValue;
+using ::cel::Value;
+
+// Value type holding elements of the given native type.
+template <typename T>
+struct ElementTraits;
+
+template <>
+struct ElementTraits<int64_t> {
+  using ValueType = IntValue;
+};
+
+template <>
+struct ElementTraits<uint64_t> {
+  using ValueType = UintValue;
+};
+
+template <>
+struct ElementTraits<double> {
+  using ValueType = DoubleValue;
+};
+
+// Checked arithmetic following the standard functions: returns false if the
+// result is an error (overflow or integer division by zero).
+
+template <typename T>
+bool Add(T x, T y, T& out) {
+#if ABSL_HAVE_BUILTIN(__builtin_add_overflow)
+  return !__builtin_add_overflow(x, y, &out);
+#else
+  auto result = cel::internal::CheckedAdd(x, y);
+  out = result.value_or(T{});
+  return result.ok();
+#endif
+}
+
+template <typename T>
+bool Sub(T x, T y, T& out) {
+#if ABSL_HAVE_BUILTIN(__builtin_sub_overflow)
+  return !__builtin_sub_overflow(x, y, &out);
+#else
+  auto result = cel::internal::CheckedSub(x, y);
+  out = result.value_or(T{});
+  return result.ok();
+#endif
+}
+
+template <typename T>
+bool Mul(T x, T y, T& out) {
+#if ABSL_HAVE_BUILTIN(__builtin_mul_overflow)
+  return !__builtin_mul_overflow(x, y, &out);
+#else
+  auto result = cel::internal::CheckedMul(x, y);
+  out = result.value_or(T{});
+  return result.ok();
+#endif
+}
+
+template <typename T>
+bool Div(T x, T y, T& out) {
+  out = T{};
+  if (y == 0) {
+    return false;
+  }
+  if constexpr (std::is_signed_v<T>) {
+    if (y == -1 && x == std::numeric_limits<T>::lowest()) {
+      return false;
+    }
+  }
+  out = x / y;
+  return true;
+}
+
+bool Add(double x, double y, double& out) {
+  out = x + y;
+  return true;
+}
+
+bool Sub(double x, double y, double& out) {
+  out = x - y;
+  return true;
+}
+
+bool Mul(double x, double y, double& out) {
+  out = x * y;
+  return true;
+}
+
+bool Div(double x, double y, double& out) {
+  out = x / y;
+  return true;
+}
+
+// Kernels. Inner loops avoid data dependent branches so that the compiler can
+// vectorize them.
+
+// Returns the index of the first element matching `pred`, or the size of
+// `elements` if there is none.
+template <typename T, typename Pred>
+size_t FindFirst(absl::Span<const T> elements, Pred pred) {
+  constexpr size_t kBlockSize = 64;
+  size_t i = 0;
+  for (; i + kBlockSize <= elements.size(); i += kBlockSize) {
+    bool found = false;
+    for (size_t j = i; j < i + kBlockSize; ++j) {
+      found |= pred(elements[j]);
+    }
+    if (found) {
+      break;
+    }
+  }
+  for (; i < elements.size(); ++i) {
+    if (pred(elements[i])) {
+      return i;
+    }
+  }
+  return elements.size();
+}
+
+template <typename T, typename Pred>
+size_t CountMatches(absl::Span<const T> elements, Pred pred) {
+  size_t count = 0;
+  for (T element : elements) {
+    count += pred(element) ? 1 : 0;
+  }
+  return count;
+}
+
+template <typename T, typename Pred>
+std::vector<T> Filter(absl::Span<const T> elements, Pred pred) {
+  std::vector<T> out(elements.size());
+  size_t size = 0;
+  for (T element : elements) {
+    out[size] = element;
+    size += pred(element) ? 1 : 0;
+  }
+  out.resize(size);
+  return out;
+}
+
+// Returns false if `fn` fails for any of the elements.
+template <typename T, typename Fn>
+bool Transform(absl::Span<const T> elements, Fn fn, std::vector<T>& out) {
+  out.resize(elements.size());
+  bool ok = true;
+  for (size_t i = 0; i < elements.size(); ++i) {
+    ok &= fn(elements[i], out[i]);
+  }
+  return ok;
+}
+
+// Calls `kernel` with the predicate `elem <op> operand`.
+template <typename T, typename Kernel>
+auto WithPredicate(VectorizedOperator op, T operand, Kernel kernel) {
+  switch (op) {
+    case VectorizedOperator::kLess:
+      return kernel([operand](T element) { return element < operand; });
+    case VectorizedOperator::kLessOrEqual:
+      return kernel([operand](T element) { return element <= operand; });
+    case VectorizedOperator::kGreater:
+      return kernel([operand](T element) { return element > operand; });
+    case VectorizedOperator::kGreaterOrEqual:
+      return kernel([operand](T element) { return element >= operand; });
+    case VectorizedOperator::kEqual:
+      return kernel([operand](T element) { return element == operand; });
+    default:
+      return kernel([operand](T element) { return element != operand; });
+  }
+}
+
+// Calls `kernel` with the negation of the predicate `elem <op> operand`.
+template <typename T, typename Kernel>
+auto WithNegatedPredicate(VectorizedOperator op, T operand, Kernel kernel) {
+  return WithPredicate(op, operand, [&kernel](auto pred) {
+    return kernel([pred](T element) { return !pred(element); });
+  });
+}
+
+// Calls `kernel` with the checked transform of the lambda.
+template <typename T, typename Kernel>
+auto WithTransform(VectorizedLambda lambda, T operand, Kernel kernel) {
+  switch (lambda.op) {
+    case VectorizedOperator::kAdd:
+      return kernel(
+          [operand](T element, T& out) { return Add(element, operand, out); });
+    case VectorizedOperator::kSubtract:
+      if (lambda.element_on_right) {
+        return kernel([operand](T element, T& out) {
+          return Sub(operand, element, out);
+        });
+      }
+      return kernel(
+          [operand](T element, T& out) { return Sub(element, operand, out); });
+    case VectorizedOperator::kMultiply:
+      return kernel(
+          [operand](T element, T& out) { return Mul(element, operand, out); });
+    default:
+      if (lambda.element_on_right) {
+        return kernel([operand](T element, T& out) {
+          return Div(operand, element, out);
+        });
+      }
+      return kernel(
+          [operand](T element, T& out) { return Div(element, operand, out); });
+  }
+}
+
+class VectorizedComprehensionStep : public JumpStepBase {
+ public:
+  VectorizedComprehensionStep(VectorizedMacro macro, VectorizedLambda lambda,
+                              absl::Nonnull<const ExpressionStep*> operand,
+                              bool short_circuiting, int fallback_size,
+                              int64_t expr_id)
+      : JumpStepBase(fallback_size, expr_id),
+        macro_(macro),
+        lambda_(lambda),
+        operand_(operand),
+        short_circuiting_(short_circuiting) {}
+
+  absl::Status Evaluate(ExecutionFrame* frame) const override;
+
+ private:
+  // Returns the result of the comprehension, or nullopt to fall back to the
+  // regular steps.
+  template <typename T>
+  absl::StatusOr<absl::optional<Value>> Compute(ExecutionFrame* frame,
+                                                absl::Span<const T> elements,
+                                                T operand) const;
+
+  VectorizedMacro macro_;
+  VectorizedLambda lambda_;
+  absl::Nonnull<const ExpressionStep*> operand_;
+  bool short_circuiting_;
+};
+
+absl::Status VectorizedComprehensionStep::Evaluate(
+    ExecutionFrame* frame) const {
+  if (!frame->value_stack().HasEnough(1)) {
+    return absl::Status(absl::StatusCode::kInternal, "Value stack underflow");
+  }
+  // Listeners observe the steps of each iteration.
+  if (frame->has_listener() ||
+      !frame->value_stack().Peek()->Is<ListValue>()) {
+    return absl::OkStatus();
+  }
+  ListValue range = frame->value_stack().Peek().As<ListValue>();
+  const PrimitiveListValue* list = PrimitiveListValue::From(range);
+  if (list == nullptr) {
+    return absl::OkStatus();
+  }
+
+  CEL_RETURN_IF_ERROR(operand_->Evaluate(frame));
+  Value operand = std::move(frame->value_stack().Peek());
+  frame->value_stack().Pop(1);
+
+  CEL_ASSIGN_OR_RETURN(
+      absl::optional<Value> result,
+      absl::visit(
+          [&](const auto& elements) -> absl::StatusOr<absl::optional<Value>> {
+            using T = typename std::decay_t<decltype(elements)>::value_type;
+            using ValueType = typename ElementTraits<T>::ValueType;
+            if (!operand->Is<ValueType>()) {
+              return absl::nullopt;
+            }
+            return Compute<T>(frame, elements,
+                              operand.As<ValueType>().NativeValue());
+          },
+          list->elements()));
+  if (!result.has_value()) {
+    return absl::OkStatus();
+  }
+  frame->value_stack().PopAndPush(*std::move(result));
+  return Jump(frame);
+}
+
+template <typename T>
+absl::StatusOr<absl::optional<Value>> VectorizedComprehensionStep::Compute(
+    ExecutionFrame* frame, absl::Span<const T> elements, T operand) const {
+  // The regular steps run the loop body once per element and consume one more
+  // iteration to detect the end of the range.
+  size_t iterations = elements.size() + 1;
+  Value result;
+  switch (macro_) {
+    case VectorizedMacro::kAll:
+    case VectorizedMacro::kExists: {
+      // all() stops at the first element not matching the predicate,
+      // exists() at the first matching one.
+      auto find_first = [elements](auto pred) {
+        return FindFirst(elements, pred);
+      };
+      size_t stop = macro_ == VectorizedMacro::kAll
+                        ? WithNegatedPredicate(lambda_.op, operand, find_first)
+                        : WithPredicate(lambda_.op, operand, find_first);
+      bool stopped = stop < elements.size();
+      if (stopped && short_circuiting_) {
+        // Iterations up to the deciding element plus one to observe the
+        // loop condition.
+        iterations = stop + 2;
+      }
+      result = BoolValue(macro_ == VectorizedMacro::kAll ? !stopped : stopped);
+      break;
+    }
+    case VectorizedMacro::kExistsOne: {
+      size_t count =
+          WithPredicate(lambda_.op, operand, [elements](auto pred) {
+            return CountMatches(elements, pred);
+          });
+      result = BoolValue(count == 1);
+      break;
+    }
+    case VectorizedMacro::kFilter:
+      result = cel::NewPrimitiveListValue(
+          frame->memory_manager(),
+          WithPredicate(lambda_.op, operand, [elements](auto pred) {
+            return Filter(elements, pred);
+          }));
+      break;
+    case VectorizedMacro::kMap: {
+      std::vector<T> out;
+      if (!WithTransform(lambda_, operand, [elements, &out](auto fn) {
+            return Transform(elements, fn, out);
+          })) {
+        // Let the regular steps report the error.
+        return absl::nullopt;
+      }
+      result = cel::NewPrimitiveListValue(frame->memory_manager(),
+                                          std::move(out));
+      break;
+    }
+  }
+  CEL_RETURN_IF_ERROR(frame->IncrementIterations(iterations));
+  return result;
+}
+
+}  // namespace
+
+std::unique_ptr<ExpressionStep> CreateVectorizedComprehensionStep(
+    VectorizedMacro macro, VectorizedLambda lambda,
+    absl::Nonnull<const ExpressionStep*> operand, bool short_circuiting,
+    int fallback_size, int64_t expr_id) {
+  return std::make_unique<VectorizedComprehensionStep>(
+      macro, lambda, operand, short_circuiting, fallback_size, expr_id);
+}
+
+}  // namespace google::api::expr::runtime
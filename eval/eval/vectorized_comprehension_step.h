@@ -0,0 +1,72 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_EVAL_VECTORIZED_COMPREHENSION_STEP_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_EVAL_VECTORIZED_COMPREHENSION_STEP_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/base/nullability.h"
+#include "eval/eval/evaluator_core.h"
+
+namespace google::api::expr::runtime {
+
+// Comprehension macros evaluated by vectorized comprehension steps.
+enum class VectorizedMacro { kAll, kExists, kExistsOne, kFilter, kMap };
+
+// Operators applied by a vectorized comprehension to each element and the
+// loop invariant operand: comparisons for the predicate of `all`, `exists`,
+// `exists_one` and `filter`, arithmetic for the transform of `map`.
+enum class VectorizedOperator {
+  kLess,
+  kLessOrEqual,
+  kGreater,
+  kGreaterOrEqual,
+  kEqual,
+  kInequal,
+  kAdd,
+  kSubtract,
+  kMultiply,
+  kDivide,
+};
+
+// The lambda of a vectorized comprehension, `elem <op> operand` or, if
+// `element_on_right`, `operand <op> elem`.
+struct VectorizedLambda {
+  VectorizedOperator op;
+  bool element_on_right = false;
+};
+
+// Factory method for a step evaluating a comprehension over a primitive list
+// (cel::PrimitiveListValue) with a data parallel kernel.
+//
+// Expects the iteration range on top of the stack, followed in the plan by the
+// regular steps of the comprehension (`fallback_size` steps). If the range is
+// a primitive list and `operand` evaluates to a number of the same kind, the
+// range is replaced with the result of the comprehension and the regular
+// steps are skipped. Otherwise the stack is left unchanged and evaluation
+// continues with the regular steps, e.g. for other lists or for results that
+// would be errors.
+//
+// `operand` must push the loop invariant operand of the lambda. It is owned by
+// the regular steps of the comprehension.
+std::unique_ptr<ExpressionStep> CreateVectorizedComprehensionStep(
+    VectorizedMacro macro, VectorizedLambda lambda,
+    absl::Nonnull<const ExpressionStep*> operand, bool short_circuiting,
+    int fallback_size, int64_t expr_id);
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_EVAL_VECTORIZED_COMPREHENSION_STEP_H_
@@ -29,6 +29,7 @@ cel::RuntimeOptions ConvertToRuntimeOptions(const InterpreterOptions& options) {
                              options.enable_comprehension_list_append,
                              options.enable_regex,
                              options.regex_max_program_size,
+                             options.regex_cache_size,
                              options.enable_string_conversion,
                              options.enable_string_concat,
                              options.enable_list_concat,
@@ -37,7 +38,11 @@ cel::RuntimeOptions ConvertToRuntimeOptions(const InterpreterOptions& options) {
                              options.enable_qualified_type_identifiers,
                              options.enable_heterogeneous_equality,
                              options.enable_empty_wrapper_null_unboxing,
-                             options.enable_lazy_bind_initialization};
+                             options.enable_lazy_bind_initialization,
+                             options.enable_direct_dispatch,
+                             options.max_recursion_depth,
+                             options.evaluation_state_pool_size,
+                             options.enable_compact_map_values};
 }
 
 }  // namespace google::api::expr::runtime
@@ -75,6 +75,12 @@ struct InterpreterOptions {
   // upper bound.
   int regex_max_program_size = 0;
 
+  // Number of compiled regular expressions to keep for regex functions called
+  // with patterns that are not constant at plan time. The cache is shared by
+  // all runtimes in the process and sized to the largest requested capacity.
+  // Use value 0 to compile the pattern on every call.
+  int regex_cache_size = 0;
+
   // Enable string() overloads.
   bool enable_string_conversion = true;
 
@@ -164,6 +170,38 @@ struct InterpreterOptions {
   // This is now always enabled. Setting this option has no effect. It will be
   // removed in a later update.
   bool enable_lazy_bind_initialization = true;
+
+  // Enable the direct dispatch evaluation loop.
+  //
+  // Core program steps are lowered into a compact instruction array that is
+  // executed inline by the evaluator instead of through virtual step calls.
+  bool enable_direct_dispatch = false;
+
+  // Maximum depth of recursively planned subexpressions.
+  //
+  // Supported subexpressions up to this depth are evaluated directly (each
+  // node returning its value to the parent) instead of through the value
+  // stack. 0 disables recursive planning, a negative value means no limit.
+  int max_recursion_depth = 0;
+
+  // Number of idle evaluator states each cel::Program keeps for reuse across
+  // evaluations. 0 disables pooling.
+  int evaluation_state_pool_size = 0;
+
+  // Enable fused planning of comprehension loops.
+  //
+  // Comprehensions generated by the standard macros are evaluated by a single
+  // step running the loop natively instead of separate next, condition and
+  // jump steps per iteration. Has no effect with unknown processing or
+  // recursive planning enabled.
+  bool enable_comprehension_fusion = false;
+
+  // Build map literals as compact map values.
+  //
+  // Entries are stored in flat arrays allocated from the evaluation arena
+  // with cached key hashes, instead of a node based hash map per map. Maps
+  // returned as a CelValue are converted to a CelMap.
+  bool enable_compact_map_values = false;
 };
 // LINT.ThenChange(//depot/google3/runtime/runtime_options.h)
 
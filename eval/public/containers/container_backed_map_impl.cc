@@ -1,5 +1,6 @@
 #include "eval/public/containers/container_backed_map_impl.h"
 
+#include <cstddef>
 #include <memory>
 #include <utility>
 
@@ -103,6 +104,11 @@ absl::Status CelMapBuilder::Add(CelValue key, CelValue value) {
   return absl::OkStatus();
 }
 
+void CelMapBuilder::Reserve(size_t capacity) {
+  values_map_.reserve(capacity);
+  key_list_.Reserve(capacity);
+}
+
 // CelValue hasher functor.
 size_t CelMapBuilder::Hasher::operator()(const CelValue& key) const {
   return key.template Visit<size_t>(HasherOp());
@@ -119,6 +125,7 @@ bool CelMapBuilder::Equal::operator()(const CelValue& key1,
 absl::StatusOr<std::unique_ptr<CelMap>> CreateContainerBackedMap(
     absl::Span<const std::pair<CelValue, CelValue>> key_values) {
   auto map = std::make_unique<CelMapBuilder>();
+  map->Reserve(key_values.size());
   for (const auto& key_value : key_values) {
     CEL_RETURN_IF_ERROR(map->Add(key_value.first, key_value.second));
   }
@@ -1,6 +1,7 @@
 #ifndef THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_CONTAINERS_CONTAINER_BACKED_MAP_IMPL_H_
 #define THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_CONTAINERS_CONTAINER_BACKED_MAP_IMPL_H_
 
+#include <cstddef>
 #include <memory>
 #include <utility>
 
@@ -22,6 +23,9 @@ class CelMapBuilder : public CelMap {
   // already exists.
   absl::Status Add(CelValue key, CelValue value);
 
+  // Reserve space for at least `capacity` entries.
+  void Reserve(size_t capacity);
+
   int size() const override { return values_map_.size(); }
 
   absl::optional<CelValue> operator[](CelValue cel_key) const override;
@@ -46,6 +50,8 @@ class CelMapBuilder : public CelMap {
 
     void Add(const CelValue& key) { keys_.push_back(key); }
 
+    void Reserve(size_t capacity) { keys_.reserve(capacity); }
+
    private:
     std::vector<CelValue> keys_;
   };
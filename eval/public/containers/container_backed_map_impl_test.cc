@@ -1,5 +1,6 @@
 #include "eval/public/containers/container_backed_map_impl.h"
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -182,6 +183,24 @@ TEST(CelMapBuilder, RepeatKeysFail) {
       StatusIs(absl::StatusCode::kInvalidArgument, "duplicate map keys"));
 }
 
+TEST(CelMapBuilder, Reserve) {
+  CelMapBuilder builder;
+  builder.Reserve(100);
+  for (int64_t i = 0; i < 100; ++i) {
+    ASSERT_OK(
+        builder.Add(CelValue::CreateInt64(i), CelValue::CreateInt64(i * 2)));
+  }
+
+  CelMap* cel_map = &builder;
+  EXPECT_THAT(cel_map->size(), Eq(100));
+  auto lookup = (*cel_map)[CelValue::CreateInt64(42)];
+  ASSERT_TRUE(lookup);
+  EXPECT_THAT(lookup->Int64OrDie(), Eq(84));
+  ASSERT_OK_AND_ASSIGN(const CelList* keys, cel_map->ListKeys());
+  EXPECT_THAT(keys->size(), Eq(100));
+  EXPECT_THAT((*keys)[99].Int64OrDie(), Eq(99));
+}
+
 }  // namespace
 
 }  // namespace google::api::expr::runtime
@@ -26,6 +26,7 @@
 #include "base/kind.h"
 #include "common/memory.h"
 #include "eval/compiler/cel_expression_builder_flat_impl.h"
+#include "eval/compiler/comprehension_fusion_optimization.h"
 #include "eval/compiler/comprehension_vulnerability_check.h"
 #include "eval/compiler/constant_folding.h"
 #include "eval/compiler/flat_expr_builder.h"
@@ -35,6 +36,7 @@
 #include "eval/public/cel_expression.h"
 #include "eval/public/cel_function.h"
 #include "eval/public/cel_options.h"
+#include "eval/public/structs/legacy_select_path_binder.h"
 #include "eval/public/structs/legacy_type_provider.h"
 #include "extensions/protobuf/memory_manager.h"
 #include "extensions/select_optimization.h"
@@ -48,6 +50,7 @@ using ::cel::ast_internal::AstImpl;
 using ::cel::extensions::CreateSelectOptimizationProgramOptimizer;
 using ::cel::extensions::ProtoMemoryManagerRef;
 using ::cel::extensions::SelectOptimizationAstUpdater;
+using ::cel::extensions::SelectOptimizationOptions;
 using ::cel::runtime_internal::CreateConstantFoldingOptimizer;
 
 // Adapter for a raw arena* pointer. Manages a MemoryManager object for the
@@ -75,6 +78,8 @@ std::unique_ptr<CelExpressionBuilder> CreatePortableExprBuilder(
   auto builder =
       std::make_unique<CelExpressionBuilderFlatImpl>(runtime_options);
 
+  // Owned by the type registry of the builder.
+  const LegacyTypeProvider& legacy_type_provider = *type_provider;
   builder->GetTypeRegistry()->RegisterTypeProvider(std::move(type_provider));
 
   FlatExprBuilder& flat_expr_builder = builder->flat_expr_builder();
@@ -100,6 +105,11 @@ std::unique_ptr<CelExpressionBuilder> CreatePortableExprBuilder(
         CreateRegexPrecompilationExtension(options.regex_max_program_size));
   }
 
+  if (options.enable_comprehension_fusion) {
+    flat_expr_builder.AddProgramOptimizer(
+        CreateComprehensionFusionExtension());
+  }
+
   if (options.enable_select_optimization) {
     // Add AST transform to update select branches on a stored
     // CheckedExpression. This may already be performed by a type checker.
@@ -120,9 +130,13 @@ std::unique_ptr<CelExpressionBuilder> CreatePortableExprBuilder(
     if (!status.ok()) {
       ABSL_LOG(ERROR) << "Failed to register @cel.hasField: " << status;
     }
-    // Add runtime implementation.
+    // Add runtime implementation. Paths on message types known to the type
+    // provider are bound to their fields at plan time.
+    SelectOptimizationOptions select_optimization_options;
+    select_optimization_options.path_binder =
+        NewLegacySelectPathBinder(legacy_type_provider);
     flat_expr_builder.AddProgramOptimizer(
-        CreateSelectOptimizationProgramOptimizer());
+        CreateSelectOptimizationProgramOptimizer(select_optimization_options));
   }
 
   return builder;
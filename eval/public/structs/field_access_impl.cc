@@ -25,6 +25,7 @@
 #include "google/protobuf/arena.h"
 #include "google/protobuf/map_field.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/absl_check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -688,6 +689,94 @@ class RepeatedFieldSetter : public FieldSetter<RepeatedFieldSetter> {
   const Reflection* GetReflection() const { return msg_->GetReflection(); }
 };
 
+// Typed getters for singular fields, selected by GetSingleFieldGetter.
+absl::StatusOr<CelValue> GetBoolField(const Message* msg,
+                                      const FieldDescriptor* desc,
+                                      ProtoWrapperTypeOptions,
+                                      const ProtobufValueFactory&, Arena*) {
+  return CelValue::CreateBool(msg->GetReflection()->GetBool(*msg, desc));
+}
+
+absl::StatusOr<CelValue> GetInt32Field(const Message* msg,
+                                       const FieldDescriptor* desc,
+                                       ProtoWrapperTypeOptions,
+                                       const ProtobufValueFactory&, Arena*) {
+  return CelValue::CreateInt64(msg->GetReflection()->GetInt32(*msg, desc));
+}
+
+absl::StatusOr<CelValue> GetInt64Field(const Message* msg,
+                                       const FieldDescriptor* desc,
+                                       ProtoWrapperTypeOptions,
+                                       const ProtobufValueFactory&, Arena*) {
+  return CelValue::CreateInt64(msg->GetReflection()->GetInt64(*msg, desc));
+}
+
+absl::StatusOr<CelValue> GetUInt32Field(const Message* msg,
+                                        const FieldDescriptor* desc,
+                                        ProtoWrapperTypeOptions,
+                                        const ProtobufValueFactory&, Arena*) {
+  return CelValue::CreateUint64(msg->GetReflection()->GetUInt32(*msg, desc));
+}
+
+absl::StatusOr<CelValue> GetUInt64Field(const Message* msg,
+                                        const FieldDescriptor* desc,
+                                        ProtoWrapperTypeOptions,
+                                        const ProtobufValueFactory&, Arena*) {
+  return CelValue::CreateUint64(msg->GetReflection()->GetUInt64(*msg, desc));
+}
+
+absl::StatusOr<CelValue> GetFloatField(const Message* msg,
+                                       const FieldDescriptor* desc,
+                                       ProtoWrapperTypeOptions,
+                                       const ProtobufValueFactory&, Arena*) {
+  return CelValue::CreateDouble(msg->GetReflection()->GetFloat(*msg, desc));
+}
+
+absl::StatusOr<CelValue> GetDoubleField(const Message* msg,
+                                        const FieldDescriptor* desc,
+                                        ProtoWrapperTypeOptions,
+                                        const ProtobufValueFactory&, Arena*) {
+  return CelValue::CreateDouble(msg->GetReflection()->GetDouble(*msg, desc));
+}
+
+absl::StatusOr<CelValue> GetEnumField(const Message* msg,
+                                      const FieldDescriptor* desc,
+                                      ProtoWrapperTypeOptions,
+                                      const ProtobufValueFactory&, Arena*) {
+  return CelValue::CreateInt64(msg->GetReflection()->GetEnumValue(*msg, desc));
+}
+
+// Returns a reference to the string field, copying it to the arena if the
+// message doesn't store it as a std::string.
+const std::string* GetStringReference(const Message* msg,
+                                      const FieldDescriptor* desc,
+                                      Arena* arena) {
+  ABSL_DCHECK(arena != nullptr);
+  std::string buffer;
+  const std::string* value =
+      &msg->GetReflection()->GetStringReference(*msg, desc, &buffer);
+  if (value == &buffer) {
+    value = google::protobuf::Arena::Create<std::string>(arena, std::move(buffer));
+  }
+  return value;
+}
+
+absl::StatusOr<CelValue> GetStringField(const Message* msg,
+                                        const FieldDescriptor* desc,
+                                        ProtoWrapperTypeOptions,
+                                        const ProtobufValueFactory&,
+                                        Arena* arena) {
+  return CelValue::CreateString(GetStringReference(msg, desc, arena));
+}
+
+absl::StatusOr<CelValue> GetBytesField(const Message* msg,
+                                       const FieldDescriptor* desc,
+                                       ProtoWrapperTypeOptions,
+                                       const ProtobufValueFactory&,
+                                       Arena* arena) {
+  return CelValue::CreateBytes(GetStringReference(msg, desc, arena));
+}
+
 }  // namespace
 
 absl::StatusOr<CelValue> CreateValueFromSingleField(
@@ -699,6 +788,42 @@ absl::StatusOr<CelValue> CreateValueFromSingleField(
   return accessor.CreateValueFromFieldAccessor(arena);
 }
 
+SingleFieldGetter GetSingleFieldGetter(const FieldDescriptor* desc) {
+  switch (desc->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_BOOL:
+      return &GetBoolField;
+    case FieldDescriptor::CPPTYPE_INT32:
+      return &GetInt32Field;
+    case FieldDescriptor::CPPTYPE_INT64:
+      return &GetInt64Field;
+    case FieldDescriptor::CPPTYPE_UINT32:
+      return &GetUInt32Field;
+    case FieldDescriptor::CPPTYPE_UINT64:
+      return &GetUInt64Field;
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      return &GetFloatField;
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      return &GetDoubleField;
+    case FieldDescriptor::CPPTYPE_ENUM:
+      return &GetEnumField;
+    case FieldDescriptor::CPPTYPE_STRING:
+      switch (desc->type()) {
+        case FieldDescriptor::TYPE_STRING:
+          return &GetStringField;
+        case FieldDescriptor::TYPE_BYTES:
+          return &GetBytesField;
+        default:
+          break;
+      }
+      break;
+    default:
+      break;
+  }
+  // Messages and anything unexpected keep the generic conversion, which also
+  // reports errors for unhandled types.
+  return &CreateValueFromSingleField;
+}
+
 absl::StatusOr<CelValue> CreateValueFromRepeatedField(
     const google::protobuf::Message* msg, const FieldDescriptor* desc, int index,
     const ProtobufValueFactory& factory, google::protobuf::Arena* arena) {
@@ -33,6 +33,23 @@ absl::StatusOr<CelValue> CreateValueFromSingleField(
     ProtoWrapperTypeOptions options, const ProtobufValueFactory& factory,
     google::protobuf::Arena* arena);
 
+// Reads a singular message field into a CelValue. Has the same signature and
+// behavior as CreateValueFromSingleField.
+using SingleFieldGetter = absl::StatusOr<CelValue> (*)(
+    const google::protobuf::Message* msg, const google::protobuf::FieldDescriptor* desc,
+    ProtoWrapperTypeOptions options, const ProtobufValueFactory& factory,
+    google::protobuf::Arena* arena);
+
+// Returns the getter for the singular field desc.
+//
+// The getter calls the typed Reflection accessor for the field (GetInt64,
+// GetStringReference, ...) directly, so callers that read the same field many
+// times can select it once instead of switching on the field's C++ type on
+// every read. Message typed fields use CreateValueFromSingleField, which
+// handles unwrapping of well-known types. String and bytes getters may copy
+// the field to the arena, so it must not be null.
+SingleFieldGetter GetSingleFieldGetter(const google::protobuf::FieldDescriptor* desc);
+
 // Creates CelValue from repeated message field.
 // Returns status of the operation.
 // msg Message containing the field.
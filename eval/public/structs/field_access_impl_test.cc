@@ -199,6 +199,23 @@ TEST_P(SingleFieldTest, Getter) {
   EXPECT_THAT(accessed_value, test::EqualsCelValue(cel_value()));
 }
 
+TEST_P(SingleFieldTest, BoundGetter) {
+  TestAllTypes test_message;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::ParseFromString(message_textproto(), &test_message));
+  google::protobuf::Arena arena;
+  const FieldDescriptor* field =
+      test_message.GetDescriptor()->FindFieldByName(field_name());
+  SingleFieldGetter getter = GetSingleFieldGetter(field);
+
+  ASSERT_OK_AND_ASSIGN(
+      CelValue accessed_value,
+      getter(&test_message, field, ProtoWrapperTypeOptions::kUnsetProtoDefault,
+             &CelProtoWrapper::InternalWrapMessage, &arena));
+
+  EXPECT_THAT(accessed_value, test::EqualsCelValue(cel_value()));
+}
+
 TEST_P(SingleFieldTest, Setter) {
   TestAllTypes test_message;
   CelValue to_set = cel_value();
@@ -0,0 +1,97 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/public/structs/generated_select_registry.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/descriptor.h"
+#include "absl/base/no_destructor.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+
+namespace google::api::expr::runtime {
+
+GeneratedSelectRegistry& GeneratedSelectRegistry::GetSingleton() {
+  static absl::NoDestructor<GeneratedSelectRegistry> kInstance;
+  return *kInstance;
+}
+
+absl::Status GeneratedSelectRegistry::Register(
+    const google::protobuf::Descriptor* descriptor, absl::string_view path,
+    GeneratedSelectFunction function) {
+  if (descriptor == nullptr || function == nullptr) {
+    return absl::InvalidArgumentError(
+        "generated select requires a descriptor and a function");
+  }
+  std::vector<absl::string_view> names = absl::StrSplit(path, '.');
+  std::vector<int64_t> field_numbers;
+  field_numbers.reserve(names.size());
+  const google::protobuf::Descriptor* message_type = descriptor;
+  for (absl::string_view name : names) {
+    if (message_type == nullptr) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("generated select path '", path,
+                       "' selects into a non-message field"));
+    }
+    const google::protobuf::FieldDescriptor* field =
+        message_type->FindFieldByName(name);
+    if (field == nullptr) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("no_such_field : ", name, " in generated select path '",
+                       path, "' on ", descriptor->full_name()));
+    }
+    if (field->is_repeated()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("generated select path '", path,
+                       "' traverses repeated field ", name));
+    }
+    field_numbers.push_back(field->number());
+    message_type = field->message_type();
+  }
+
+  absl::MutexLock lock(&mutex_);
+  if (!functions_[descriptor]
+           .try_emplace(std::move(field_numbers), function)
+           .second) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("generated select path '", path,
+                     "' already registered for ", descriptor->full_name()));
+  }
+  return absl::OkStatus();
+}
+
+GeneratedSelectFunction GeneratedSelectRegistry::Find(
+    const google::protobuf::Descriptor* descriptor,
+    absl::Span<const int64_t> field_numbers) const {
+  absl::ReaderMutexLock lock(&mutex_);
+  auto type_functions = functions_.find(descriptor);
+  if (type_functions == functions_.end()) {
+    return nullptr;
+  }
+  auto function = type_functions->second.find(
+      std::vector<int64_t>(field_numbers.begin(), field_numbers.end()));
+  if (function == type_functions->second.end()) {
+    return nullptr;
+  }
+  return function->second;
+}
+
+}  // namespace google::api::expr::runtime
@@ -0,0 +1,111 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_STRUCTS_GENERATED_SELECT_REGISTRY_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_STRUCTS_GENERATED_SELECT_REGISTRY_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "google/protobuf/arena.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "eval/public/cel_value.h"
+#include "internal/casts.h"
+
+namespace google::api::expr::runtime {
+
+// Reads the value at the end of a select path from a message of the type the
+// function was registered for.
+using GeneratedSelectFunction = CelValue (*)(const google::protobuf::Message& message,
+                                             google::protobuf::Arena* arena);
+
+// Registry of select paths on message types compiled into the binary, read
+// with the generated accessors of the message instead of reflection.
+//
+// ProtoMessageTypeAdapter::BindQualify consults the registry, so optimized
+// selects (see InterpreterOptions::enable_select_optimization) on a registered
+// path call the registered function directly. Paths are only matched
+// against messages whose descriptor is the one the path was registered for,
+// i.e. messages from the generated pool.
+//
+// Only expressions built with the legacy CelExpressionBuilder use the
+// registry: its select optimization binds paths on checked operand types
+// through NewLegacySelectPathBinder. cel::Runtime programs don't bind select
+// paths, and selects that aren't bound go through StructValue::Qualify, which
+// walks the message with reflection (protobuf_internal::ProtoQualifyState)
+// without consulting the registry.
+//
+// The registered function must follow the CEL conversion for the selected
+// field, e.g.
+//
+//   CelValue SelectE(const RequestContext& request, google::protobuf::Arena*) {
+//     return CelValue::CreateBool(request.a().b().c().d().e());
+//   }
+//
+//   GeneratedSelectRegistry::GetSingleton()
+//       .Register<RequestContext, &SelectE>("a.b.c.d.e");
+//
+// Registration is expected to happen before expressions are planned.
+class GeneratedSelectRegistry {
+ public:
+  // Returns the registry used by ProtoMessageTypeAdapter.
+  static GeneratedSelectRegistry& GetSingleton();
+
+  GeneratedSelectRegistry() = default;
+
+  GeneratedSelectRegistry(const GeneratedSelectRegistry&) = delete;
+  GeneratedSelectRegistry& operator=(const GeneratedSelectRegistry&) = delete;
+
+  // Registers `function` for selecting `path`, the dot separated names of
+  // singular fields, on messages of type `descriptor`.
+  absl::Status Register(const google::protobuf::Descriptor* descriptor,
+                        absl::string_view path,
+                        GeneratedSelectFunction function);
+
+  // Registers `Function` for selecting `path` on messages of the generated
+  // type `T`.
+  template <typename T, CelValue (*Function)(const T&, google::protobuf::Arena*)>
+  absl::Status Register(absl::string_view path) {
+    return Register(T::descriptor(), path, &Invoke<T, Function>);
+  }
+
+  // Returns the function registered for the path given by the field numbers
+  // `field_numbers` on `descriptor`, or nullptr.
+  GeneratedSelectFunction Find(const google::protobuf::Descriptor* descriptor,
+                               absl::Span<const int64_t> field_numbers) const;
+
+ private:
+  template <typename T, CelValue (*Function)(const T&, google::protobuf::Arena*)>
+  static CelValue Invoke(const google::protobuf::Message& message,
+                         google::protobuf::Arena* arena) {
+    return Function(cel::internal::down_cast<const T&>(message), arena);
+  }
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<const google::protobuf::Descriptor*,
+                      absl::flat_hash_map<std::vector<int64_t>,
+                                          GeneratedSelectFunction>>
+      functions_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_STRUCTS_GENERATED_SELECT_REGISTRY_H_
@@ -0,0 +1,84 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/public/structs/generated_select_registry.h"
+
+#include "google/protobuf/wrappers.pb.h"
+#include "absl/status/status.h"
+#include "eval/public/cel_value.h"
+#include "eval/public/testing/matchers.h"
+#include "eval/testutil/test_message.pb.h"
+#include "internal/testing.h"
+#include "google/protobuf/arena.h"
+
+namespace google::api::expr::runtime {
+namespace {
+
+using cel::internal::IsOk;
+using cel::internal::StatusIs;
+
+CelValue SelectNestedInt64(const TestMessage& message, google::protobuf::Arena*) {
+  return CelValue::CreateInt64(message.message_value().int64_value());
+}
+
+TEST(GeneratedSelectRegistry, RegisterAndFind) {
+  GeneratedSelectRegistry registry;
+  ASSERT_THAT((registry.Register<TestMessage, &SelectNestedInt64>(
+                  "message_value.int64_value")),
+              IsOk());
+
+  GeneratedSelectFunction function =
+      registry.Find(TestMessage::descriptor(), {12, 2});
+  ASSERT_NE(function, nullptr);
+
+  google::protobuf::Arena arena;
+  TestMessage message;
+  message.mutable_message_value()->set_int64_value(42);
+  EXPECT_THAT(function(message, &arena), test::IsCelInt64(42));
+
+  EXPECT_EQ(registry.Find(TestMessage::descriptor(), {12}), nullptr);
+  EXPECT_EQ(registry.Find(TestMessage::descriptor(), {12, 2, 1}), nullptr);
+  EXPECT_EQ(registry.Find(TestMessage::descriptor(), {2}), nullptr);
+  EXPECT_EQ(registry.Find(google::protobuf::Int64Value::descriptor(), {12, 2}),
+            nullptr);
+}
+
+TEST(GeneratedSelectRegistry, RegisterDuplicate) {
+  GeneratedSelectRegistry registry;
+  ASSERT_THAT((registry.Register<TestMessage, &SelectNestedInt64>(
+                  "message_value.int64_value")),
+              IsOk());
+  EXPECT_THAT((registry.Register<TestMessage, &SelectNestedInt64>(
+                  "message_value.int64_value")),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+}
+
+TEST(GeneratedSelectRegistry, RegisterInvalidPath) {
+  GeneratedSelectRegistry registry;
+  EXPECT_THAT((registry.Register<TestMessage, &SelectNestedInt64>(
+                  "message_value.unknown_field")),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT((registry.Register<TestMessage, &SelectNestedInt64>(
+                  "message_list.int64_value")),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT((registry.Register<TestMessage, &SelectNestedInt64>(
+                  "int64_value.int64_value")),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(registry.Register(TestMessage::descriptor(), "int64_value",
+                                /*function=*/nullptr),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace google::api::expr::runtime
@@ -0,0 +1,167 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "eval/public/structs/legacy_select_path_binder.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "base/attribute.h"
+#include "common/legacy_value.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "eval/public/cel_value.h"
+#include "eval/public/message_wrapper.h"
+#include "eval/public/structs/legacy_type_adapter.h"
+#include "eval/public/structs/legacy_type_info_apis.h"
+#include "eval/public/structs/legacy_type_provider.h"
+#include "extensions/protobuf/memory_manager.h"
+#include "extensions/select_optimization.h"
+#include "internal/status_macros.h"
+#include "google/protobuf/arena.h"
+
+namespace google::api::expr::runtime {
+namespace {
+
+using ::cel::extensions::BoundSelectPath;
+using ::cel::extensions::ProtoMemoryManagerArena;
+using ::cel::extensions::SelectPathBinder;
+
+// Converts the result of a bound qualifier to a cel::Value.
+using ResultConverter = absl::StatusOr<cel::Value> (*)(google::protobuf::Arena* arena,
+                                                       const CelValue& value);
+
+absl::StatusOr<cel::Value> ConvertBool(google::protobuf::Arena*, const CelValue& value) {
+  return cel::BoolValue(value.BoolOrDie());
+}
+
+absl::StatusOr<cel::Value> ConvertInt64(google::protobuf::Arena*,
+                                        const CelValue& value) {
+  return cel::IntValue(value.Int64OrDie());
+}
+
+absl::StatusOr<cel::Value> ConvertUint64(google::protobuf::Arena*,
+                                         const CelValue& value) {
+  return cel::UintValue(value.Uint64OrDie());
+}
+
+absl::StatusOr<cel::Value> ConvertDouble(google::protobuf::Arena*,
+                                         const CelValue& value) {
+  return cel::DoubleValue(value.DoubleOrDie());
+}
+
+absl::StatusOr<cel::Value> ConvertAny(google::protobuf::Arena* arena,
+                                      const CelValue& value) {
+  cel::Value scratch;
+  CEL_ASSIGN_OR_RETURN(cel::ValueView result,
+                       cel::ModernValue(arena, value, scratch));
+  return cel::Value(result);
+}
+
+ResultConverter GetResultConverter(absl::optional<CelValue::Type> type) {
+  if (!type.has_value()) {
+    return &ConvertAny;
+  }
+  switch (*type) {
+    case CelValue::Type::kBool:
+      return &ConvertBool;
+    case CelValue::Type::kInt64:
+      return &ConvertInt64;
+    case CelValue::Type::kUint64:
+      return &ConvertUint64;
+    case CelValue::Type::kDouble:
+      return &ConvertDouble;
+    default:
+      return &ConvertAny;
+  }
+}
+
+class LegacyBoundSelectPath final : public BoundSelectPath {
+ public:
+  explicit LegacyBoundSelectPath(
+      std::unique_ptr<LegacyTypeAccessApis::BoundQualifier> qualifier)
+      : qualifier_(std::move(qualifier)),
+        converter_(GetResultConverter(qualifier_->result_type())) {}
+
+  absl::StatusOr<absl::optional<cel::Value>> Apply(
+      cel::ValueManager& value_manager,
+      const cel::StructValue& operand) const override {
+    google::protobuf::Arena* arena =
+        ProtoMemoryManagerArena(value_manager.GetMemoryManager());
+    if (arena == nullptr ||
+        !cel::As<cel::common_internal::LegacyStructValueView>(
+             cel::ValueView(operand))
+             .has_value()) {
+      return absl::nullopt;
+    }
+    CEL_ASSIGN_OR_RETURN(CelValue legacy_operand,
+                         cel::LegacyValue(arena, operand));
+    CEL_ASSIGN_OR_RETURN(
+        absl::optional<CelValue> result,
+        qualifier_->Apply(legacy_operand.MessageWrapperOrDie(),
+                          value_manager.GetMemoryManager()));
+    if (!result.has_value()) {
+      return absl::nullopt;
+    }
+    return converter_(arena, *result);
+  }
+
+ private:
+  std::unique_ptr<LegacyTypeAccessApis::BoundQualifier> qualifier_;
+  // Selected when binding from the qualifier's result type, so fixed scalar
+  // results skip the generic CelValue conversion.
+  ResultConverter converter_;
+};
+
+class LegacySelectPathBinder final : public SelectPathBinder {
+ public:
+  explicit LegacySelectPathBinder(const LegacyTypeProvider& type_provider)
+      : type_provider_(type_provider) {}
+
+  std::unique_ptr<BoundSelectPath> Bind(
+      absl::string_view type_name, absl::Span<const cel::SelectQualifier> path,
+      bool presence_test) const override {
+    absl::optional<const LegacyTypeInfoApis*> type_info =
+        type_provider_.ProvideLegacyTypeInfo(type_name);
+    if (!type_info.has_value() || *type_info == nullptr) {
+      return nullptr;
+    }
+    const LegacyTypeAccessApis* access_apis =
+        (*type_info)->GetAccessApis(MessageWrapper());
+    if (access_apis == nullptr) {
+      return nullptr;
+    }
+    auto qualifier = access_apis->BindQualify(path, presence_test);
+    if (qualifier == nullptr) {
+      return nullptr;
+    }
+    return std::make_unique<LegacyBoundSelectPath>(std::move(qualifier));
+  }
+
+ private:
+  const LegacyTypeProvider& type_provider_;
+};
+
+}  // namespace
+
+std::shared_ptr<const SelectPathBinder> NewLegacySelectPathBinder(
+    const LegacyTypeProvider& type_provider) {
+  return std::make_shared<LegacySelectPathBinder>(type_provider);
+}
+
+}  // namespace google::api::expr::runtime
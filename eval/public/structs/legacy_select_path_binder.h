@@ -0,0 +1,35 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_STRUCTS_LEGACY_SELECT_PATH_BINDER_H_
+#define THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_STRUCTS_LEGACY_SELECT_PATH_BINDER_H_
+
+#include <memory>
+
+#include "eval/public/structs/legacy_type_provider.h"
+#include "extensions/select_optimization.h"
+
+namespace google::api::expr::runtime {
+
+// Returns a select path binder for the select optimization that binds paths
+// with LegacyTypeAccessApis::BindQualify of the types provided by
+// `type_provider`.
+//
+// `type_provider` is only used while planning and must outlive the planner.
+std::shared_ptr<const cel::extensions::SelectPathBinder>
+NewLegacySelectPathBinder(const LegacyTypeProvider& type_provider);
+
+}  // namespace google::api::expr::runtime
+
+#endif  // THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_STRUCTS_LEGACY_SELECT_PATH_BINDER_H_
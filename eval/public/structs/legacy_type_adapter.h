@@ -19,11 +19,13 @@
 #define THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_STRUCTS_LEGACY_TYPE_ADPATER_H_
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "base/attribute.h"
 #include "common/memory.h"
@@ -84,6 +86,29 @@ class LegacyTypeAccessApis {
     int qualifier_count;
   };
 
+  // A select path resolved against one type ahead of evaluation.
+  class BoundQualifier {
+   public:
+    virtual ~BoundQualifier() = default;
+
+    // Apply the bound select operations on the given instance.
+    //
+    // Returns nullopt if the instance isn't of the type the path was bound
+    // to, in which case the evaluator should use Qualify instead. Otherwise
+    // the result follows the same rules as Qualify with every qualifier
+    // applied. Implementations may also return nullopt if memory_manager
+    // isn't backed by an arena.
+    virtual absl::StatusOr<absl::optional<CelValue>> Apply(
+        const CelValue::MessageWrapper& instance,
+        cel::MemoryManagerRef memory_manager) const = 0;
+
+    // The type of every value returned by Apply, if it is fixed by the path.
+    // Lets callers select the conversion of the result once when binding.
+    virtual absl::optional<CelValue::Type> result_type() const {
+      return absl::nullopt;
+    }
+  };
+
   virtual ~LegacyTypeAccessApis() = default;
 
   // Return whether an instance of the type has field set to a non-default
@@ -121,6 +146,17 @@ class LegacyTypeAccessApis {
     return absl::UnimplementedError("Qualify unsupported.");
   }
 
+  // Resolve a series of select operations for this type once, typically when
+  // the expression is planned, so that applying them to an instance doesn't
+  // need to look up fields by name or number.
+  //
+  // Returns nullptr if the path can't be bound ahead of time. The evaluator
+  // then uses Qualify for every evaluation.
+  virtual std::unique_ptr<BoundQualifier> BindQualify(
+      absl::Span<const cel::SelectQualifier>, bool presence_test) const {
+    return nullptr;
+  }
+
   // Interface for equality operator.
   // The interpreter will check that both instances report to be the same type,
   // but implementations should confirm that both instances are actually of the
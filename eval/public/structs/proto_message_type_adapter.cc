@@ -14,8 +14,10 @@
 
 #include "eval/public/structs/proto_message_type_adapter.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,6 +32,7 @@
 #include "absl/strings/substitute.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "absl/types/variant.h"
 #include "base/attribute.h"
 #include "common/memory.h"
 #include "eval/public/cel_options.h"
@@ -39,6 +42,7 @@
 #include "eval/public/message_wrapper.h"
 #include "eval/public/structs/cel_proto_wrap_util.h"
 #include "eval/public/structs/field_access_impl.h"
+#include "eval/public/structs/generated_select_registry.h"
 #include "eval/public/structs/legacy_type_adapter.h"
 #include "eval/public/structs/legacy_type_info_apis.h"
 #include "extensions/protobuf/internal/qualify.h"
@@ -440,6 +444,131 @@ CelValue MessageCelValueFactory(const google::protobuf::Message* message) {
       MessageWrapper(message, &DucktypedMessageAdapter::GetSingleton()));
 }
 
+// Select path over singular fields, resolved to field descriptors and a typed
+// getter for the last field by ProtoMessageTypeAdapter::BindQualify.
+class ProtoBoundQualifier final : public LegacyTypeAccessApis::BoundQualifier {
+ public:
+  ProtoBoundQualifier(const google::protobuf::Descriptor* descriptor,
+                      std::vector<const FieldDescriptor*> message_fields,
+                      const FieldDescriptor* last_field, bool presence_test)
+      : descriptor_(descriptor),
+        message_fields_(std::move(message_fields)),
+        last_field_(last_field),
+        getter_(internal::GetSingleFieldGetter(last_field)),
+        presence_test_(presence_test) {}
+
+  absl::StatusOr<absl::optional<CelValue>> Apply(
+      const CelValue::MessageWrapper& instance,
+      cel::MemoryManagerRef memory_manager) const override {
+    google::protobuf::Arena* arena = ProtoMemoryManagerArena(memory_manager);
+    // The getters copy non-contiguous strings to the arena.
+    if (arena == nullptr || !instance.HasFullProto() ||
+        instance.message_ptr() == nullptr) {
+      return absl::nullopt;
+    }
+    const auto* message =
+        cel::internal::down_cast<const google::protobuf::Message*>(instance.message_ptr());
+    if (message->GetDescriptor() != descriptor_) {
+      return absl::nullopt;
+    }
+    for (const FieldDescriptor* field : message_fields_) {
+      message = &message->GetReflection()->GetMessage(*message, field);
+    }
+    if (presence_test_) {
+      return CelValue::CreateBool(
+          message->GetReflection()->HasField(*message, last_field_));
+    }
+    return getter_(message, last_field_, ProtoWrapperTypeOptions::kUnsetNull,
+                   &MessageCelValueFactory, arena);
+  }
+
+  absl::optional<CelValue::Type> result_type() const override {
+    if (presence_test_) {
+      return CelValue::Type::kBool;
+    }
+    switch (last_field_->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_BOOL:
+        return CelValue::Type::kBool;
+      case FieldDescriptor::CPPTYPE_INT32:
+      case FieldDescriptor::CPPTYPE_INT64:
+      case FieldDescriptor::CPPTYPE_ENUM:
+        return CelValue::Type::kInt64;
+      case FieldDescriptor::CPPTYPE_UINT32:
+      case FieldDescriptor::CPPTYPE_UINT64:
+        return CelValue::Type::kUint64;
+      case FieldDescriptor::CPPTYPE_FLOAT:
+      case FieldDescriptor::CPPTYPE_DOUBLE:
+        return CelValue::Type::kDouble;
+      default:
+        // Strings and bytes share a C++ type, and messages may be unwrapped
+        // to any type.
+        return absl::nullopt;
+    }
+  }
+
+ private:
+  const google::protobuf::Descriptor* descriptor_;
+  // Singular message fields traversed before the last field.
+  std::vector<const FieldDescriptor*> message_fields_;
+  const FieldDescriptor* last_field_;
+  internal::SingleFieldGetter getter_;
+  bool presence_test_;
+};
+
+// Select path read by a function from the GeneratedSelectRegistry.
+class GeneratedBoundQualifier final
+    : public LegacyTypeAccessApis::BoundQualifier {
+ public:
+  GeneratedBoundQualifier(const google::protobuf::Descriptor* descriptor,
+                          GeneratedSelectFunction function)
+      : descriptor_(descriptor), function_(function) {}
+
+  absl::StatusOr<absl::optional<CelValue>> Apply(
+      const CelValue::MessageWrapper& instance,
+      cel::MemoryManagerRef memory_manager) const override {
+    google::protobuf::Arena* arena = ProtoMemoryManagerArena(memory_manager);
+    if (arena == nullptr || !instance.HasFullProto() ||
+        instance.message_ptr() == nullptr) {
+      return absl::nullopt;
+    }
+    const auto* message =
+        cel::internal::down_cast<const google::protobuf::Message*>(instance.message_ptr());
+    if (message->GetDescriptor() != descriptor_) {
+      return absl::nullopt;
+    }
+    return function_(*message, arena);
+  }
+
+ private:
+  const google::protobuf::Descriptor* descriptor_;
+  GeneratedSelectFunction function_;
+};
+
+// Whether qualifying through a field of the given message type converts it to
+// a CEL value first (see protobuf_internal::ProtoQualifyState).
+bool IsOpaqueQualifyType(const google::protobuf::Descriptor& descriptor) {
+  switch (descriptor.well_known_type()) {
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_ANY:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_STRUCT:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_VALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_LISTVALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_TIMESTAMP:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_DURATION:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_DOUBLEVALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_FLOATVALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_INT64VALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_UINT64VALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_INT32VALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_UINT32VALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_STRINGVALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_BYTESVALUE:
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_BOOLVALUE:
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace
 
 std::string ProtoMessageTypeAdapter::DebugString(
@@ -552,6 +681,54 @@ ProtoMessageTypeAdapter::Qualify(
                      memory_manager);
 }
 
+std::unique_ptr<LegacyTypeAccessApis::BoundQualifier>
+ProtoMessageTypeAdapter::BindQualify(
+    absl::Span<const cel::SelectQualifier> qualifiers,
+    bool presence_test) const {
+  if (descriptor_ == nullptr || qualifiers.empty()) {
+    return nullptr;
+  }
+  // Only chains of singular fields are bound. Anything involving extensions,
+  // containers or well-known types is left to Qualify.
+  const google::protobuf::Descriptor* descriptor = descriptor_;
+  std::vector<const FieldDescriptor*> message_fields;
+  message_fields.reserve(qualifiers.size() - 1);
+  std::vector<int64_t> field_numbers;
+  field_numbers.reserve(qualifiers.size());
+  for (size_t i = 0; i < qualifiers.size(); ++i) {
+    const auto* specifier = absl::get_if<cel::FieldSpecifier>(&qualifiers[i]);
+    if (specifier == nullptr) {
+      return nullptr;
+    }
+    const FieldDescriptor* field =
+        descriptor->FindFieldByNumber(specifier->number);
+    if (field == nullptr || field->is_repeated()) {
+      return nullptr;
+    }
+    field_numbers.push_back(field->number());
+    if (i + 1 == qualifiers.size()) {
+      // Prefer generated accessors registered for the path over reflection.
+      if (GeneratedSelectFunction function =
+              presence_test ? nullptr
+                            : GeneratedSelectRegistry::GetSingleton().Find(
+                                  descriptor_, field_numbers);
+          function != nullptr) {
+        return std::make_unique<GeneratedBoundQualifier>(descriptor_,
+                                                         function);
+      }
+      return std::make_unique<ProtoBoundQualifier>(
+          descriptor_, std::move(message_fields), field, presence_test);
+    }
+    if (field->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE ||
+        IsOpaqueQualifyType(*field->message_type())) {
+      return nullptr;
+    }
+    message_fields.push_back(field);
+    descriptor = field->message_type();
+  }
+  return nullptr;
+}
+
 absl::Status ProtoMessageTypeAdapter::SetField(
     const google::protobuf::FieldDescriptor* field, const CelValue& value,
     google::protobuf::Arena* arena, google::protobuf::Message* message) const {
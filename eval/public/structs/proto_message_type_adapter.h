@@ -15,6 +15,7 @@
 #ifndef THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_STRUCTS_PROTO_MESSAGE_TYPE_ADAPTER_H_
 #define THIRD_PARTY_CEL_CPP_EVAL_PUBLIC_STRUCTS_PROTO_MESSAGE_TYPE_ADAPTER_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -96,6 +97,10 @@ class ProtoMessageTypeAdapter : public LegacyTypeInfoApis,
       const CelValue::MessageWrapper& instance, bool presence_test,
       cel::MemoryManagerRef memory_manager) const override;
 
+  std::unique_ptr<LegacyTypeAccessApis::BoundQualifier> BindQualify(
+      absl::Span<const cel::SelectQualifier> qualifiers,
+      bool presence_test) const override;
+
   bool IsEqualTo(const CelValue::MessageWrapper& instance,
                  const CelValue::MessageWrapper& other_instance) const override;
 
@@ -20,11 +20,13 @@
 #include "google/protobuf/descriptor.pb.h"
 #include "absl/status/status.h"
 #include "base/attribute.h"
+#include "common/memory.h"
 #include "common/value.h"
 #include "eval/public/cel_value.h"
 #include "eval/public/containers/container_backed_list_impl.h"
 #include "eval/public/containers/container_backed_map_impl.h"
 #include "eval/public/message_wrapper.h"
+#include "eval/public/structs/generated_select_registry.h"
 #include "eval/public/structs/legacy_type_adapter.h"
 #include "eval/public/structs/legacy_type_info_apis.h"
 #include "eval/public/testing/matchers.h"
@@ -777,6 +779,228 @@ TEST(ProtoMesssageTypeAdapter, Qualify) {
       IsOkAndHolds(Field(&LegacyQualifyResult::value, test::IsCelInt64(42))));
 }
 
+TEST(ProtoMesssageTypeAdapter, BindQualify) {
+  google::protobuf::Arena arena;
+  ProtoMessageTypeAdapter adapter(
+      google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+          "google.api.expr.runtime.TestMessage"),
+      google::protobuf::MessageFactory::generated_factory());
+  auto manager = ProtoMemoryManagerRef(&arena);
+
+  TestMessage message;
+  message.mutable_message_value()->set_int64_value(42);
+  message.mutable_message_value()->mutable_message_value()->set_string_value(
+      "foo");
+  CelValue::MessageWrapper wrapped(&message, &adapter);
+
+  const LegacyTypeAccessApis* api = adapter.GetAccessApis(MessageWrapper());
+  ASSERT_NE(api, nullptr);
+
+  std::vector<cel::SelectQualifier> qualfiers{
+      cel::FieldSpecifier{12, "message_value"},
+      cel::FieldSpecifier{2, "int64_value"}};
+  auto bound = api->BindQualify(qualfiers, /*presence_test=*/false);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->Apply(wrapped, manager),
+              IsOkAndHolds(Optional(test::IsCelInt64(42))));
+
+  qualfiers = {cel::FieldSpecifier{12, "message_value"},
+               cel::FieldSpecifier{12, "message_value"},
+               cel::FieldSpecifier{7, "string_value"}};
+  bound = api->BindQualify(qualfiers, /*presence_test=*/false);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->Apply(wrapped, manager),
+              IsOkAndHolds(Optional(test::IsCelString("foo"))));
+
+  // Unset intermediate messages read as their defaults.
+  qualfiers = {cel::FieldSpecifier{12, "message_value"},
+               cel::FieldSpecifier{12, "message_value"},
+               cel::FieldSpecifier{12, "message_value"},
+               cel::FieldSpecifier{2, "int64_value"}};
+  bound = api->BindQualify(qualfiers, /*presence_test=*/false);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->Apply(wrapped, manager),
+              IsOkAndHolds(Optional(test::IsCelInt64(0))));
+
+  // Unset wrappers are null.
+  qualfiers = {cel::FieldSpecifier{305, "int64_wrapper_value"}};
+  bound = api->BindQualify(qualfiers, /*presence_test=*/false);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->Apply(wrapped, manager),
+              IsOkAndHolds(Optional(test::IsCelNull())));
+}
+
+CelValue SelectNestedUint32(const TestMessage& message, google::protobuf::Arena*) {
+  return CelValue::CreateUint64(message.message_value().uint32_value() + 1);
+}
+
+TEST(ProtoMesssageTypeAdapter, BindQualifyGenerated) {
+  absl::Status status =
+      GeneratedSelectRegistry::GetSingleton()
+          .Register<TestMessage, &SelectNestedUint32>(
+              "message_value.uint32_value");
+  ASSERT_TRUE(status.ok() || absl::IsAlreadyExists(status)) << status;
+
+  google::protobuf::Arena arena;
+  ProtoMessageTypeAdapter adapter(
+      google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+          "google.api.expr.runtime.TestMessage"),
+      google::protobuf::MessageFactory::generated_factory());
+  auto manager = ProtoMemoryManagerRef(&arena);
+
+  TestMessage message;
+  message.mutable_message_value()->set_uint32_value(41);
+  CelValue::MessageWrapper wrapped(&message, &adapter);
+
+  const LegacyTypeAccessApis* api = adapter.GetAccessApis(MessageWrapper());
+  ASSERT_NE(api, nullptr);
+
+  // The registered function is distinguishable from reflection by its result.
+  std::vector<cel::SelectQualifier> qualfiers{
+      cel::FieldSpecifier{12, "message_value"},
+      cel::FieldSpecifier{3, "uint32_value"}};
+  auto bound = api->BindQualify(qualfiers, /*presence_test=*/false);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->Apply(wrapped, manager),
+              IsOkAndHolds(Optional(test::IsCelUint64(42))));
+
+  // Presence tests still use reflection.
+  bound = api->BindQualify(qualfiers, /*presence_test=*/true);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->Apply(wrapped, manager),
+              IsOkAndHolds(Optional(test::IsCelBool(true))));
+}
+
+TEST(ProtoMesssageTypeAdapter, BindQualifyHas) {
+  google::protobuf::Arena arena;
+  ProtoMessageTypeAdapter adapter(
+      google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+          "google.api.expr.runtime.TestMessage"),
+      google::protobuf::MessageFactory::generated_factory());
+  auto manager = ProtoMemoryManagerRef(&arena);
+
+  TestMessage message;
+  message.mutable_message_value()->set_int64_value(42);
+  CelValue::MessageWrapper wrapped(&message, &adapter);
+
+  const LegacyTypeAccessApis* api = adapter.GetAccessApis(MessageWrapper());
+  ASSERT_NE(api, nullptr);
+
+  std::vector<cel::SelectQualifier> qualfiers{
+      cel::FieldSpecifier{12, "message_value"},
+      cel::FieldSpecifier{2, "int64_value"}};
+  auto bound = api->BindQualify(qualfiers, /*presence_test=*/true);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->Apply(wrapped, manager),
+              IsOkAndHolds(Optional(test::IsCelBool(true))));
+
+  qualfiers = {cel::FieldSpecifier{12, "message_value"},
+               cel::FieldSpecifier{7, "string_value"}};
+  bound = api->BindQualify(qualfiers, /*presence_test=*/true);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->Apply(wrapped, manager),
+              IsOkAndHolds(Optional(test::IsCelBool(false))));
+}
+
+TEST(ProtoMesssageTypeAdapter, BindQualifyOtherType) {
+  google::protobuf::Arena arena;
+  ProtoMessageTypeAdapter adapter(
+      google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+          "google.api.expr.runtime.TestMessage"),
+      google::protobuf::MessageFactory::generated_factory());
+  auto manager = ProtoMemoryManagerRef(&arena);
+
+  Int64Value message;
+  CelValue::MessageWrapper wrapped(&message, &adapter);
+
+  std::vector<cel::SelectQualifier> qualfiers{
+      cel::FieldSpecifier{2, "int64_value"}};
+  auto bound = adapter.BindQualify(qualfiers, /*presence_test=*/false);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->Apply(wrapped, manager), IsOkAndHolds(Eq(absl::nullopt)));
+}
+
+TEST(ProtoMesssageTypeAdapter, BindQualifyUnsupported) {
+  ProtoMessageTypeAdapter adapter(
+      google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+          "google.api.expr.runtime.TestMessage"),
+      google::protobuf::MessageFactory::generated_factory());
+
+  std::vector<cel::SelectQualifier> no_such_field{
+      cel::FieldSpecifier{12, "message_value"},
+      cel::FieldSpecifier{99, "not_a_field"}};
+  EXPECT_EQ(adapter.BindQualify(no_such_field, /*presence_test=*/false),
+            nullptr);
+
+  std::vector<cel::SelectQualifier> repeated{
+      cel::FieldSpecifier{112, "message_list"},
+      cel::AttributeQualifier::OfInt(0)};
+  EXPECT_EQ(adapter.BindQualify(repeated, /*presence_test=*/false), nullptr);
+
+  std::vector<cel::SelectQualifier> any{cel::FieldSpecifier{300, "any_value"},
+                                        cel::FieldSpecifier{1, "type_url"}};
+  EXPECT_EQ(adapter.BindQualify(any, /*presence_test=*/false), nullptr);
+
+  // Timestamps, durations and wrappers are converted to CEL values, which
+  // don't have fields.
+  std::vector<cel::SelectQualifier> timestamp{
+      cel::FieldSpecifier{302, "timestamp_value"},
+      cel::FieldSpecifier{1, "seconds"}};
+  EXPECT_EQ(adapter.BindQualify(timestamp, /*presence_test=*/false), nullptr);
+
+  std::vector<cel::SelectQualifier> duration{
+      cel::FieldSpecifier{301, "duration_value"},
+      cel::FieldSpecifier{1, "seconds"}};
+  EXPECT_EQ(adapter.BindQualify(duration, /*presence_test=*/false), nullptr);
+
+  std::vector<cel::SelectQualifier> wrapper{
+      cel::FieldSpecifier{305, "int64_wrapper_value"},
+      cel::FieldSpecifier{1, "value"}};
+  EXPECT_EQ(adapter.BindQualify(wrapper, /*presence_test=*/false), nullptr);
+}
+
+TEST(ProtoMesssageTypeAdapter, BindQualifyRequiresArena) {
+  ProtoMessageTypeAdapter adapter(
+      google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+          "google.api.expr.runtime.TestMessage"),
+      google::protobuf::MessageFactory::generated_factory());
+
+  TestMessage message;
+  message.set_string_value("foo");
+  CelValue::MessageWrapper wrapped(&message, &adapter);
+
+  std::vector<cel::SelectQualifier> qualfiers{
+      cel::FieldSpecifier{7, "string_value"}};
+  auto bound = adapter.BindQualify(qualfiers, /*presence_test=*/false);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(
+      bound->Apply(wrapped, cel::MemoryManagerRef::ReferenceCounting()),
+      IsOkAndHolds(Eq(absl::nullopt)));
+}
+
+TEST(ProtoMesssageTypeAdapter, BindQualifyResultType) {
+  ProtoMessageTypeAdapter adapter(
+      google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+          "google.api.expr.runtime.TestMessage"),
+      google::protobuf::MessageFactory::generated_factory());
+
+  std::vector<cel::SelectQualifier> qualfiers{
+      cel::FieldSpecifier{12, "message_value"},
+      cel::FieldSpecifier{2, "int64_value"}};
+  auto bound = adapter.BindQualify(qualfiers, /*presence_test=*/false);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->result_type(), Optional(CelValue::Type::kInt64));
+
+  bound = adapter.BindQualify(qualfiers, /*presence_test=*/true);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_THAT(bound->result_type(), Optional(CelValue::Type::kBool));
+
+  qualfiers = {cel::FieldSpecifier{305, "int64_wrapper_value"}};
+  bound = adapter.BindQualify(qualfiers, /*presence_test=*/false);
+  ASSERT_NE(bound, nullptr);
+  EXPECT_EQ(bound->result_type(), absl::nullopt);
+}
+
 TEST(ProtoMesssageTypeAdapter, QualifyDynamicFieldAccessUnsupported) {
   google::protobuf::Arena arena;
   ProtoMessageTypeAdapter adapter(
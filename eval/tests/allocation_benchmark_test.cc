@@ -13,6 +13,7 @@
 // limitations under the License.
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "google/api/expr/v1alpha1/syntax.pb.h"
 #include "google/rpc/context/attribute_context.pb.h"
@@ -23,6 +24,9 @@
 #include "absl/container/node_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "eval/public/activation.h"
 #include "eval/public/builtin_func_registrar.h"
@@ -32,12 +36,15 @@
 #include "eval/public/cel_value.h"
 #include "eval/public/containers/container_backed_list_impl.h"
 #include "eval/public/containers/container_backed_map_impl.h"
+#include "eval/public/string_extension_func_registrar.h"
 #include "eval/public/structs/cel_proto_wrapper.h"
 #include "eval/tests/request_context.pb.h"
+#include "extensions/strings.h"
 #include "internal/benchmark.h"
 #include "internal/status_macros.h"
 #include "internal/testing.h"
 #include "parser/parser.h"
+#include "runtime/runtime_options.h"
 
 namespace google::api::expr::runtime {
 namespace {
@@ -174,6 +181,48 @@ static void BM_AllocateMap(benchmark::State& state) {
 
 BENCHMARK(BM_AllocateMap);
 
+// Evaluates cel expression:
+// '{0: 0, 1: 1, ..., n - 1: n - 1}[n - 1] == n - 1'
+//
+// Builds a map literal and looks up its last entry, with or without compact
+// map values.
+static void BM_AllocateMapAndLookup(benchmark::State& state) {
+  const int size = state.range(0);
+  InterpreterOptions options;
+  options.enable_compact_map_values = state.range(1) != 0;
+
+  google::protobuf::Arena arena;
+  std::vector<std::string> entries;
+  entries.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    entries.push_back(absl::StrCat(i, ": ", i));
+  }
+  std::string expr = absl::StrCat("{", absl::StrJoin(entries, ", "), "}[",
+                                  size - 1, "] == ", size - 1);
+  auto builder = CreateCelExpressionBuilder(options);
+  ASSERT_OK(RegisterBuiltinFunctions(builder->GetRegistry(), options));
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse(expr));
+  ASSERT_OK_AND_ASSIGN(auto cel_expr,
+                       builder->CreateExpression(&parsed_expr.expr(),
+                                                 &parsed_expr.source_info()));
+
+  for (auto _ : state) {
+    Activation activation;
+    ASSERT_OK_AND_ASSIGN(CelValue result,
+                         cel_expr->Evaluate(activation, &arena));
+    ASSERT_TRUE(result.IsBool() && result.BoolOrDie());
+  }
+}
+
+BENCHMARK(BM_AllocateMapAndLookup)
+    ->ArgPair(2, false)
+    ->ArgPair(2, true)
+    ->ArgPair(8, false)
+    ->ArgPair(8, true)
+    ->ArgPair(64, false)
+    ->ArgPair(64, true);
+
 static void BM_AllocateMessage(benchmark::State& state) {
   google::protobuf::Arena arena;
   std::string expr(
@@ -258,5 +307,72 @@ static void BM_AllocateList(benchmark::State& state) {
 }
 BENCHMARK(BM_AllocateList);
 
+// Builds a header value with `fields` comma separated key-value pairs.
+std::string MakeHeader(int fields) {
+  std::vector<std::string> parts;
+  parts.reserve(fields);
+  for (int i = 0; i < fields; ++i) {
+    parts.push_back(absl::StrCat("x-field-", i, "=some-moderately-long-value-",
+                                 i));
+  }
+  return absl::StrJoin(parts, ", ");
+}
+
+// Evaluates `expr` against a header with state.range(0) fields, using either
+// the legacy string extension functions or the cel::Value based ones.
+void RunStringsExtensionBenchmark(benchmark::State& state,
+                                  absl::string_view expr, bool modern) {
+  InterpreterOptions options;
+  auto builder = CreateCelExpressionBuilder(options);
+  ASSERT_OK(RegisterBuiltinFunctions(builder->GetRegistry(), options));
+  if (modern) {
+    ASSERT_OK(cel::extensions::RegisterStringsFunctions(
+        builder->GetRegistry()->InternalGetRegistry(),
+        cel::RuntimeOptions{}));
+  } else {
+    ASSERT_OK(
+        RegisterStringExtensionFunctions(builder->GetRegistry(), options));
+  }
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse(expr));
+  ASSERT_OK_AND_ASSIGN(auto cel_expr,
+                       builder->CreateExpression(&parsed_expr.expr(),
+                                                 &parsed_expr.source_info()));
+  std::string header = MakeHeader(state.range(0));
+
+  for (auto _ : state) {
+    google::protobuf::Arena arena;
+    Activation activation;
+    activation.InsertValue("header", CelValue::CreateStringView(header));
+    ASSERT_OK_AND_ASSIGN(CelValue result,
+                         cel_expr->Evaluate(activation, &arena));
+    ASSERT_FALSE(result.IsError()) << result.DebugString();
+  }
+  state.SetBytesProcessed(state.iterations() * header.size());
+}
+
+constexpr char kSplitExpr[] = "size(header.split(', ')) > 0";
+constexpr char kSplitJoinExpr[] = "header.split(', ').join(';')";
+
+static void BM_SplitHeaderLegacy(benchmark::State& state) {
+  RunStringsExtensionBenchmark(state, kSplitExpr, /*modern=*/false);
+}
+BENCHMARK(BM_SplitHeaderLegacy)->Range(8, 512);
+
+static void BM_SplitHeader(benchmark::State& state) {
+  RunStringsExtensionBenchmark(state, kSplitExpr, /*modern=*/true);
+}
+BENCHMARK(BM_SplitHeader)->Range(8, 512);
+
+static void BM_SplitJoinHeaderLegacy(benchmark::State& state) {
+  RunStringsExtensionBenchmark(state, kSplitJoinExpr, /*modern=*/false);
+}
+BENCHMARK(BM_SplitJoinHeaderLegacy)->Range(8, 512);
+
+static void BM_SplitJoinHeader(benchmark::State& state) {
+  RunStringsExtensionBenchmark(state, kSplitJoinExpr, /*modern=*/true);
+}
+BENCHMARK(BM_SplitJoinHeader)->Range(8, 512);
+
 }  // namespace
 }  // namespace google::api::expr::runtime
@@ -30,6 +30,12 @@
 #include "google/protobuf/arena.h"
 
 ABSL_FLAG(bool, enable_optimizations, false, "enable const folding opt");
+ABSL_FLAG(bool, enable_direct_dispatch, false,
+          "enable the direct dispatch evaluation loop");
+ABSL_FLAG(int, max_recursion_depth, 0,
+          "max depth of recursively planned subexpressions (-1 unlimited)");
+ABSL_FLAG(bool, enable_comprehension_fusion, false,
+          "plan standard macro comprehensions as a single loop step");
 
 namespace google {
 namespace api {
@@ -51,6 +57,11 @@ InterpreterOptions GetOptions(google::protobuf::Arena& arena) {
     options.constant_folding = true;
   }
 
+  options.enable_direct_dispatch = absl::GetFlag(FLAGS_enable_direct_dispatch);
+  options.max_recursion_depth = absl::GetFlag(FLAGS_max_recursion_depth);
+  options.enable_comprehension_fusion =
+      absl::GetFlag(FLAGS_enable_comprehension_fusion);
+
   return options;
 }
 
@@ -225,6 +236,43 @@ static void BM_EvalString_Trace(benchmark::State& state) {
 // nature of the proto to native type conversion.
 BENCHMARK(BM_EvalString_Trace)->Range(1, 10000);
 
+// Benchmark test
+// Evaluates an unchecked expression mixing calls over several argument kinds,
+// each of which has to be matched against the candidate overloads at runtime.
+void BM_HeterogeneousCalls(benchmark::State& state) {
+  google::protobuf::Arena arena;
+  Activation activation;
+  ASSERT_OK_AND_ASSIGN(
+      ParsedExpr parsed_expr,
+      parser::Parse("x + 1 > 2 && d * 2.0 < 10.0 && u - 1u >= 0u && "
+                    "size(s) + size(l) == 5 && s.startsWith('ab') && "
+                    "string(x) != s && int(d) < x"));
+
+  InterpreterOptions options = GetOptions(arena);
+  auto builder = CreateCelExpressionBuilder(options);
+  ASSERT_OK(RegisterBuiltinFunctions(builder->GetRegistry(), options));
+
+  ASSERT_OK_AND_ASSIGN(auto cel_expr,
+                       builder->CreateExpression(&parsed_expr.expr(), nullptr));
+
+  ContainerBackedListImpl cel_list(
+      {CelValue::CreateInt64(1), CelValue::CreateInt64(2)});
+  activation.InsertValue("x", CelValue::CreateInt64(3));
+  activation.InsertValue("d", CelValue::CreateDouble(1.5));
+  activation.InsertValue("u", CelValue::CreateUint64(2));
+  activation.InsertValue("s", CelValue::CreateStringView("abc"));
+  activation.InsertValue("l", CelValue::CreateList(&cel_list));
+
+  for (auto _ : state) {
+    ASSERT_OK_AND_ASSIGN(CelValue result,
+                         cel_expr->Evaluate(activation, &arena));
+    ASSERT_TRUE(result.IsBool());
+    ASSERT_TRUE(result.BoolOrDie());
+  }
+}
+
+BENCHMARK(BM_HeterogeneousCalls);
+
 const char kIP[] = "10.0.1.2";
 const char kPath[] = "/admin/edit";
 const char kToken[] = "admin";
@@ -0,0 +1,208 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks nested field selects on the messages used by
+// BM_NestedProtoFieldRead and BM_ProtoStructAccess, evaluated by reflection
+// per select, by select optimization bound to field descriptors, and by
+// select optimization through functions in the GeneratedSelectRegistry.
+//
+// Select optimization needs a checked expression, so the parsed expressions
+// are annotated with the message types of their select operands.
+
+#include <memory>
+#include <utility>
+
+#include "google/api/expr/v1alpha1/checked.pb.h"
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "google/rpc/context/attribute_context.pb.h"
+#include "absl/log/absl_check.h"
+#include "absl/strings/string_view.h"
+#include "eval/public/activation.h"
+#include "eval/public/builtin_func_registrar.h"
+#include "eval/public/cel_expr_builder_factory.h"
+#include "eval/public/cel_expression.h"
+#include "eval/public/cel_options.h"
+#include "eval/public/cel_value.h"
+#include "eval/public/structs/cel_proto_wrapper.h"
+#include "eval/public/structs/generated_select_registry.h"
+#include "eval/tests/request_context.pb.h"
+#include "internal/benchmark.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+
+namespace google::api::expr::runtime {
+namespace {
+
+using ::google::api::expr::v1alpha1::CheckedExpr;
+using ::google::api::expr::v1alpha1::Expr;
+using ::google::rpc::context::AttributeContext;
+
+enum class SelectMode {
+  kReflection,
+  kOptimized,
+  kGenerated,
+};
+
+// Records the message types of `expr` and its subexpressions in `checked`,
+// taking `request` to be of type `request_type`. Returns the message type of
+// `expr`, or nullptr.
+const google::protobuf::Descriptor* AnnotateMessageTypes(
+    const Expr& expr, const google::protobuf::Descriptor* request_type,
+    CheckedExpr& checked) {
+  const google::protobuf::Descriptor* type = nullptr;
+  switch (expr.expr_kind_case()) {
+    case Expr::kIdentExpr:
+      if (expr.ident_expr().name() == "request") {
+        type = request_type;
+      }
+      break;
+    case Expr::kSelectExpr: {
+      const google::protobuf::Descriptor* operand_type = AnnotateMessageTypes(
+          expr.select_expr().operand(), request_type, checked);
+      if (operand_type != nullptr && !expr.select_expr().test_only()) {
+        const google::protobuf::FieldDescriptor* field =
+            operand_type->FindFieldByName(expr.select_expr().field());
+        if (field != nullptr && !field->is_repeated()) {
+          type = field->message_type();
+        }
+      }
+      break;
+    }
+    case Expr::kCallExpr:
+      for (const Expr& arg : expr.call_expr().args()) {
+        AnnotateMessageTypes(arg, request_type, checked);
+      }
+      break;
+    default:
+      break;
+  }
+  if (type != nullptr) {
+    (*checked.mutable_type_map())[expr.id()].set_message_type(
+        type->full_name());
+  }
+  return type;
+}
+
+std::unique_ptr<CelExpression> MakeExpression(
+    absl::string_view expression, const google::protobuf::Descriptor* request_type,
+    SelectMode mode, CheckedExpr& checked) {
+  auto parsed_expr = parser::Parse(expression);
+  ABSL_CHECK_OK(parsed_expr.status());
+  *checked.mutable_expr() = parsed_expr->expr();
+  *checked.mutable_source_info() = parsed_expr->source_info();
+  AnnotateMessageTypes(checked.expr(), request_type, checked);
+
+  InterpreterOptions options;
+  options.enable_select_optimization = mode != SelectMode::kReflection;
+  auto builder = CreateCelExpressionBuilder(options);
+  ABSL_CHECK_OK(RegisterBuiltinFunctions(builder->GetRegistry(), options));
+  auto cel_expr = builder->CreateExpression(&checked);
+  ABSL_CHECK_OK(cel_expr.status());
+  return *std::move(cel_expr);
+}
+
+CelValue SelectNestedField(const RequestContext& request, google::protobuf::Arena*) {
+  return CelValue::CreateBool(request.a().b().c().d().e());
+}
+
+CelValue SelectAuthPrincipal(const AttributeContext::Request& request,
+                             google::protobuf::Arena*) {
+  return CelValue::CreateStringView(request.auth().principal());
+}
+
+// Registration is process wide, so the benchmarks using the registered
+// functions are registered after the ones that must not.
+void RegisterGeneratedSelects() {
+  static const bool kRegistered = [] {
+    auto& registry = GeneratedSelectRegistry::GetSingleton();
+    ABSL_CHECK_OK((registry.Register<RequestContext, &SelectNestedField>(
+        "a.b.c.d.e")));
+    ABSL_CHECK_OK(
+        (registry.Register<AttributeContext::Request, &SelectAuthPrincipal>(
+            "auth.principal")));
+    return true;
+  }();
+  static_cast<void>(kRegistered);
+}
+
+void RunBenchmark(benchmark::State& state, absl::string_view expression,
+                  const google::protobuf::Message& request, SelectMode mode) {
+  if (mode == SelectMode::kGenerated) {
+    RegisterGeneratedSelects();
+  }
+  google::protobuf::Arena arena;
+  CheckedExpr checked;
+  std::unique_ptr<CelExpression> cel_expr =
+      MakeExpression(expression, request.GetDescriptor(), mode, checked);
+  Activation activation;
+  activation.InsertValue("request",
+                         CelProtoWrapper::CreateMessage(&request, &arena));
+
+  for (auto _ : state) {
+    ASSERT_OK_AND_ASSIGN(CelValue result,
+                         cel_expr->Evaluate(activation, &arena));
+    ASSERT_TRUE(result.IsBool());
+    ASSERT_TRUE(result.BoolOrDie());
+  }
+}
+
+void RunNestedFieldRead(benchmark::State& state, SelectMode mode) {
+  RequestContext request;
+  request.mutable_a()->mutable_b()->mutable_c()->mutable_d()->set_e(false);
+  RunBenchmark(state, "!request.a.b.c.d.e", request, mode);
+}
+
+void RunAuthPrincipal(benchmark::State& state, SelectMode mode) {
+  AttributeContext::Request request;
+  request.mutable_auth()->set_principal("user:me@example.com");
+  RunBenchmark(state, "request.auth.principal == 'user:me@example.com'",
+               request, mode);
+}
+
+void BM_SelectNestedFieldReflection(benchmark::State& state) {
+  RunNestedFieldRead(state, SelectMode::kReflection);
+}
+
+void BM_SelectNestedFieldOptimized(benchmark::State& state) {
+  RunNestedFieldRead(state, SelectMode::kOptimized);
+}
+
+void BM_SelectAuthPrincipalReflection(benchmark::State& state) {
+  RunAuthPrincipal(state, SelectMode::kReflection);
+}
+
+void BM_SelectAuthPrincipalOptimized(benchmark::State& state) {
+  RunAuthPrincipal(state, SelectMode::kOptimized);
+}
+
+void BM_SelectNestedFieldGenerated(benchmark::State& state) {
+  RunNestedFieldRead(state, SelectMode::kGenerated);
+}
+
+void BM_SelectAuthPrincipalGenerated(benchmark::State& state) {
+  RunAuthPrincipal(state, SelectMode::kGenerated);
+}
+
+BENCHMARK(BM_SelectNestedFieldReflection);
+BENCHMARK(BM_SelectNestedFieldOptimized);
+BENCHMARK(BM_SelectAuthPrincipalReflection);
+BENCHMARK(BM_SelectAuthPrincipalOptimized);
+BENCHMARK(BM_SelectNestedFieldGenerated);
+BENCHMARK(BM_SelectAuthPrincipalGenerated);
+
+}  // namespace
+}  // namespace google::api::expr::runtime
@@ -0,0 +1,1052 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "extensions/protobuf/json_writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/struct.pb.h"
+#include "absl/base/nullability.h"
+#include "absl/base/optimization.h"
+#include "absl/functional/overload.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "absl/types/variant.h"
+#include "base/internal/message_wrapper.h"
+#include "common/any.h"
+#include "common/casting.h"
+#include "common/json.h"
+#include "common/value.h"
+#include "common/value_kind.h"
+#include "common/value_manager.h"
+#include "extensions/protobuf/internal/any.h"
+#include "extensions/protobuf/internal/duration.h"
+#include "extensions/protobuf/internal/field_mask.h"
+#include "extensions/protobuf/internal/map_reflection.h"
+#include "extensions/protobuf/internal/timestamp.h"
+#include "extensions/protobuf/internal/wrappers.h"
+#include "internal/status_macros.h"
+#include "internal/time.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/map_field.h"
+#include "google/protobuf/message.h"
+
+namespace cel::extensions {
+
+namespace {
+
+// Pieces at least this large bypass the buffer of `CordJsonSink`.
+constexpr size_t kCordJsonSinkBufferSize = 4096;
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+constexpr char kBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Appends the contents of a JSON string, escaping as required by RFC 8259.
+// Runs of characters which need no escaping are appended as is.
+void AppendEscaped(absl::string_view text, JsonSink& sink) {
+  size_t start = 0;
+  for (size_t index = 0; index < text.size(); ++index) {
+    const auto c = static_cast<unsigned char>(text[index]);
+    char unicode_escape[6];
+    absl::string_view escape;
+    switch (c) {
+      case '"':
+        escape = "\\\"";
+        break;
+      case '\\':
+        escape = "\\\\";
+        break;
+      case '\b':
+        escape = "\\b";
+        break;
+      case '\f':
+        escape = "\\f";
+        break;
+      case '\n':
+        escape = "\\n";
+        break;
+      case '\r':
+        escape = "\\r";
+        break;
+      case '\t':
+        escape = "\\t";
+        break;
+      default:
+        if (ABSL_PREDICT_TRUE(c >= 0x20)) {
+          continue;
+        }
+        unicode_escape[0] = '\\';
+        unicode_escape[1] = 'u';
+        unicode_escape[2] = '0';
+        unicode_escape[3] = '0';
+        unicode_escape[4] = kHexDigits[c >> 4];
+        unicode_escape[5] = kHexDigits[c & 0xf];
+        escape = absl::string_view(unicode_escape, sizeof(unicode_escape));
+        break;
+    }
+    if (index > start) {
+      sink.Append(text.substr(start, index - start));
+    }
+    sink.Append(escape);
+    start = index + 1;
+  }
+  if (start < text.size()) {
+    sink.Append(text.substr(start));
+  }
+}
+
+void AppendString(absl::string_view text, JsonSink& sink) {
+  sink.Append("\"");
+  AppendEscaped(text, sink);
+  sink.Append("\"");
+}
+
+void AppendString(const absl::Cord& text, JsonSink& sink) {
+  sink.Append("\"");
+  for (absl::string_view chunk : text.Chunks()) {
+    AppendEscaped(chunk, sink);
+  }
+  sink.Append("\"");
+}
+
+// Base64 encodes bytes into a fixed size buffer, so that `Cord` chunks can be
+// encoded without flattening them first.
+class Base64Writer final {
+ public:
+  explicit Base64Writer(JsonSink& sink) : sink_(sink) {}
+
+  void Append(absl::string_view bytes) {
+    for (char byte : bytes) {
+      pending_[pending_size_++] = static_cast<unsigned char>(byte);
+      if (pending_size_ == 3) {
+        EncodePending();
+      }
+    }
+  }
+
+  // Encodes the remaining bytes with padding and flushes the buffer.
+  void Finish() {
+    if (pending_size_ != 0) {
+      const size_t pending_size = pending_size_;
+      for (size_t index = pending_size; index < 3; ++index) {
+        pending_[index] = 0;
+      }
+      EncodePending();
+      for (size_t index = pending_size + 1; index < 4; ++index) {
+        buffer_[buffer_size_ - 4 + index] = '=';
+      }
+    }
+    Flush();
+  }
+
+ private:
+  void EncodePending() {
+    if (buffer_size_ + 4 > sizeof(buffer_)) {
+      Flush();
+    }
+    const uint32_t bits = (uint32_t{pending_[0]} << 16) |
+                          (uint32_t{pending_[1]} << 8) | pending_[2];
+    buffer_[buffer_size_++] = kBase64Chars[(bits >> 18) & 0x3f];
+    buffer_[buffer_size_++] = kBase64Chars[(bits >> 12) & 0x3f];
+    buffer_[buffer_size_++] = kBase64Chars[(bits >> 6) & 0x3f];
+    buffer_[buffer_size_++] = kBase64Chars[bits & 0x3f];
+    pending_size_ = 0;
+  }
+
+  void Flush() {
+    if (buffer_size_ != 0) {
+      sink_.Append(absl::string_view(buffer_, buffer_size_));
+      buffer_size_ = 0;
+    }
+  }
+
+  JsonSink& sink_;
+  unsigned char pending_[3];
+  size_t pending_size_ = 0;
+  char buffer_[256];
+  size_t buffer_size_ = 0;
+};
+
+void AppendBytes(absl::string_view bytes, JsonSink& sink) {
+  sink.Append("\"");
+  Base64Writer writer(sink);
+  writer.Append(bytes);
+  writer.Finish();
+  sink.Append("\"");
+}
+
+void AppendBytes(const absl::Cord& bytes, JsonSink& sink) {
+  sink.Append("\"");
+  Base64Writer writer(sink);
+  for (absl::string_view chunk : bytes.Chunks()) {
+    writer.Append(chunk);
+  }
+  writer.Finish();
+  sink.Append("\"");
+}
+
+void AppendBool(bool value, JsonSink& sink) {
+  sink.Append(value ? "true" : "false");
+}
+
+// Doubles are written with the fewest digits that round trip. Values without
+// a JSON number representation are written as strings, as in the proto3 JSON
+// mapping.
+void AppendDouble(double value, JsonSink& sink) {
+  if (std::isnan(value)) {
+    sink.Append("\"NaN\"");
+    return;
+  }
+  if (std::isinf(value)) {
+    sink.Append(value > 0 ? "\"Infinity\"" : "\"-Infinity\"");
+    return;
+  }
+  char buffer[32];
+  int size = absl::SNPrintF(buffer, sizeof(buffer), "%.15g", value);
+  double parsed;
+  if (!absl::SimpleAtod(absl::string_view(buffer, size), &parsed) ||
+      parsed != value) {
+    size = absl::SNPrintF(buffer, sizeof(buffer), "%.17g", value);
+  }
+  sink.Append(absl::string_view(buffer, size));
+}
+
+// Integers outside of the range exactly representable by a double are written
+// as strings, as by `cel::JsonInt`.
+void AppendInt(int64_t value, JsonSink& sink) {
+  const absl::AlphaNum digits(value);
+  if (value < kJsonMinInt || value > kJsonMaxInt) {
+    AppendString(digits.Piece(), sink);
+  } else {
+    sink.Append(digits.Piece());
+  }
+}
+
+// As `AppendInt`, but for `cel::JsonUint`.
+void AppendUint(uint64_t value, JsonSink& sink) {
+  const absl::AlphaNum digits(value);
+  if (value > kJsonMaxUint) {
+    AppendString(digits.Piece(), sink);
+  } else {
+    sink.Append(digits.Piece());
+  }
+}
+
+void AppendEnum(absl::Nonnull<const google::protobuf::EnumDescriptor*> descriptor,
+                int value, JsonSink& sink) {
+  if (descriptor->full_name() == "google.protobuf.NullValue") {
+    sink.Append("null");
+    return;
+  }
+  if (const auto* value_descriptor = descriptor->FindValueByNumber(value);
+      value_descriptor != nullptr && !value_descriptor->name().empty()) {
+    AppendString(value_descriptor->name(), sink);
+    return;
+  }
+  AppendInt(value, sink);
+}
+
+absl::Status AppendMessage(AnyToJsonConverter& converter,
+                           const google::protobuf::Message& message, JsonSink& sink);
+
+absl::Status AppendSingularField(
+    AnyToJsonConverter& converter, const google::protobuf::Message& message,
+    absl::Nonnull<const google::protobuf::Reflection*> reflection,
+    absl::Nonnull<const google::protobuf::FieldDescriptor*> field, JsonSink& sink) {
+  switch (field->cpp_type()) {
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+      AppendInt(reflection->GetInt32(message, field), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+      AppendInt(reflection->GetInt64(message, field), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+      AppendUint(reflection->GetUInt32(message, field), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+      AppendUint(reflection->GetUInt64(message, field), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+      AppendDouble(reflection->GetDouble(message, field), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+      AppendDouble(static_cast<double>(reflection->GetFloat(message, field)),
+                   sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+      AppendBool(reflection->GetBool(message, field), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
+      AppendEnum(field->enum_type(), reflection->GetEnumValue(message, field),
+                 sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_STRING: {
+      std::string scratch;
+      const auto& value =
+          reflection->GetStringReference(message, field, &scratch);
+      if (field->type() == google::protobuf::FieldDescriptor::TYPE_BYTES) {
+        AppendBytes(value, sink);
+      } else {
+        AppendString(value, sink);
+      }
+      return absl::OkStatus();
+    }
+    case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+      return AppendMessage(converter, reflection->GetMessage(message, field),
+                           sink);
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "unexpected protocol buffer field type: ",
+          google::protobuf::FieldDescriptor::CppTypeName(field->cpp_type())));
+  }
+}
+
+absl::Status AppendRepeatedField(
+    AnyToJsonConverter& converter, const google::protobuf::Message& message,
+    absl::Nonnull<const google::protobuf::Reflection*> reflection,
+    absl::Nonnull<const google::protobuf::FieldDescriptor*> field, JsonSink& sink) {
+  const int field_size = reflection->FieldSize(message, field);
+  std::string scratch;
+  sink.Append("[");
+  for (int field_index = 0; field_index < field_size; ++field_index) {
+    if (field_index != 0) {
+      sink.Append(",");
+    }
+    switch (field->cpp_type()) {
+      case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+        AppendInt(reflection->GetRepeatedInt32(message, field, field_index),
+                  sink);
+        break;
+      case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+        AppendInt(reflection->GetRepeatedInt64(message, field, field_index),
+                  sink);
+        break;
+      case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+        AppendUint(reflection->GetRepeatedUInt32(message, field, field_index),
+                   sink);
+        break;
+      case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+        AppendUint(reflection->GetRepeatedUInt64(message, field, field_index),
+                   sink);
+        break;
+      case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+        AppendDouble(reflection->GetRepeatedDouble(message, field, field_index),
+                     sink);
+        break;
+      case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+        AppendDouble(static_cast<double>(reflection->GetRepeatedFloat(
+                         message, field, field_index)),
+                     sink);
+        break;
+      case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+        AppendBool(reflection->GetRepeatedBool(message, field, field_index),
+                   sink);
+        break;
+      case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
+        AppendEnum(
+            field->enum_type(),
+            reflection->GetRepeatedEnumValue(message, field, field_index),
+            sink);
+        break;
+      case google::protobuf::FieldDescriptor::CPPTYPE_STRING: {
+        const auto& value = reflection->GetRepeatedStringReference(
+            message, field, field_index, &scratch);
+        if (field->type() == google::protobuf::FieldDescriptor::TYPE_BYTES) {
+          AppendBytes(value, sink);
+        } else {
+          AppendString(value, sink);
+        }
+        break;
+      }
+      case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+        CEL_RETURN_IF_ERROR(AppendMessage(
+            converter,
+            reflection->GetRepeatedMessage(message, field, field_index), sink));
+        break;
+      default:
+        return absl::InvalidArgumentError(absl::StrCat(
+            "unexpected protocol buffer field type: ",
+            google::protobuf::FieldDescriptor::CppTypeName(field->cpp_type())));
+    }
+  }
+  sink.Append("]");
+  return absl::OkStatus();
+}
+
+absl::Status AppendMapKey(const google::protobuf::MapKey& key, JsonSink& sink) {
+  switch (key.type()) {
+    case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+      sink.Append(key.GetBoolValue() ? "\"true\"" : "\"false\"");
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+      AppendString(absl::AlphaNum(key.GetInt32Value()).Piece(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+      AppendString(absl::AlphaNum(key.GetInt64Value()).Piece(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+      AppendString(absl::AlphaNum(key.GetUInt32Value()).Piece(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+      AppendString(absl::AlphaNum(key.GetUInt64Value()).Piece(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
+      AppendString(key.GetStringValue(), sink);
+      return absl::OkStatus();
+    default:
+      return absl::InternalError(
+          absl::StrCat("unexpected protocol buffer map key type: ",
+                       google::protobuf::FieldDescriptor::CppTypeName(key.type())));
+  }
+}
+
+absl::Status AppendMapValue(
+    AnyToJsonConverter& converter,
+    absl::Nonnull<const google::protobuf::FieldDescriptor*> field,
+    const google::protobuf::MapValueRef& value, JsonSink& sink) {
+  switch (field->cpp_type()) {
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT32:
+      AppendInt(value.GetInt32Value(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_INT64:
+      AppendInt(value.GetInt64Value(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT32:
+      AppendUint(value.GetUInt32Value(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_UINT64:
+      AppendUint(value.GetUInt64Value(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+      AppendDouble(value.GetDoubleValue(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+      AppendDouble(static_cast<double>(value.GetFloatValue()), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_BOOL:
+      AppendBool(value.GetBoolValue(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_ENUM:
+      AppendEnum(field->enum_type(), value.GetEnumValue(), sink);
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_STRING:
+      if (field->type() == google::protobuf::FieldDescriptor::TYPE_BYTES) {
+        AppendBytes(value.GetStringValue(), sink);
+      } else {
+        AppendString(value.GetStringValue(), sink);
+      }
+      return absl::OkStatus();
+    case google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+      return AppendMessage(converter, value.GetMessageValue(), sink);
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "unexpected protocol buffer field type: ",
+          google::protobuf::FieldDescriptor::CppTypeName(field->cpp_type())));
+  }
+}
+
+absl::Status AppendMapField(
+    AnyToJsonConverter& converter, const google::protobuf::Message& message,
+    absl::Nonnull<const google::protobuf::Reflection*> reflection,
+    absl::Nonnull<const google::protobuf::FieldDescriptor*> field, JsonSink& sink) {
+  const auto* value_field = field->message_type()->map_value();
+  auto begin = protobuf_internal::MapBegin(*reflection, message, *field);
+  const auto end = protobuf_internal::MapEnd(*reflection, message, *field);
+  sink.Append("{");
+  for (bool first = true; begin != end; ++begin, first = false) {
+    if (!first) {
+      sink.Append(",");
+    }
+    CEL_RETURN_IF_ERROR(AppendMapKey(begin.GetKey(), sink));
+    sink.Append(":");
+    CEL_RETURN_IF_ERROR(
+        AppendMapValue(converter, value_field, begin.GetValueRef(), sink));
+  }
+  sink.Append("}");
+  return absl::OkStatus();
+}
+
+absl::Status AppendField(
+    AnyToJsonConverter& converter, const google::protobuf::Message& message,
+    absl::Nonnull<const google::protobuf::Reflection*> reflection,
+    absl::Nonnull<const google::protobuf::FieldDescriptor*> field, JsonSink& sink) {
+  if (field->is_map()) {
+    return AppendMapField(converter, message, reflection, field, sink);
+  }
+  if (field->is_repeated()) {
+    return AppendRepeatedField(converter, message, reflection, field, sink);
+  }
+  return AppendSingularField(converter, message, reflection, field, sink);
+}
+
+absl::Status CheckStructField(
+    absl::Nullable<const google::protobuf::FieldDescriptor*> field,
+    google::protobuf::FieldDescriptor::CppType cpp_type, bool repeated) {
+  if (ABSL_PREDICT_FALSE(field == nullptr || field->cpp_type() != cpp_type ||
+                         field->is_repeated() != repeated)) {
+    return absl::InvalidArgumentError(
+        "unexpected descriptor for protocol buffer JSON well known type");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status AppendStructProto(const google::protobuf::Message& message,
+                               JsonSink& sink);
+
+absl::Status AppendListValueProto(const google::protobuf::Message& message,
+                                  JsonSink& sink);
+
+// Writes `google.protobuf.Value`, which is its own JSON representation.
+absl::Status AppendValueProto(const google::protobuf::Message& message,
+                              JsonSink& sink) {
+  const auto* descriptor = message.GetDescriptor();
+  const auto* reflection = message.GetReflection();
+  const auto* kind = descriptor->FindOneofByName("kind");
+  if (ABSL_PREDICT_FALSE(kind == nullptr)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("`", descriptor->full_name(),
+                     "` is missing oneof `kind`"));
+  }
+  const auto* field = reflection->GetOneofFieldDescriptor(message, kind);
+  if (field == nullptr) {
+    sink.Append("null");
+    return absl::OkStatus();
+  }
+  switch (field->number()) {
+    case google::protobuf::Value::kNullValueFieldNumber:
+      sink.Append("null");
+      return absl::OkStatus();
+    case google::protobuf::Value::kNumberValueFieldNumber:
+      CEL_RETURN_IF_ERROR(CheckStructField(
+          field, google::protobuf::FieldDescriptor::CPPTYPE_DOUBLE, false));
+      AppendDouble(reflection->GetDouble(message, field), sink);
+      return absl::OkStatus();
+    case google::protobuf::Value::kStringValueFieldNumber: {
+      CEL_RETURN_IF_ERROR(CheckStructField(
+          field, google::protobuf::FieldDescriptor::CPPTYPE_STRING, false));
+      std::string scratch;
+      AppendString(reflection->GetStringReference(message, field, &scratch),
+                   sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Value::kBoolValueFieldNumber:
+      CEL_RETURN_IF_ERROR(CheckStructField(
+          field, google::protobuf::FieldDescriptor::CPPTYPE_BOOL, false));
+      AppendBool(reflection->GetBool(message, field), sink);
+      return absl::OkStatus();
+    case google::protobuf::Value::kStructValueFieldNumber:
+      CEL_RETURN_IF_ERROR(CheckStructField(
+          field, google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE, false));
+      return AppendStructProto(reflection->GetMessage(message, field), sink);
+    case google::protobuf::Value::kListValueFieldNumber:
+      CEL_RETURN_IF_ERROR(CheckStructField(
+          field, google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE, false));
+      return AppendListValueProto(reflection->GetMessage(message, field), sink);
+    default:
+      return absl::InternalError(absl::StrCat(
+          field->full_name(), " has unexpected number: ", field->number()));
+  }
+}
+
+absl::Status AppendStructProto(const google::protobuf::Message& message,
+                               JsonSink& sink) {
+  const auto* reflection = message.GetReflection();
+  const auto* fields = message.GetDescriptor()->FindFieldByNumber(
+      google::protobuf::Struct::kFieldsFieldNumber);
+  CEL_RETURN_IF_ERROR(CheckStructField(
+      fields, google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE, true));
+  if (ABSL_PREDICT_FALSE(!fields->is_map())) {
+    return absl::InvalidArgumentError(
+        "unexpected descriptor for protocol buffer JSON well known type");
+  }
+  auto begin = protobuf_internal::MapBegin(*reflection, message, *fields);
+  const auto end = protobuf_internal::MapEnd(*reflection, message, *fields);
+  sink.Append("{");
+  for (bool first = true; begin != end; ++begin, first = false) {
+    if (!first) {
+      sink.Append(",");
+    }
+    AppendString(begin.GetKey().GetStringValue(), sink);
+    sink.Append(":");
+    CEL_RETURN_IF_ERROR(
+        AppendValueProto(begin.GetValueRef().GetMessageValue(), sink));
+  }
+  sink.Append("}");
+  return absl::OkStatus();
+}
+
+absl::Status AppendListValueProto(const google::protobuf::Message& message,
+                                  JsonSink& sink) {
+  const auto* reflection = message.GetReflection();
+  const auto* values = message.GetDescriptor()->FindFieldByNumber(
+      google::protobuf::ListValue::kValuesFieldNumber);
+  CEL_RETURN_IF_ERROR(CheckStructField(
+      values, google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE, true));
+  const int size = reflection->FieldSize(message, values);
+  sink.Append("[");
+  for (int index = 0; index < size; ++index) {
+    if (index != 0) {
+      sink.Append(",");
+    }
+    CEL_RETURN_IF_ERROR(AppendValueProto(
+        reflection->GetRepeatedMessage(message, values, index), sink));
+  }
+  sink.Append("]");
+  return absl::OkStatus();
+}
+
+bool IsWellKnownJsonType(const google::protobuf::Descriptor& descriptor) {
+  return descriptor.well_known_type() !=
+             google::protobuf::Descriptor::WELLKNOWNTYPE_UNSPECIFIED ||
+         descriptor.full_name() == "google.protobuf.Empty";
+}
+
+// Writes `google.protobuf.Any` as an object with `@type`. Well known types
+// are written under `value`, other types have their fields inlined.
+absl::Status AppendAnyProto(AnyToJsonConverter& converter,
+                            const google::protobuf::Message& message, JsonSink& sink) {
+  CEL_ASSIGN_OR_RETURN(auto any,
+                       protobuf_internal::UnwrapDynamicAnyProto(message));
+  absl::string_view type_name;
+  if (!ParseTypeUrl(any.type_url(), &type_name)) {
+    return absl::InvalidArgumentError(
+        "invalid `google.protobuf.Any` field `type_url`");
+  }
+  if (type_name == "google.protobuf.Any") {
+    // Any in an any. Get out.
+    return absl::InvalidArgumentError(
+        "refusing to convert recursive `google.protobuf.Any` to JSON");
+  }
+  const auto* descriptor =
+      google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+          type_name);
+  if (descriptor != nullptr && IsWellKnownJsonType(*descriptor)) {
+    std::unique_ptr<google::protobuf::Message> value(
+        google::protobuf::MessageFactory::generated_factory()
+            ->GetPrototype(descriptor)
+            ->New());
+    if (!value->ParseFromCord(any.value())) {
+      return absl::UnknownError(
+          absl::StrCat("failed to parse `", value->GetTypeName(), "`"));
+    }
+    sink.Append("{\"@type\":");
+    AppendString(any.type_url(), sink);
+    sink.Append(",\"value\":");
+    CEL_RETURN_IF_ERROR(AppendMessage(converter, *value, sink));
+    sink.Append("}");
+    return absl::OkStatus();
+  }
+  CEL_ASSIGN_OR_RETURN(auto json,
+                       converter.ConvertToJson(any.type_url(), any.value()));
+  if (!absl::holds_alternative<JsonObject>(json)) {
+    return absl::InternalError("expected JSON object");
+  }
+  sink.Append("{\"@type\":");
+  AppendString(any.type_url(), sink);
+  for (const auto& entry : absl::get<JsonObject>(json)) {
+    if (entry.first == "@type") {
+      continue;
+    }
+    sink.Append(",");
+    AppendString(entry.first, sink);
+    sink.Append(":");
+    JsonToJsonText(entry.second, sink);
+  }
+  sink.Append("}");
+  return absl::OkStatus();
+}
+
+absl::Status AppendMessage(AnyToJsonConverter& converter,
+                           const google::protobuf::Message& message, JsonSink& sink) {
+  const auto* descriptor = message.GetDescriptor();
+  if (ABSL_PREDICT_FALSE(descriptor == nullptr)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("`", message.GetTypeName(), "` is missing descriptor"));
+  }
+  const auto* reflection = message.GetReflection();
+  if (ABSL_PREDICT_FALSE(reflection == nullptr)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("`", message.GetTypeName(), "` is missing reflection"));
+  }
+  switch (descriptor->well_known_type()) {
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_DOUBLEVALUE: {
+      CEL_ASSIGN_OR_RETURN(auto value,
+                           protobuf_internal::UnwrapDynamicDoubleValueProto(
+                               message));
+      AppendDouble(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_FLOATVALUE: {
+      CEL_ASSIGN_OR_RETURN(
+          auto value, protobuf_internal::UnwrapDynamicFloatValueProto(message));
+      AppendDouble(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_INT64VALUE: {
+      CEL_ASSIGN_OR_RETURN(
+          auto value, protobuf_internal::UnwrapDynamicInt64ValueProto(message));
+      AppendInt(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_UINT64VALUE: {
+      CEL_ASSIGN_OR_RETURN(auto value,
+                           protobuf_internal::UnwrapDynamicUInt64ValueProto(
+                               message));
+      AppendUint(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_INT32VALUE: {
+      CEL_ASSIGN_OR_RETURN(
+          auto value, protobuf_internal::UnwrapDynamicInt32ValueProto(message));
+      AppendInt(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_UINT32VALUE: {
+      CEL_ASSIGN_OR_RETURN(auto value,
+                           protobuf_internal::UnwrapDynamicUInt32ValueProto(
+                               message));
+      AppendUint(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_STRINGVALUE: {
+      CEL_ASSIGN_OR_RETURN(auto value,
+                           protobuf_internal::UnwrapDynamicStringValueProto(
+                               message));
+      AppendString(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_BYTESVALUE: {
+      CEL_ASSIGN_OR_RETURN(
+          auto value, protobuf_internal::UnwrapDynamicBytesValueProto(message));
+      AppendBytes(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_BOOLVALUE: {
+      CEL_ASSIGN_OR_RETURN(
+          auto value, protobuf_internal::UnwrapDynamicBoolValueProto(message));
+      AppendBool(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_ANY:
+      return AppendAnyProto(converter, message, sink);
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_FIELDMASK: {
+      CEL_ASSIGN_OR_RETURN(
+          auto value,
+          protobuf_internal::DynamicFieldMaskProtoToJsonString(message));
+      AppendString(value, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_DURATION: {
+      CEL_ASSIGN_OR_RETURN(
+          auto value, protobuf_internal::UnwrapDynamicDurationProto(message));
+      CEL_ASSIGN_OR_RETURN(auto json, internal::EncodeDurationToJson(value));
+      AppendString(json, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_TIMESTAMP: {
+      CEL_ASSIGN_OR_RETURN(
+          auto value, protobuf_internal::UnwrapDynamicTimestampProto(message));
+      CEL_ASSIGN_OR_RETURN(auto json, internal::EncodeTimestampToJson(value));
+      AppendString(json, sink);
+      return absl::OkStatus();
+    }
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_VALUE:
+      return AppendValueProto(message, sink);
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_LISTVALUE:
+      return AppendListValueProto(message, sink);
+    case google::protobuf::Descriptor::WELLKNOWNTYPE_STRUCT:
+      return AppendStructProto(message, sink);
+    default:
+      break;
+  }
+  if (descriptor->full_name() == "google.protobuf.Empty") {
+    sink.Append("{}");
+    return absl::OkStatus();
+  }
+  std::vector<const google::protobuf::FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+  sink.Append("{");
+  for (size_t index = 0; index < fields.size(); ++index) {
+    if (index != 0) {
+      sink.Append(",");
+    }
+    AppendString(fields[index]->json_name(), sink);
+    sink.Append(":");
+    CEL_RETURN_IF_ERROR(
+        AppendField(converter, message, reflection, fields[index], sink));
+  }
+  sink.Append("}");
+  return absl::OkStatus();
+}
+
+// Returns the message backing `value`, if it is a legacy struct value over a
+// full protocol buffer message.
+absl::Nullable<const google::protobuf::Message*> AsProtoMessage(ValueView value) {
+  auto legacy_value = As<common_internal::LegacyStructValueView>(value);
+  if (!legacy_value.has_value() ||
+      (legacy_value->message_ptr() & base_internal::kMessageWrapperTagMask) !=
+          base_internal::kMessageWrapperTagMessageValue) {
+    return nullptr;
+  }
+  return static_cast<const google::protobuf::Message*>(
+      reinterpret_cast<const google::protobuf::MessageLite*>(
+          legacy_value->message_ptr() & base_internal::kMessageWrapperPtrMask));
+}
+
+// Whether the keys of `map` can be written as JSON member names as they are
+// visited. Keys of different kinds may name the same member, e.g. `1` and
+// `1u`, which `ConvertToJson` has to reject.
+absl::StatusOr<bool> HasUniformJsonKeys(ValueManager& value_manager,
+                                        MapValueView map) {
+  if (map.Size() < 2) {
+    return true;
+  }
+  absl::optional<ValueKind> key_kind;
+  bool uniform = true;
+  CEL_RETURN_IF_ERROR(map.ForEach(
+      value_manager,
+      [&key_kind, &uniform](ValueView key, ValueView) -> absl::StatusOr<bool> {
+        if (!key_kind.has_value()) {
+          key_kind = key.kind();
+        }
+        uniform = key.kind() == *key_kind;
+        return uniform;
+      }));
+  return uniform;
+}
+
+absl::Status AppendMapKey(ValueView key, JsonSink& sink) {
+  switch (key.kind()) {
+    case ValueKind::kBool:
+      sink.Append(Cast<BoolValueView>(key).NativeValue() ? "\"true\""
+                                                         : "\"false\"");
+      return absl::OkStatus();
+    case ValueKind::kInt:
+      AppendString(
+          absl::AlphaNum(Cast<IntValueView>(key).NativeValue()).Piece(), sink);
+      return absl::OkStatus();
+    case ValueKind::kUint:
+      AppendString(
+          absl::AlphaNum(Cast<UintValueView>(key).NativeValue()).Piece(),
+          sink);
+      return absl::OkStatus();
+    case ValueKind::kString:
+      Cast<StringValueView>(key).NativeValue(
+          [&sink](const auto& text) { AppendString(text, sink); });
+      return absl::OkStatus();
+    default:
+      return absl::FailedPreconditionError(absl::StrCat(
+          ValueKindToString(key.kind()),
+          " is unserializable to JSON object member name"));
+  }
+}
+
+absl::Status AppendValue(ValueManager& value_manager, ValueView value,
+                         JsonSink& sink) {
+  switch (value.kind()) {
+    case ValueKind::kNull:
+      sink.Append("null");
+      return absl::OkStatus();
+    case ValueKind::kBool:
+      AppendBool(Cast<BoolValueView>(value).NativeValue(), sink);
+      return absl::OkStatus();
+    case ValueKind::kInt:
+      AppendInt(Cast<IntValueView>(value).NativeValue(), sink);
+      return absl::OkStatus();
+    case ValueKind::kUint:
+      AppendUint(Cast<UintValueView>(value).NativeValue(), sink);
+      return absl::OkStatus();
+    case ValueKind::kDouble:
+      AppendDouble(Cast<DoubleValueView>(value).NativeValue(), sink);
+      return absl::OkStatus();
+    case ValueKind::kString:
+      Cast<StringValueView>(value).NativeValue(
+          [&sink](const auto& text) { AppendString(text, sink); });
+      return absl::OkStatus();
+    case ValueKind::kBytes:
+      Cast<BytesValueView>(value).NativeValue(
+          [&sink](const auto& bytes) { AppendBytes(bytes, sink); });
+      return absl::OkStatus();
+    case ValueKind::kDuration: {
+      CEL_ASSIGN_OR_RETURN(auto json,
+                           internal::EncodeDurationToJson(
+                               Cast<DurationValueView>(value).NativeValue()));
+      AppendString(json, sink);
+      return absl::OkStatus();
+    }
+    case ValueKind::kTimestamp: {
+      CEL_ASSIGN_OR_RETURN(auto json,
+                           internal::EncodeTimestampToJson(
+                               Cast<TimestampValueView>(value).NativeValue()));
+      AppendString(json, sink);
+      return absl::OkStatus();
+    }
+    case ValueKind::kList: {
+      bool first = true;
+      sink.Append("[");
+      CEL_RETURN_IF_ERROR(Cast<ListValueView>(value).ForEach(
+          value_manager,
+          [&](ValueView element) -> absl::StatusOr<bool> {
+            if (!first) {
+              sink.Append(",");
+            }
+            first = false;
+            CEL_RETURN_IF_ERROR(AppendValue(value_manager, element, sink));
+            return true;
+          }));
+      sink.Append("]");
+      return absl::OkStatus();
+    }
+    case ValueKind::kMap: {
+      auto map = Cast<MapValueView>(value);
+      CEL_ASSIGN_OR_RETURN(auto uniform_keys,
+                           HasUniformJsonKeys(value_manager, map));
+      if (!uniform_keys) {
+        break;
+      }
+      bool first = true;
+      sink.Append("{");
+      CEL_RETURN_IF_ERROR(map.ForEach(
+          value_manager,
+          [&](ValueView key, ValueView entry) -> absl::StatusOr<bool> {
+            if (!first) {
+              sink.Append(",");
+            }
+            first = false;
+            CEL_RETURN_IF_ERROR(AppendMapKey(key, sink));
+            sink.Append(":");
+            CEL_RETURN_IF_ERROR(AppendValue(value_manager, entry, sink));
+            return true;
+          }));
+      sink.Append("}");
+      return absl::OkStatus();
+    }
+    case ValueKind::kStruct:
+      if (const auto* message = AsProtoMessage(value); message != nullptr) {
+        return AppendMessage(value_manager, *message, sink);
+      }
+      break;
+    default:
+      break;
+  }
+  // Everything else goes through `Json`, which also produces the error for
+  // values which have no JSON representation.
+  CEL_ASSIGN_OR_RETURN(auto json, value.ConvertToJson(value_manager));
+  JsonToJsonText(json, sink);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+void CordJsonSink::Append(absl::string_view text) {
+  if (text.size() >= kCordJsonSinkBufferSize) {
+    Flush();
+    output_.Append(text);
+    return;
+  }
+  while (!text.empty()) {
+    absl::Span<char> available = buffer_.available();
+    if (available.empty()) {
+      Flush();
+      buffer_ =
+          absl::CordBuffer::CreateWithDefaultLimit(kCordJsonSinkBufferSize);
+      available = buffer_.available();
+    }
+    const size_t size = std::min(available.size(), text.size());
+    std::memcpy(available.data(), text.data(), size);
+    buffer_.IncreaseLengthBy(size);
+    text.remove_prefix(size);
+  }
+}
+
+void CordJsonSink::Flush() {
+  if (buffer_.length() != 0) {
+    output_.Append(std::move(buffer_));
+    buffer_ = absl::CordBuffer();
+  }
+}
+
+void BufferJsonSink::Append(absl::string_view text) {
+  if (size_ < buffer_.size()) {
+    std::memcpy(buffer_.data() + size_, text.data(),
+                std::min(text.size(), buffer_.size() - size_));
+  }
+  size_ += text.size();
+}
+
+absl::Status ValueToJsonText(ValueManager& value_manager, ValueView value,
+                             JsonSink& sink) {
+  return AppendValue(value_manager, value, sink);
+}
+
+absl::Status ProtoMessageToJsonText(AnyToJsonConverter& converter,
+                                    const google::protobuf::Message& message,
+                                    JsonSink& sink) {
+  return AppendMessage(converter, message, sink);
+}
+
+void JsonToJsonText(const Json& json, JsonSink& sink) {
+  absl::visit(
+      absl::Overload(
+          [&sink](JsonNull) { sink.Append("null"); },
+          [&sink](JsonBool value) { AppendBool(value, sink); },
+          [&sink](JsonNumber value) { AppendDouble(value, sink); },
+          [&sink](const JsonString& value) { AppendString(value, sink); },
+          [&sink](const JsonArray& value) {
+            sink.Append("[");
+            bool first = true;
+            for (const auto& element : value) {
+              if (!first) {
+                sink.Append(",");
+              }
+              first = false;
+              JsonToJsonText(element, sink);
+            }
+            sink.Append("]");
+          },
+          [&sink](const JsonObject& value) {
+            sink.Append("{");
+            bool first = true;
+            for (const auto& entry : value) {
+              if (!first) {
+                sink.Append(",");
+              }
+              first = false;
+              AppendString(entry.first, sink);
+              sink.Append(":");
+              JsonToJsonText(entry.second, sink);
+            }
+            sink.Append("}");
+          }),
+      json);
+}
+
+}  // namespace cel::extensions
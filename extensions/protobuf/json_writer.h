@@ -0,0 +1,113 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This header exposes utilities for writing `cel::Value` and
+// `google::protobuf::Message` as JSON text, without first building `Json`.
+
+#ifndef THIRD_PARTY_CEL_CPP_EXTENSIONS_PROTOBUF_JSON_WRITER_H_
+#define THIRD_PARTY_CEL_CPP_EXTENSIONS_PROTOBUF_JSON_WRITER_H_
+
+#include <cstddef>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/cord_buffer.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "common/json.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "google/protobuf/message.h"
+
+namespace cel::extensions {
+
+// `JsonSink` receives the JSON text produced by the functions below, in
+// order. If writing fails part way through, the text already appended is
+// incomplete.
+class JsonSink {
+ public:
+  virtual ~JsonSink() = default;
+
+  virtual void Append(absl::string_view text) = 0;
+};
+
+// `CordJsonSink` appends JSON text to an `absl::Cord`, filling whole
+// `absl::CordBuffer`s instead of appending each piece. The text is only
+// guaranteed to be in the cord after `Flush()` or destruction.
+class CordJsonSink final : public JsonSink {
+ public:
+  explicit CordJsonSink(absl::Cord& output) : output_(output) {}
+
+  CordJsonSink(const CordJsonSink&) = delete;
+  CordJsonSink& operator=(const CordJsonSink&) = delete;
+
+  ~CordJsonSink() override { Flush(); }
+
+  void Append(absl::string_view text) override;
+
+  void Flush();
+
+ private:
+  absl::Cord& output_;
+  absl::CordBuffer buffer_;
+};
+
+// `BufferJsonSink` writes JSON text into a caller provided buffer. Text which
+// does not fit is dropped and `overflow()` becomes true; `size()` is still the
+// size the full text would have needed.
+class BufferJsonSink final : public JsonSink {
+ public:
+  explicit BufferJsonSink(absl::Span<char> buffer) : buffer_(buffer) {}
+
+  BufferJsonSink(const BufferJsonSink&) = delete;
+  BufferJsonSink& operator=(const BufferJsonSink&) = delete;
+
+  void Append(absl::string_view text) override;
+
+  size_t size() const { return size_; }
+
+  bool overflow() const { return size_ > buffer_.size(); }
+
+  // Returns the text written so far. Only complete if `!overflow()`.
+  absl::string_view text() const {
+    return absl::string_view(buffer_.data(),
+                             size_ < buffer_.size() ? size_ : buffer_.size());
+  }
+
+ private:
+  absl::Span<char> buffer_;
+  size_t size_ = 0;
+};
+
+// Writes `value` to `sink` as JSON text, following the same mapping as
+// `ValueInterface::ConvertToJson`. Messages are written with
+// `ProtoMessageToJsonText` when the value is backed by one. Values without a
+// JSON representation fail with the same error as `ConvertToJson`.
+absl::Status ValueToJsonText(ValueManager& value_manager, ValueView value,
+                             JsonSink& sink);
+
+// Writes `message` to `sink` as JSON text, following the proto3 JSON mapping
+// as implemented by `protobuf_internal::ProtoMessageToJson`. Fields are
+// written in field number order. `converter` is used for
+// `google.protobuf.Any` holding types other than the well known types.
+absl::Status ProtoMessageToJsonText(AnyToJsonConverter& converter,
+                                    const google::protobuf::Message& message,
+                                    JsonSink& sink);
+
+// Writes `json` to `sink` as JSON text.
+void JsonToJsonText(const Json& json, JsonSink& sink);
+
+}  // namespace cel::extensions
+
+#endif  // THIRD_PARTY_CEL_CPP_EXTENSIONS_PROTOBUF_JSON_WRITER_H_
@@ -0,0 +1,191 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks writing JSON text for messages and values with `state.range(0)`
+// elements, either by building `Json` first or by streaming into a sink.
+// Throughput is reported in bytes of JSON text.
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "base/type_provider.h"
+#include "common/json.h"
+#include "common/value.h"
+#include "common/values/legacy_value_manager.h"
+#include "extensions/protobuf/internal/json.h"
+#include "extensions/protobuf/json.h"
+#include "extensions/protobuf/json_writer.h"
+#include "extensions/protobuf/memory_manager.h"
+#include "internal/benchmark.h"
+#include "internal/testing.h"
+#include "proto/test/v1/proto3/test_all_types.pb.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::google::api::expr::test::v1::proto3::TestAllTypes;
+
+TestAllTypes MakeMessage(int size) {
+  TestAllTypes message;
+  message.set_single_int64(-42);
+  message.set_single_string("a string with a \"quote\"");
+  for (int i = 0; i < size; ++i) {
+    message.add_repeated_int64(i);
+    message.add_repeated_double(i * 0.5);
+    message.add_repeated_string(absl::StrCat("element-", i));
+    auto* nested = message.add_repeated_nested_message();
+    nested->set_bb(i);
+    (*message.mutable_map_string_string())[absl::StrCat("key-", i)] =
+        absl::StrCat("value-", i);
+  }
+  return message;
+}
+
+void BM_ProtoMessageToJsonTree(benchmark::State& state) {
+  ProtoAnyToJsonConverter converter(
+      google::protobuf::DescriptorPool::generated_pool(),
+      google::protobuf::MessageFactory::generated_factory());
+  const TestAllTypes message = MakeMessage(state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    auto json = protobuf_internal::ProtoMessageToJson(converter, message);
+    ABSL_CHECK_OK(json.status());
+    absl::Cord output;
+    {
+      CordJsonSink sink(output);
+      JsonToJsonText(*json, sink);
+    }
+    bytes += output.size();
+    benchmark::DoNotOptimize(output);
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+void BM_ProtoMessageToJsonTextCord(benchmark::State& state) {
+  ProtoAnyToJsonConverter converter(
+      google::protobuf::DescriptorPool::generated_pool(),
+      google::protobuf::MessageFactory::generated_factory());
+  const TestAllTypes message = MakeMessage(state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    absl::Cord output;
+    {
+      CordJsonSink sink(output);
+      ABSL_CHECK_OK(ProtoMessageToJsonText(converter, message, sink));
+    }
+    bytes += output.size();
+    benchmark::DoNotOptimize(output);
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+void BM_ProtoMessageToJsonTextBuffer(benchmark::State& state) {
+  ProtoAnyToJsonConverter converter(
+      google::protobuf::DescriptorPool::generated_pool(),
+      google::protobuf::MessageFactory::generated_factory());
+  const TestAllTypes message = MakeMessage(state.range(0));
+  std::vector<char> buffer(1 << 20);
+  size_t bytes = 0;
+  for (auto _ : state) {
+    BufferJsonSink sink(absl::MakeSpan(buffer));
+    ABSL_CHECK_OK(ProtoMessageToJsonText(converter, message, sink));
+    ABSL_CHECK(!sink.overflow());
+    bytes += sink.size();
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_ProtoMessageToJsonTree)->Range(1, 4096);
+BENCHMARK(BM_ProtoMessageToJsonTextCord)->Range(1, 4096);
+BENCHMARK(BM_ProtoMessageToJsonTextBuffer)->Range(1, 4096);
+
+// A list of `size` maps, as produced by expressions such as
+// `items.map(i, {'id': i.id, 'name': i.name, 'scores': i.scores})`.
+Value MakeValue(ValueManager& value_manager, int size) {
+  auto list_builder =
+      value_manager.NewListValueBuilder(value_manager.GetDynListType());
+  ABSL_CHECK_OK(list_builder.status());
+  for (int i = 0; i < size; ++i) {
+    auto scores_builder =
+        value_manager.NewListValueBuilder(value_manager.GetDynListType());
+    ABSL_CHECK_OK(scores_builder.status());
+    for (int j = 0; j < 4; ++j) {
+      ABSL_CHECK_OK((*scores_builder)->Add(DoubleValue(i * 0.25 + j)));
+    }
+    auto map_builder =
+        value_manager.NewMapValueBuilder(value_manager.GetDynDynMapType());
+    ABSL_CHECK_OK(map_builder.status());
+    ABSL_CHECK_OK((*map_builder)->Put(StringValue("id"), IntValue(i)));
+    ABSL_CHECK_OK((*map_builder)->Put(
+        StringValue("name"), StringValue(absl::StrCat("item-", i))));
+    ABSL_CHECK_OK((*map_builder)->Put(StringValue("scores"),
+                                      std::move(**scores_builder).Build()));
+    ABSL_CHECK_OK((*list_builder)->Add(std::move(**map_builder).Build()));
+  }
+  return std::move(**list_builder).Build();
+}
+
+void BM_ValueToJsonTree(benchmark::State& state) {
+  google::protobuf::Arena arena;
+  common_internal::LegacyValueManager value_manager(
+      ProtoMemoryManagerRef(&arena), TypeProvider::Builtin());
+  const Value value = MakeValue(value_manager, state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    auto json = value.ConvertToJson(value_manager);
+    ABSL_CHECK_OK(json.status());
+    absl::Cord output;
+    {
+      CordJsonSink sink(output);
+      JsonToJsonText(*json, sink);
+    }
+    bytes += output.size();
+    benchmark::DoNotOptimize(output);
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+void BM_ValueToJsonText(benchmark::State& state) {
+  google::protobuf::Arena arena;
+  common_internal::LegacyValueManager value_manager(
+      ProtoMemoryManagerRef(&arena), TypeProvider::Builtin());
+  const Value value = MakeValue(value_manager, state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    absl::Cord output;
+    {
+      CordJsonSink sink(output);
+      ABSL_CHECK_OK(ValueToJsonText(value_manager, value, sink));
+    }
+    bytes += output.size();
+    benchmark::DoNotOptimize(output);
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_ValueToJsonTree)->Range(1, 4096);
+BENCHMARK(BM_ValueToJsonText)->Range(1, 4096);
+
+}  // namespace
+}  // namespace cel::extensions
@@ -0,0 +1,339 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "extensions/protobuf/json_writer.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+
+#include "google/protobuf/any.pb.h"
+#include "google/protobuf/duration.pb.h"
+#include "google/protobuf/struct.pb.h"
+#include "google/protobuf/wrappers.pb.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/cord_test_helpers.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/type_provider.h"
+#include "common/json.h"
+#include "common/legacy_value.h"
+#include "common/value.h"
+#include "common/values/legacy_value_manager.h"
+#include "eval/public/structs/cel_proto_wrapper.h"
+#include "extensions/protobuf/json.h"
+#include "extensions/protobuf/memory_manager.h"
+#include "internal/proto_matchers.h"
+#include "internal/status_macros.h"
+#include "internal/testing.h"
+#include "proto/test/v1/proto3/test_all_types.pb.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+#include "google/protobuf/util/json_util.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::cel::internal::IsOkAndHolds;
+using ::cel::internal::StatusIs;
+using ::cel::internal::test::EqualsProto;
+using ::google::api::expr::runtime::CelProtoWrapper;
+using ::google::api::expr::test::v1::proto3::TestAllTypes;
+
+std::string ToText(const Json& json) {
+  absl::Cord output;
+  {
+    CordJsonSink sink(output);
+    JsonToJsonText(json, sink);
+  }
+  return std::string(output);
+}
+
+TEST(CordJsonSink, AppendsAcrossBuffers) {
+  absl::Cord output("prefix:");
+  std::string expected = "prefix:";
+  {
+    CordJsonSink sink(output);
+    for (int i = 0; i < 2000; ++i) {
+      sink.Append("abc");
+      expected.append("abc");
+    }
+    const std::string large(10000, 'x');
+    sink.Append(large);
+    expected.append(large);
+    sink.Append("def");
+    expected.append("def");
+  }
+  EXPECT_EQ(output, expected);
+}
+
+TEST(BufferJsonSink, Overflow) {
+  char buffer[8];
+  BufferJsonSink sink(absl::MakeSpan(buffer));
+  sink.Append("[1,");
+  sink.Append("2]");
+  EXPECT_FALSE(sink.overflow());
+  EXPECT_EQ(sink.text(), "[1,2]");
+
+  sink.Append(",3,4]");
+  EXPECT_TRUE(sink.overflow());
+  EXPECT_EQ(sink.size(), 10);
+  EXPECT_EQ(sink.text(), "[1,2],3,");
+}
+
+TEST(JsonToJsonText, Scalars) {
+  EXPECT_EQ(ToText(kJsonNull), "null");
+  EXPECT_EQ(ToText(true), "true");
+  EXPECT_EQ(ToText(1.0), "1");
+  EXPECT_EQ(ToText(-0.25), "-0.25");
+  EXPECT_EQ(ToText(0.1), "0.1");
+  EXPECT_EQ(ToText(1e100), "1e+100");
+  EXPECT_EQ(ToText(std::numeric_limits<double>::quiet_NaN()), "\"NaN\"");
+  EXPECT_EQ(ToText(std::numeric_limits<double>::infinity()), "\"Infinity\"");
+  EXPECT_EQ(ToText(-std::numeric_limits<double>::infinity()),
+            "\"-Infinity\"");
+  EXPECT_EQ(ToText(JsonString("a\"b\\c\n\x01")),
+            R"json("a\"b\\c\n\u0001")json");
+  EXPECT_EQ(ToText(JsonString(absl::MakeFragmentedCord({"ab", "\t", "cd"}))),
+            R"json("ab\tcd")json");
+}
+
+TEST(JsonToJsonText, Containers) {
+  JsonArrayBuilder array;
+  array.push_back(JsonInt(1));
+  array.push_back(JsonString("two"));
+  array.push_back(JsonArray());
+  EXPECT_EQ(ToText(std::move(array).Build()), R"json([1,"two",[]])json");
+
+  JsonObjectBuilder object;
+  object.insert_or_assign(JsonString("key"), JsonObject());
+  EXPECT_EQ(ToText(std::move(object).Build()), R"json({"key":{}})json");
+}
+
+class ProtoMessageToJsonTextTest : public testing::Test {
+ public:
+  ProtoMessageToJsonTextTest()
+      : converter_(google::protobuf::DescriptorPool::generated_pool(),
+                   google::protobuf::MessageFactory::generated_factory()) {}
+
+  absl::StatusOr<std::string> ToText(const google::protobuf::Message& message) {
+    absl::Cord output;
+    CordJsonSink sink(output);
+    CEL_RETURN_IF_ERROR(ProtoMessageToJsonText(converter_, message, sink));
+    sink.Flush();
+    return std::string(output);
+  }
+
+ protected:
+  ProtoAnyToJsonConverter converter_;
+};
+
+TEST_F(ProtoMessageToJsonTextTest, ScalarFields) {
+  TestAllTypes message;
+  message.set_single_int32(-5);
+  EXPECT_THAT(ToText(message),
+              IsOkAndHolds(R"json({"singleInt32":-5})json"));
+
+  message.Clear();
+  message.set_single_int64(int64_t{1} << 60);
+  EXPECT_THAT(ToText(message),
+              IsOkAndHolds(R"json({"singleInt64":"1152921504606846976"})json"));
+
+  message.Clear();
+  message.set_single_float(1.5);
+  EXPECT_THAT(ToText(message), IsOkAndHolds(R"json({"singleFloat":1.5})json"));
+
+  message.Clear();
+  message.set_single_string("foo");
+  EXPECT_THAT(ToText(message),
+              IsOkAndHolds(R"json({"singleString":"foo"})json"));
+
+  message.Clear();
+  message.set_single_bytes("bar");
+  EXPECT_THAT(ToText(message),
+              IsOkAndHolds(R"json({"singleBytes":"YmFy"})json"));
+
+  message.Clear();
+  message.set_standalone_enum(TestAllTypes::BAZ);
+  EXPECT_THAT(ToText(message),
+              IsOkAndHolds(R"json({"standaloneEnum":"BAZ"})json"));
+
+  message.Clear();
+  message.add_repeated_int32(1);
+  message.add_repeated_int32(2);
+  EXPECT_THAT(ToText(message),
+              IsOkAndHolds(R"json({"repeatedInt32":[1,2]})json"));
+}
+
+TEST_F(ProtoMessageToJsonTextTest, WellKnownTypes) {
+  TestAllTypes message;
+  message.mutable_single_int64_wrapper()->set_value(3);
+  EXPECT_THAT(ToText(message),
+              IsOkAndHolds(R"json({"singleInt64Wrapper":3})json"));
+
+  message.Clear();
+  message.mutable_single_duration()->set_seconds(2);
+  EXPECT_THAT(ToText(message),
+              IsOkAndHolds(R"json({"singleDuration":"2s"})json"));
+
+  message.Clear();
+  (*message.mutable_single_struct()->mutable_fields())["key"].set_bool_value(
+      true);
+  EXPECT_THAT(ToText(message),
+              IsOkAndHolds(R"json({"singleStruct":{"key":true}})json"));
+
+  message.Clear();
+  message.mutable_list_value()->add_values()->set_string_value("a");
+  EXPECT_THAT(ToText(message), IsOkAndHolds(R"json({"listValue":["a"]})json"));
+
+  message.Clear();
+  message.mutable_single_value()->set_null_value(google::protobuf::NULL_VALUE);
+  EXPECT_THAT(ToText(message), IsOkAndHolds(R"json({"singleValue":null})json"));
+}
+
+TEST_F(ProtoMessageToJsonTextTest, Any) {
+  google::protobuf::Any any;
+  google::protobuf::Int32Value wrapper;
+  wrapper.set_value(5);
+  any.PackFrom(wrapper);
+  EXPECT_THAT(ToText(any),
+              IsOkAndHolds(
+                  R"json({"@type":"type.googleapis.com/)json"
+                  R"json(google.protobuf.Int32Value","value":5})json"));
+
+  TestAllTypes message;
+  message.set_single_string("foo");
+  any.PackFrom(message);
+  EXPECT_THAT(ToText(any),
+              IsOkAndHolds(
+                  R"json({"@type":"type.googleapis.com/google.api.expr.)json"
+                  R"json(test.v1.proto3.TestAllTypes",)json"
+                  R"json("singleString":"foo"})json"));
+
+  google::protobuf::Any nested;
+  nested.PackFrom(any);
+  EXPECT_THAT(ToText(nested), StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(ProtoMessageToJsonTextTest, RoundTrip) {
+  TestAllTypes message;
+  message.set_single_int64(-42);
+  message.set_single_uint64(uint64_t{1} << 63);
+  message.set_single_double(0.1);
+  message.add_repeated_int32(1);
+  message.add_repeated_int32(2);
+  message.add_repeated_string("a\"b");
+  message.add_repeated_bytes(std::string("\0\1\2\3", 4));
+  message.add_repeated_nested_enum(TestAllTypes::BAR);
+  message.add_repeated_nested_message()->set_bb(3);
+  (*message.mutable_map_string_string())["key"] = "value";
+  (*message.mutable_map_int64_int64())[-1] = 1;
+  (*message.mutable_map_bool_bool())[true] = false;
+  message.mutable_single_nested_message()->set_bb(4);
+  message.mutable_single_timestamp()->set_seconds(1);
+
+  ASSERT_OK_AND_ASSIGN(std::string json, ToText(message));
+  TestAllTypes parsed;
+  ASSERT_TRUE(google::protobuf::util::JsonStringToMessage(json, &parsed).ok())
+      << json;
+  EXPECT_THAT(parsed, EqualsProto(message));
+}
+
+class ValueToJsonTextTest : public testing::Test {
+ public:
+  ValueToJsonTextTest()
+      : value_manager_(ProtoMemoryManagerRef(&arena_),
+                       TypeProvider::Builtin()) {}
+
+  absl::StatusOr<std::string> ToText(ValueView value) {
+    absl::Cord output;
+    CordJsonSink sink(output);
+    CEL_RETURN_IF_ERROR(ValueToJsonText(value_manager_, value, sink));
+    sink.Flush();
+    return std::string(output);
+  }
+
+ protected:
+  google::protobuf::Arena arena_;
+  common_internal::LegacyValueManager value_manager_;
+};
+
+TEST_F(ValueToJsonTextTest, Scalars) {
+  EXPECT_THAT(ToText(NullValueView()), IsOkAndHolds("null"));
+  EXPECT_THAT(ToText(IntValueView(-3)), IsOkAndHolds("-3"));
+  EXPECT_THAT(ToText(IntValueView(kJsonMaxInt + 1)),
+              IsOkAndHolds("\"9007199254740992\""));
+  EXPECT_THAT(ToText(UintValueView(3)), IsOkAndHolds("3"));
+  EXPECT_THAT(ToText(DoubleValueView(2.5)), IsOkAndHolds("2.5"));
+  EXPECT_THAT(ToText(StringValueView("\"")),
+              IsOkAndHolds(R"json("\"")json"));
+  EXPECT_THAT(ToText(BytesValueView("foob")),
+              IsOkAndHolds(R"json("Zm9vYg==")json"));
+  EXPECT_THAT(ToText(DurationValueView(absl::Milliseconds(1500))),
+              IsOkAndHolds(R"json("1.500s")json"));
+  EXPECT_THAT(ToText(TimestampValueView(absl::UnixEpoch())),
+              IsOkAndHolds(R"json("1970-01-01T00:00:00Z")json"));
+  EXPECT_THAT(ToText(value_manager_.CreateErrorValue(
+                  absl::InternalError("error"))),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(ValueToJsonTextTest, Containers) {
+  ASSERT_OK_AND_ASSIGN(auto list_builder, value_manager_.NewListValueBuilder(
+                                              value_manager_.GetDynListType()));
+  ASSERT_OK(list_builder->Add(IntValue(1)));
+  ASSERT_OK(list_builder->Add(BoolValue(false)));
+  ListValue list = std::move(*list_builder).Build();
+
+  ASSERT_OK_AND_ASSIGN(
+      auto map_builder,
+      value_manager_.NewMapValueBuilder(value_manager_.GetDynDynMapType()));
+  ASSERT_OK(map_builder->Put(IntValue(1), std::move(list)));
+  MapValue map = std::move(*map_builder).Build();
+
+  EXPECT_THAT(ToText(map), IsOkAndHolds(
+                               R"json({"1":[1,false]})json"));
+}
+
+TEST_F(ValueToJsonTextTest, ConflictingMapKeys) {
+  ASSERT_OK_AND_ASSIGN(
+      auto map_builder,
+      value_manager_.NewMapValueBuilder(value_manager_.GetDynDynMapType()));
+  ASSERT_OK(map_builder->Put(IntValue(1), NullValue()));
+  ASSERT_OK(map_builder->Put(StringValue("1"), NullValue()));
+  MapValue map = std::move(*map_builder).Build();
+
+  EXPECT_THAT(ToText(map), StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(ValueToJsonTextTest, Message) {
+  TestAllTypes message;
+  message.set_single_int32(1);
+  message.add_repeated_string("a");
+  Value scratch;
+  ASSERT_OK_AND_ASSIGN(
+      auto value,
+      ModernValue(&arena_, CelProtoWrapper::CreateMessage(&message, &arena_),
+                  scratch));
+  EXPECT_THAT(
+      ToText(value),
+      IsOkAndHolds(R"json({"singleInt32":1,"repeatedString":["a"]})json"));
+}
+
+}  // namespace
+}  // namespace cel::extensions
@@ -0,0 +1,649 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "extensions/protobuf/lazy_message_value.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/call_once.h"
+#include "absl/base/casts.h"
+#include "absl/base/nullability.h"
+#include "absl/base/optimization.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "absl/types/variant.h"
+#include "base/attribute.h"
+#include "common/any.h"
+#include "common/casting.h"
+#include "common/json.h"
+#include "common/legacy_value.h"
+#include "common/memory.h"
+#include "common/native_type.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "eval/public/structs/cel_proto_wrapper.h"
+#include "extensions/protobuf/internal/json.h"
+#include "extensions/protobuf/memory_manager.h"
+#include "internal/proto_wire.h"
+#include "internal/status_macros.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::cel::internal::ProtoWireDecoder;
+using ::cel::internal::ProtoWireEncoder;
+using ::cel::internal::ProtoWireTag;
+using ::cel::internal::ProtoWireType;
+using ::google::api::expr::runtime::CelProtoWrapper;
+using ::google::protobuf::Descriptor;
+using ::google::protobuf::FieldDescriptor;
+
+// A single record of a field, as found on the wire.
+struct WireRecord {
+  ProtoWireType type;
+  // Payload of varint, fixed32 and fixed64 records.
+  uint64_t scalar = 0;
+  // Payload of length delimited records.
+  absl::Cord bytes;
+};
+
+// All of the records of one field number, in wire order.
+struct WireField {
+  // Position of the last record among all records of the message, used to tell
+  // which member of a oneof was set last.
+  size_t last_position = 0;
+  absl::InlinedVector<WireRecord, 1> records;
+};
+
+using WireIndex = absl::flat_hash_map<int64_t, WireField>;
+
+absl::StatusOr<WireIndex> BuildWireIndex(absl::string_view type_name,
+                                         const absl::Cord& serialized) {
+  WireIndex index;
+  ProtoWireDecoder decoder(type_name, serialized);
+  size_t position = 0;
+  while (decoder.HasNext()) {
+    CEL_ASSIGN_OR_RETURN(ProtoWireTag tag, decoder.ReadTag());
+    WireRecord record{tag.type()};
+    switch (tag.type()) {
+      case ProtoWireType::kVarint: {
+        CEL_ASSIGN_OR_RETURN(record.scalar, decoder.ReadVarint<uint64_t>());
+        break;
+      }
+      case ProtoWireType::kFixed32: {
+        CEL_ASSIGN_OR_RETURN(record.scalar, decoder.ReadFixed32<uint32_t>());
+        break;
+      }
+      case ProtoWireType::kFixed64: {
+        CEL_ASSIGN_OR_RETURN(record.scalar, decoder.ReadFixed64<uint64_t>());
+        break;
+      }
+      case ProtoWireType::kLengthDelimited: {
+        CEL_ASSIGN_OR_RETURN(record.bytes, decoder.ReadLengthDelimited());
+        break;
+      }
+      default:
+        // Groups cannot be skipped without decoding them.
+        return absl::UnimplementedError(
+            absl::StrCat("group encountered decoding field ",
+                         tag.field_number(), " of ", type_name));
+    }
+    WireField& field = index[tag.field_number()];
+    field.last_position = position++;
+    field.records.push_back(std::move(record));
+  }
+  decoder.EnsureFullyDecoded();
+  return index;
+}
+
+// Returns whether the value of `field` can be decoded from its records, as
+// opposed to parsing them into a message.
+bool IsWireField(const FieldDescriptor& field) {
+  if (field.is_repeated()) {
+    return false;
+  }
+  switch (field.type()) {
+    case FieldDescriptor::TYPE_GROUP:
+      return false;
+    case FieldDescriptor::TYPE_MESSAGE:
+      return field.message_type()->well_known_type() ==
+             Descriptor::WELLKNOWNTYPE_UNSPECIFIED;
+    default:
+      return true;
+  }
+}
+
+ProtoWireType WireTypeFor(const FieldDescriptor& field) {
+  switch (field.type()) {
+    case FieldDescriptor::TYPE_DOUBLE:
+    case FieldDescriptor::TYPE_FIXED64:
+    case FieldDescriptor::TYPE_SFIXED64:
+      return ProtoWireType::kFixed64;
+    case FieldDescriptor::TYPE_FLOAT:
+    case FieldDescriptor::TYPE_FIXED32:
+    case FieldDescriptor::TYPE_SFIXED32:
+      return ProtoWireType::kFixed32;
+    case FieldDescriptor::TYPE_STRING:
+    case FieldDescriptor::TYPE_BYTES:
+    case FieldDescriptor::TYPE_MESSAGE:
+      return ProtoWireType::kLengthDelimited;
+    default:
+      return ProtoWireType::kVarint;
+  }
+}
+
+bool IsNullValueEnum(const FieldDescriptor& field) {
+  return field.enum_type()->full_name() == "google.protobuf.NullValue";
+}
+
+// Returns the records of `field`, or `nullptr` if it is unset. A member of a
+// oneof is unset when another member of the same oneof was set after it.
+absl::Nullable<const WireField*> FindWireField(const WireIndex& index,
+                                               const FieldDescriptor& field) {
+  auto it = index.find(field.number());
+  if (it == index.end()) {
+    return nullptr;
+  }
+  if (const auto* oneof = field.containing_oneof(); oneof != nullptr) {
+    for (int i = 0; i < oneof->field_count(); ++i) {
+      const FieldDescriptor* member = oneof->field(i);
+      if (member == &field) {
+        continue;
+      }
+      if (auto member_it = index.find(member->number());
+          member_it != index.end() &&
+          member_it->second.last_position > it->second.last_position) {
+        return nullptr;
+      }
+    }
+  }
+  return &it->second;
+}
+
+// Returns the last record of `type`. Records of another wire type are treated
+// as unknown fields, as the protobuf parser does.
+absl::Nullable<const WireRecord*> LastRecord(const WireField& field,
+                                             ProtoWireType type) {
+  for (auto it = field.records.rbegin(); it != field.records.rend(); ++it) {
+    if (it->type == type) {
+      return &*it;
+    }
+  }
+  return nullptr;
+}
+
+int32_t ZigZagDecode32(uint64_t value) {
+  uint32_t n = static_cast<uint32_t>(value);
+  return static_cast<int32_t>((n >> 1) ^ (~(n & 1) + 1));
+}
+
+int64_t ZigZagDecode64(uint64_t value) {
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+ValueView ScalarFieldValue(const FieldDescriptor& field, uint64_t value) {
+  switch (field.type()) {
+    case FieldDescriptor::TYPE_INT64:
+    case FieldDescriptor::TYPE_SFIXED64:
+      return IntValueView{absl::bit_cast<int64_t>(value)};
+    case FieldDescriptor::TYPE_INT32:
+    case FieldDescriptor::TYPE_SFIXED32:
+      return IntValueView{static_cast<int32_t>(value)};
+    case FieldDescriptor::TYPE_SINT32:
+      return IntValueView{ZigZagDecode32(value)};
+    case FieldDescriptor::TYPE_SINT64:
+      return IntValueView{ZigZagDecode64(value)};
+    case FieldDescriptor::TYPE_UINT64:
+    case FieldDescriptor::TYPE_FIXED64:
+      return UintValueView{value};
+    case FieldDescriptor::TYPE_UINT32:
+    case FieldDescriptor::TYPE_FIXED32:
+      return UintValueView{static_cast<uint32_t>(value)};
+    case FieldDescriptor::TYPE_BOOL:
+      return BoolValueView{value != 0};
+    case FieldDescriptor::TYPE_DOUBLE:
+      return DoubleValueView{absl::bit_cast<double>(value)};
+    case FieldDescriptor::TYPE_FLOAT:
+      return DoubleValueView{
+          absl::bit_cast<float>(static_cast<uint32_t>(value))};
+    case FieldDescriptor::TYPE_ENUM:
+      if (IsNullValueEnum(field)) {
+        return NullValueView{};
+      }
+      return IntValueView{static_cast<int32_t>(value)};
+    default:
+      ABSL_UNREACHABLE();
+  }
+}
+
+absl::StatusOr<ValueView> DefaultFieldValue(const FieldDescriptor& field) {
+  switch (field.cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+      return IntValueView{field.default_value_int32()};
+    case FieldDescriptor::CPPTYPE_INT64:
+      return IntValueView{field.default_value_int64()};
+    case FieldDescriptor::CPPTYPE_UINT32:
+      return UintValueView{field.default_value_uint32()};
+    case FieldDescriptor::CPPTYPE_UINT64:
+      return UintValueView{field.default_value_uint64()};
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      return DoubleValueView{field.default_value_double()};
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      return DoubleValueView{field.default_value_float()};
+    case FieldDescriptor::CPPTYPE_BOOL:
+      return BoolValueView{field.default_value_bool()};
+    case FieldDescriptor::CPPTYPE_ENUM:
+      if (IsNullValueEnum(field)) {
+        return NullValueView{};
+      }
+      return IntValueView{field.default_value_enum()->number()};
+    case FieldDescriptor::CPPTYPE_STRING:
+      if (field.type() == FieldDescriptor::TYPE_BYTES) {
+        return BytesValueView{absl::string_view(field.default_value_string())};
+      }
+      return StringValueView{absl::string_view(field.default_value_string())};
+    default:
+      return absl::InternalError(
+          absl::StrCat("unexpected field type for ", field.full_name()));
+  }
+}
+
+class LazyMessageValue final : public ParsedStructValueInterface {
+ public:
+  LazyMessageValue(absl::Nonnull<google::protobuf::Arena*> arena,
+                   absl::Nonnull<const google::protobuf::Message*> prototype,
+                   absl::Cord serialized)
+      : arena_(arena),
+        prototype_(prototype),
+        descriptor_(prototype->GetDescriptor()),
+        serialized_(std::move(serialized)) {}
+
+  absl::string_view GetTypeName() const override {
+    return descriptor_->full_name();
+  }
+
+  std::string DebugString() const override {
+    auto message = absl::WrapUnique(prototype_->New());
+    // Whatever could be parsed is still useful for debugging.
+    static_cast<void>(message->ParsePartialFromCord(serialized_));
+    return message->ShortDebugString();
+  }
+
+  absl::StatusOr<size_t> GetSerializedSize(AnyToJsonConverter&) const override {
+    return serialized_.size();
+  }
+
+  absl::Status SerializeTo(AnyToJsonConverter&,
+                           absl::Cord& value) const override {
+    value.Append(serialized_);
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<std::string> GetTypeUrl(
+      absl::string_view prefix) const override {
+    return MakeTypeUrlWithPrefix(prefix, GetTypeName());
+  }
+
+  absl::StatusOr<Json> ConvertToJson(
+      AnyToJsonConverter& converter) const override {
+    auto message = absl::WrapUnique(prototype_->New());
+    if (!message->ParsePartialFromCord(serialized_)) {
+      return MalformedError();
+    }
+    return protobuf_internal::ProtoMessageToJson(converter, *message);
+  }
+
+  bool IsZeroValue() const override {
+    const auto& index = Index();
+    if (!index.ok()) {
+      return serialized_.empty();
+    }
+    for (const auto& entry : *index) {
+      const FieldDescriptor* field = descriptor_->FindFieldByNumber(
+          static_cast<int>(entry.first));
+      if (field == nullptr) {
+        continue;
+      }
+      auto has_field = HasField(*field);
+      if (!has_field.ok() || *has_field) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  absl::StatusOr<ValueView> GetFieldByName(
+      ValueManager& value_manager, absl::string_view name, Value& scratch,
+      ProtoWrapperTypeOptions unboxing_options) const override {
+    const FieldDescriptor* field = descriptor_->FindFieldByName(name);
+    if (field == nullptr) {
+      scratch = NoSuchFieldError(name);
+      return scratch;
+    }
+    return GetField(value_manager, *field, scratch, unboxing_options);
+  }
+
+  absl::StatusOr<ValueView> GetFieldByNumber(
+      ValueManager& value_manager, int64_t number, Value& scratch,
+      ProtoWrapperTypeOptions unboxing_options) const override {
+    const FieldDescriptor* field = FindFieldByNumber(number);
+    if (field == nullptr) {
+      scratch = NoSuchFieldError(absl::StrCat(number));
+      return scratch;
+    }
+    return GetField(value_manager, *field, scratch, unboxing_options);
+  }
+
+  absl::StatusOr<bool> HasFieldByName(absl::string_view name) const override {
+    const FieldDescriptor* field = descriptor_->FindFieldByName(name);
+    if (field == nullptr) {
+      return NoSuchFieldError(name).NativeValue();
+    }
+    return HasField(*field);
+  }
+
+  absl::StatusOr<bool> HasFieldByNumber(int64_t number) const override {
+    const FieldDescriptor* field = FindFieldByNumber(number);
+    if (field == nullptr) {
+      return NoSuchFieldError(absl::StrCat(number)).NativeValue();
+    }
+    return HasField(*field);
+  }
+
+  absl::Status ForEachField(ValueManager& value_manager,
+                            ForEachFieldCallback callback) const override {
+    Value scratch;
+    for (int i = 0; i < descriptor_->field_count(); ++i) {
+      const FieldDescriptor& field = *descriptor_->field(i);
+      CEL_ASSIGN_OR_RETURN(bool present, HasField(field));
+      if (!present) {
+        continue;
+      }
+      CEL_ASSIGN_OR_RETURN(
+          ValueView value,
+          GetField(value_manager, field, scratch,
+                   ProtoWrapperTypeOptions::kUnsetNull));
+      CEL_ASSIGN_OR_RETURN(bool ok, callback(field.name(), value));
+      if (!ok) {
+        break;
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Follows field selections through singular message fields without creating
+  // the intermediate values. The first selection of another kind of field
+  // ends the walk, and its value is returned along with the number of
+  // qualifiers applied so far.
+  absl::StatusOr<std::pair<ValueView, int>> Qualify(
+      ValueManager& value_manager, absl::Span<const SelectQualifier> qualifiers,
+      bool presence_test, Value& scratch) const override {
+    if (ABSL_PREDICT_FALSE(qualifiers.empty())) {
+      return absl::InvalidArgumentError("invalid select qualifier path.");
+    }
+    const LazyMessageValue* message = this;
+    absl::optional<LazyMessageValue> nested;
+    for (int i = 0; i < static_cast<int>(qualifiers.size()); ++i) {
+      const auto* specifier = absl::get_if<FieldSpecifier>(&qualifiers[i]);
+      if (specifier == nullptr) {
+        return absl::UnimplementedError(
+            "dynamic field access on message not supported");
+      }
+      const FieldDescriptor* field =
+          message->FindFieldByNumber(specifier->number);
+      if (field == nullptr) {
+        scratch = NoSuchFieldError(specifier->name);
+        return std::pair<ValueView, int>{scratch, -1};
+      }
+      const bool last = i + 1 == static_cast<int>(qualifiers.size());
+      if (last && presence_test) {
+        CEL_ASSIGN_OR_RETURN(bool present, message->HasField(*field));
+        return std::pair<ValueView, int>{BoolValueView{present}, -1};
+      }
+      if (last || !IsWireField(*field) ||
+          field->type() != FieldDescriptor::TYPE_MESSAGE ||
+          !message->Index().ok()) {
+        CEL_ASSIGN_OR_RETURN(
+            ValueView value,
+            message->GetField(value_manager, *field, scratch,
+                              ProtoWrapperTypeOptions::kUnsetNull));
+        return std::pair<ValueView, int>{value, last ? -1 : i + 1};
+      }
+      absl::Cord bytes = message->MessageFieldBytes(*field);
+      const auto* prototype = message->FieldPrototype(*field);
+      nested.emplace(arena_, prototype, std::move(bytes));
+      message = &*nested;
+    }
+    ABSL_UNREACHABLE();
+  }
+
+ private:
+  NativeTypeId GetNativeTypeId() const noexcept override {
+    return NativeTypeId::For<LazyMessageValue>();
+  }
+
+  absl::Status MalformedError() const {
+    return absl::DataLossError(
+        absl::StrCat("malformed message encountered decoding ", GetTypeName()));
+  }
+
+  // Returns where the fields of this message are, scanning the message on
+  // first use. Fails for malformed messages and messages with groups, which
+  // are then read by parsing them.
+  const absl::StatusOr<WireIndex>& Index() const {
+    absl::call_once(index_once_, [this]() {
+      index_ = BuildWireIndex(GetTypeName(), serialized_);
+    });
+    return index_;
+  }
+
+  absl::Nullable<const FieldDescriptor*> FindFieldByNumber(
+      int64_t number) const {
+    if (number < 1 || number > FieldDescriptor::kMaxNumber) {
+      return nullptr;
+    }
+    return descriptor_->FindFieldByNumber(static_cast<int>(number));
+  }
+
+  absl::Nonnull<const google::protobuf::Message*> FieldPrototype(
+      const FieldDescriptor& field) const {
+    return prototype_->GetReflection()->GetMessageFactory()->GetPrototype(
+        field.message_type());
+  }
+
+  // Returns the concatenation of the records of a singular message field,
+  // which the protobuf parser would merge.
+  absl::Cord MessageFieldBytes(const FieldDescriptor& field) const {
+    absl::Cord bytes;
+    if (const WireField* wire_field = FindWireField(*Index(), field);
+        wire_field != nullptr) {
+      for (const WireRecord& record : wire_field->records) {
+        if (record.type == ProtoWireType::kLengthDelimited) {
+          bytes.Append(record.bytes);
+        }
+      }
+    }
+    return bytes;
+  }
+
+  absl::StatusOr<bool> HasField(const FieldDescriptor& field) const {
+    const auto& index = Index();
+    if (!index.ok() || !IsWireField(field)) {
+      auto message = absl::WrapUnique(prototype_->New());
+      CEL_RETURN_IF_ERROR(ParseField(field, *message));
+      const auto* reflection = message->GetReflection();
+      if (field.is_repeated()) {
+        return reflection->FieldSize(*message, &field) != 0;
+      }
+      return reflection->HasField(*message, &field);
+    }
+    const WireField* wire_field = FindWireField(*index, field);
+    if (wire_field == nullptr) {
+      return false;
+    }
+    const WireRecord* record = LastRecord(*wire_field, WireTypeFor(field));
+    if (record == nullptr) {
+      return false;
+    }
+    if (field.type() == FieldDescriptor::TYPE_MESSAGE || field.has_presence()) {
+      return true;
+    }
+    // Fields without presence are only set when they are not the default.
+    if (field.cpp_type() == FieldDescriptor::CPPTYPE_STRING) {
+      return !record->bytes.empty();
+    }
+    return record->scalar != 0;
+  }
+
+  absl::StatusOr<ValueView> GetField(
+      ValueManager& value_manager, const FieldDescriptor& field,
+      Value& scratch, ProtoWrapperTypeOptions unboxing_options) const {
+    const auto& index = Index();
+    if (!index.ok() || !IsWireField(field)) {
+      return GetParsedField(value_manager, field, scratch, unboxing_options);
+    }
+    if (field.type() == FieldDescriptor::TYPE_MESSAGE) {
+      scratch = ParsedStructValue(
+          ProtoMemoryManagerRef(arena_).MakeShared<LazyMessageValue>(
+              arena_, FieldPrototype(field), MessageFieldBytes(field)));
+      return scratch;
+    }
+    const WireField* wire_field = FindWireField(*index, field);
+    const WireRecord* record =
+        wire_field != nullptr ? LastRecord(*wire_field, WireTypeFor(field))
+                              : nullptr;
+    if (record == nullptr) {
+      return DefaultFieldValue(field);
+    }
+    switch (field.type()) {
+      case FieldDescriptor::TYPE_STRING:
+        scratch = value_manager.CreateUncheckedStringValue(record->bytes);
+        return scratch;
+      case FieldDescriptor::TYPE_BYTES: {
+        CEL_ASSIGN_OR_RETURN(scratch,
+                             value_manager.CreateBytesValue(record->bytes));
+        return scratch;
+      }
+      default:
+        return ScalarFieldValue(field, record->scalar);
+    }
+  }
+
+  // Reads `field` through the regular protobuf support, from a message with
+  // only the records of `field` parsed into it. The message is allocated on
+  // the arena of this value, so the result does not depend on the memory
+  // manager of `value_manager`.
+  absl::StatusOr<ValueView> GetParsedField(
+      ValueManager& value_manager, const FieldDescriptor& field,
+      Value& scratch, ProtoWrapperTypeOptions unboxing_options) const {
+    google::protobuf::Message* message = prototype_->New(arena_);
+    CEL_RETURN_IF_ERROR(ParseField(field, *message));
+    Value message_scratch;
+    CEL_ASSIGN_OR_RETURN(
+        ValueView message_value,
+        ModernValue(arena_, CelProtoWrapper::CreateMessage(message, arena_),
+                    message_scratch));
+    return Cast<StructValueView>(message_value)
+        .GetFieldByName(value_manager, field.name(), scratch,
+                        unboxing_options);
+  }
+
+  // Parses the records of `field` into `message`. Falls back to parsing the
+  // whole message when it could not be scanned.
+  absl::Status ParseField(const FieldDescriptor& field,
+                          google::protobuf::Message& message) const {
+    const auto& index = Index();
+    if (!index.ok()) {
+      if (!message.ParsePartialFromCord(serialized_)) {
+        return MalformedError();
+      }
+      return absl::OkStatus();
+    }
+    const WireField* wire_field = FindWireField(*index, field);
+    if (wire_field == nullptr) {
+      return absl::OkStatus();
+    }
+    absl::Cord records;
+    ProtoWireEncoder encoder(GetTypeName(), records);
+    for (const WireRecord& record : wire_field->records) {
+      CEL_RETURN_IF_ERROR(
+          encoder.WriteTag(ProtoWireTag(field.number(), record.type)));
+      switch (record.type) {
+        case ProtoWireType::kVarint:
+          CEL_RETURN_IF_ERROR(encoder.WriteVarint(record.scalar));
+          break;
+        case ProtoWireType::kFixed32:
+          CEL_RETURN_IF_ERROR(
+              encoder.WriteFixed32(static_cast<uint32_t>(record.scalar)));
+          break;
+        case ProtoWireType::kFixed64:
+          CEL_RETURN_IF_ERROR(encoder.WriteFixed64(record.scalar));
+          break;
+        default:
+          CEL_RETURN_IF_ERROR(encoder.WriteLengthDelimited(record.bytes));
+          break;
+      }
+    }
+    encoder.EnsureFullyEncoded();
+    if (!message.ParsePartialFromCord(records)) {
+      return MalformedError();
+    }
+    return absl::OkStatus();
+  }
+
+  // The arena this value is allocated on. Nested values and messages parsed
+  // for fields that can't be read from the wire are allocated on it too.
+  google::protobuf::Arena* const arena_;
+  const google::protobuf::Message* const prototype_;
+  const Descriptor* const descriptor_;
+  const absl::Cord serialized_;
+  mutable absl::once_flag index_once_;
+  mutable absl::StatusOr<WireIndex> index_;
+};
+
+}  // namespace
+
+absl::StatusOr<StructValue> NewLazyMessageValue(
+    MemoryManagerRef memory_manager, const google::protobuf::Message& prototype,
+    absl::Cord serialized) {
+  const Descriptor* descriptor = prototype.GetDescriptor();
+  if (descriptor->well_known_type() != Descriptor::WELLKNOWNTYPE_UNSPECIFIED) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "well known type ", descriptor->full_name(), " cannot be read lazily"));
+  }
+  google::protobuf::Arena* arena = ProtoMemoryManagerArena(memory_manager);
+  if (arena == nullptr) {
+    return absl::FailedPreconditionError(
+        "lazy message values require a protobuf arena backed memory manager");
+  }
+  return ParsedStructValue(memory_manager.MakeShared<LazyMessageValue>(
+      arena, &prototype, std::move(serialized)));
+}
+
+}  // namespace cel::extensions
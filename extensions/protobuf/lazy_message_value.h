@@ -0,0 +1,48 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_EXTENSIONS_PROTOBUF_LAZY_MESSAGE_VALUE_H_
+#define THIRD_PARTY_CEL_CPP_EXTENSIONS_PROTOBUF_LAZY_MESSAGE_VALUE_H_
+
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "google/protobuf/message.h"
+
+namespace cel::extensions {
+
+// Returns a struct value for the message of type `prototype` serialized as
+// `serialized`, without parsing it.
+//
+// The first field access scans the top-level records of `serialized` once,
+// skipping over their payloads, and remembers where each field is. Singular
+// scalar, string, bytes and enum fields are then decoded straight from the
+// wire. Singular message fields become lazy values over their own bytes, so
+// selecting `a.b.c` only ever looks at the records on that path.
+//
+// Repeated fields, maps, well-known types and groups are read by parsing just
+// the records of that field into a message allocated on the arena.
+//
+// `memory_manager` must be backed by a protobuf arena (see
+// `ProtoMemoryManagerRef`), otherwise `FailedPrecondition` is returned. Fields
+// can then be read with any `ValueManager`. `prototype` must outlive the
+// returned value and must not be a well-known type.
+absl::StatusOr<StructValue> NewLazyMessageValue(
+    MemoryManagerRef memory_manager, const google::protobuf::Message& prototype,
+    absl::Cord serialized);
+
+}  // namespace cel::extensions
+
+#endif  // THIRD_PARTY_CEL_CPP_EXTENSIONS_PROTOBUF_LAZY_MESSAGE_VALUE_H_
@@ -0,0 +1,123 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks reading a nested field out of a serialized request, as in
+// BM_NestedProtoFieldRead, by parsing the request first or by reading it
+// lazily. The request also carries `state.range(0)` headers which the
+// expression never reads.
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/log/absl_check.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "common/legacy_value.h"
+#include "common/value.h"
+#include "eval/public/structs/cel_proto_wrapper.h"
+#include "eval/tests/request_context.pb.h"
+#include "extensions/protobuf/lazy_message_value.h"
+#include "extensions/protobuf/memory_manager.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/benchmark.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/runtime.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+#include "google/protobuf/arena.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::google::api::expr::parser::Parse;
+using ::google::api::expr::runtime::CelProtoWrapper;
+using ::google::api::expr::runtime::RequestContext;
+
+std::unique_ptr<Program> MakeProgram() {
+  RuntimeOptions options;
+  auto builder = CreateStandardRuntimeBuilder(options);
+  ABSL_CHECK_OK(builder.status());
+  auto runtime = std::move(builder).value().Build();
+  ABSL_CHECK_OK(runtime.status());
+
+  auto expr = Parse("!request.a.b.c.d.e");
+  ABSL_CHECK_OK(expr.status());
+
+  auto program = ProtobufRuntimeAdapter::CreateProgram(**runtime, *expr);
+  ABSL_CHECK_OK(program.status());
+  return *std::move(program);
+}
+
+absl::Cord MakeRequest(int headers) {
+  RequestContext request;
+  request.set_ip("192.168.0.1");
+  request.set_path("/admin/edit");
+  request.set_token("admin");
+  for (int i = 0; i < headers; ++i) {
+    (*request.mutable_headers())[absl::StrCat("header-", i)] =
+        absl::StrCat("value-", i);
+  }
+  request.mutable_a()->mutable_b()->mutable_c()->mutable_d()->set_e(false);
+  return absl::Cord(request.SerializeAsString());
+}
+
+void RunBenchmark(benchmark::State& state, bool lazy) {
+  std::unique_ptr<Program> program = MakeProgram();
+  const absl::Cord serialized = MakeRequest(state.range(0));
+
+  for (auto _ : state) {
+    google::protobuf::Arena arena;
+    ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                      ProtoMemoryManagerRef(&arena));
+    Activation activation;
+    if (lazy) {
+      auto request = NewLazyMessageValue(value_factory.get().GetMemoryManager(),
+                                         RequestContext::default_instance(),
+                                         serialized);
+      ABSL_CHECK_OK(request.status());
+      activation.InsertOrAssignValue("request", *std::move(request));
+    } else {
+      auto* request = google::protobuf::Arena::Create<RequestContext>(&arena);
+      ABSL_CHECK(request->ParseFromCord(serialized));
+      Value scratch;
+      auto value = ModernValue(
+          &arena, CelProtoWrapper::CreateMessage(request, &arena), scratch);
+      ABSL_CHECK_OK(value.status());
+      activation.InsertOrAssignValue("request", Value(*value));
+    }
+    auto result = program->Evaluate(activation, value_factory.get());
+    ABSL_CHECK_OK(result.status());
+    ABSL_CHECK((*result)->Is<BoolValue>() &&
+               (*result)->As<BoolValue>().NativeValue());
+  }
+}
+
+void BM_NestedProtoFieldReadParsed(benchmark::State& state) {
+  RunBenchmark(state, /*lazy=*/false);
+}
+
+void BM_NestedProtoFieldReadLazy(benchmark::State& state) {
+  RunBenchmark(state, /*lazy=*/true);
+}
+
+BENCHMARK(BM_NestedProtoFieldReadParsed)->Range(0, 256);
+BENCHMARK(BM_NestedProtoFieldReadLazy)->Range(0, 256);
+
+}  // namespace
+}  // namespace cel::extensions
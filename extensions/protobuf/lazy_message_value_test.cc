@@ -0,0 +1,290 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "extensions/protobuf/lazy_message_value.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/wrappers.pb.h"
+#include "absl/log/absl_check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/string_view.h"
+#include "base/attribute.h"
+#include "base/type_provider.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "common/values/legacy_value_manager.h"
+#include "extensions/protobuf/memory_manager.h"
+#include "internal/testing.h"
+#include "proto/test/v1/proto3/test_all_types.pb.h"
+#include "google/protobuf/arena.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::cel::internal::StatusIs;
+using ::google::api::expr::test::v1::proto3::NestedTestAllTypes;
+using ::google::api::expr::test::v1::proto3::TestAllTypes;
+
+class LazyMessageValueTest : public testing::Test {
+ public:
+  LazyMessageValueTest()
+      : value_factory_(ProtoMemoryManagerRef(&arena_),
+                       TypeProvider::Builtin()) {}
+
+  StructValue MakeValue(const google::protobuf::Message& message) {
+    auto value = NewLazyMessageValue(value_factory_.GetMemoryManager(),
+                                     *message.GetReflection()
+                                          ->GetMessageFactory()
+                                          ->GetPrototype(
+                                              message.GetDescriptor()),
+                                     absl::Cord(message.SerializeAsString()));
+    ABSL_CHECK_OK(value.status());
+    return *std::move(value);
+  }
+
+  Value GetField(const StructValue& value, absl::string_view name) {
+    auto field = value.GetFieldByName(value_factory_, name);
+    ABSL_CHECK_OK(field.status());
+    return *std::move(field);
+  }
+
+  bool HasField(const StructValue& value, absl::string_view name) {
+    auto has_field = value.HasFieldByName(name);
+    ABSL_CHECK_OK(has_field.status());
+    return *has_field;
+  }
+
+ protected:
+  google::protobuf::Arena arena_;
+  common_internal::LegacyValueManager value_factory_;
+};
+
+TEST_F(LazyMessageValueTest, ScalarFields) {
+  TestAllTypes message;
+  message.set_single_int32(-5);
+  message.set_single_int64(-6);
+  message.set_single_uint32(7);
+  message.set_single_sint64(-8);
+  message.set_single_fixed32(9);
+  message.set_single_sfixed64(-10);
+  message.set_single_float(1.5);
+  message.set_single_double(-2.5);
+  message.set_single_bool(true);
+  message.set_single_string("foo");
+  message.set_single_bytes("bar");
+  message.set_standalone_enum(TestAllTypes::BAZ);
+  StructValue value = MakeValue(message);
+
+  EXPECT_EQ(value.GetTypeName(), "google.api.expr.test.v1.proto3.TestAllTypes");
+  EXPECT_EQ(GetField(value, "single_int32")->As<IntValue>().NativeValue(), -5);
+  EXPECT_EQ(GetField(value, "single_int64")->As<IntValue>().NativeValue(), -6);
+  EXPECT_EQ(GetField(value, "single_uint32")->As<UintValue>().NativeValue(), 7);
+  EXPECT_EQ(GetField(value, "single_sint64")->As<IntValue>().NativeValue(), -8);
+  EXPECT_EQ(GetField(value, "single_fixed32")->As<UintValue>().NativeValue(),
+            9);
+  EXPECT_EQ(GetField(value, "single_sfixed64")->As<IntValue>().NativeValue(),
+            -10);
+  EXPECT_EQ(GetField(value, "single_float")->As<DoubleValue>().NativeValue(),
+            1.5);
+  EXPECT_EQ(GetField(value, "single_double")->As<DoubleValue>().NativeValue(),
+            -2.5);
+  EXPECT_TRUE(GetField(value, "single_bool")->As<BoolValue>().NativeValue());
+  EXPECT_EQ(GetField(value, "single_string")->As<StringValue>().NativeString(),
+            "foo");
+  EXPECT_EQ(GetField(value, "single_bytes")->As<BytesValue>().NativeString(),
+            "bar");
+  EXPECT_EQ(GetField(value, "standalone_enum")->As<IntValue>().NativeValue(),
+            TestAllTypes::BAZ);
+  EXPECT_TRUE(HasField(value, "single_string"));
+  EXPECT_FALSE(value.IsZeroValue());
+}
+
+TEST_F(LazyMessageValueTest, DefaultsAndPresence) {
+  StructValue value = MakeValue(TestAllTypes());
+
+  EXPECT_TRUE(value.IsZeroValue());
+  EXPECT_FALSE(HasField(value, "single_int32"));
+  EXPECT_EQ(GetField(value, "single_int32")->As<IntValue>().NativeValue(), 0);
+  EXPECT_EQ(GetField(value, "single_string")->As<StringValue>().NativeString(),
+            "");
+  EXPECT_FALSE(HasField(value, "standalone_message"));
+  Value nested = GetField(value, "standalone_message");
+  ASSERT_TRUE(nested->Is<StructValue>());
+  EXPECT_TRUE(nested->As<StructValue>().IsZeroValue());
+
+  EXPECT_TRUE(IsNoSuchField(GetField(value, "missing")->As<ErrorValue>()));
+  EXPECT_THAT(value.HasFieldByName("missing"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(LazyMessageValueTest, NestedMessages) {
+  NestedTestAllTypes message;
+  message.mutable_child()->mutable_child()->mutable_payload()->set_single_int32(
+      42);
+  message.mutable_payload()->set_single_string("top");
+  StructValue value = MakeValue(message);
+
+  Value child = GetField(value, "child");
+  ASSERT_TRUE(child->Is<StructValue>());
+  Value grandchild = GetField(child->As<StructValue>(), "child");
+  Value payload = GetField(grandchild->As<StructValue>(), "payload");
+  EXPECT_EQ(GetField(payload->As<StructValue>(), "single_int32")
+                ->As<IntValue>()
+                .NativeValue(),
+            42);
+  EXPECT_FALSE(HasField(child->As<StructValue>(), "payload"));
+
+  std::vector<SelectQualifier> path = {FieldSpecifier{1, "child"},
+                                       FieldSpecifier{1, "child"},
+                                       FieldSpecifier{2, "payload"},
+                                       FieldSpecifier{1, "single_int32"}};
+  ASSERT_OK_AND_ASSIGN(auto result, value.Qualify(value_factory_, path,
+                                                  /*presence_test=*/false));
+  EXPECT_EQ(result.second, -1);
+  EXPECT_EQ(result.first->As<IntValue>().NativeValue(), 42);
+  ASSERT_OK_AND_ASSIGN(result, value.Qualify(value_factory_, path,
+                                             /*presence_test=*/true));
+  EXPECT_TRUE(result.first->As<BoolValue>().NativeValue());
+}
+
+TEST_F(LazyMessageValueTest, LastRecordWins) {
+  TestAllTypes first;
+  first.set_single_int32(1);
+  first.set_single_nested_enum(TestAllTypes::BAR);
+  first.mutable_standalone_message()->set_bb(2);
+  TestAllTypes second;
+  second.set_single_int32(3);
+  second.mutable_single_nested_message()->set_bb(4);
+
+  // Concatenated messages are merged, as by the parser.
+  const std::string serialized =
+      first.SerializeAsString() + second.SerializeAsString();
+  TestAllTypes merged;
+  ASSERT_TRUE(merged.ParseFromString(serialized));
+  ASSERT_OK_AND_ASSIGN(
+      StructValue value,
+      NewLazyMessageValue(value_factory_.GetMemoryManager(),
+                          TestAllTypes::default_instance(),
+                          absl::Cord(serialized)));
+
+  EXPECT_EQ(GetField(value, "single_int32")->As<IntValue>().NativeValue(), 3);
+  // Setting a member of a oneof clears the others.
+  EXPECT_EQ(HasField(value, "single_nested_enum"),
+            merged.has_single_nested_enum());
+  EXPECT_EQ(HasField(value, "single_nested_message"),
+            merged.has_single_nested_message());
+  EXPECT_TRUE(HasField(value, "single_nested_message"));
+  Value standalone = GetField(value, "standalone_message");
+  EXPECT_EQ(GetField(standalone->As<StructValue>(), "bb")
+                ->As<IntValue>()
+                .NativeValue(),
+            2);
+}
+
+TEST_F(LazyMessageValueTest, ParsedFields) {
+  TestAllTypes message;
+  message.add_repeated_int32(1);
+  message.add_repeated_int32(2);
+  (*message.mutable_map_string_string())["key"] = "value";
+  message.mutable_single_int64_wrapper()->set_value(5);
+  StructValue value = MakeValue(message);
+
+  Value list = GetField(value, "repeated_int32");
+  ASSERT_TRUE(list->Is<ListValue>());
+  EXPECT_EQ(list->As<ListValue>().Size(), 2);
+  Value map = GetField(value, "map_string_string");
+  ASSERT_TRUE(map->Is<MapValue>());
+  EXPECT_EQ(map->As<MapValue>().Size(), 1);
+  EXPECT_EQ(
+      GetField(value, "single_int64_wrapper")->As<IntValue>().NativeValue(), 5);
+  EXPECT_TRUE(GetField(value, "single_int32_wrapper")->Is<NullValue>());
+  EXPECT_TRUE(HasField(value, "repeated_int32"));
+  EXPECT_FALSE(HasField(value, "repeated_int64"));
+}
+
+TEST_F(LazyMessageValueTest, RequiresArena) {
+  TestAllTypes message;
+  message.add_repeated_int32(1);
+  EXPECT_THAT(NewLazyMessageValue(MemoryManagerRef::ReferenceCounting(),
+                                  TestAllTypes::default_instance(),
+                                  absl::Cord(message.SerializeAsString())),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(LazyMessageValueTest, ReferenceCountingValueManager) {
+  TestAllTypes message;
+  message.add_repeated_int32(1);
+  message.add_repeated_int32(2);
+  message.mutable_single_nested_message()->set_bb(7);
+  message.mutable_single_int64_wrapper()->set_value(3);
+  StructValue value = MakeValue(message);
+  common_internal::LegacyValueManager value_factory(
+      MemoryManagerRef::ReferenceCounting(), TypeProvider::Builtin());
+
+  // Fields parsed through the regular protobuf support are allocated on the
+  // arena of the value, not by the value manager reading them.
+  ASSERT_OK_AND_ASSIGN(Value repeated,
+                       value.GetFieldByName(value_factory, "repeated_int32"));
+  ASSERT_TRUE(repeated->Is<ListValue>());
+  EXPECT_EQ(repeated->As<ListValue>().Size(), 2);
+  ASSERT_OK_AND_ASSIGN(Value wrapper, value.GetFieldByName(
+                                          value_factory, "single_int64_wrapper"));
+  ASSERT_TRUE(wrapper->Is<IntValue>());
+  EXPECT_EQ(wrapper->As<IntValue>().NativeValue(), 3);
+  ASSERT_OK_AND_ASSIGN(Value nested,
+                       value.GetFieldByName(value_factory,
+                                            "single_nested_message"));
+  ASSERT_TRUE(nested->Is<StructValue>());
+  ASSERT_OK_AND_ASSIGN(Value bb, nested->As<StructValue>().GetFieldByName(
+                                     value_factory, "bb"));
+  ASSERT_TRUE(bb->Is<IntValue>());
+  EXPECT_EQ(bb->As<IntValue>().NativeValue(), 7);
+}
+
+TEST_F(LazyMessageValueTest, Serialization) {
+  TestAllTypes message;
+  message.set_single_int32(1);
+  message.add_repeated_string("a");
+  StructValue value = MakeValue(message);
+
+  ASSERT_OK_AND_ASSIGN(absl::Cord serialized, value.Serialize(value_factory_));
+  EXPECT_EQ(serialized, message.SerializeAsString());
+  EXPECT_EQ(value.DebugString(), message.ShortDebugString());
+}
+
+TEST_F(LazyMessageValueTest, MalformedMessage) {
+  ASSERT_OK_AND_ASSIGN(
+      StructValue value,
+      NewLazyMessageValue(value_factory_.GetMemoryManager(),
+                          TestAllTypes::default_instance(),
+                          absl::Cord("\x08")));
+  EXPECT_THAT(value.GetFieldByName(value_factory_, "single_int32"),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST_F(LazyMessageValueTest, WellKnownTypes) {
+  EXPECT_THAT(
+      NewLazyMessageValue(value_factory_.GetMemoryManager(),
+                          google::protobuf::Int64Value::default_instance(),
+                          absl::Cord()),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace cel::extensions
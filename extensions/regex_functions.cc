@@ -14,12 +14,12 @@
 
 #include "extensions/regex_functions.h"
 
-#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "eval/public/cel_function.h"
 #include "eval/public/cel_options.h"
@@ -27,10 +27,13 @@
 #include "eval/public/containers/container_backed_map_impl.h"
 #include "eval/public/portable_cel_function_adapter.h"
 #include "re2/re2.h"
+#include "runtime/internal/regex_cache.h"
 
 namespace cel::extensions {
 namespace {
 
+using ::cel::runtime_internal::RegexCache;
+using ::cel::runtime_internal::RegexProgram;
 using ::google::api::expr::runtime::CelFunction;
 using ::google::api::expr::runtime::CelFunctionRegistry;
 using ::google::api::expr::runtime::CelValue;
@@ -40,16 +43,47 @@ using ::google::api::expr::runtime::PortableBinaryFunctionAdapter;
 using ::google::api::expr::runtime::PortableFunctionAdapter;
 using ::google::protobuf::Arena;
 
+// Compiles the patterns given to the regex functions, reusing programs from
+// the process-wide cache if enabled in the options.
+class RegexCompiler {
+ public:
+  explicit RegexCompiler(const InterpreterOptions& options)
+      : max_program_size_(options.regex_max_program_size) {
+    if (options.regex_cache_size > 0) {
+      cache_ = &RegexCache::Global();
+      cache_->Reserve(options.regex_cache_size);
+    }
+  }
+
+  RegexCache* cache() const { return cache_; }
+
+  // Checks that a program compiled for one of the functions can be used.
+  absl::Status Validate(const RE2& re2) const {
+    if (!re2.ok()) {
+      return absl::InvalidArgumentError("Given Regex is Invalid");
+    }
+    if (max_program_size_ > 0 && re2.ProgramSize() > max_program_size_) {
+      return absl::InvalidArgumentError("exceeded RE2 max program size");
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  int max_program_size_;
+  RegexCache* cache_ = nullptr;
+};
+
 // Extract matched group values from the given target string and rewrite the
 // string
-CelValue ExtractString(Arena* arena, CelValue::StringHolder target,
+CelValue ExtractString(const RegexCompiler& compiler, Arena* arena,
+                       CelValue::StringHolder target,
                        CelValue::StringHolder regex,
                        CelValue::StringHolder rewrite) {
-  RE2 re2(regex.value());
-  if (!re2.ok()) {
-    return CreateErrorValue(
-        arena, absl::InvalidArgumentError("Given Regex is Invalid"));
+  RegexProgram program(compiler.cache(), regex.value());
+  if (absl::Status status = compiler.Validate(*program); !status.ok()) {
+    return CreateErrorValue(arena, status);
   }
+  const RE2& re2 = *program;
   std::string output;
   auto result = RE2::Extract(target.value(), re2, rewrite.value(), &output);
   if (!result) {
@@ -63,13 +97,14 @@ CelValue ExtractString(Arena* arena, CelValue::StringHolder target,
 
 // Captures the first unnamed/named group value
 // NOTE: For capturing all the groups, use CaptureStringN instead
-CelValue CaptureString(Arena* arena, CelValue::StringHolder target,
+CelValue CaptureString(const RegexCompiler& compiler, Arena* arena,
+                       CelValue::StringHolder target,
                        CelValue::StringHolder regex) {
-  RE2 re2(regex.value());
-  if (!re2.ok()) {
-    return CreateErrorValue(
-        arena, absl::InvalidArgumentError("Given Regex is Invalid"));
+  RegexProgram program(compiler.cache(), regex.value());
+  if (absl::Status status = compiler.Validate(*program); !status.ok()) {
+    return CreateErrorValue(arena, status);
   }
+  const RE2& re2 = *program;
   std::string output;
   auto result = RE2::FullMatch(target.value(), re2, &output);
   if (!result) {
@@ -87,13 +122,14 @@ CelValue CaptureString(Arena* arena, CelValue::StringHolder target,
 // value> pairs as follows:
 //   a. For a named group - <named_group_name, captured_string>
 //   b. For an unnamed group - <group_index, captured_string>
-CelValue CaptureStringN(Arena* arena, CelValue::StringHolder target,
+CelValue CaptureStringN(const RegexCompiler& compiler, Arena* arena,
+                        CelValue::StringHolder target,
                         CelValue::StringHolder regex) {
-  RE2 re2(regex.value());
-  if (!re2.ok()) {
-    return CreateErrorValue(
-        arena, absl::InvalidArgumentError("Given Regex is Invalid"));
+  RegexProgram program(compiler.cache(), regex.value());
+  if (absl::Status status = compiler.Validate(*program); !status.ok()) {
+    return CreateErrorValue(arena, status);
   }
+  const RE2& re2 = *program;
   const int capturing_groups_count = re2.NumberOfCapturingGroups();
   const auto& named_capturing_groups_map = re2.CapturingGroupNames();
   if (capturing_groups_count <= 0) {
@@ -136,17 +172,18 @@ CelValue CaptureStringN(Arena* arena, CelValue::StringHolder target,
   return CelValue::CreateMap(cel_map);
 }
 
-absl::Status RegisterRegexFunctions(CelFunctionRegistry* registry) {
+absl::Status RegisterRegexFunctions(CelFunctionRegistry* registry,
+                                    const RegexCompiler& compiler) {
   // Register Regex Extract Function
   CEL_RETURN_IF_ERROR(
       (PortableFunctionAdapter<CelValue, CelValue::StringHolder,
                                CelValue::StringHolder, CelValue::StringHolder>::
            CreateAndRegister(
                kRegexExtract, /*receiver_type=*/false,
-               [](Arena* arena, CelValue::StringHolder target,
-                  CelValue::StringHolder regex,
-                  CelValue::StringHolder rewrite) -> CelValue {
-                 return ExtractString(arena, target, regex, rewrite);
+               [compiler](Arena* arena, CelValue::StringHolder target,
+                          CelValue::StringHolder regex,
+                          CelValue::StringHolder rewrite) -> CelValue {
+                 return ExtractString(compiler, arena, target, regex, rewrite);
                },
                registry)));
 
@@ -155,9 +192,9 @@ absl::Status RegisterRegexFunctions(CelFunctionRegistry* registry) {
       PortableBinaryFunctionAdapter<CelValue, CelValue::StringHolder,
                                     CelValue::StringHolder>::
           Create(kRegexCapture, /*receiver_style=*/false,
-                 [](Arena* arena, CelValue::StringHolder target,
-                    CelValue::StringHolder regex) -> CelValue {
-                   return CaptureString(arena, target, regex);
+                 [compiler](Arena* arena, CelValue::StringHolder target,
+                            CelValue::StringHolder regex) -> CelValue {
+                   return CaptureString(compiler, arena, target, regex);
                  })));
 
   // Register Regex CaptureN Function
@@ -165,9 +202,9 @@ absl::Status RegisterRegexFunctions(CelFunctionRegistry* registry) {
       PortableBinaryFunctionAdapter<CelValue, CelValue::StringHolder,
                                     CelValue::StringHolder>::
           Create(kRegexCaptureN, /*receiver_style=*/false,
-                 [](Arena* arena, CelValue::StringHolder target,
-                    CelValue::StringHolder regex) -> CelValue {
-                   return CaptureStringN(arena, target, regex);
+                 [compiler](Arena* arena, CelValue::StringHolder target,
+                            CelValue::StringHolder regex) -> CelValue {
+                   return CaptureStringN(compiler, arena, target, regex);
                  }));
 }
 
@@ -176,7 +213,8 @@ absl::Status RegisterRegexFunctions(CelFunctionRegistry* registry) {
 absl::Status RegisterRegexFunctions(CelFunctionRegistry* registry,
                                     const InterpreterOptions& options) {
   if (options.enable_regex) {
-    CEL_RETURN_IF_ERROR(RegisterRegexFunctions(registry));
+    CEL_RETURN_IF_ERROR(
+        RegisterRegexFunctions(registry, RegexCompiler(options)));
   }
   return absl::OkStatus();
 }
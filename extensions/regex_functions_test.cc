@@ -31,6 +31,7 @@
 #include "eval/public/testing/matchers.h"
 #include "internal/testing.h"
 #include "parser/parser.h"
+#include "runtime/regex_cache.h"
 
 namespace cel::extensions {
 
@@ -41,6 +42,7 @@ using cel::internal::StatusIs;
 using Builder = ::google::api::expr::runtime::CelExpressionBuilder;
 using ::google::api::expr::parser::Parse;
 using ::google::api::expr::runtime::test::IsCelError;
+using ::google::api::expr::runtime::test::IsCelList;
 using ::google::api::expr::runtime::test::IsCelString;
 using cel::internal::IsOkAndHolds;
 
@@ -192,6 +194,137 @@ TEST_F(RegexFunctionsTest, CaptureStringWithUnnamedGroups) {
   EXPECT_THAT(status, IsOkAndHolds(IsCelString("o")));
 }
 
+TEST_F(RegexFunctionsTest, CachedPatternsReused) {
+  options_.regex_cache_size = 16;
+  RegexCacheStats before = GetRegexCacheStats();
+
+  auto status = TestCaptureStringInclusion(
+      (R"([re.capture('foo', 'fo(o)'), re.capture('fooo', 'fo(o+)'),
+          re.extract('foo', 'fo(o)', '\\1'), re.capture('foo', 'fo(o+)')])"));
+  ASSERT_OK(status.status());
+  ASSERT_TRUE(status->IsList());
+  EXPECT_EQ(status->ListOrDie()->size(), 4);
+
+  RegexCacheStats after = GetRegexCacheStats();
+  EXPECT_GE(after.capacity, 16);
+  EXPECT_GE(after.hits - before.hits, 2);
+}
+
+TEST_F(RegexFunctionsTest, MaxProgramSizeExceeded) {
+  options_.regex_max_program_size = 1;
+  auto status = TestCaptureStringInclusion((R"(re.capture('foo', 'fo(o)'))"));
+  EXPECT_THAT(status.value(),
+              IsCelError(StatusIs(absl::StatusCode::kInvalidArgument,
+                                  "exceeded RE2 max program size")));
+}
+
+class RegexPrecompilationTest : public ::testing::Test {
+ public:
+  RegexPrecompilationTest() {
+    options_.enable_qualified_identifier_rewrites = true;
+    options_.enable_regex_precompilation = true;
+    builder_ = CreateCelExpressionBuilder(options_);
+  }
+
+  void SetUp() override {
+    ASSERT_OK(RegisterRegexFunctions(builder_->GetRegistry(), options_));
+  }
+
+  absl::StatusOr<CelValue> Evaluate(const std::string& expr_string,
+                                    CelValue input) {
+    CEL_ASSIGN_OR_RETURN(auto parsed_expr, Parse(expr_string));
+    CEL_ASSIGN_OR_RETURN(
+        auto expr_plan, builder_->CreateExpression(&parsed_expr.expr(),
+                                                   &parsed_expr.source_info()));
+    ::google::api::expr::runtime::Activation activation;
+    activation.InsertValue("input", input);
+    return expr_plan->Evaluate(activation, &arena_);
+  }
+
+  google::protobuf::Arena arena_;
+  google::api::expr::runtime::InterpreterOptions options_;
+  std::unique_ptr<Builder> builder_;
+};
+
+TEST_F(RegexPrecompilationTest, Extract) {
+  EXPECT_THAT(Evaluate(R"(re.extract(input, '(\\w+)@(\\w+)', '\\2!\\1'))",
+                       CelValue::CreateStringView("testuser@google")),
+              IsOkAndHolds(IsCelString("google!testuser")));
+  EXPECT_THAT(Evaluate(R"(re.extract(input, 'f(o+)(s)', '\\1\\2'))",
+                       CelValue::CreateStringView("foo")),
+              IsOkAndHolds(IsCelError(
+                  StatusIs(absl::StatusCode::kInvalidArgument,
+                           "Unable to extract string for the given regex"))));
+}
+
+TEST_F(RegexPrecompilationTest, Capture) {
+  EXPECT_THAT(Evaluate(R"(re.capture(input, 'fo(o+)'))",
+                       CelValue::CreateStringView("fooo")),
+              IsOkAndHolds(IsCelString("oo")));
+}
+
+TEST_F(RegexPrecompilationTest, CaptureN) {
+  ASSERT_OK_AND_ASSIGN(
+      CelValue result,
+      Evaluate(R"(re.captureN(input, '(?P<user>\\w+)@(\\w+)'))",
+               CelValue::CreateStringView("testuser@google")));
+  ASSERT_TRUE(result.IsMap());
+  const auto& map = *result.MapOrDie();
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_THAT(map[CelValue::CreateStringView("user")],
+              testing::Optional(IsCelString("testuser")));
+  EXPECT_THAT(map[CelValue::CreateStringView("2")],
+              testing::Optional(IsCelString("google")));
+}
+
+TEST_F(RegexPrecompilationTest, NonStringArgumentsFallBack) {
+  EXPECT_THAT(Evaluate(R"(re.capture(input, 'fo(o+)'))",
+                       CelValue::CreateInt64(1)),
+              IsOkAndHolds(IsCelError(
+                  StatusIs(absl::StatusCode::kUnknown,
+                           testing::HasSubstr("No matching overloads")))));
+}
+
+TEST_F(RegexPrecompilationTest, InvalidPatternsAreBuilderErrors) {
+  CelValue input = CelValue::CreateStringView("foo");
+  EXPECT_THAT(Evaluate(R"(re.capture(input, 'fo(o'))", input),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       testing::HasSubstr("unsupported RE2 pattern")));
+  EXPECT_THAT(Evaluate(R"(re.captureN(input, 'foo'))", input),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       testing::HasSubstr("capturing groups were not found")));
+  EXPECT_THAT(Evaluate(R"(re.extract(input, 'f(o+)', '\\2'))", input),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       testing::HasSubstr("invalid rewrite")));
+}
+
+TEST(RegexPrecompilationConstantFoldingTest, FoldedCallsAreNotRewritten) {
+  google::protobuf::Arena arena;
+  google::api::expr::runtime::InterpreterOptions options;
+  options.enable_qualified_identifier_rewrites = true;
+  options.enable_regex_precompilation = true;
+  options.constant_folding = true;
+  options.constant_arena = &arena;
+  auto builder = CreateCelExpressionBuilder(options);
+  ASSERT_OK(RegisterRegexFunctions(builder->GetRegistry(), options));
+
+  // The calls are folded to constants before regex precompilation runs; the
+  // surrounding values must stay where they are on the stack.
+  ASSERT_OK_AND_ASSIGN(
+      auto parsed_expr,
+      Parse(R"([input, re.extract('abc', 'a(b)c', '\\1'), 'y',
+                re.capture('fooo', 'fo(o+)')])"));
+  ASSERT_OK_AND_ASSIGN(auto expr_plan,
+                       builder->CreateExpression(&parsed_expr.expr(),
+                                                 &parsed_expr.source_info()));
+  ::google::api::expr::runtime::Activation activation;
+  activation.InsertValue("input", CelValue::CreateStringView("x"));
+  EXPECT_THAT(expr_plan->Evaluate(activation, &arena),
+              IsOkAndHolds(IsCelList(testing::ElementsAre(
+                  IsCelString("x"), IsCelString("b"), IsCelString("y"),
+                  IsCelString("oo")))));
+}
+
 std::vector<TestCase> createParams() {
   return {
       {// Extract String: Fails for mismatched regex
@@ -533,13 +533,15 @@ class OptimizedSelectStep : public ExpressionStepBase {
                       std::vector<AttributeQualifier> qualifiers,
                       bool presence_test,
                       bool enable_wrapper_type_null_unboxing,
+                      std::unique_ptr<BoundSelectPath> bound_path,
                       SelectOptimizationOptions options)
       : ExpressionStepBase(expr_id),
         select_path_(std::move(select_path)),
         qualifiers_(std::move(qualifiers)),
         presence_test_(presence_test),
         enable_wrapper_type_null_unboxing_(enable_wrapper_type_null_unboxing),
-        options_(options)
+        bound_path_(std::move(bound_path)),
+        options_(std::move(options))
 
   {
     ABSL_DCHECK(!select_path_.empty());
@@ -561,6 +563,8 @@ class OptimizedSelectStep : public ExpressionStepBase {
   std::vector<AttributeQualifier> qualifiers_;
   bool presence_test_;
   bool enable_wrapper_type_null_unboxing_;
+  // Select path bound to the checked operand type at plan time, if any.
+  std::unique_ptr<BoundSelectPath> bound_path_;
   SelectOptimizationOptions options_;
 };
 
@@ -615,6 +619,15 @@ AttributeTrail OptimizedSelectStep::GetAttributeTrail(
 
 absl::StatusOr<Value> OptimizedSelectStep::ApplySelect(
     ExecutionFrame* frame, const StructValue& struct_value) const {
+  if (bound_path_ != nullptr && !options_.force_fallback_implementation) {
+    CEL_ASSIGN_OR_RETURN(
+        absl::optional<Value> bound_result,
+        bound_path_->Apply(frame->value_factory(), struct_value));
+    if (bound_result.has_value()) {
+      return std::move(bound_result).value();
+    }
+  }
+
   auto value_or = (options_.force_fallback_implementation)
                       ? absl::UnimplementedError("Forced fallback impl")
                       : struct_value.Qualify(frame->value_factory(),
@@ -687,8 +700,8 @@ absl::Status OptimizedSelectStep::Evaluate(ExecutionFrame* frame) const {
 
 class SelectOptimizer : public ProgramOptimizer {
  public:
-  explicit SelectOptimizer(const SelectOptimizationOptions& options)
-      : options_(options) {}
+  SelectOptimizer(const AstImpl& ast, const SelectOptimizationOptions& options)
+      : ast_(ast), options_(options) {}
 
   absl::Status OnPreVisit(PlannerContext& context,
                           const cel::ast_internal::Expr& node) override {
@@ -699,6 +712,7 @@ class SelectOptimizer : public ProgramOptimizer {
                            const cel::ast_internal::Expr& node) override;
 
  private:
+  const AstImpl& ast_;
   SelectOptimizationOptions options_;
 };
 
@@ -769,11 +783,22 @@ absl::Status SelectOptimizer::OnPostVisit(PlannerContext& context,
   CEL_ASSIGN_OR_RETURN(auto operand_subplan, context.ExtractSubplan(operand));
   absl::c_move(operand_subplan, std::back_inserter(path));
 
+  // Bind the path to the checked type of the operand, if known, so that the
+  // fields don't need to be resolved on every evaluation.
+  std::unique_ptr<BoundSelectPath> bound_path;
+  if (options_.path_binder != nullptr) {
+    const ast_internal::Type& operand_type = ast_.GetType(operand.id());
+    if (operand_type.has_message_type()) {
+      bound_path = options_.path_binder->Bind(
+          operand_type.message_type().type(), instructions, presence_test);
+    }
+  }
+
   bool enable_wrapper_type_null_unboxing =
       context.options().enable_empty_wrapper_null_unboxing;
   path.push_back(std::make_unique<OptimizedSelectStep>(
       node.id(), std::move(instructions), std::move(qualifiers), presence_test,
-      enable_wrapper_type_null_unboxing, options_));
+      enable_wrapper_type_null_unboxing, std::move(bound_path), options_));
 
   return context.ReplaceSubplan(node, std::move(path));
 }
@@ -791,7 +816,7 @@ google::api::expr::runtime::ProgramOptimizerFactory
 CreateSelectOptimizationProgramOptimizer(
     const SelectOptimizationOptions& options) {
   return [=](PlannerContext& context, const cel::ast_internal::AstImpl& ast) {
-    return std::make_unique<SelectOptimizer>(options);
+    return std::make_unique<SelectOptimizer>(ast, options);
   };
 }
 
@@ -15,8 +15,17 @@
 #ifndef THIRD_PARTY_CEL_CPP_EXTENSIONS_SELECT_OPTIMIZATION_H_
 #define THIRD_PARTY_CEL_CPP_EXTENSIONS_SELECT_OPTIMIZATION_H_
 
+#include <memory>
+
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "base/ast_internal/ast_impl.h"
+#include "base/attribute.h"
+#include "common/value.h"
+#include "common/value_manager.h"
 #include "eval/compiler/flat_expr_builder_extensions.h"
 
 namespace cel::extensions {
@@ -24,6 +33,34 @@ namespace cel::extensions {
 constexpr char kCelAttribute[] = "@cel.attribute";
 constexpr char kFieldsHas[] = "@cel.hasField";
 
+// A select path resolved against the checked type of its operand when the
+// program is planned.
+class BoundSelectPath {
+ public:
+  virtual ~BoundSelectPath() = default;
+
+  // Applies the path to `operand`.
+  //
+  // Returns nullopt if `operand` is not an instance of the type the path was
+  // bound to. The select is then evaluated with `StructValue::Qualify`.
+  virtual absl::StatusOr<absl::optional<Value>> Apply(
+      ValueManager& value_manager, const StructValue& operand) const = 0;
+};
+
+// Resolves optimized select paths ahead of evaluation, e.g. to the field
+// descriptors of a protobuf message type, so that evaluating them doesn't
+// need to look up the fields again.
+class SelectPathBinder {
+ public:
+  virtual ~SelectPathBinder() = default;
+
+  // Binds `path` for operands of the struct type `type_name`. Returns nullptr
+  // if the path can't be bound for that type.
+  virtual std::unique_ptr<BoundSelectPath> Bind(
+      absl::string_view type_name, absl::Span<const SelectQualifier> path,
+      bool presence_test) const = 0;
+};
+
 // Configuration options for the select optimization.
 struct SelectOptimizationOptions {
   // Force the program to use the fallback implementation for the select.
@@ -34,6 +71,11 @@ struct SelectOptimizationOptions {
   // unimplemented for a given StructType. This option is exposed for testing or
   // to more closely match behavior of unoptimized expressions.
   bool force_fallback_implementation = false;
+
+  // If set, select paths on operands with a checked struct type are bound
+  // when the program is planned. Paths that can't be bound, and operands of
+  // another type at runtime, use the Qualify implementation.
+  std::shared_ptr<const SelectPathBinder> path_binder;
 };
 
 // Scans ast for optimizable select branches.
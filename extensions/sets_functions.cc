@@ -14,6 +14,8 @@
 
 #include "extensions/sets_functions.h"
 
+#include <cstddef>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "base/function_adapter.h"
@@ -21,15 +23,70 @@
 #include "common/value_manager.h"
 #include "internal/status_macros.h"
 #include "runtime/function_registry.h"
+#include "runtime/internal/list_membership_index.h"
 #include "runtime/runtime_options.h"
 
 namespace cel::extensions {
 
 namespace {
 
+using ::cel::runtime_internal::ListMembershipIndex;
+
+// Below this size, probing the list with ListValue::Contains is cheaper than
+// hashing its elements.
+constexpr size_t kMinIndexedListSize = 8;
+
+bool ShouldIndex(const ListValue& indexed, const ListValue& probed) {
+  return indexed.Size() >= kMinIndexedListSize && probed.Size() > 1;
+}
+
+// Hashed implementation of sets.contains, O(n + m) instead of O(n * m).
+absl::StatusOr<Value> SetsContainsIndexed(ValueManager& value_factory,
+                                          const ListValue& list,
+                                          const ListValue& sublist) {
+  ListMembershipIndex index;
+  CEL_RETURN_IF_ERROR(index.Build(value_factory, list));
+  bool any_missing = false;
+  Value scratch;
+  CEL_RETURN_IF_ERROR(sublist.ForEach(
+      value_factory,
+      [&index, &value_factory, &scratch,
+       &any_missing](ValueView sublist_element) -> absl::StatusOr<bool> {
+        CEL_ASSIGN_OR_RETURN(
+            bool contains,
+            index.Contains(value_factory, sublist_element, scratch));
+        any_missing = !contains;
+        return !any_missing;
+      }));
+  return value_factory.CreateBoolValue(!any_missing);
+}
+
+// Hashed implementation of sets.intersects. Indexes the smaller list and
+// probes it with the elements of the larger one.
+absl::StatusOr<Value> SetsIntersectsIndexed(ValueManager& value_factory,
+                                            const ListValue& smaller,
+                                            const ListValue& larger) {
+  ListMembershipIndex index;
+  CEL_RETURN_IF_ERROR(index.Build(value_factory, smaller));
+  bool exists = false;
+  Value scratch;
+  CEL_RETURN_IF_ERROR(larger.ForEach(
+      value_factory,
+      [&index, &value_factory, &scratch,
+       &exists](ValueView element) -> absl::StatusOr<bool> {
+        CEL_ASSIGN_OR_RETURN(exists,
+                             index.Contains(value_factory, element, scratch));
+        return !exists;
+      }));
+  return value_factory.CreateBoolValue(exists);
+}
+
 absl::StatusOr<Value> SetsContains(ValueManager& value_factory,
                                    const ListValue& list,
                                    const ListValue& sublist) {
+  if (ShouldIndex(list, sublist)) {
+    return SetsContainsIndexed(value_factory, list, sublist);
+  }
   bool any_missing = false;
   CEL_RETURN_IF_ERROR(sublist.ForEach(
       value_factory,
@@ -50,6 +107,12 @@ absl::StatusOr<Value> SetsContains(ValueManager& value_factory,
 absl::StatusOr<Value> SetsIntersects(ValueManager& value_factory,
                                      const ListValue& list,
                                      const ListValue& sublist) {
+  const bool list_is_smaller = list.Size() <= sublist.Size();
+  const ListValue& smaller = list_is_smaller ? list : sublist;
+  const ListValue& larger = list_is_smaller ? sublist : list;
+  if (ShouldIndex(smaller, larger)) {
+    return SetsIntersectsIndexed(value_factory, smaller, larger);
+  }
   bool exists = false;
   CEL_RETURN_IF_ERROR(list.ForEach(
       value_factory,
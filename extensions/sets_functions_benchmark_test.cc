@@ -328,6 +328,112 @@ void BM_SetsEquivalentComprehensionFalse(benchmark::State& state) {
       state);
 }
 
+// Distinct elements, as in large entitlement lists: x holds the ints
+// [0, len) and y holds the same values as uints in reverse order, or the
+// uints [len, 2 * len) if the lists shouldn't overlap.
+absl::StatusOr<std::unique_ptr<ListStorage>> RegisterDistinctLists(
+    bool overlap, int len, bool use_modern, cel::ValueManager& value_factory,
+    Activation& activation) {
+  if (!use_modern) {
+    std::vector<CelValue> x;
+    std::vector<CelValue> y;
+    x.reserve(len);
+    y.reserve(len);
+    for (int i = 0; i < len; i++) {
+      x.push_back(CelValue::CreateInt64(i));
+      y.push_back(CelValue::CreateUint64(overlap ? len - 1 - i : len + i));
+    }
+    auto result = std::make_unique<LegacyListStorage>(
+        ContainerBackedListImpl(std::move(x)),
+        ContainerBackedListImpl(std::move(y)));
+    activation.InsertValue("x", result->x());
+    activation.InsertValue("y", result->y());
+    return result;
+  }
+
+  auto list_type = value_factory.CreateListType(value_factory.GetDynType());
+  CEL_ASSIGN_OR_RETURN(auto x_builder,
+                       value_factory.NewListValueBuilder(list_type));
+  CEL_ASSIGN_OR_RETURN(auto y_builder,
+                       value_factory.NewListValueBuilder(list_type));
+  x_builder->Reserve(len);
+  y_builder->Reserve(len);
+  for (int i = 0; i < len; i++) {
+    CEL_RETURN_IF_ERROR(x_builder->Add(value_factory.CreateIntValue(i)));
+    CEL_RETURN_IF_ERROR(y_builder->Add(
+        value_factory.CreateUintValue(overlap ? len - 1 - i : len + i)));
+  }
+  auto result = std::make_unique<ModernListStorage>(
+      std::move(*x_builder).Build(), std::move(*y_builder).Build());
+  activation.InsertValue("x", result->x());
+  activation.InsertValue("y", result->y());
+  return result;
+}
+
+void RunDistinctBenchmark(const TestCase& test_case, benchmark::State& state) {
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse(test_case.expr));
+
+  google::protobuf::Arena arena;
+  auto manager = ProtoMemoryManagerRef(&arena);
+  cel::common_internal::LegacyValueManager value_factory(
+      manager, TypeProvider::Builtin());
+
+  InterpreterOptions options;
+  options.enable_qualified_identifier_rewrites = true;
+  auto builder = CreateCelExpressionBuilder(options);
+  ASSERT_OK(RegisterBuiltinFunctions(builder->GetRegistry(), options));
+  ASSERT_OK(RegisterSetsFunctions(builder->GetRegistry()->InternalGetRegistry(),
+                                  cel::RuntimeOptions{}));
+  ASSERT_OK_AND_ASSIGN(
+      auto cel_expr, builder->CreateExpression(&(parsed_expr.expr()), nullptr));
+
+  Activation activation;
+  ASSERT_OK_AND_ASSIGN(
+      auto storage,
+      RegisterDistinctLists(test_case.result.BoolOrDie(), test_case.size,
+                            test_case.list_impl == ListImpl::kWrappedModern,
+                            value_factory, activation));
+
+  state.SetLabel(test_case.MakeLabel(test_case.size));
+  for (auto _ : state) {
+    google::protobuf::Arena eval_arena;
+    ASSERT_OK_AND_ASSIGN(CelValue result,
+                         cel_expr->Evaluate(activation, &eval_arena));
+    ASSERT_TRUE(result.IsBool());
+    ASSERT_EQ(result.BoolOrDie(), test_case.result.BoolOrDie())
+        << test_case.test_name;
+  }
+  state.SetItemsProcessed(state.iterations() * test_case.size);
+}
+
+void BM_SetsContainsDistinct(benchmark::State& state) {
+  ListImpl impl = FromNumber(state.range(0));
+  int size = state.range(1);
+
+  RunDistinctBenchmark({"sets.contains_distinct", "sets.contains(x, y)", impl,
+                        size, CelValue::CreateBool(true)},
+                       state);
+}
+
+void BM_SetsIntersectsDistinctFalse(benchmark::State& state) {
+  ListImpl impl = FromNumber(state.range(0));
+  int size = state.range(1);
+
+  RunDistinctBenchmark({"sets.intersects_distinct_false",
+                        "sets.intersects(x, y)", impl, size,
+                        CelValue::CreateBool(false)},
+                       state);
+}
+
+void BM_SetsEquivalentDistinct(benchmark::State& state) {
+  ListImpl impl = FromNumber(state.range(0));
+  int size = state.range(1);
+
+  RunDistinctBenchmark({"sets.equivalent_distinct", "sets.equivalent(x, y)",
+                        impl, size, CelValue::CreateBool(true)},
+                       state);
+}
+
 template <typename Benchmark>
 void BenchArgs(Benchmark* bench) {
   for (ListImpl impl :
@@ -348,5 +454,18 @@ BENCHMARK(BM_SetsEquivalentComprehensionFalse)->Apply(BenchArgs);
 BENCHMARK(BM_SetsEquivalentTrue)->Apply(BenchArgs);
 BENCHMARK(BM_SetsEquivalentFalse)->Apply(BenchArgs);
 
+template <typename Benchmark>
+void DistinctBenchArgs(Benchmark* bench) {
+  for (ListImpl impl : {ListImpl::kLegacy, ListImpl::kWrappedModern}) {
+    for (int size : {10000, 100000, 1000000}) {
+      bench->ArgPair(ToNumber(impl), size);
+    }
+  }
+}
+
+BENCHMARK(BM_SetsContainsDistinct)->Apply(DistinctBenchArgs);
+BENCHMARK(BM_SetsIntersectsDistinctFalse)->Apply(DistinctBenchArgs);
+BENCHMARK(BM_SetsEquivalentDistinct)->Apply(DistinctBenchArgs);
+
 }  // namespace
 }  // namespace cel::extensions
@@ -159,6 +159,19 @@ INSTANTIATE_TEST_SUITE_P(
 
         {"sets.equivalent([{'foo': true, 'bar': false}], [{'bar': false, "
          "'foo': true}])"},
+
+        // Lists large enough to be indexed rather than scanned.
+        {"sets.contains([1, 2, 3, 4, 5, 6, 7, 8], [8u, 1.0, 4])"},
+        {"!sets.contains([1, 2, 3, 4, 5, 6, 7, 8], [8u, 9])"},
+        {"!sets.contains([1, 2, 3, 4, 5, 6, 7, 8, double('nan')], "
+         "[1, double('nan')])"},
+        {"sets.intersects([9, 10], [1, 2, 3, 4, 5, 6, 7, 8, 9.0])"},
+        {"sets.intersects([1, 2, 3, 4, 5, 6, 7, 8, 9.0], [9u, 10])"},
+        {"!sets.intersects([0.5, 10], [1, 2, 3, 4, 5, 6, 7, 8, 9])"},
+        {"sets.equivalent([1, 2, 3, 4, 5, 6, 7, 8, 'a', [1]], "
+         "[[1.0], 'a', 8u, 7, 6, 5, 4, 3, 2, 1.0])"},
+        {"!sets.equivalent([1, 2, 3, 4, 5, 6, 7, 8, 'a', [1]], "
+         "[[2], 'a', 8, 7, 6, 5, 4, 3, 2, 1])"},
     }));
 
 }  // namespace
@@ -0,0 +1,273 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "extensions/strings.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/functional/overload.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "base/function_adapter.h"
+#include "common/casting.h"
+#include "common/json.h"
+#include "common/memory.h"
+#include "common/native_type.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "internal/status_macros.h"
+#include "runtime/function_registry.h"
+#include "runtime/runtime_options.h"
+
+namespace cel::extensions {
+
+namespace {
+
+// Byte range of a single element of a split list within its source string.
+struct SplitPiece {
+  size_t offset;
+  size_t size;
+};
+
+// List returned by `split`. Rather than copying every substring up front, the
+// list keeps a reference to the source string and the byte ranges of its
+// elements. Elements are materialized on access as subranges of the source
+// cord, which share its storage instead of copying it.
+class SplitListValue final : public ParsedListValueInterface {
+ public:
+  SplitListValue(absl::Cord source, std::vector<SplitPiece> pieces)
+      : source_(std::move(source)), pieces_(std::move(pieces)) {}
+
+  std::string DebugString() const override {
+    std::string out = "[";
+    for (size_t i = 0; i < pieces_.size(); ++i) {
+      if (i > 0) {
+        out.append(", ");
+      }
+      out.append(StringValue(Element(i)).DebugString());
+    }
+    out.push_back(']');
+    return out;
+  }
+
+  bool IsEmpty() const override { return pieces_.empty(); }
+
+  size_t Size() const override { return pieces_.size(); }
+
+  absl::StatusOr<JsonArray> ConvertToJsonArray(
+      AnyToJsonConverter&) const override {
+    JsonArrayBuilder builder;
+    builder.reserve(pieces_.size());
+    for (size_t i = 0; i < pieces_.size(); ++i) {
+      builder.push_back(JsonString(Element(i)));
+    }
+    return std::move(builder).Build();
+  }
+
+  absl::StatusOr<ValueView> Contains(
+      ValueManager& value_manager, ValueView other,
+      Value& scratch ABSL_ATTRIBUTE_LIFETIME_BOUND) const override {
+    auto string_value = As<StringValueView>(other);
+    if (!string_value.has_value()) {
+      return ParsedListValueInterface::Contains(value_manager, other, scratch);
+    }
+    for (size_t i = 0; i < pieces_.size(); ++i) {
+      if (string_value->Equals(Element(i))) {
+        return BoolValueView{true};
+      }
+    }
+    return BoolValueView{false};
+  }
+
+ private:
+  absl::Cord Element(size_t index) const {
+    const SplitPiece& piece = pieces_[index];
+    return source_.Subcord(piece.offset, piece.size);
+  }
+
+  absl::StatusOr<ValueView> GetImpl(ValueManager&, size_t index,
+                                    Value& scratch) const override {
+    scratch = StringValue(Element(index));
+    return scratch;
+  }
+
+  NativeTypeId GetNativeTypeId() const noexcept override {
+    return NativeTypeId::For<SplitListValue>();
+  }
+
+  const absl::Cord source_;
+  const std::vector<SplitPiece> pieces_;
+};
+
+template <typename Delimiter>
+std::vector<SplitPiece> SplitPieces(absl::string_view text,
+                                    Delimiter delimiter) {
+  std::vector<SplitPiece> pieces;
+  for (absl::string_view piece : absl::StrSplit(text, delimiter)) {
+    pieces.push_back(
+        SplitPiece{static_cast<size_t>(piece.data() - text.data()),
+                   piece.size()});
+  }
+  return pieces;
+}
+
+absl::StatusOr<Value> SplitWithLimit(ValueManager& value_manager,
+                                     const StringValue& string,
+                                     const StringValue& delimiter,
+                                     int64_t limit) {
+  // As per specifications[1], a limit of 0 returns an empty list and a
+  // negative limit splits on every occurrence of the delimiter.
+  // 1. https://pkg.go.dev/github.com/google/cel-go/ext#Strings
+  absl::Cord source;
+  std::vector<SplitPiece> pieces;
+  if (limit != 0) {
+    std::string string_scratch;
+    std::string delimiter_scratch;
+    absl::string_view text = string.NativeString(string_scratch);
+    absl::string_view separator = delimiter.NativeString(delimiter_scratch);
+    if (limit < 0) {
+      pieces = SplitPieces(text, separator);
+    } else {
+      // absl::MaxSplits produces at most limit + 1 elements, where the
+      // specification asks for at most limit elements.
+      int max_splits = static_cast<int>(
+          std::min<int64_t>(limit - 1, std::numeric_limits<int>::max()));
+      pieces = SplitPieces(text, absl::MaxSplits(separator, max_splits));
+    }
+    // For reference counted and cord backed strings this shares the
+    // underlying storage rather than copying it.
+    source = string.NativeCord();
+  }
+  return ParsedListValue(
+      value_manager.GetMemoryManager().MakeShared<SplitListValue>(
+          std::move(source), std::move(pieces)));
+}
+
+absl::StatusOr<Value> Split(ValueManager& value_manager,
+                            const StringValue& string,
+                            const StringValue& delimiter) {
+  return SplitWithLimit(value_manager, string, delimiter, -1);
+}
+
+absl::StatusOr<Value> JoinWithSeparator(ValueManager& value_manager,
+                                        const ListValue& list,
+                                        const StringValue& separator) {
+  std::string separator_scratch;
+  absl::string_view separator_view = separator.NativeString(separator_scratch);
+
+  // Compute the size of the result first, so that it is allocated once.
+  size_t result_size = 0;
+  bool all_strings = true;
+  CEL_RETURN_IF_ERROR(list.ForEach(
+      value_manager,
+      [&](size_t index, ValueView element) -> absl::StatusOr<bool> {
+        auto string_element = As<StringValueView>(element);
+        if (!string_element.has_value()) {
+          all_strings = false;
+          return false;
+        }
+        if (index > 0) {
+          result_size += separator_view.size();
+        }
+        result_size += string_element->NativeValue(
+            [](const auto& value) -> size_t { return value.size(); });
+        return true;
+      }));
+  if (!all_strings) {
+    return value_manager.CreateErrorValue(
+        absl::InvalidArgumentError("join: list contains non-string elements"));
+  }
+
+  std::string result;
+  result.reserve(result_size);
+  CEL_RETURN_IF_ERROR(list.ForEach(
+      value_manager,
+      [&](size_t index, ValueView element) -> absl::StatusOr<bool> {
+        if (index > 0) {
+          result.append(separator_view.data(), separator_view.size());
+        }
+        Cast<StringValueView>(element).NativeValue(absl::Overload(
+            [&result](absl::string_view value) {
+              result.append(value.data(), value.size());
+            },
+            [&result](const absl::Cord& value) {
+              for (absl::string_view chunk : value.Chunks()) {
+                result.append(chunk.data(), chunk.size());
+              }
+            }));
+        return true;
+      }));
+  return StringValue(std::move(result));
+}
+
+absl::StatusOr<Value> Join(ValueManager& value_manager,
+                           const ListValue& list) {
+  return JoinWithSeparator(value_manager, list, StringValue());
+}
+
+absl::Status RegisterSplitFunctions(FunctionRegistry& registry) {
+  CEL_RETURN_IF_ERROR(registry.Register(
+      BinaryFunctionAdapter<
+          absl::StatusOr<Value>, const StringValue&,
+          const StringValue&>::CreateDescriptor("split",
+                                                /*receiver_style=*/true),
+      BinaryFunctionAdapter<absl::StatusOr<Value>, const StringValue&,
+                            const StringValue&>::WrapFunction(Split)));
+  return registry.Register(
+      VariadicFunctionAdapter<
+          absl::StatusOr<Value>, const StringValue&, const StringValue&,
+          int64_t>::CreateDescriptor("split", /*receiver_style=*/true),
+      VariadicFunctionAdapter<absl::StatusOr<Value>, const StringValue&,
+                              const StringValue&,
+                              int64_t>::WrapFunction(SplitWithLimit));
+}
+
+absl::Status RegisterJoinFunctions(FunctionRegistry& registry) {
+  CEL_RETURN_IF_ERROR(registry.Register(
+      UnaryFunctionAdapter<absl::StatusOr<Value>, const ListValue&>::
+          CreateDescriptor("join", /*receiver_style=*/true),
+      UnaryFunctionAdapter<absl::StatusOr<Value>,
+                           const ListValue&>::WrapFunction(Join)));
+  return registry.Register(
+      BinaryFunctionAdapter<
+          absl::StatusOr<Value>, const ListValue&,
+          const StringValue&>::CreateDescriptor("join",
+                                                /*receiver_style=*/true),
+      BinaryFunctionAdapter<
+          absl::StatusOr<Value>, const ListValue&,
+          const StringValue&>::WrapFunction(JoinWithSeparator));
+}
+
+}  // namespace
+
+absl::Status RegisterStringsFunctions(FunctionRegistry& registry,
+                                      const RuntimeOptions& options) {
+  if (options.enable_string_concat) {
+    CEL_RETURN_IF_ERROR(RegisterJoinFunctions(registry));
+  }
+  CEL_RETURN_IF_ERROR(RegisterSplitFunctions(registry));
+  return absl::OkStatus();
+}
+
+}  // namespace cel::extensions
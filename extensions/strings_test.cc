@@ -0,0 +1,130 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "extensions/strings.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "eval/public/activation.h"
+#include "eval/public/builtin_func_registrar.h"
+#include "eval/public/cel_expr_builder_factory.h"
+#include "eval/public/cel_expression.h"
+#include "eval/public/cel_options.h"
+#include "eval/public/cel_value.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/runtime_options.h"
+#include "google/protobuf/arena.h"
+
+namespace cel::extensions {
+namespace {
+using ::google::api::expr::v1alpha1::ParsedExpr;
+
+using ::google::api::expr::parser::Parse;
+using ::google::api::expr::runtime::Activation;
+using ::google::api::expr::runtime::CelExpressionBuilder;
+using ::google::api::expr::runtime::CelValue;
+using ::google::api::expr::runtime::CreateCelExpressionBuilder;
+using ::google::api::expr::runtime::InterpreterOptions;
+
+using ::google::protobuf::Arena;
+using cel::internal::IsOk;
+using testing::HasSubstr;
+
+struct TestInfo {
+  std::string expr;
+};
+
+std::unique_ptr<CelExpressionBuilder> CreateBuilder() {
+  InterpreterOptions options;
+  options.enable_heterogeneous_equality = true;
+  std::unique_ptr<CelExpressionBuilder> builder =
+      CreateCelExpressionBuilder(options);
+  EXPECT_THAT(
+      RegisterStringsFunctions(builder->GetRegistry()->InternalGetRegistry(),
+                               cel::RuntimeOptions{}),
+      IsOk());
+  EXPECT_THAT(google::api::expr::runtime::RegisterBuiltinFunctions(
+                  builder->GetRegistry(), options),
+              IsOk());
+  return builder;
+}
+
+class CelStringsFunctionsTest : public testing::TestWithParam<TestInfo> {};
+
+TEST_P(CelStringsFunctionsTest, EndToEnd) {
+  const TestInfo& test_info = GetParam();
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse(test_info.expr));
+  std::unique_ptr<CelExpressionBuilder> builder = CreateBuilder();
+  ASSERT_OK_AND_ASSIGN(auto cel_expr,
+                       builder->CreateExpression(&parsed_expr.expr(),
+                                                 &parsed_expr.source_info()));
+  Arena arena;
+  Activation activation;
+  ASSERT_OK_AND_ASSIGN(CelValue out, cel_expr->Evaluate(activation, &arena));
+  ASSERT_TRUE(out.IsBool()) << test_info.expr << " -> " << out.DebugString();
+  EXPECT_TRUE(out.BoolOrDie()) << test_info.expr << " -> " << out.DebugString();
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CelStringsFunctionsTest, CelStringsFunctionsTest,
+    testing::ValuesIn<TestInfo>({
+        {"'a,b,c'.split(',') == ['a', 'b', 'c']"},
+        {"'a,,c,'.split(',') == ['a', '', 'c', '']"},
+        {"'abc'.split(',') == ['abc']"},
+        {"''.split(',') == ['']"},
+        {"'abc'.split('') == ['a', 'b', 'c']"},
+        {"'a::b::c'.split('::') == ['a', 'b', 'c']"},
+        {"'a,b,c'.split(',', -1) == ['a', 'b', 'c']"},
+        {"'a,b,c'.split(',', 0) == []"},
+        {"'a,b,c'.split(',', 1) == ['a,b,c']"},
+        {"'a,b,c'.split(',', 2) == ['a', 'b,c']"},
+        {"'a,b,c'.split(',', 5) == ['a', 'b', 'c']"},
+        {"size('a,b,c'.split(',')) == 3"},
+        {"'a,b,c'.split(',')[1] == 'b'"},
+        {"'b' in 'a,b,c'.split(',')"},
+        {"!('d' in 'a,b,c'.split(','))"},
+        {"!(1 in 'a,b,c'.split(','))"},
+        {"'a,b,c'.split(',') + ['d'] == ['a', 'b', 'c', 'd']"},
+        {"'a,b,c'.split(',').exists(x, x == 'c')"},
+        {"'a,b,c'.split(',').map(x, x + x) == ['aa', 'bb', 'cc']"},
+        {"['a', 'b', 'c'].join() == 'abc'"},
+        {"['a', 'b', 'c'].join(', ') == 'a, b, c'"},
+        {"[].join(',') == ''"},
+        {"['a'].join(',') == 'a'"},
+        {"['', ''].join(',') == ','"},
+        {"'a,b,c'.split(',').join('-') == 'a-b-c'"},
+        {"'this is a longer source string, long enough that its elements "
+         "are not inlined'.split(', ').join(', ') == 'this is a longer source "
+         "string, long enough that its elements are not inlined'"},
+    }));
+
+TEST(CelStringsFunctionsTest, JoinNonStringElements) {
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse("['a', 1].join()"));
+  std::unique_ptr<CelExpressionBuilder> builder = CreateBuilder();
+  ASSERT_OK_AND_ASSIGN(auto cel_expr,
+                       builder->CreateExpression(&parsed_expr.expr(),
+                                                 &parsed_expr.source_info()));
+  Arena arena;
+  Activation activation;
+  ASSERT_OK_AND_ASSIGN(CelValue out, cel_expr->Evaluate(activation, &arena));
+  ASSERT_TRUE(out.IsError()) << out.DebugString();
+  EXPECT_THAT(out.ErrorOrDie()->message(), HasSubstr("non-string"));
+}
+
+}  // namespace
+}  // namespace cel::extensions
@@ -14,6 +14,7 @@
 
 #include "internal/proto_wire.h"
 
+#include <cstring>
 #include <limits>
 #include <string>
 #include <utility>
@@ -160,4 +161,67 @@ absl::Status ProtoWireEncoder::WriteLengthDelimited(absl::string_view data) {
   return absl::OkStatus();
 }
 
+absl::Status ProtoWireReverseEncoder::WriteLength(size_t length) {
+  if (ABSL_PREDICT_FALSE(length > std::numeric_limits<uint32_t>::max())) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("out of range length encountered encoding ", message_));
+  }
+  WriteVarint(length);
+  return absl::OkStatus();
+}
+
+void ProtoWireReverseEncoder::WriteBytes(absl::string_view data) {
+  if (data.size() <= kBlockSize - used_) {
+    used_ += data.size();
+    std::memcpy(block_ + (kBlockSize - used_), data.data(), data.size());
+    return;
+  }
+  Flush();
+  if (data.size() > kBlockSize) {
+    output_.Prepend(data);
+    flushed_ += data.size();
+    return;
+  }
+  used_ = data.size();
+  std::memcpy(block_ + (kBlockSize - used_), data.data(), data.size());
+}
+
+void ProtoWireReverseEncoder::WriteBytes(const absl::Cord& data) {
+  if (auto flat = data.TryFlat(); flat.has_value()) {
+    WriteBytes(*flat);
+    return;
+  }
+  // Share the cord's chunks instead of copying them.
+  Flush();
+  output_.Prepend(data);
+  flushed_ += data.size();
+}
+
+void ProtoWireReverseEncoder::Truncate(size_t size) {
+  ABSL_DCHECK_LE(size, this->size());
+  if (size >= flushed_) {
+    used_ = size - flushed_;
+    return;
+  }
+  output_.RemovePrefix(flushed_ - size);
+  flushed_ = size;
+  used_ = 0;
+}
+
+void ProtoWireReverseEncoder::Finish() {
+  Flush();
+  data_.Append(std::move(output_));
+  output_.Clear();
+  flushed_ = 0;
+}
+
+void ProtoWireReverseEncoder::Flush() {
+  if (used_ == 0) {
+    return;
+  }
+  output_.Prepend(absl::string_view(block_ + (kBlockSize - used_), used_));
+  flushed_ += used_;
+  used_ = 0;
+}
+
 }  // namespace cel::internal
@@ -506,6 +506,89 @@ class ProtoWireEncoder final {
   absl::optional<ProtoWireTag> tag_;
 };
 
+// `ProtoWireReverseEncoder` writes a message back to front: fields are written
+// last to first, and each field's value is written before its tag. The length
+// of a length delimited field is then known once its contents are written, so
+// nested messages are neither serialized separately nor sized in a separate
+// pass:
+//
+//   const size_t mark = encoder.size();
+//   ... write the nested message ...
+//   CEL_RETURN_IF_ERROR(encoder.WriteLength(encoder.size() - mark));
+//   encoder.WriteTag(tag);
+//
+// Bytes are staged in a fixed block and prepended to an internal cord as the
+// block fills. Nothing is appended to `data` until `Finish()`, so abandoning
+// the encoder on error leaves `data` untouched.
+class ProtoWireReverseEncoder final {
+ public:
+  explicit ProtoWireReverseEncoder(absl::string_view message
+                                       ABSL_ATTRIBUTE_LIFETIME_BOUND,
+                                   absl::Cord& data
+                                       ABSL_ATTRIBUTE_LIFETIME_BOUND)
+      : message_(message), data_(data) {}
+
+  ProtoWireReverseEncoder(const ProtoWireReverseEncoder&) = delete;
+  ProtoWireReverseEncoder& operator=(const ProtoWireReverseEncoder&) = delete;
+
+  bool empty() const { return size() == 0; }
+
+  // Number of bytes written so far.
+  size_t size() const { return flushed_ + used_; }
+
+  void WriteTag(ProtoWireTag tag) {
+    ABSL_DCHECK_NE(tag.field_number(), 0);
+    ABSL_DCHECK(ProtoWireTypeIsValid(tag.type()));
+    WriteVarint(static_cast<uint32_t>(tag));
+  }
+
+  void WriteVarint(uint64_t value) {
+    VarintEncodeUnsafe(value, Reserve(VarintSize(value)));
+  }
+
+  void WriteFixed64(uint64_t value) { Fixed64EncodeUnsafe(value, Reserve(8)); }
+
+  void WriteFixed64(double value) {
+    WriteFixed64(absl::bit_cast<uint64_t>(value));
+  }
+
+  // Writes the length prefix of a length delimited field whose contents are
+  // the last `length` bytes written.
+  absl::Status WriteLength(size_t length);
+
+  // Writes raw bytes, typically the contents of a length delimited field.
+  void WriteBytes(absl::string_view data);
+  void WriteBytes(const absl::Cord& data);
+
+  // Discards everything written after `size()` was `size`.
+  void Truncate(size_t size);
+
+  // Appends the encoded message to `data`.
+  void Finish();
+
+ private:
+  static constexpr size_t kBlockSize = 4096;
+
+  // Returns space for `n` bytes immediately before the bytes written so far.
+  char* Reserve(size_t n) {
+    ABSL_DCHECK_LE(n, kBlockSize);
+    if (ABSL_PREDICT_FALSE(kBlockSize - used_ < n)) {
+      Flush();
+    }
+    used_ += n;
+    return block_ + (kBlockSize - used_);
+  }
+
+  void Flush();
+
+  absl::string_view message_;
+  absl::Cord& data_;
+  absl::Cord output_;
+  size_t flushed_ = 0;
+  size_t used_ = 0;
+  char block_[kBlockSize];
+};
+
 }  // namespace cel::internal
 
 #endif  // THIRD_PARTY_CEL_CPP_INTERNAL_PROTO_WIRE_H_
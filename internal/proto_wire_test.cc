@@ -14,9 +14,13 @@
 
 #include "internal/proto_wire.h"
 
+#include <cstddef>
 #include <limits>
+#include <string>
+#include <vector>
 
 #include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "internal/testing.h"
 
@@ -285,6 +289,75 @@ TEST(ProtoWireEncoder, LengthDelimited) {
             "foo");
 }
 
+TEST(ProtoWireReverseEncoder, Scalars) {
+  absl::Cord data("prefix");
+  ProtoWireReverseEncoder encoder("foo.Bar", data);
+  EXPECT_TRUE(encoder.empty());
+  encoder.WriteFixed64(0.0);
+  encoder.WriteTag(ProtoWireTag(2, ProtoWireType::kFixed64));
+  encoder.WriteVarint(1);
+  encoder.WriteTag(ProtoWireTag(1, ProtoWireType::kVarint));
+  EXPECT_EQ(encoder.size(), 11);
+  EXPECT_EQ(data, "prefix");
+  encoder.Finish();
+  EXPECT_EQ(data, absl::StrCat("prefix",
+                               absl::string_view("\x08\x01\x11\x00\x00\x00"
+                                                 "\x00\x00\x00\x00\x00",
+                                                 11)));
+}
+
+TEST(ProtoWireReverseEncoder, LengthDelimited) {
+  absl::Cord data;
+  ProtoWireReverseEncoder encoder("foo.Bar", data);
+  encoder.WriteBytes(absl::Cord("foo"));
+  EXPECT_OK(encoder.WriteLength(3));
+  encoder.WriteTag(ProtoWireTag(1, ProtoWireType::kLengthDelimited));
+  encoder.Finish();
+  EXPECT_EQ(data,
+            "\x0a\x03"
+            "foo");
+}
+
+TEST(ProtoWireReverseEncoder, MatchesForwardEncoderAcrossBlocks) {
+  absl::Cord expected;
+  ProtoWireEncoder forward("foo.Bar", expected);
+  absl::Cord data;
+  ProtoWireReverseEncoder reverse("foo.Bar", data);
+  std::vector<std::string> strings;
+  for (int i = 0; i < 2048; ++i) {
+    strings.push_back(
+        std::string(static_cast<size_t>(i % 7) * 1000, 'a' + i % 26));
+  }
+  for (const auto& string : strings) {
+    EXPECT_OK(
+        forward.WriteTag(ProtoWireTag(1, ProtoWireType::kLengthDelimited)));
+    EXPECT_OK(forward.WriteLengthDelimited(string));
+  }
+  forward.EnsureFullyEncoded();
+  for (auto it = strings.rbegin(); it != strings.rend(); ++it) {
+    reverse.WriteBytes(*it);
+    EXPECT_OK(reverse.WriteLength(it->size()));
+    reverse.WriteTag(ProtoWireTag(1, ProtoWireType::kLengthDelimited));
+  }
+  EXPECT_EQ(reverse.size(), expected.size());
+  reverse.Finish();
+  EXPECT_EQ(data, expected);
+}
+
+TEST(ProtoWireReverseEncoder, Truncate) {
+  absl::Cord data;
+  ProtoWireReverseEncoder encoder("foo.Bar", data);
+  encoder.WriteBytes("foo");
+  const size_t mark = encoder.size();
+  encoder.WriteBytes(std::string(10000, 'x'));
+  encoder.WriteBytes("bar");
+  encoder.Truncate(mark);
+  EXPECT_EQ(encoder.size(), 3);
+  encoder.WriteBytes("baz");
+  encoder.Finish();
+  EXPECT_EQ(data, "bazfoo");
+}
+
 }  // namespace
 
 }  // namespace cel::internal
@@ -15,6 +15,7 @@
 #ifndef THIRD_PARTY_CEL_CPP_RUNTIME_ACTIVATION_INTERFACE_H_
 #define THIRD_PARTY_CEL_CPP_RUNTIME_ACTIVATION_INTERFACE_H_
 
+#include <cstddef>
 #include <vector>
 
 #include "absl/status/statusor.h"
@@ -53,6 +54,17 @@ class ActivationInterface {
     return Value{*maybe};
   }
 
+  // Find value for a variable that the program resolved to a declared variable
+  // index at plan time (see Program::GetDeclaredVariables).
+  //
+  // name is the variable's name. The default implementation ignores the index
+  // and looks the variable up by name.
+  virtual absl::StatusOr<absl::optional<ValueView>> FindVariableAt(
+      ValueManager& factory, size_t index, absl::string_view name,
+      Value& scratch ABSL_ATTRIBUTE_LIFETIME_BOUND) const {
+    return FindVariable(factory, name, scratch);
+  }
+
   // Find a set of context function overloads by name.
   virtual std::vector<FunctionOverloadReference> FindFunctionOverloads(
       absl::string_view name) const = 0;
@@ -0,0 +1,427 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runtime/compact_map_value.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "absl/base/nullability.h"
+#include "absl/base/optimization.h"
+#include "absl/hash/hash.h"
+#include "absl/log/absl_log.h"
+#include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "common/casting.h"
+#include "common/json.h"
+#include "common/memory.h"
+#include "common/native_type.h"
+#include "common/type.h"
+#include "common/value.h"
+#include "common/value_kind.h"
+#include "common/value_manager.h"
+#include "internal/status_macros.h"
+
+namespace cel {
+namespace {
+
+// Maps with at most this many entries are searched without an index.
+constexpr size_t kLinearScanLimit = 8;
+
+struct Entry {
+  Value key;
+  Value value;
+  size_t hash;
+};
+
+size_t HashKey(ValueView key) {
+  switch (key.kind()) {
+    case ValueKind::kBool:
+      return absl::HashOf(ValueKind::kBool, Cast<BoolValueView>(key));
+    case ValueKind::kInt:
+      return absl::HashOf(ValueKind::kInt, Cast<IntValueView>(key));
+    case ValueKind::kUint:
+      return absl::HashOf(ValueKind::kUint, Cast<UintValueView>(key));
+    case ValueKind::kString:
+      return absl::HashOf(ValueKind::kString, Cast<StringValueView>(key));
+    default:
+      ABSL_DLOG(FATAL) << "Invalid map key value: " << key;
+      return 0;
+  }
+}
+
+bool KeyEquals(ValueView lhs, ValueView rhs) {
+  if (lhs.kind() != rhs.kind()) {
+    return false;
+  }
+  switch (lhs.kind()) {
+    case ValueKind::kBool:
+      return Cast<BoolValueView>(lhs) == Cast<BoolValueView>(rhs);
+    case ValueKind::kInt:
+      return Cast<IntValueView>(lhs) == Cast<IntValueView>(rhs);
+    case ValueKind::kUint:
+      return Cast<UintValueView>(lhs) == Cast<UintValueView>(rhs);
+    case ValueKind::kString:
+      return Cast<StringValueView>(lhs) == Cast<StringValueView>(rhs);
+    default:
+      ABSL_DLOG(FATAL) << "Invalid map key value: " << lhs;
+      return false;
+  }
+}
+
+absl::Cord KeyToJson(ValueView key) {
+  switch (key.kind()) {
+    case ValueKind::kBool:
+      return Cast<BoolValueView>(key).NativeValue() ? absl::Cord("true")
+                                                     : absl::Cord("false");
+    case ValueKind::kInt:
+      return absl::Cord(absl::StrCat(Cast<IntValueView>(key).NativeValue()));
+    case ValueKind::kUint:
+      return absl::Cord(absl::StrCat(Cast<UintValueView>(key).NativeValue()));
+    case ValueKind::kString:
+      return Cast<StringValueView>(key).NativeCord();
+    default:
+      ABSL_DLOG(FATAL) << "Invalid map key value: " << key;
+      return absl::Cord();
+  }
+}
+
+// Number of index slots for `size` entries, keeping the load factor at or
+// below 1/2.
+size_t SlotCountFor(size_t size) {
+  return std::max<size_t>(absl::bit_ceil(2 * size), 2 * kLinearScanLimit);
+}
+
+template <typename T>
+T* AllocateArray(MemoryManagerRef memory_manager, size_t size) {
+  return static_cast<T*>(memory_manager.Allocate(size * sizeof(T), alignof(T)));
+}
+
+// Returns memory from `AllocateArray`. With a pooling memory manager this is
+// a no-op; the memory is released with the arena.
+template <typename T>
+void DeallocateArray(MemoryManagerRef memory_manager, T* array, size_t size) {
+  if (array != nullptr) {
+    memory_manager.Deallocate(array, size * sizeof(T), alignof(T));
+  }
+}
+
+// The entries of a compact map in insertion order and, once there are more
+// than kLinearScanLimit of them, an open addressing index over them.
+//
+// Storage is allocated from the memory manager passed to the mutating
+// methods, which must be the same for the lifetime of the object. The owner
+// must call Destroy().
+class CompactMapStorage {
+ public:
+  CompactMapStorage() = default;
+
+  CompactMapStorage(CompactMapStorage&& other) noexcept
+      : entries_(std::exchange(other.entries_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0)),
+        slots_(std::exchange(other.slots_, nullptr)),
+        slot_count_(std::exchange(other.slot_count_, 0)) {}
+
+  CompactMapStorage(const CompactMapStorage&) = delete;
+  CompactMapStorage& operator=(const CompactMapStorage&) = delete;
+  CompactMapStorage& operator=(CompactMapStorage&&) = delete;
+
+  size_t size() const { return size_; }
+
+  absl::Span<const Entry> entries() const {
+    return absl::MakeConstSpan(entries_, size_);
+  }
+
+  absl::Nullable<const Entry*> Find(ValueView key) const {
+    return Find(key, HashKey(key));
+  }
+
+  absl::Nullable<const Entry*> Find(ValueView key, size_t hash) const {
+    if (slots_ == nullptr) {
+      for (size_t i = 0; i < size_; ++i) {
+        const Entry& entry = entries_[i];
+        if (entry.hash == hash && KeyEquals(entry.key, key)) {
+          return &entry;
+        }
+      }
+      return nullptr;
+    }
+    const size_t mask = slot_count_ - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+      uint32_t index = slots_[slot];
+      if (index == 0) {
+        return nullptr;
+      }
+      const Entry& entry = entries_[index - 1];
+      if (entry.hash == hash && KeyEquals(entry.key, key)) {
+        return &entry;
+      }
+    }
+  }
+
+  void Reserve(MemoryManagerRef memory_manager, size_t capacity) {
+    if (capacity <= capacity_) {
+      return;
+    }
+    Entry* entries = AllocateArray<Entry>(memory_manager, capacity);
+    for (size_t i = 0; i < size_; ++i) {
+      ::new (static_cast<void*>(entries + i)) Entry(std::move(entries_[i]));
+      entries_[i].~Entry();
+    }
+    DeallocateArray(memory_manager, entries_, capacity_);
+    entries_ = entries;
+    capacity_ = capacity;
+    if (capacity > kLinearScanLimit && slot_count_ < SlotCountFor(capacity)) {
+      Rehash(memory_manager, SlotCountFor(capacity));
+    }
+  }
+
+  // Appends an entry. The key must not be present yet.
+  void Insert(MemoryManagerRef memory_manager, Value key, Value value,
+              size_t hash) {
+    if (size_ == capacity_) {
+      Reserve(memory_manager, std::max<size_t>(4, 2 * capacity_));
+    }
+    ::new (static_cast<void*>(entries_ + size_))
+        Entry{std::move(key), std::move(value), hash};
+    ++size_;
+    if (slots_ != nullptr && 2 * size_ <= slot_count_) {
+      InsertSlot(size_ - 1);
+    } else if (size_ > kLinearScanLimit) {
+      Rehash(memory_manager, SlotCountFor(size_));
+    }
+  }
+
+  void Destroy(MemoryManagerRef memory_manager) {
+    for (size_t i = 0; i < size_; ++i) {
+      entries_[i].~Entry();
+    }
+    DeallocateArray(memory_manager, entries_, capacity_);
+    DeallocateArray(memory_manager, slots_, slot_count_);
+    entries_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+    slots_ = nullptr;
+    slot_count_ = 0;
+  }
+
+ private:
+  void InsertSlot(size_t index) {
+    const size_t mask = slot_count_ - 1;
+    size_t slot = entries_[index].hash & mask;
+    while (slots_[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+    slots_[slot] = static_cast<uint32_t>(index + 1);
+  }
+
+  void Rehash(MemoryManagerRef memory_manager, size_t slot_count) {
+    DeallocateArray(memory_manager, slots_, slot_count_);
+    slots_ = AllocateArray<uint32_t>(memory_manager, slot_count);
+    slot_count_ = slot_count;
+    std::memset(slots_, 0, slot_count * sizeof(uint32_t));
+    for (size_t i = 0; i < size_; ++i) {
+      InsertSlot(i);
+    }
+  }
+
+  Entry* entries_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+  // Each slot holds 1 + the index of an entry, or 0 if empty. The slot count
+  // is a power of 2.
+  uint32_t* slots_ = nullptr;
+  size_t slot_count_ = 0;
+};
+
+class CompactMapValueKeyIterator final : public ValueIterator {
+ public:
+  explicit CompactMapValueKeyIterator(absl::Span<const Entry> entries)
+      : entries_(entries) {}
+
+  bool HasNext() override { return index_ < entries_.size(); }
+
+  absl::StatusOr<ValueView> Next(ValueManager&, Value&) override {
+    if (ABSL_PREDICT_FALSE(index_ >= entries_.size())) {
+      return absl::FailedPreconditionError(
+          "ValueIterator::Next() called when "
+          "ValueIterator::HasNext() returns false");
+    }
+    return ValueView(entries_[index_++].key);
+  }
+
+ private:
+  const absl::Span<const Entry> entries_;
+  size_t index_ = 0;
+};
+
+class CompactMapValue final : public ParsedMapValueInterface {
+ public:
+  CompactMapValue(MemoryManagerRef memory_manager, MapType type,
+                  CompactMapStorage storage)
+      : memory_manager_(memory_manager),
+        type_(std::move(type)),
+        storage_(std::move(storage)) {}
+
+  ~CompactMapValue() override { storage_.Destroy(memory_manager_); }
+
+  std::string DebugString() const override {
+    std::string out = "{";
+    for (const Entry& entry : storage_.entries()) {
+      if (out.size() > 1) {
+        out.append(", ");
+      }
+      absl::StrAppend(&out, entry.key.DebugString(), ": ",
+                      entry.value.DebugString());
+    }
+    out.push_back('}');
+    return out;
+  }
+
+  size_t Size() const override { return storage_.size(); }
+
+  absl::StatusOr<JsonObject> ConvertToJsonObject(
+      AnyToJsonConverter& converter) const override {
+    JsonObjectBuilder builder;
+    builder.reserve(Size());
+    for (const Entry& entry : storage_.entries()) {
+      CEL_ASSIGN_OR_RETURN(auto json_value,
+                           entry.value.ConvertToJson(converter));
+      if (!builder
+               .insert(std::pair{KeyToJson(entry.key), std::move(json_value)})
+               .second) {
+        return absl::FailedPreconditionError(
+            "cannot convert map with duplicate keys to JSON");
+      }
+    }
+    return std::move(builder).Build();
+  }
+
+  absl::StatusOr<ListValueView> ListKeys(ValueManager& value_manager,
+                                         ListValue& scratch) const override {
+    CEL_ASSIGN_OR_RETURN(auto keys,
+                         value_manager.NewListValueBuilder(
+                             value_manager.CreateListType(type_.key())));
+    keys->Reserve(Size());
+    for (const Entry& entry : storage_.entries()) {
+      CEL_RETURN_IF_ERROR(keys->Add(entry.key));
+    }
+    scratch = std::move(*keys).Build();
+    return scratch;
+  }
+
+  absl::Status ForEach(ValueManager&, ForEachCallback callback) const override {
+    for (const Entry& entry : storage_.entries()) {
+      CEL_ASSIGN_OR_RETURN(auto ok, callback(entry.key, entry.value));
+      if (!ok) {
+        break;
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<absl::Nonnull<ValueIteratorPtr>> NewIterator(
+      ValueManager&) const override {
+    return std::make_unique<CompactMapValueKeyIterator>(storage_.entries());
+  }
+
+ protected:
+  Type GetTypeImpl(TypeManager&) const override { return type_; }
+
+ private:
+  absl::StatusOr<absl::optional<ValueView>> FindImpl(ValueManager&,
+                                                     ValueView key,
+                                                     Value&) const override {
+    if (const Entry* entry = storage_.Find(key); entry != nullptr) {
+      return ValueView(entry->value);
+    }
+    return absl::nullopt;
+  }
+
+  absl::StatusOr<bool> HasImpl(ValueManager&, ValueView key) const override {
+    return storage_.Find(key) != nullptr;
+  }
+
+  NativeTypeId GetNativeTypeId() const noexcept override {
+    return NativeTypeId::For<CompactMapValue>();
+  }
+
+  const MemoryManagerRef memory_manager_;
+  const MapType type_;
+  CompactMapStorage storage_;
+};
+
+class CompactMapValueBuilder final : public MapValueBuilder {
+ public:
+  CompactMapValueBuilder(MemoryManagerRef memory_manager, MapType type)
+      : memory_manager_(memory_manager), type_(std::move(type)) {}
+
+  CompactMapValueBuilder(const CompactMapValueBuilder&) = delete;
+  CompactMapValueBuilder& operator=(const CompactMapValueBuilder&) = delete;
+
+  ~CompactMapValueBuilder() override { storage_.Destroy(memory_manager_); }
+
+  absl::Status Put(Value key, Value value) override {
+    if (key.Is<ErrorValue>()) {
+      return key.As<ErrorValue>().NativeValue();
+    }
+    if (value.Is<ErrorValue>()) {
+      return value.As<ErrorValue>().NativeValue();
+    }
+    CEL_RETURN_IF_ERROR(CheckMapKey(key));
+    size_t hash = HashKey(key);
+    if (storage_.Find(key, hash) != nullptr) {
+      return DuplicateKeyError().NativeValue();
+    }
+    storage_.Insert(memory_manager_, std::move(key), std::move(value), hash);
+    return absl::OkStatus();
+  }
+
+  size_t Size() const override { return storage_.size(); }
+
+  void Reserve(size_t capacity) override {
+    storage_.Reserve(memory_manager_, capacity);
+  }
+
+  MapValue Build() && override {
+    return ParsedMapValue(memory_manager_.MakeShared<CompactMapValue>(
+        memory_manager_, std::move(type_), std::move(storage_)));
+  }
+
+ private:
+  MemoryManagerRef memory_manager_;
+  MapType type_;
+  CompactMapStorage storage_;
+};
+
+}  // namespace
+
+Unique<MapValueBuilder> NewCompactMapValueBuilder(
+    MemoryManagerRef memory_manager, MapType type) {
+  return memory_manager.MakeUnique<CompactMapValueBuilder>(memory_manager,
+                                                           std::move(type));
+}
+
+}  // namespace cel
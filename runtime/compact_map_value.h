@@ -0,0 +1,39 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_COMPACT_MAP_VALUE_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_COMPACT_MAP_VALUE_H_
+
+#include "common/memory.h"
+#include "common/type.h"
+#include "common/value.h"
+
+namespace cel {
+
+// Returns a builder for maps stored in flat arrays allocated from
+// `memory_manager`.
+//
+// Entries are kept in insertion order (which is also the iteration order)
+// together with the hash of their key. Maps with up to 8 entries are searched
+// by a linear scan over the cached hashes. Larger maps add an open addressing
+// index with linear probing. With a pooling memory manager, all of the
+// storage lives in the arena; nothing is allocated per entry.
+//
+// Keys must be bool, int, uint or string values and are compared by kind and
+// value, as for the other map implementations.
+Unique<MapValueBuilder> NewCompactMapValueBuilder(
+    MemoryManagerRef memory_manager, MapType type);
+
+}  // namespace cel
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_COMPACT_MAP_VALUE_H_
@@ -0,0 +1,198 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/compact_map_value.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "base/type_provider.h"
+#include "common/json.h"
+#include "common/memory.h"
+#include "common/type.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "common/values/legacy_value_manager.h"
+#include "extensions/protobuf/memory_manager.h"
+#include "google/protobuf/arena.h"
+#include "internal/testing.h"
+
+namespace cel {
+namespace {
+
+using ::cel::extensions::ProtoMemoryManagerRef;
+using ::cel::internal::StatusIs;
+using testing::ElementsAre;
+
+class CompactMapValueTest : public testing::TestWithParam<MemoryManagement> {
+ public:
+  CompactMapValueTest()
+      : value_factory_(memory_manager(), TypeProvider::Builtin()) {}
+
+  MemoryManagerRef memory_manager() {
+    return GetParam() == MemoryManagement::kPooling
+               ? ProtoMemoryManagerRef(&arena_)
+               : MemoryManagerRef::ReferenceCounting();
+  }
+
+  Unique<MapValueBuilder> NewBuilder() {
+    return NewCompactMapValueBuilder(memory_manager(),
+                                     MapType(value_factory_.GetDynDynMapType()));
+  }
+
+  // Returns the value for `key`, or nullopt if there is none.
+  absl::optional<Value> Find(const MapValue& map, const Value& key) {
+    auto result = map.Find(value_factory_, key);
+    if (!result.ok() || !result->second) {
+      return absl::nullopt;
+    }
+    return result->first;
+  }
+
+ protected:
+  google::protobuf::Arena arena_;
+  common_internal::LegacyValueManager value_factory_;
+};
+
+TEST_P(CompactMapValueTest, SmallMap) {
+  auto builder = NewBuilder();
+  builder->Reserve(3);
+  ASSERT_OK(builder->Put(StringValue("b"), IntValue(1)));
+  ASSERT_OK(builder->Put(IntValue(1), StringValue("one")));
+  ASSERT_OK(builder->Put(BoolValue(true), UintValue(2)));
+  MapValue map = std::move(*builder).Build();
+
+  EXPECT_EQ(map.Size(), 3);
+  EXPECT_EQ(map.DebugString(), "{\"b\": 1, 1: \"one\", true: 2u}");
+
+  absl::optional<Value> value = Find(map, IntValue(1));
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ((*value)->As<StringValue>().NativeString(), "one");
+  value = Find(map, StringValue("b"));
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ((*value)->As<IntValue>().NativeValue(), 1);
+  // Keys are compared by kind.
+  EXPECT_FALSE(Find(map, UintValue(1)).has_value());
+  EXPECT_FALSE(Find(map, BoolValue(false)).has_value());
+
+  ASSERT_OK_AND_ASSIGN(Value has, map.Has(value_factory_, BoolValue(true)));
+  EXPECT_TRUE(has->As<BoolValue>().NativeValue());
+  EXPECT_THAT(map.Get(value_factory_, StringValue("c")),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(map.Has(value_factory_, DoubleValue(1.0)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_P(CompactMapValueTest, LargeMap) {
+  auto builder = NewBuilder();
+  for (int64_t i = 0; i < 1000; ++i) {
+    ASSERT_OK(builder->Put(IntValue(i), IntValue(i * i)));
+    ASSERT_OK(builder->Put(StringValue(absl::StrCat("key", i)), IntValue(i)));
+  }
+  MapValue map = std::move(*builder).Build();
+
+  EXPECT_EQ(map.Size(), 2000);
+  for (int64_t i = 0; i < 1000; ++i) {
+    absl::optional<Value> value = Find(map, IntValue(i));
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ((*value)->As<IntValue>().NativeValue(), i * i);
+    value = Find(map, StringValue(absl::StrCat("key", i)));
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ((*value)->As<IntValue>().NativeValue(), i);
+  }
+  EXPECT_FALSE(Find(map, IntValue(1000)).has_value());
+  EXPECT_FALSE(Find(map, StringValue("key1000")).has_value());
+}
+
+TEST_P(CompactMapValueTest, DuplicateKeys) {
+  auto builder = NewBuilder();
+  for (int64_t i = 0; i < 20; ++i) {
+    ASSERT_OK(builder->Put(IntValue(i), NullValue()));
+  }
+  EXPECT_THAT(builder->Put(IntValue(3), NullValue()),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+  EXPECT_THAT(builder->Put(ListValue(), NullValue()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_EQ(builder->Size(), 20);
+}
+
+TEST_P(CompactMapValueTest, InsertionOrder) {
+  auto builder = NewBuilder();
+  for (int64_t i = 12; i > 0; --i) {
+    ASSERT_OK(builder->Put(IntValue(i), IntValue(-i)));
+  }
+  MapValue map = std::move(*builder).Build();
+
+  std::vector<int64_t> keys;
+  ASSERT_OK(map.ForEach(value_factory_,
+                        [&keys](ValueView key,
+                                ValueView value) -> absl::StatusOr<bool> {
+                          keys.push_back(Cast<IntValueView>(key).NativeValue());
+                          return keys.size() < 3;
+                        }));
+  EXPECT_THAT(keys, ElementsAre(12, 11, 10));
+
+  ASSERT_OK_AND_ASSIGN(ListValue key_list, map.ListKeys(value_factory_));
+  EXPECT_EQ(key_list.Size(), 12);
+  ASSERT_OK_AND_ASSIGN(Value first, key_list.Get(value_factory_, 0));
+  EXPECT_EQ(first->As<IntValue>().NativeValue(), 12);
+
+  ASSERT_OK_AND_ASSIGN(auto iterator, map.NewIterator(value_factory_));
+  keys.clear();
+  while (iterator->HasNext()) {
+    ASSERT_OK_AND_ASSIGN(Value key, iterator->Next(value_factory_));
+    keys.push_back(key->As<IntValue>().NativeValue());
+  }
+  EXPECT_EQ(keys.size(), 12);
+  EXPECT_EQ(keys.back(), 1);
+}
+
+TEST_P(CompactMapValueTest, Equality) {
+  auto builder = NewBuilder();
+  ASSERT_OK(builder->Put(StringValue("a"), IntValue(1)));
+  ASSERT_OK(builder->Put(StringValue("b"), IntValue(2)));
+  MapValue map = std::move(*builder).Build();
+
+  auto other_builder = NewBuilder();
+  ASSERT_OK(other_builder->Put(StringValue("b"), IntValue(2)));
+  ASSERT_OK(other_builder->Put(StringValue("a"), IntValue(1)));
+  MapValue other = std::move(*other_builder).Build();
+
+  ASSERT_OK_AND_ASSIGN(Value equal, map.Equal(value_factory_, other));
+  EXPECT_TRUE(equal->As<BoolValue>().NativeValue());
+}
+
+TEST_P(CompactMapValueTest, ConvertToJson) {
+  auto builder = NewBuilder();
+  ASSERT_OK(builder->Put(StringValue("a"), DoubleValue(1.5)));
+  ASSERT_OK(builder->Put(IntValue(2), BoolValue(true)));
+  MapValue map = std::move(*builder).Build();
+
+  ASSERT_OK_AND_ASSIGN(JsonObject json, map.ConvertToJsonObject(value_factory_));
+  EXPECT_EQ(json, MakeJsonObject({{JsonString("a"), JsonNumber(1.5)},
+                                  {JsonString("2"), JsonBool(true)}}));
+}
+
+INSTANTIATE_TEST_SUITE_P(CompactMapValueTest, CompactMapValueTest,
+                         testing::Values(MemoryManagement::kPooling,
+                                         MemoryManagement::kReferenceCounting));
+
+}  // namespace
+}  // namespace cel
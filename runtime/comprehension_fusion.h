@@ -0,0 +1,37 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_COMPREHENSION_FUSION_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_COMPREHENSION_FUSION_H_
+
+#include "absl/status/status.h"
+#include "runtime/runtime_builder.h"
+
+namespace cel::extensions {
+
+// Enable fused planning of comprehension loops in the runtime being built.
+//
+// Comprehensions generated by the standard macros (`all`, `exists`,
+// `exists_one`, `map` and `filter`) are planned as a single step that runs
+// the loop natively, instead of separate next, condition and jump steps per
+// iteration. Short-circuiting, error propagation and the iteration budget are
+// unchanged.
+//
+// Only applies to the flat plan (RuntimeOptions::max_recursion_depth == 0)
+// without unknown processing.
+absl::Status EnableComprehensionFusion(RuntimeBuilder& builder);
+
+}  // namespace cel::extensions
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_COMPREHENSION_FUSION_H_
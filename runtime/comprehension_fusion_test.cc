@@ -0,0 +1,189 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/comprehension_fusion.h"
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/status_macros.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/runtime.h"
+#include "runtime/runtime_builder.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::cel::internal::StatusIs;
+using ::google::api::expr::parser::Parse;
+using ::google::api::expr::v1alpha1::ParsedExpr;
+using testing::HasSubstr;
+
+using ValueMatcher = testing::Matcher<Value>;
+
+MATCHER_P(IsBoolValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<BoolValue>() &&
+         value->As<BoolValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsIntValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<IntValue>() &&
+         value->As<IntValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsErrorValue, expected_substr, "") {
+  const Value& value = arg;
+  return value->Is<ErrorValue>() &&
+         absl::StrContains(value->As<ErrorValue>().NativeValue().message(),
+                           expected_substr);
+}
+
+struct TestCase {
+  std::string name;
+  std::string expression;
+  ValueMatcher result_matcher;
+};
+
+absl::StatusOr<std::unique_ptr<TraceableProgram>> MakeProgram(
+    const RuntimeOptions& options, absl::string_view expression) {
+  CEL_ASSIGN_OR_RETURN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+  CEL_RETURN_IF_ERROR(EnableComprehensionFusion(builder));
+  CEL_ASSIGN_OR_RETURN(auto runtime, std::move(builder).Build());
+
+  CEL_ASSIGN_OR_RETURN(ParsedExpr parsed_expr, Parse(expression));
+  return ProtobufRuntimeAdapter::CreateProgram(*runtime, parsed_expr);
+}
+
+absl::StatusOr<Value> Evaluate(const RuntimeOptions& options,
+                               absl::string_view expression) {
+  CEL_ASSIGN_OR_RETURN(auto program, MakeProgram(options, expression));
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+  activation.InsertOrAssignValue("x", IntValue(3));
+  return program->Evaluate(activation, value_factory.get());
+}
+
+class ComprehensionFusionTest
+    : public testing::TestWithParam<std::tuple<TestCase, bool>> {
+ public:
+  const TestCase& test_case() const { return std::get<0>(GetParam()); }
+  bool enable_list_append() const { return std::get<1>(GetParam()); }
+};
+
+TEST_P(ComprehensionFusionTest, Basic) {
+  RuntimeOptions options;
+  options.enable_comprehension_list_append = enable_list_append();
+
+  ASSERT_OK_AND_ASSIGN(Value value, Evaluate(options, test_case().expression));
+  EXPECT_THAT(value, test_case().result_matcher);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Cases, ComprehensionFusionTest,
+    testing::Combine(
+        testing::ValuesIn(std::vector<TestCase>{
+            {"all_true", "[1, 2, 3].all(i, i > 0)", IsBoolValue(true)},
+            {"all_false", "[1, 2, 3].all(i, i < x)", IsBoolValue(false)},
+            {"all_empty", "[].all(i, i > 0)", IsBoolValue(true)},
+            {"all_error_absorbed", "[0, -1].all(i, 1 / i > 0)",
+             IsBoolValue(false)},
+            {"all_error", "[0, 1].all(i, 1 / i > 0)",
+             IsErrorValue("divide by zero")},
+            {"exists_true", "[1, 2, 3].exists(i, i == x)", IsBoolValue(true)},
+            {"exists_false", "[1, 2, 3].exists(i, i > x)",
+             IsBoolValue(false)},
+            {"exists_error_absorbed", "[0, 1].exists(i, 1 / i > 0)",
+             IsBoolValue(true)},
+            {"exists_error", "[0, -1].exists(i, 1 / i > 0)",
+             IsErrorValue("divide by zero")},
+            {"exists_map", "{'a': 1, 'b': 2}.exists(k, k == 'b')",
+             IsBoolValue(true)},
+            {"exists_one_true", "[1, 2, 3].exists_one(i, i == x)",
+             IsBoolValue(true)},
+            {"exists_one_false", "[1, 3, 3].exists_one(i, i == x)",
+             IsBoolValue(false)},
+            {"exists_one_error", "[1, 0].exists_one(i, 1 / i > 0)",
+             IsErrorValue("divide by zero")},
+            {"map", "[1, 2, 3].map(i, i * x) == [3, 6, 9]",
+             IsBoolValue(true)},
+            {"map_filter", "[1, 2, 3].map(i, i > 1, i * x) == [6, 9]",
+             IsBoolValue(true)},
+            {"filter", "[1, 2, 3, 4].filter(i, i % 2 == 0) == [2, 4]",
+             IsBoolValue(true)},
+            {"filter_size", "size([1, 2, 3, 4].filter(i, i < x))",
+             IsIntValue(2)},
+            {"nested",
+             "[1, 2, 3].all(i, [1, 2, 3].exists(j, i == j)) && "
+             "[[1, 2], [3]].map(l, l.map(i, i * x)) == [[3, 6], [9]]",
+             IsBoolValue(true)},
+            {"nested_shadowing",
+             "[1, 2].map(i, [3, 4].map(i, i)) == [[3, 4], [3, 4]]",
+             IsBoolValue(true)},
+            {"non_list_range", "x.all(i, i > 0)",
+             IsErrorValue("No matching overloads")},
+            {"error_range", "(1 / 0).exists(i, i > 0)",
+             IsErrorValue("divide by zero")},
+        }),
+        testing::Bool()),
+    [](const testing::TestParamInfo<std::tuple<TestCase, bool>>& info) {
+      return absl::StrCat(std::get<0>(info.param).name,
+                          std::get<1>(info.param) ? "_list_append" : "");
+    });
+
+TEST(ComprehensionFusion, ShortCircuitsWithinIterationBudget) {
+  RuntimeOptions options;
+  options.comprehension_max_iterations = 2;
+
+  ASSERT_OK_AND_ASSIGN(Value value,
+                       Evaluate(options, "[1, 2, 3, 4].exists(i, i == 1)"));
+  EXPECT_THAT(value, IsBoolValue(true));
+
+  EXPECT_THAT(Evaluate(options, "[1, 2, 3, 4].map(i, i)"),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Iteration budget exceeded")));
+}
+
+TEST(ComprehensionFusion, NoShortCircuiting) {
+  RuntimeOptions options;
+  options.short_circuiting = false;
+  options.comprehension_max_iterations = 2;
+
+  EXPECT_THAT(Evaluate(options, "[1, 2, 3, 4].exists(i, i == 1)"),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Iteration budget exceeded")));
+}
+
+}  // namespace
+}  // namespace cel::extensions
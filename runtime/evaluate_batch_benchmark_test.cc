@@ -0,0 +1,114 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares Program::EvaluateBatch against calling Program::Evaluate in a loop.
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/log/absl_check.h"
+#include "common/value.h"
+#include "extensions/protobuf/memory_manager.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/benchmark.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/activation_interface.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/runtime.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+#include "google/protobuf/arena.h"
+
+namespace cel {
+namespace {
+
+using ::cel::extensions::ProtobufRuntimeAdapter;
+using ::cel::extensions::ProtoMemoryManagerRef;
+using ::google::api::expr::parser::Parse;
+using ::google::api::expr::v1alpha1::ParsedExpr;
+
+constexpr char kExpression[] = "x > 10 && (x * 2 + 1) % 3 == 0 || x == 5";
+
+std::unique_ptr<Program> MakeProgram() {
+  RuntimeOptions options;
+  auto builder = CreateStandardRuntimeBuilder(options);
+  ABSL_CHECK_OK(builder.status());
+  auto runtime = std::move(builder).value().Build();
+  ABSL_CHECK_OK(runtime.status());
+
+  auto expr = Parse(kExpression);
+  ABSL_CHECK_OK(expr.status());
+
+  auto program = ProtobufRuntimeAdapter::CreateProgram(**runtime, *expr);
+  ABSL_CHECK_OK(program.status());
+  return *std::move(program);
+}
+
+std::vector<Activation> MakeActivations(ValueManager& value_factory,
+                                        int batch_size) {
+  std::vector<Activation> activations(batch_size);
+  for (int i = 0; i < batch_size; ++i) {
+    activations[i].InsertOrAssignValue("x", value_factory.CreateIntValue(i));
+  }
+  return activations;
+}
+
+void BM_EvaluateLoop(benchmark::State& state) {
+  google::protobuf::Arena arena;
+  std::unique_ptr<Program> program = MakeProgram();
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    ProtoMemoryManagerRef(&arena));
+  std::vector<Activation> activations =
+      MakeActivations(value_factory.get(), state.range(0));
+
+  for (auto _ : state) {
+    for (const Activation& activation : activations) {
+      auto result = program->Evaluate(activation, value_factory.get());
+      ABSL_CHECK_OK(result.status());
+      benchmark::DoNotOptimize(result);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_EvaluateBatch(benchmark::State& state) {
+  google::protobuf::Arena arena;
+  std::unique_ptr<Program> program = MakeProgram();
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    ProtoMemoryManagerRef(&arena));
+  std::vector<Activation> activations =
+      MakeActivations(value_factory.get(), state.range(0));
+  std::vector<const ActivationInterface*> activation_ptrs;
+  activation_ptrs.reserve(activations.size());
+  for (const Activation& activation : activations) {
+    activation_ptrs.push_back(&activation);
+  }
+
+  for (auto _ : state) {
+    auto results = program->EvaluateBatch(activation_ptrs, value_factory.get());
+    ABSL_CHECK_OK(results.status());
+    benchmark::DoNotOptimize(results);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_EvaluateLoop)->Range(1, 1024);
+BENCHMARK(BM_EvaluateBatch)->Range(1, 1024);
+
+}  // namespace
+}  // namespace cel
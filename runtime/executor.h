@@ -0,0 +1,40 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_EXECUTOR_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_EXECUTOR_H_
+
+#include "absl/functional/any_invocable.h"
+
+namespace cel {
+
+// Interface for a caller-provided thread pool.
+//
+// Used by the runtime to run independent parts of a program concurrently (see
+// cel::extensions::EnableParallelEvaluation).
+class Executor {
+ public:
+  virtual ~Executor() = default;
+
+  // Schedule task to run asynchronously.
+  //
+  // The runtime never blocks waiting for a task that has not started: it runs
+  // unstarted work on the waiting thread instead, so a bounded pool cannot
+  // deadlock. Running the task inline is allowed but gains no concurrency.
+  virtual void Schedule(absl::AnyInvocable<void() &&> task) = 0;
+};
+
+}  // namespace cel
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_EXECUTOR_H_
@@ -0,0 +1,93 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/indexed_activation.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "absl/log/absl_check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "common/value.h"
+
+namespace cel {
+
+IndexedActivation::IndexedActivation(
+    absl::Span<const std::string> declared_variables)
+    : names_(declared_variables.begin(), declared_variables.end()),
+      values_(declared_variables.size()) {
+  indexes_.reserve(names_.size());
+  for (size_t i = 0; i < names_.size(); ++i) {
+    indexes_.insert({names_[i], i});
+  }
+}
+
+absl::StatusOr<absl::optional<ValueView>> IndexedActivation::FindVariable(
+    ValueManager& factory, absl::string_view name, Value& scratch) const {
+  auto iter = indexes_.find(name);
+  if (iter == indexes_.end() || !values_[iter->second].has_value()) {
+    return absl::nullopt;
+  }
+  return ValueView{*values_[iter->second]};
+}
+
+absl::StatusOr<absl::optional<ValueView>> IndexedActivation::FindVariableAt(
+    ValueManager& factory, size_t index, absl::string_view name,
+    Value& scratch) const {
+  // The index is only meaningful if this activation was declared with the
+  // same variables as the program; otherwise fall back to the name.
+  if (index >= names_.size() || names_[index] != name) {
+    return FindVariable(factory, name, scratch);
+  }
+  if (!values_[index].has_value()) {
+    return absl::nullopt;
+  }
+  return ValueView{*values_[index]};
+}
+
+absl::optional<size_t> IndexedActivation::FindIndex(
+    absl::string_view name) const {
+  auto iter = indexes_.find(name);
+  if (iter == indexes_.end()) {
+    return absl::nullopt;
+  }
+  return iter->second;
+}
+
+void IndexedActivation::SetValue(size_t index, Value value) {
+  ABSL_DCHECK_LT(index, values_.size());
+  values_[index] = std::move(value);
+}
+
+bool IndexedActivation::InsertOrAssignValue(absl::string_view name,
+                                            Value value) {
+  auto iter = indexes_.find(name);
+  if (iter == indexes_.end()) {
+    return false;
+  }
+  values_[iter->second] = std::move(value);
+  return true;
+}
+
+void IndexedActivation::ClearValues() {
+  for (auto& value : values_) {
+    value.reset();
+  }
+}
+
+}  // namespace cel
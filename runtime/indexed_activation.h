@@ -0,0 +1,111 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_INDEXED_ACTIVATION_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_INDEXED_ACTIVATION_H_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "base/attribute.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "runtime/activation_interface.h"
+#include "runtime/function_overload_reference.h"
+
+namespace cel {
+
+// Thread-compatible activation that binds variables by index.
+//
+// The set of variables is fixed at construction, typically from
+// Program::GetDeclaredVariables(). Values are held in an array, so programs
+// that resolved a variable to the same index read it without hashing its
+// name. Lookups by name (e.g. from a program planned separately) go through a
+// name to index map.
+//
+// Context functions are not supported.
+class IndexedActivation final : public ActivationInterface {
+ public:
+  explicit IndexedActivation(absl::Span<const std::string> declared_variables);
+
+  // Implements ActivationInterface.
+  absl::StatusOr<absl::optional<ValueView>> FindVariable(
+      ValueManager& factory, absl::string_view name,
+      Value& scratch) const override;
+  using ActivationInterface::FindVariable;
+
+  absl::StatusOr<absl::optional<ValueView>> FindVariableAt(
+      ValueManager& factory, size_t index, absl::string_view name,
+      Value& scratch) const override;
+
+  std::vector<FunctionOverloadReference> FindFunctionOverloads(
+      absl::string_view name) const override {
+    return {};
+  }
+
+  absl::Span<const cel::AttributePattern> GetUnknownAttributes()
+      const override {
+    return unknown_patterns_;
+  }
+
+  absl::Span<const cel::AttributePattern> GetMissingAttributes()
+      const override {
+    return missing_patterns_;
+  }
+
+  // Number of declared variables.
+  size_t size() const { return names_.size(); }
+
+  // Returns the index of a declared variable.
+  absl::optional<size_t> FindIndex(absl::string_view name) const;
+
+  // Bind a value to the variable at index. index must be less than size().
+  void SetValue(size_t index, Value value);
+
+  // Bind a value to a declared variable.
+  //
+  // Returns false if name is not declared.
+  bool InsertOrAssignValue(absl::string_view name, Value value);
+
+  // Unbind all values, keeping the declarations so the activation can be
+  // reused.
+  void ClearValues();
+
+  void SetUnknownPatterns(std::vector<cel::AttributePattern> patterns) {
+    unknown_patterns_ = std::move(patterns);
+  }
+
+  void SetMissingPatterns(std::vector<cel::AttributePattern> patterns) {
+    missing_patterns_ = std::move(patterns);
+  }
+
+ private:
+  std::vector<std::string> names_;
+  absl::flat_hash_map<std::string, size_t> indexes_;
+  std::vector<absl::optional<Value>> values_;
+
+  std::vector<cel::AttributePattern> unknown_patterns_;
+  std::vector<cel::AttributePattern> missing_patterns_;
+};
+
+}  // namespace cel
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_INDEXED_ACTIVATION_H_
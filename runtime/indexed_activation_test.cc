@@ -0,0 +1,116 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/indexed_activation.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "base/type_provider.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "common/values/legacy_value_manager.h"
+#include "internal/testing.h"
+
+namespace cel {
+namespace {
+
+using testing::Eq;
+using testing::Optional;
+using cel::internal::IsOkAndHolds;
+
+MATCHER_P(IsIntValue, x, absl::StrCat("is IntValue with value ", x)) {
+  const Value value{arg};
+
+  return value->Is<IntValue>() && value.As<IntValue>().NativeValue() == x;
+}
+
+class IndexedActivationTest : public testing::Test {
+ public:
+  IndexedActivationTest()
+      : value_factory_(MemoryManagerRef::ReferenceCounting(),
+                       TypeProvider::Builtin()) {}
+
+ protected:
+  common_internal::LegacyValueManager value_factory_;
+};
+
+TEST_F(IndexedActivationTest, FindIndex) {
+  std::vector<std::string> declared{"a", "b"};
+  IndexedActivation activation(declared);
+
+  EXPECT_EQ(activation.size(), 2);
+  EXPECT_THAT(activation.FindIndex("a"), Optional(0));
+  EXPECT_THAT(activation.FindIndex("b"), Optional(1));
+  EXPECT_THAT(activation.FindIndex("c"), Eq(absl::nullopt));
+}
+
+TEST_F(IndexedActivationTest, SetValue) {
+  std::vector<std::string> declared{"a", "b"};
+  IndexedActivation activation(declared);
+  activation.SetValue(1, value_factory_.CreateIntValue(42));
+
+  Value scratch;
+  EXPECT_THAT(activation.FindVariableAt(value_factory_, 1, "b", scratch),
+              IsOkAndHolds(Optional(IsIntValue(42))));
+  EXPECT_THAT(activation.FindVariable(value_factory_, "b", scratch),
+              IsOkAndHolds(Optional(IsIntValue(42))));
+  EXPECT_THAT(activation.FindVariableAt(value_factory_, 0, "a", scratch),
+              IsOkAndHolds(Eq(absl::nullopt)));
+}
+
+TEST_F(IndexedActivationTest, InsertOrAssignValue) {
+  std::vector<std::string> declared{"a"};
+  IndexedActivation activation(declared);
+
+  EXPECT_TRUE(
+      activation.InsertOrAssignValue("a", value_factory_.CreateIntValue(1)));
+  EXPECT_FALSE(
+      activation.InsertOrAssignValue("b", value_factory_.CreateIntValue(2)));
+
+  Value scratch;
+  EXPECT_THAT(activation.FindVariable(value_factory_, "a", scratch),
+              IsOkAndHolds(Optional(IsIntValue(1))));
+  EXPECT_THAT(activation.FindVariable(value_factory_, "b", scratch),
+              IsOkAndHolds(Eq(absl::nullopt)));
+}
+
+TEST_F(IndexedActivationTest, MismatchedIndexFallsBackToName) {
+  std::vector<std::string> declared{"a", "b"};
+  IndexedActivation activation(declared);
+  activation.SetValue(0, value_factory_.CreateIntValue(1));
+  activation.SetValue(1, value_factory_.CreateIntValue(2));
+
+  Value scratch;
+  EXPECT_THAT(activation.FindVariableAt(value_factory_, 0, "b", scratch),
+              IsOkAndHolds(Optional(IsIntValue(2))));
+  EXPECT_THAT(activation.FindVariableAt(value_factory_, 7, "a", scratch),
+              IsOkAndHolds(Optional(IsIntValue(1))));
+}
+
+TEST_F(IndexedActivationTest, ClearValues) {
+  std::vector<std::string> declared{"a"};
+  IndexedActivation activation(declared);
+  activation.SetValue(0, value_factory_.CreateIntValue(1));
+  activation.ClearValues();
+
+  Value scratch;
+  EXPECT_THAT(activation.FindVariableAt(value_factory_, 0, "a", scratch),
+              IsOkAndHolds(Eq(absl::nullopt)));
+  EXPECT_THAT(activation.FindIndex("a"), Optional(0));
+}
+
+}  // namespace
+}  // namespace cel
@@ -0,0 +1,37 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_INDEXED_LIST_MEMBERSHIP_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_INDEXED_LIST_MEMBERSHIP_H_
+
+#include "absl/status/status.h"
+#include "runtime/runtime_builder.h"
+
+namespace cel::extensions {
+
+// Enable hash indexed membership tests against constant lists in the runtime
+// being built.
+//
+// Constant lists (list literals with constant elements, or lists computed by
+// constant folding) used as the right hand side of the 'in' operator are
+// indexed once at plan time, so `x in [...]` is a hash lookup instead of a
+// scan of the list. Lists provided at evaluation time can be wrapped with
+// cel::NewIndexedListValue for the same effect.
+//
+// Only applies when heterogeneous equality is enabled and to the flat plan
+// (RuntimeOptions::max_recursion_depth == 0).
+absl::Status EnableIndexedListMembership(RuntimeBuilder& builder);
+
+}  // namespace cel::extensions
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_INDEXED_LIST_MEMBERSHIP_H_
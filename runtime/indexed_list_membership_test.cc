@@ -0,0 +1,112 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runtime/indexed_list_membership.h"
+
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/strings/str_cat.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/constant_folding.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/runtime_builder.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::google::api::expr::parser::Parse;
+using ::google::api::expr::v1alpha1::ParsedExpr;
+
+struct TestCase {
+  std::string name;
+  std::string expression;
+  Value x;
+  bool expected;
+};
+
+class IndexedListMembershipTest
+    : public testing::TestWithParam<std::tuple<TestCase, bool>> {
+ public:
+  const TestCase& test_case() const { return std::get<0>(GetParam()); }
+  bool enable_constant_folding() const { return std::get<1>(GetParam()); }
+};
+
+TEST_P(IndexedListMembershipTest, Basic) {
+  RuntimeOptions options;
+  ASSERT_OK_AND_ASSIGN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+  if (enable_constant_folding()) {
+    ASSERT_OK(
+        EnableConstantFolding(builder, MemoryManagerRef::ReferenceCounting()));
+  }
+  ASSERT_OK(EnableIndexedListMembership(builder));
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse(test_case().expression));
+  ASSERT_OK_AND_ASSIGN(auto program, ProtobufRuntimeAdapter::CreateProgram(
+                                         *runtime, parsed_expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+  activation.InsertOrAssignValue("x", test_case().x);
+
+  ASSERT_OK_AND_ASSIGN(Value value,
+                       program->Evaluate(activation, value_factory.get()));
+  ASSERT_TRUE(value->Is<BoolValue>()) << value.DebugString();
+  EXPECT_EQ(value->As<BoolValue>().NativeValue(), test_case().expected);
+}
+
+constexpr char kIntList[] = "x in [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]";
+constexpr char kStringList[] =
+    "x in ['a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j']";
+constexpr char kFoldedList[] =
+    "x in [1, 2, 3, 4, 5] + [6, 7, 8, 9, 10] + [1.5, 2.5]";
+
+INSTANTIATE_TEST_SUITE_P(
+    Cases, IndexedListMembershipTest,
+    testing::Combine(
+        testing::ValuesIn(std::vector<TestCase>{
+            {"int_list_int", kIntList, IntValue(5), true},
+            {"int_list_uint", kIntList, UintValue(5), true},
+            {"int_list_double", kIntList, DoubleValue(5.0), true},
+            {"int_list_fraction", kIntList, DoubleValue(5.5), false},
+            {"int_list_missing", kIntList, IntValue(11), false},
+            {"int_list_string", kIntList, StringValue("5"), false},
+            {"string_list", kStringList, StringValue("e"), true},
+            {"string_list_missing", kStringList, StringValue("z"), false},
+            {"folded_list", kFoldedList, DoubleValue(2.5), true},
+            {"folded_list_missing", kFoldedList, IntValue(0), false},
+            {"short_list", "x in [1, 2]", UintValue(2), true},
+            {"non_constant_list", "x in [1, 2, 3, 4, 5, 6, 7, 8, 9, x]",
+             IntValue(42), true},
+        }),
+        testing::Bool()),
+    [](const testing::TestParamInfo<std::tuple<TestCase, bool>>& info) {
+      return absl::StrCat(std::get<0>(info.param).name,
+                          std::get<1>(info.param) ? "_folded" : "");
+    });
+
+}  // namespace
+}  // namespace cel::extensions
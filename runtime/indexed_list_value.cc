@@ -0,0 +1,122 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runtime/indexed_list_value.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "absl/base/attributes.h"
+#include "absl/base/call_once.h"
+#include "absl/base/nullability.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "common/json.h"
+#include "common/memory.h"
+#include "common/native_type.h"
+#include "common/type.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "internal/status_macros.h"
+#include "runtime/internal/list_membership_index.h"
+
+namespace cel {
+namespace {
+
+class IndexedListValue final : public ParsedListValueInterface {
+ public:
+  explicit IndexedListValue(ListValue elements)
+      : elements_(std::move(elements)) {}
+
+  std::string DebugString() const override { return elements_.DebugString(); }
+
+  bool IsEmpty() const override { return elements_.IsEmpty(); }
+
+  size_t Size() const override { return elements_.Size(); }
+
+  absl::StatusOr<JsonArray> ConvertToJsonArray(
+      AnyToJsonConverter& converter) const override {
+    return elements_.ConvertToJsonArray(converter);
+  }
+
+  absl::Status ForEach(ValueManager& value_manager,
+                       ForEachCallback callback) const override {
+    return elements_.ForEach(value_manager, callback);
+  }
+
+  absl::Status ForEach(ValueManager& value_manager,
+                       ForEachWithIndexCallback callback) const override {
+    return elements_.ForEach(value_manager, callback);
+  }
+
+  absl::StatusOr<absl::Nonnull<ValueIteratorPtr>> NewIterator(
+      ValueManager& value_manager) const override {
+    return elements_.NewIterator(value_manager);
+  }
+
+  absl::StatusOr<ValueView> Contains(
+      ValueManager& value_manager, ValueView other,
+      Value& scratch ABSL_ATTRIBUTE_LIFETIME_BOUND) const override {
+    CEL_RETURN_IF_ERROR(BuildIndex(value_manager));
+    CEL_ASSIGN_OR_RETURN(bool contains,
+                         index_.Contains(value_manager, other, scratch));
+    return BoolValueView{contains};
+  }
+
+  // Builds the index if it hasn't been already. Thread-safe.
+  absl::Status BuildIndex(ValueManager& value_manager) const {
+    absl::call_once(index_once_, [this, &value_manager]() {
+      index_status_ = index_.Build(value_manager, elements_);
+    });
+    return index_status_;
+  }
+
+ protected:
+  Type GetTypeImpl(TypeManager& type_manager) const override {
+    return elements_.GetType(type_manager);
+  }
+
+ private:
+  absl::StatusOr<ValueView> GetImpl(ValueManager& value_manager, size_t index,
+                                    Value& scratch) const override {
+    return elements_.Get(value_manager, index, scratch);
+  }
+
+  NativeTypeId GetNativeTypeId() const noexcept override {
+    return NativeTypeId::For<IndexedListValue>();
+  }
+
+  const ListValue elements_;
+  mutable absl::once_flag index_once_;
+  mutable absl::Status index_status_;
+  mutable runtime_internal::ListMembershipIndex index_;
+};
+
+}  // namespace
+
+ListValue NewIndexedListValue(MemoryManagerRef memory_manager,
+                              ListValue elements) {
+  return ParsedListValue(
+      memory_manager.MakeShared<IndexedListValue>(std::move(elements)));
+}
+
+absl::StatusOr<ListValue> NewIndexedListValue(ValueManager& value_manager,
+                                              ListValue elements) {
+  auto list = value_manager.GetMemoryManager().MakeShared<IndexedListValue>(
+      std::move(elements));
+  CEL_RETURN_IF_ERROR(list->BuildIndex(value_manager));
+  return ParsedListValue(std::move(list));
+}
+
+}  // namespace cel
@@ -0,0 +1,45 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_INDEXED_LIST_VALUE_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_INDEXED_LIST_VALUE_H_
+
+#include "absl/status/statusor.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+
+namespace cel {
+
+// Returns a list with the same elements as `elements` that answers membership
+// tests (ListValue::Contains, and by extension the `in` operator under
+// heterogeneous equality) with a hash lookup instead of a linear scan.
+//
+// Null, bool, numeric, string and bytes elements are indexed. Numbers are
+// matched following CEL heterogeneous equality, so `1u in [1.0]` holds. Any
+// other elements are still compared one at a time.
+//
+// The index is built on the first membership test, so wrapping a list that is
+// never tested costs nothing. The returned value is safe to share between
+// concurrent evaluations.
+ListValue NewIndexedListValue(MemoryManagerRef memory_manager,
+                              ListValue elements);
+
+// Same as above, but builds the index immediately. Intended for lists that are
+// known ahead of evaluation (e.g. constants at plan time).
+absl::StatusOr<ListValue> NewIndexedListValue(ValueManager& value_manager,
+                                              ListValue elements);
+
+}  // namespace cel
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_INDEXED_LIST_VALUE_H_
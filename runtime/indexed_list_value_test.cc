@@ -0,0 +1,187 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runtime/indexed_list_value.h"
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "base/type_provider.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "common/values/legacy_value_manager.h"
+#include "internal/status_macros.h"
+#include "internal/testing.h"
+
+namespace cel {
+namespace {
+
+class IndexedListValueTest : public testing::TestWithParam<bool> {
+ public:
+  IndexedListValueTest()
+      : value_factory_(MemoryManagerRef::ReferenceCounting(),
+                       TypeProvider::Builtin()) {}
+
+  // Returns an indexed list of elements, built lazily or eagerly depending on
+  // the test parameter.
+  absl::StatusOr<ListValue> MakeList(std::vector<Value> elements) {
+    CEL_ASSIGN_OR_RETURN(auto builder, value_factory_.NewListValueBuilder(
+                                           value_factory_.GetDynListType()));
+    for (Value& element : elements) {
+      CEL_RETURN_IF_ERROR(builder->Add(std::move(element)));
+    }
+    ListValue list = std::move(*builder).Build();
+    if (GetParam()) {
+      return NewIndexedListValue(value_factory_, std::move(list));
+    }
+    return NewIndexedListValue(value_factory_.GetMemoryManager(),
+                               std::move(list));
+  }
+
+  bool Contains(const ListValue& list, const Value& value) {
+    auto result = list.Contains(value_factory_, value);
+    return result.ok() && (*result)->Is<BoolValue>() &&
+           (*result)->As<BoolValue>().NativeValue();
+  }
+
+ protected:
+  common_internal::LegacyValueManager value_factory_;
+};
+
+TEST_P(IndexedListValueTest, Empty) {
+  ASSERT_OK_AND_ASSIGN(ListValue list, MakeList({}));
+  EXPECT_TRUE(list.IsEmpty());
+  EXPECT_FALSE(Contains(list, IntValue(1)));
+}
+
+TEST_P(IndexedListValueTest, PreservesElements) {
+  ASSERT_OK_AND_ASSIGN(ListValue list,
+                       MakeList({IntValue(1), IntValue(2), IntValue(3)}));
+  EXPECT_EQ(list.Size(), 3);
+  EXPECT_EQ(list.DebugString(), "[1, 2, 3]");
+  ASSERT_OK_AND_ASSIGN(Value element, list.Get(value_factory_, 1));
+  ASSERT_TRUE(element->Is<IntValue>());
+  EXPECT_EQ(element->As<IntValue>().NativeValue(), 2);
+
+  std::vector<int64_t> elements;
+  ASSERT_OK(list.ForEach(
+      value_factory_, [&elements](ValueView element) -> absl::StatusOr<bool> {
+        elements.push_back(Cast<IntValueView>(element).NativeValue());
+        return true;
+      }));
+  EXPECT_THAT(elements, testing::ElementsAre(1, 2, 3));
+
+  ASSERT_OK_AND_ASSIGN(Value equal, list.Equal(value_factory_, list));
+  EXPECT_TRUE(equal->Is<BoolValue>() && equal->As<BoolValue>().NativeValue());
+}
+
+TEST_P(IndexedListValueTest, ScalarMembership) {
+  ASSERT_OK_AND_ASSIGN(auto string_value,
+                       value_factory_.CreateStringValue("a"));
+  ASSERT_OK_AND_ASSIGN(auto bytes_value, value_factory_.CreateBytesValue("b"));
+  ASSERT_OK_AND_ASSIGN(
+      ListValue list,
+      MakeList({NullValue(), BoolValue(true), string_value, bytes_value}));
+
+  EXPECT_TRUE(Contains(list, NullValue()));
+  EXPECT_TRUE(Contains(list, BoolValue(true)));
+  EXPECT_FALSE(Contains(list, BoolValue(false)));
+  EXPECT_TRUE(Contains(list, string_value));
+  EXPECT_TRUE(Contains(list, bytes_value));
+  ASSERT_OK_AND_ASSIGN(auto other_string,
+                       value_factory_.CreateStringValue("b"));
+  EXPECT_FALSE(Contains(list, other_string));
+  ASSERT_OK_AND_ASSIGN(auto other_bytes, value_factory_.CreateBytesValue("a"));
+  EXPECT_FALSE(Contains(list, other_bytes));
+  EXPECT_FALSE(Contains(list, IntValue(0)));
+}
+
+TEST_P(IndexedListValueTest, HeterogeneousNumericMembership) {
+  ASSERT_OK_AND_ASSIGN(
+      ListValue list,
+      MakeList({IntValue(-1), UintValue(2), DoubleValue(3.5), DoubleValue(4.0),
+                DoubleValue(-0.0),
+                DoubleValue(std::numeric_limits<double>::quiet_NaN()),
+                IntValue(std::numeric_limits<int64_t>::max())}));
+
+  EXPECT_TRUE(Contains(list, IntValue(-1)));
+  EXPECT_TRUE(Contains(list, DoubleValue(-1.0)));
+  EXPECT_FALSE(Contains(list, UintValue(1)));
+  EXPECT_TRUE(Contains(list, IntValue(2)));
+  EXPECT_TRUE(Contains(list, UintValue(2)));
+  EXPECT_TRUE(Contains(list, DoubleValue(2.0)));
+  EXPECT_TRUE(Contains(list, DoubleValue(3.5)));
+  EXPECT_FALSE(Contains(list, IntValue(3)));
+  EXPECT_TRUE(Contains(list, IntValue(4)));
+  EXPECT_TRUE(Contains(list, UintValue(4)));
+  EXPECT_TRUE(Contains(list, IntValue(0)));
+  EXPECT_TRUE(Contains(list, DoubleValue(0.0)));
+  EXPECT_FALSE(
+      Contains(list, DoubleValue(std::numeric_limits<double>::quiet_NaN())));
+  // Integers are compared to doubles after converting to double.
+  EXPECT_TRUE(Contains(
+      list, DoubleValue(static_cast<double>(
+                std::numeric_limits<int64_t>::max()))));
+  EXPECT_TRUE(Contains(
+      list, UintValue(static_cast<uint64_t>(
+                std::numeric_limits<int64_t>::max()))));
+  EXPECT_FALSE(Contains(
+      list, IntValue(std::numeric_limits<int64_t>::max() - 1)));
+}
+
+TEST_P(IndexedListValueTest, MembershipMatchesLinearScan) {
+  std::vector<Value> elements;
+  for (int64_t i = 0; i < 100; i += 3) {
+    elements.push_back(IntValue(i));
+    elements.push_back(DoubleValue(i + 0.5));
+  }
+  ASSERT_OK_AND_ASSIGN(auto builder, value_factory_.NewListValueBuilder(
+                                         value_factory_.GetDynListType()));
+  for (const Value& element : elements) {
+    ASSERT_OK(builder->Add(element));
+  }
+  ListValue plain_list = std::move(*builder).Build();
+  ASSERT_OK_AND_ASSIGN(ListValue list, MakeList(std::move(elements)));
+
+  for (int64_t i = -1; i < 101; ++i) {
+    for (const Value& value :
+         {Value(IntValue(i)), Value(UintValue(i < 0 ? 0 : i)),
+          Value(DoubleValue(i)), Value(DoubleValue(i + 0.5))}) {
+      EXPECT_EQ(Contains(list, value), Contains(plain_list, value))
+          << value.DebugString();
+    }
+  }
+}
+
+TEST_P(IndexedListValueTest, UnindexedElements) {
+  ASSERT_OK_AND_ASSIGN(ListValue inner, MakeList({IntValue(1)}));
+  ASSERT_OK_AND_ASSIGN(ListValue list, MakeList({IntValue(1), inner}));
+
+  ASSERT_OK_AND_ASSIGN(ListValue other_inner, MakeList({DoubleValue(1.0)}));
+  EXPECT_TRUE(Contains(list, other_inner));
+  ASSERT_OK_AND_ASSIGN(ListValue empty, MakeList({}));
+  EXPECT_FALSE(Contains(list, empty));
+}
+
+INSTANTIATE_TEST_SUITE_P(IndexedListValueTest, IndexedListValueTest,
+                         testing::Bool(),
+                         [](const testing::TestParamInfo<bool>& info) {
+                           return info.param ? "Eager" : "Lazy";
+                         });
+
+}  // namespace
+}  // namespace cel
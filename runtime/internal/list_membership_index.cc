@@ -0,0 +1,137 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runtime/internal/list_membership_index.h"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "common/casting.h"
+#include "common/value.h"
+#include "common/value_kind.h"
+#include "common/value_manager.h"
+#include "internal/status_macros.h"
+
+namespace cel::runtime_internal {
+namespace {
+
+// -0.0 and 0.0 are equal.
+double NormalizeZero(double value) { return value == 0.0 ? 0.0 : value; }
+
+}  // namespace
+
+absl::Status ListMembershipIndex::Build(ValueManager& value_manager,
+                                        const ListValue& list) {
+  return list.ForEach(
+      value_manager, [this](ValueView element) -> absl::StatusOr<bool> {
+        Add(element);
+        return true;
+      });
+}
+
+void ListMembershipIndex::Add(ValueView element) {
+  switch (element.kind()) {
+    case ValueKind::kNull:
+      has_null_ = true;
+      return;
+    case ValueKind::kBool:
+      if (Cast<BoolValueView>(element).NativeValue()) {
+        has_true_ = true;
+      } else {
+        has_false_ = true;
+      }
+      return;
+    case ValueKind::kInt: {
+      int64_t value = Cast<IntValueView>(element).NativeValue();
+      integers_.insert(value);
+      integers_as_doubles_.insert(NormalizeZero(static_cast<double>(value)));
+      return;
+    }
+    case ValueKind::kUint: {
+      uint64_t value = Cast<UintValueView>(element).NativeValue();
+      integers_.insert(value);
+      integers_as_doubles_.insert(NormalizeZero(static_cast<double>(value)));
+      return;
+    }
+    case ValueKind::kDouble: {
+      double value = Cast<DoubleValueView>(element).NativeValue();
+      // NaN is not equal to anything, including itself.
+      if (!std::isnan(value)) {
+        doubles_.insert(NormalizeZero(value));
+      }
+      return;
+    }
+    case ValueKind::kString:
+      strings_.insert(Cast<StringValueView>(element).NativeString());
+      return;
+    case ValueKind::kBytes:
+      bytes_.insert(Cast<BytesValueView>(element).NativeString());
+      return;
+    default:
+      others_.push_back(Value(element));
+      return;
+  }
+}
+
+absl::StatusOr<bool> ListMembershipIndex::Contains(
+    ValueManager& value_manager, ValueView other, Value& scratch) const {
+  switch (other.kind()) {
+    case ValueKind::kNull:
+      return has_null_;
+    case ValueKind::kBool:
+      return Cast<BoolValueView>(other).NativeValue() ? has_true_ : has_false_;
+    case ValueKind::kInt: {
+      int64_t value = Cast<IntValueView>(other).NativeValue();
+      return integers_.contains(value) ||
+             doubles_.contains(static_cast<double>(value));
+    }
+    case ValueKind::kUint: {
+      uint64_t value = Cast<UintValueView>(other).NativeValue();
+      return integers_.contains(value) ||
+             doubles_.contains(static_cast<double>(value));
+    }
+    case ValueKind::kDouble: {
+      double value = Cast<DoubleValueView>(other).NativeValue();
+      if (std::isnan(value)) {
+        return false;
+      }
+      value = NormalizeZero(value);
+      return doubles_.contains(value) || integers_as_doubles_.contains(value);
+    }
+    case ValueKind::kString: {
+      std::string buffer;
+      return strings_.contains(
+          Cast<StringValueView>(other).NativeString(buffer));
+    }
+    case ValueKind::kBytes: {
+      std::string buffer;
+      return bytes_.contains(Cast<BytesValueView>(other).NativeString(buffer));
+    }
+    default:
+      break;
+  }
+  for (const Value& element : others_) {
+    CEL_ASSIGN_OR_RETURN(auto result,
+                         element.Equal(value_manager, other, scratch));
+    if (auto bool_result = As<BoolValueView>(result);
+        bool_result.has_value() && bool_result->NativeValue()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace cel::runtime_internal
@@ -0,0 +1,71 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_LIST_MEMBERSHIP_INDEX_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_LIST_MEMBERSHIP_INDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/numeric/int128.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+
+namespace cel::runtime_internal {
+
+// Hash index over the elements of a list for membership tests under CEL
+// heterogeneous equality.
+//
+// Null, bool, numeric, string and bytes elements are hashed. Integers (int
+// and uint) are compared exactly, and against doubles after converting the
+// integer to double, matching cel::internal::Number, so they are indexed both
+// ways. Other elements are kept aside and compared with Equal.
+//
+// Not thread-safe while building; Contains is safe to call concurrently once
+// built.
+class ListMembershipIndex {
+ public:
+  ListMembershipIndex() = default;
+
+  ListMembershipIndex(const ListMembershipIndex&) = delete;
+  ListMembershipIndex& operator=(const ListMembershipIndex&) = delete;
+
+  // Adds the elements of list to the index.
+  absl::Status Build(ValueManager& value_manager, const ListValue& list);
+
+  void Add(ValueView element);
+
+  // Returns whether other is equal to an indexed element. A non-ok status is
+  // only returned if comparing against an unhashed element fails.
+  absl::StatusOr<bool> Contains(ValueManager& value_manager, ValueView other,
+                                Value& scratch) const;
+
+ private:
+  bool has_null_ = false;
+  bool has_true_ = false;
+  bool has_false_ = false;
+  absl::flat_hash_set<absl::int128> integers_;
+  absl::flat_hash_set<double> integers_as_doubles_;
+  absl::flat_hash_set<double> doubles_;
+  absl::flat_hash_set<std::string> strings_;
+  absl::flat_hash_set<std::string> bytes_;
+  // Elements which are not hashed.
+  std::vector<Value> others_;
+};
+
+}  // namespace cel::runtime_internal
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_LIST_MEMBERSHIP_INDEX_H_
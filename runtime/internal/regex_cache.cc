@@ -0,0 +1,113 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/internal/regex_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "re2/re2.h"
+
+namespace cel::runtime_internal {
+
+RegexCache& RegexCache::Global() {
+  static absl::NoDestructor<RegexCache> cache(0);
+  return *cache;
+}
+
+RegexCache::RegexCache(size_t capacity) : capacity_(capacity) {}
+
+void RegexCache::Reserve(size_t capacity) {
+  size_t current = capacity_.load(std::memory_order_relaxed);
+  while (current < capacity &&
+         !capacity_.compare_exchange_weak(current, capacity,
+                                          std::memory_order_relaxed)) {
+  }
+}
+
+size_t RegexCache::KeyHash::operator()(KeyView key) const {
+  return absl::HashOf(key.pattern, key.options);
+}
+
+uint64_t RegexCache::OptionsKey(const RE2::Options& options) {
+  uint64_t flags = 0;
+  for (bool flag :
+       {options.encoding() == RE2::Options::EncodingLatin1,
+        options.posix_syntax(), options.longest_match(), options.log_errors(),
+        options.literal(), options.never_nl(), options.dot_nl(),
+        options.never_capture(), options.case_sensitive(),
+        options.perl_classes(), options.word_boundary(), options.one_line()}) {
+    flags = (flags << 1) | (flag ? 1 : 0);
+  }
+  return (static_cast<uint64_t>(options.max_mem()) << 16) | flags;
+}
+
+size_t RegexCache::ShardCapacity() const {
+  return std::max<size_t>(1, (capacity() + kShardCount - 1) / kShardCount);
+}
+
+std::shared_ptr<const RE2> RegexCache::Get(absl::string_view pattern,
+                                           const RE2::Options& options) {
+  KeyView key(pattern, OptionsKey(options));
+  Shard& shard = shards_[KeyHash{}(key) % kShardCount];
+  {
+    absl::MutexLock lock(&shard.mutex);
+    if (auto it = shard.index.find(key); it != shard.index.end()) {
+      shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return it->second->program;
+    }
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+
+  // Compile outside of the lock, compilation dominates the cost of a miss.
+  auto program = std::make_shared<const RE2>(pattern, options);
+
+  absl::MutexLock lock(&shard.mutex);
+  if (auto it = shard.index.find(key); it != shard.index.end()) {
+    // Another thread compiled the same pattern concurrently.
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    return it->second->program;
+  }
+  shard.entries.push_front(
+      Entry{Key{std::string(pattern), key.options}, program});
+  shard.index.insert({shard.entries.front().key, shard.entries.begin()});
+  const size_t shard_capacity = ShardCapacity();
+  while (shard.entries.size() > shard_capacity) {
+    shard.index.erase(shard.entries.back().key);
+    shard.entries.pop_back();
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return program;
+}
+
+size_t RegexCache::size() const {
+  size_t size = 0;
+  for (const Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex);
+    size += shard.entries.size();
+  }
+  return size;
+}
+
+}  // namespace cel::runtime_internal
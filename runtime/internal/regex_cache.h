@@ -0,0 +1,163 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_REGEX_CACHE_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_REGEX_CACHE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "re2/re2.h"
+
+namespace cel::runtime_internal {
+
+// Bounded cache of compiled RE2 programs keyed by pattern and options, for
+// regex functions called with patterns that are not known at plan time.
+//
+// The cache is split into shards, each with its own lock and LRU list, so
+// concurrent evaluations only contend when their patterns land in the same
+// shard. Programs are handed out as shared pointers so that an eviction never
+// invalidates a program still in use by another call.
+//
+// Invalid patterns are cached too; callers are expected to check RE2::ok()
+// and the program size themselves.
+class RegexCache final {
+ public:
+  static constexpr size_t kShardCount = 16;
+
+  // Returns the process-wide cache shared by the regex function overloads.
+  // Its capacity is the largest capacity requested with Reserve.
+  static RegexCache& Global();
+
+  explicit RegexCache(size_t capacity);
+
+  RegexCache(const RegexCache&) = delete;
+  RegexCache& operator=(const RegexCache&) = delete;
+
+  // Grows the capacity of the cache to at least `capacity` programs.
+  void Reserve(size_t capacity);
+
+  // Returns the compiled program for `pattern`, compiling and caching it on a
+  // miss.
+  std::shared_ptr<const RE2> Get(
+      absl::string_view pattern,
+      const RE2::Options& options = RE2::DefaultOptions);
+
+  size_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
+
+  uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+
+  uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+  uint64_t evictions() const {
+    return evictions_.load(std::memory_order_relaxed);
+  }
+
+  // Number of programs currently cached.
+  size_t size() const;
+
+ private:
+  struct Key {
+    std::string pattern;
+    uint64_t options;
+  };
+
+  struct KeyView {
+    KeyView(const Key& key)  // NOLINT(google-explicit-constructor)
+        : pattern(key.pattern), options(key.options) {}
+    KeyView(absl::string_view pattern, uint64_t options)
+        : pattern(pattern), options(options) {}
+
+    absl::string_view pattern;
+    uint64_t options;
+  };
+
+  struct KeyHash {
+    using is_transparent = void;
+
+    size_t operator()(KeyView key) const;
+  };
+
+  struct KeyEq {
+    using is_transparent = void;
+
+    bool operator()(KeyView lhs, KeyView rhs) const {
+      return lhs.options == rhs.options && lhs.pattern == rhs.pattern;
+    }
+  };
+
+  struct Entry {
+    Key key;
+    std::shared_ptr<const RE2> program;
+  };
+
+  struct Shard {
+    mutable absl::Mutex mutex;
+    // Most recently used entries first.
+    std::list<Entry> entries ABSL_GUARDED_BY(mutex);
+    absl::flat_hash_map<Key, std::list<Entry>::iterator, KeyHash, KeyEq> index
+        ABSL_GUARDED_BY(mutex);
+  };
+
+  static uint64_t OptionsKey(const RE2::Options& options);
+
+  size_t ShardCapacity() const;
+
+  std::atomic<size_t> capacity_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::array<Shard, kShardCount> shards_;
+};
+
+// The program for a pattern used by a single call: shared from `cache` if it
+// is not null, otherwise compiled in place. Neither path allocates beyond what
+// RE2 does for compilation itself.
+class RegexProgram final {
+ public:
+  RegexProgram(RegexCache* cache, absl::string_view pattern) {
+    if (cache != nullptr) {
+      cached_ = cache->Get(pattern);
+    } else {
+      compiled_.emplace(pattern);
+    }
+  }
+
+  RegexProgram(const RegexProgram&) = delete;
+  RegexProgram& operator=(const RegexProgram&) = delete;
+
+  const RE2& operator*() const {
+    return cached_ != nullptr ? *cached_ : *compiled_;
+  }
+
+  const RE2* operator->() const { return &**this; }
+
+ private:
+  std::shared_ptr<const RE2> cached_;
+  absl::optional<RE2> compiled_;
+};
+
+}  // namespace cel::runtime_internal
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_REGEX_CACHE_H_
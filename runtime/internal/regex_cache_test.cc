@@ -0,0 +1,135 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/internal/regex_cache.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "internal/testing.h"
+#include "re2/re2.h"
+
+namespace cel::runtime_internal {
+namespace {
+
+TEST(RegexCache, ReusesCompiledPrograms) {
+  RegexCache cache(16);
+
+  std::shared_ptr<const RE2> first = cache.Get("a+b");
+  std::shared_ptr<const RE2> second = cache.Get("a+b");
+
+  ASSERT_TRUE(first->ok());
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(cache.misses(), 1);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(RegexCache, KeyedByOptions) {
+  RegexCache cache(16);
+  RE2::Options case_insensitive;
+  case_insensitive.set_case_sensitive(false);
+
+  std::shared_ptr<const RE2> sensitive = cache.Get("abc");
+  std::shared_ptr<const RE2> insensitive = cache.Get("abc", case_insensitive);
+
+  EXPECT_NE(sensitive.get(), insensitive.get());
+  EXPECT_FALSE(RE2::FullMatch("ABC", *sensitive));
+  EXPECT_TRUE(RE2::FullMatch("ABC", *insensitive));
+  EXPECT_EQ(cache.misses(), 2);
+}
+
+TEST(RegexCache, CachesInvalidPatterns) {
+  RegexCache cache(16);
+
+  EXPECT_FALSE(cache.Get("a(b")->ok());
+  EXPECT_FALSE(cache.Get("a(b")->ok());
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+TEST(RegexCache, EvictsLeastRecentlyUsed) {
+  // One program per shard.
+  RegexCache cache(RegexCache::kShardCount);
+
+  for (int i = 0; i < 100; ++i) {
+    cache.Get(absl::StrCat("pattern", i));
+  }
+  EXPECT_LE(cache.size(), RegexCache::kShardCount);
+  EXPECT_GE(cache.evictions(), 100 - RegexCache::kShardCount);
+
+  // The most recently used program is still cached.
+  cache.Get("pattern99");
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+TEST(RegexCache, EvictedProgramsRemainValid) {
+  RegexCache cache(1);
+
+  std::shared_ptr<const RE2> program = cache.Get("x+");
+  for (int i = 0; i < 100; ++i) {
+    cache.Get(absl::StrCat("y", i));
+  }
+  EXPECT_TRUE(RE2::FullMatch("xxx", *program));
+}
+
+TEST(RegexCache, Reserve) {
+  RegexCache cache(4);
+
+  cache.Reserve(64);
+  EXPECT_EQ(cache.capacity(), 64);
+  cache.Reserve(8);
+  EXPECT_EQ(cache.capacity(), 64);
+}
+
+TEST(RegexCache, ConcurrentAccess) {
+  RegexCache cache(32);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&cache]() {
+      for (int i = 0; i < 1000; ++i) {
+        std::string pattern = absl::StrCat("[a-z]+", i % 64);
+        auto program = cache.Get(pattern);
+        ASSERT_TRUE(program->ok());
+        ASSERT_EQ(program->pattern(), pattern);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(cache.hits() + cache.misses(), 8000);
+}
+
+TEST(RegexProgram, SharesCachedProgram) {
+  RegexCache cache(16);
+  std::shared_ptr<const RE2> cached = cache.Get("a+b");
+
+  RegexProgram program(&cache, "a+b");
+
+  EXPECT_EQ(&*program, cached.get());
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+TEST(RegexProgram, CompilesWithoutCache) {
+  RegexProgram program(nullptr, "a+b");
+
+  ASSERT_TRUE(program->ok());
+  EXPECT_TRUE(RE2::FullMatch("aab", *program));
+}
+
+}  // namespace
+}  // namespace cel::runtime_internal
@@ -38,6 +38,12 @@ class RuntimeFriendAccess {
   static NativeTypeId RuntimeTypeId(Runtime& runtime) {
     return runtime.GetNativeTypeId();
   }
+
+  // Return the internal type_id for the evaluation state instance for checked
+  // down casting.
+  static NativeTypeId EvaluationStateTypeId(const EvaluationState& state) {
+    return state.GetNativeTypeId();
+  }
 };
 
 }  // namespace cel::runtime_internal
@@ -13,39 +13,256 @@
 // limitations under the License.
 #include "runtime/internal/runtime_impl.h"
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "base/ast.h"
 #include "base/type_provider.h"
+#include "common/native_type.h"
 #include "common/value.h"
 #include "eval/eval/evaluator_core.h"
+#include "internal/casts.h"
 #include "internal/status_macros.h"
 #include "runtime/activation_interface.h"
+#include "runtime/internal/runtime_friend_access.h"
 #include "runtime/runtime.h"
 
 namespace cel::runtime_internal {
 namespace {
 
+using ::google::api::expr::runtime::ExecutionFrame;
+using ::google::api::expr::runtime::FlatExpression;
+using ::google::api::expr::runtime::FlatExpressionEvaluatorState;
+
+// Fixed-capacity, lock-free pool of idle evaluator states.
+//
+// Each slot holds at most one state. Slots are claimed with an atomic exchange
+// (acquire) or compare-exchange against null (release), so no locks are taken
+// on the evaluation path. States released while the pool is full are
+// destroyed.
+class EvaluatorStatePool {
+ public:
+  explicit EvaluatorStatePool(size_t capacity) : slots_(capacity) {
+    for (auto& slot : slots_) {
+      slot.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  EvaluatorStatePool(const EvaluatorStatePool&) = delete;
+  EvaluatorStatePool& operator=(const EvaluatorStatePool&) = delete;
+
+  ~EvaluatorStatePool() {
+    for (auto& slot : slots_) {
+      delete slot.load(std::memory_order_relaxed);
+    }
+  }
+
+  // Returns an idle state or nullptr if the pool is empty.
+  std::unique_ptr<FlatExpressionEvaluatorState> Acquire() {
+    for (auto& slot : slots_) {
+      if (slot.load(std::memory_order_relaxed) == nullptr) {
+        continue;
+      }
+      FlatExpressionEvaluatorState* state =
+          slot.exchange(nullptr, std::memory_order_acquire);
+      if (state != nullptr) {
+        return absl::WrapUnique(state);
+      }
+    }
+    return nullptr;
+  }
+
+  void Release(std::unique_ptr<FlatExpressionEvaluatorState> state) {
+    for (auto& slot : slots_) {
+      FlatExpressionEvaluatorState* expected = nullptr;
+      if (slot.compare_exchange_strong(expected, state.get(),
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        state.release();
+        return;
+      }
+    }
+  }
+
+ private:
+  std::vector<std::atomic<FlatExpressionEvaluatorState*>> slots_;
+};
+
+class EvaluationStateImpl final : public EvaluationState {
+ public:
+  explicit EvaluationStateImpl(const Program* program) : program_(program) {}
+
+  const Program* program() const { return program_; }
+
+  // Returns the underlying evaluator state bound to value_factory, allocating
+  // it on first use.
+  FlatExpressionEvaluatorState& Bind(const FlatExpression& expression,
+                                     ValueManager& value_factory) {
+    if (state_ == nullptr) {
+      state_ = expression.MakeEvaluatorStatePtr(value_factory);
+    } else {
+      state_->set_value_factory(value_factory);
+    }
+    return *state_;
+  }
+
+ private:
+  NativeTypeId GetNativeTypeId() const override {
+    return NativeTypeId::For<EvaluationStateImpl>();
+  }
+
+  const Program* program_;
+  std::unique_ptr<FlatExpressionEvaluatorState> state_;
+};
+
+class AsyncEvaluationImpl final : public AsyncEvaluation {
+ public:
+  AsyncEvaluationImpl(const FlatExpression& expression,
+                      const ActivationInterface& activation,
+                      ValueManager& value_factory)
+      : state_(expression.MakeEvaluatorStatePtr(value_factory)),
+        frame_(expression.MakeSuspendableFrame(activation, *state_)) {}
+
+  absl::Status Start() {
+    return Update(frame_->Evaluate(
+        google::api::expr::runtime::EvaluationListener()));
+  }
+
+  bool done() const override { return done_; }
+
+  ValueFuture& pending() const override { return frame_->pending(); }
+
+  absl::Status Resume() override {
+    if (done_ || !frame_->pending().IsReady()) {
+      return absl::FailedPreconditionError(
+          "evaluation is not waiting on a ready function result");
+    }
+    return Update(frame_->Resume());
+  }
+
+  const Value& result() const override { return result_; }
+
+ private:
+  absl::Status Update(absl::StatusOr<Value> result) {
+    if (frame_->suspended()) {
+      return absl::OkStatus();
+    }
+    done_ = true;
+    CEL_ASSIGN_OR_RETURN(result_, std::move(result));
+    return absl::OkStatus();
+  }
+
+  std::unique_ptr<FlatExpressionEvaluatorState> state_;
+  std::unique_ptr<ExecutionFrame> frame_;
+  bool done_ = false;
+  Value result_;
+};
+
 class ProgramImpl final : public TraceableProgram {
  public:
   using EvaluationListener = TraceableProgram::EvaluationListener;
   ProgramImpl(
       const std::shared_ptr<const RuntimeImpl::Environment>& environment,
-      google::api::expr::runtime::FlatExpression impl)
-      : environment_(environment), impl_(std::move(impl)) {}
+      FlatExpression impl, int evaluation_state_pool_size)
+      : environment_(environment), impl_(std::move(impl)) {
+    if (evaluation_state_pool_size > 0) {
+      state_pool_ =
+          std::make_unique<EvaluatorStatePool>(evaluation_state_pool_size);
+    }
+  }
 
   absl::StatusOr<Value> Evaluate(const ActivationInterface& activation,
                                  ValueManager& value_factory) const override {
     return Trace(activation, EvaluationListener(), value_factory);
   }
 
+  absl::StatusOr<Value> Evaluate(const ActivationInterface& activation,
+                                 ValueManager& value_factory,
+                                 EvaluationState& state) const override {
+    if (RuntimeFriendAccess::EvaluationStateTypeId(state) !=
+            NativeTypeId::For<EvaluationStateImpl>() ||
+        cel::internal::down_cast<EvaluationStateImpl&>(state).program() !=
+            this) {
+      return absl::InvalidArgumentError(
+          "evaluation state was not created by this program");
+    }
+    FlatExpressionEvaluatorState& flat_state =
+        cel::internal::down_cast<EvaluationStateImpl&>(state).Bind(
+            impl_, value_factory);
+    auto result = impl_.EvaluateWithCallback(activation, EvaluationListener(),
+                                              flat_state);
+    // Don't hold on to values from this evaluation: their memory manager may
+    // not outlive the state.
+    flat_state.Reset();
+    return result;
+  }
+
+  absl::StatusOr<std::unique_ptr<EvaluationState>> CreateEvaluationState()
+      const override {
+    return std::make_unique<EvaluationStateImpl>(this);
+  }
+
   absl::StatusOr<Value> Trace(const ActivationInterface& activation,
                               EvaluationListener callback,
                               ValueManager& value_factory) const override {
-    auto state = impl_.MakeEvaluatorState(value_factory);
-    return impl_.EvaluateWithCallback(activation, std::move(callback), state);
+    if (state_pool_ == nullptr) {
+      auto state = impl_.MakeEvaluatorState(value_factory);
+      return impl_.EvaluateWithCallback(activation, std::move(callback), state);
+    }
+    std::unique_ptr<FlatExpressionEvaluatorState> state =
+        AcquireState(value_factory);
+    auto result =
+        impl_.EvaluateWithCallback(activation, std::move(callback), *state);
+    ReleaseState(std::move(state));
+    return result;
+  }
+
+  absl::StatusOr<std::unique_ptr<AsyncEvaluation>> EvaluateAsync(
+      const ActivationInterface& activation,
+      ValueManager& value_factory) const override {
+    auto evaluation =
+        std::make_unique<AsyncEvaluationImpl>(impl_, activation, value_factory);
+    CEL_RETURN_IF_ERROR(evaluation->Start());
+    return evaluation;
+  }
+
+  absl::StatusOr<std::vector<Value>> EvaluateBatch(
+      absl::Span<const ActivationInterface* const> activations,
+      ValueManager& value_factory) const override {
+    // A single state, drawn from the pool if enabled, serves the whole batch.
+    // It is reset between items so no item sees another's stack or slots.
+    std::unique_ptr<FlatExpressionEvaluatorState> state =
+        AcquireState(value_factory);
+    std::vector<Value> results;
+    results.reserve(activations.size());
+    absl::Status status;
+    for (const ActivationInterface* activation : activations) {
+      auto result = impl_.EvaluateWithCallback(*activation,
+                                               EvaluationListener(), *state);
+      state->Reset();
+      if (!result.ok()) {
+        status = std::move(result).status();
+        break;
+      }
+      results.push_back(*std::move(result));
+    }
+    ReleaseState(std::move(state));
+    if (!status.ok()) {
+      return status;
+    }
+    return results;
+  }
+
+  absl::Span<const std::string> GetDeclaredVariables() const override {
+    return impl_.declared_variables();
   }
 
   const TypeProvider& GetTypeProvider() const override {
@@ -53,9 +270,36 @@ class ProgramImpl final : public TraceableProgram {
   }
 
  private:
+  // Returns a state bound to value_factory, taken from the pool if one is
+  // idle.
+  std::unique_ptr<FlatExpressionEvaluatorState> AcquireState(
+      ValueManager& value_factory) const {
+    std::unique_ptr<FlatExpressionEvaluatorState> state;
+    if (state_pool_ != nullptr) {
+      state = state_pool_->Acquire();
+    }
+    if (state == nullptr) {
+      return impl_.MakeEvaluatorStatePtr(value_factory);
+    }
+    state->set_value_factory(value_factory);
+    return state;
+  }
+
+  // Clears state and returns it to the pool. States are cleared so they never
+  // hold values from a memory manager that may already be gone.
+  void ReleaseState(std::unique_ptr<FlatExpressionEvaluatorState> state) const {
+    if (state_pool_ == nullptr) {
+      return;
+    }
+    state->Reset();
+    state_pool_->Release(std::move(state));
+  }
+
   // Keep the Runtime environment alive while programs reference it.
   std::shared_ptr<const RuntimeImpl::Environment> environment_;
-  google::api::expr::runtime::FlatExpression impl_;
+  FlatExpression impl_;
+  // Null if evaluator state pooling is disabled.
+  std::unique_ptr<EvaluatorStatePool> state_pool_;
 };
 
 }  // namespace
@@ -73,7 +317,9 @@ RuntimeImpl::CreateTraceableProgram(
   CEL_ASSIGN_OR_RETURN(auto flat_expr, expr_builder_.CreateExpressionImpl(
                                            std::move(ast), options.issues));
 
-  return std::make_unique<ProgramImpl>(environment_, std::move(flat_expr));
+  return std::make_unique<ProgramImpl>(
+      environment_, std::move(flat_expr),
+      expr_builder_.options().evaluation_state_pool_size);
 }
 
 }  // namespace cel::runtime_internal
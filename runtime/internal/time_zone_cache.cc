@@ -0,0 +1,102 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/internal/time_zone_cache.h"
+
+#include <cstddef>
+#include <string>
+
+#include "absl/base/no_destructor.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace cel::runtime_internal {
+namespace {
+
+// Bounds the memory held for time zone strings coming from input data.
+constexpr size_t kMaxCachedTimeZones = 1024;
+
+class TimeZoneCache final {
+ public:
+  absl::StatusOr<ResolvedTimeZone> Resolve(absl::string_view tz) {
+    {
+      absl::ReaderMutexLock lock(&mutex_);
+      if (auto it = zones_.find(tz); it != zones_.end()) {
+        return it->second;
+      }
+    }
+    absl::StatusOr<ResolvedTimeZone> resolved = ParseTimeZone(tz);
+    if (!resolved.ok()) {
+      return resolved;
+    }
+    absl::MutexLock lock(&mutex_);
+    if (zones_.size() < kMaxCachedTimeZones) {
+      zones_.try_emplace(tz, *resolved);
+    }
+    return resolved;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, ResolvedTimeZone> zones_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+absl::StatusOr<ResolvedTimeZone> ParseTimeZone(absl::string_view tz) {
+  ResolvedTimeZone resolved;
+
+  // Early return if there is no timezone.
+  if (tz.empty()) {
+    return resolved;
+  }
+
+  // Check to see whether the timezone is an IANA timezone.
+  if (absl::LoadTimeZone(tz, &resolved.zone)) {
+    return resolved;
+  }
+
+  // Check for times of the format: [+-]HH:MM and convert them into durations
+  // specified as [+-]HHhMMm.
+  if (absl::StrContains(tz, ":")) {
+    std::string dur = absl::StrCat(tz, "m");
+    absl::StrReplaceAll({{":", "h"}}, &dur);
+    if (absl::ParseDuration(dur, &resolved.offset)) {
+      resolved.zone = absl::UTCTimeZone();
+      return resolved;
+    }
+  }
+
+  // Otherwise, error.
+  return absl::InvalidArgumentError("Invalid timezone");
+}
+
+absl::StatusOr<ResolvedTimeZone> ResolveTimeZone(absl::string_view tz) {
+  if (tz.empty()) {
+    return ResolvedTimeZone();
+  }
+  static absl::NoDestructor<TimeZoneCache> cache;
+  return cache->Resolve(tz);
+}
+
+}  // namespace cel::runtime_internal
@@ -0,0 +1,48 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_TIME_ZONE_CACHE_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_TIME_ZONE_CACHE_H_
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace cel::runtime_internal {
+
+// Time zone argument of the timestamp accessor functions (getHours etc.):
+// either an IANA time zone, or a fixed offset from UTC.
+struct ResolvedTimeZone {
+  absl::TimeZone zone = absl::UTCTimeZone();
+  // Offset applied to the timestamp before the breakdown in `zone`. Only set
+  // for fixed offsets, in which case `zone` is UTC.
+  absl::Duration offset = absl::ZeroDuration();
+
+  absl::TimeZone::CivilInfo At(absl::Time timestamp) const {
+    return zone.At(timestamp + offset);
+  }
+};
+
+// Resolves a time zone argument: empty for UTC, an IANA time zone name such as
+// "America/New_York", or an offset of the form [+-]HH:MM.
+absl::StatusOr<ResolvedTimeZone> ParseTimeZone(absl::string_view tz);
+
+// Same as ParseTimeZone, but looks the time zone up in a process-wide cache
+// first. Successfully resolved time zones are added to the cache until it
+// reaches a fixed size, after which new time zones are resolved on each call.
+absl::StatusOr<ResolvedTimeZone> ResolveTimeZone(absl::string_view tz);
+
+}  // namespace cel::runtime_internal
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_TIME_ZONE_CACHE_H_
@@ -0,0 +1,70 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/internal/time_zone_cache.h"
+
+#include "absl/status/status.h"
+#include "absl/time/civil_time.h"
+#include "absl/time/time.h"
+#include "internal/testing.h"
+
+namespace cel::runtime_internal {
+namespace {
+
+using ::cel::internal::StatusIs;
+
+// 2024-07-01T12:00:00Z
+const absl::Time kTimestamp = absl::FromCivil(
+    absl::CivilSecond(2024, 7, 1, 12, 0, 0), absl::UTCTimeZone());
+
+TEST(TimeZoneCache, Empty) {
+  ASSERT_OK_AND_ASSIGN(ResolvedTimeZone time_zone, ResolveTimeZone(""));
+  EXPECT_EQ(time_zone.At(kTimestamp).cs, absl::CivilSecond(2024, 7, 1, 12));
+}
+
+TEST(TimeZoneCache, Iana) {
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK_AND_ASSIGN(ResolvedTimeZone time_zone,
+                         ResolveTimeZone("America/New_York"));
+    // Daylight saving time.
+    EXPECT_EQ(time_zone.At(kTimestamp).cs, absl::CivilSecond(2024, 7, 1, 8));
+  }
+}
+
+TEST(TimeZoneCache, FixedOffset) {
+  ASSERT_OK_AND_ASSIGN(ResolvedTimeZone positive, ResolveTimeZone("+05:30"));
+  EXPECT_EQ(positive.At(kTimestamp).cs,
+            absl::CivilSecond(2024, 7, 1, 17, 30));
+
+  ASSERT_OK_AND_ASSIGN(ResolvedTimeZone negative, ResolveTimeZone("-02:15"));
+  EXPECT_EQ(negative.At(kTimestamp).cs, absl::CivilSecond(2024, 7, 1, 9, 45));
+}
+
+TEST(TimeZoneCache, Invalid) {
+  EXPECT_THAT(ResolveTimeZone("Not/A_Zone"),
+              StatusIs(absl::StatusCode::kInvalidArgument, "Invalid timezone"));
+  EXPECT_THAT(ResolveTimeZone("05:xx"),
+              StatusIs(absl::StatusCode::kInvalidArgument, "Invalid timezone"));
+}
+
+TEST(TimeZoneCache, MatchesUncached) {
+  for (const char* tz : {"UTC", "Asia/Kolkata", "+01:00", "-11:30"}) {
+    ASSERT_OK_AND_ASSIGN(ResolvedTimeZone cached, ResolveTimeZone(tz));
+    ASSERT_OK_AND_ASSIGN(ResolvedTimeZone uncached, ParseTimeZone(tz));
+    EXPECT_EQ(cached.At(kTimestamp).cs, uncached.At(kTimestamp).cs) << tz;
+  }
+}
+
+}  // namespace
+}  // namespace cel::runtime_internal
@@ -0,0 +1,86 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/internal/timestamp_accessors.h"
+
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/civil_time.h"
+#include "absl/time/time.h"
+#include "base/builtins.h"
+
+namespace cel::runtime_internal {
+
+int64_t TimestampFullYear(const absl::TimeZone::CivilInfo& breakdown) {
+  return breakdown.cs.year();
+}
+
+int64_t TimestampMonth(const absl::TimeZone::CivilInfo& breakdown) {
+  return breakdown.cs.month() - 1;
+}
+
+int64_t TimestampDayOfYear(const absl::TimeZone::CivilInfo& breakdown) {
+  return absl::GetYearDay(absl::CivilDay(breakdown.cs)) - 1;
+}
+
+int64_t TimestampDayOfMonth(const absl::TimeZone::CivilInfo& breakdown) {
+  return breakdown.cs.day() - 1;
+}
+
+int64_t TimestampDate(const absl::TimeZone::CivilInfo& breakdown) {
+  return breakdown.cs.day();
+}
+
+int64_t TimestampDayOfWeek(const absl::TimeZone::CivilInfo& breakdown) {
+  absl::Weekday weekday = absl::GetWeekday(breakdown.cs);
+
+  // get day of week from the date in UTC, zero-based, zero for Sunday,
+  // based on GetDayOfWeek CEL function definition.
+  int weekday_num = static_cast<int>(weekday);
+  weekday_num = (weekday_num == 6) ? 0 : weekday_num + 1;
+  return weekday_num;
+}
+
+int64_t TimestampHours(const absl::TimeZone::CivilInfo& breakdown) {
+  return breakdown.cs.hour();
+}
+
+int64_t TimestampMinutes(const absl::TimeZone::CivilInfo& breakdown) {
+  return breakdown.cs.minute();
+}
+
+int64_t TimestampSeconds(const absl::TimeZone::CivilInfo& breakdown) {
+  return breakdown.cs.second();
+}
+
+int64_t TimestampMilliseconds(const absl::TimeZone::CivilInfo& breakdown) {
+  return absl::ToInt64Milliseconds(breakdown.subsecond);
+}
+
+TimestampAccessor FindTimestampAccessor(absl::string_view function) {
+  if (function == builtin::kFullYear) return &TimestampFullYear;
+  if (function == builtin::kMonth) return &TimestampMonth;
+  if (function == builtin::kDayOfYear) return &TimestampDayOfYear;
+  if (function == builtin::kDayOfMonth) return &TimestampDayOfMonth;
+  if (function == builtin::kDate) return &TimestampDate;
+  if (function == builtin::kDayOfWeek) return &TimestampDayOfWeek;
+  if (function == builtin::kHours) return &TimestampHours;
+  if (function == builtin::kMinutes) return &TimestampMinutes;
+  if (function == builtin::kSeconds) return &TimestampSeconds;
+  if (function == builtin::kMilliseconds) return &TimestampMilliseconds;
+  return nullptr;
+}
+
+}  // namespace cel::runtime_internal
@@ -0,0 +1,47 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_TIMESTAMP_ACCESSORS_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_TIMESTAMP_ACCESSORS_H_
+
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace cel::runtime_internal {
+
+// Extracts the result of a timestamp accessor function (getFullYear,
+// getHours, ...) from the breakdown of the timestamp in the requested time
+// zone.
+using TimestampAccessor = int64_t (*)(const absl::TimeZone::CivilInfo&);
+
+int64_t TimestampFullYear(const absl::TimeZone::CivilInfo& breakdown);
+int64_t TimestampMonth(const absl::TimeZone::CivilInfo& breakdown);
+int64_t TimestampDayOfYear(const absl::TimeZone::CivilInfo& breakdown);
+int64_t TimestampDayOfMonth(const absl::TimeZone::CivilInfo& breakdown);
+int64_t TimestampDate(const absl::TimeZone::CivilInfo& breakdown);
+int64_t TimestampDayOfWeek(const absl::TimeZone::CivilInfo& breakdown);
+int64_t TimestampHours(const absl::TimeZone::CivilInfo& breakdown);
+int64_t TimestampMinutes(const absl::TimeZone::CivilInfo& breakdown);
+int64_t TimestampSeconds(const absl::TimeZone::CivilInfo& breakdown);
+int64_t TimestampMilliseconds(const absl::TimeZone::CivilInfo& breakdown);
+
+// Returns the accessor for the named timestamp function, or nullptr if there
+// is none.
+TimestampAccessor FindTimestampAccessor(absl::string_view function);
+
+}  // namespace cel::runtime_internal
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_INTERNAL_TIMESTAMP_ACCESSORS_H_
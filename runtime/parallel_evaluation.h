@@ -0,0 +1,49 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_PARALLEL_EVALUATION_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_PARALLEL_EVALUATION_H_
+
+#include <memory>
+
+#include "absl/status/status.h"
+#include "runtime/executor.h"
+#include "runtime/runtime_builder.h"
+
+namespace cel::extensions {
+
+// Enable concurrent evaluation of independent calls to expensive functions in
+// the runtime being built.
+//
+// Functions opt in by setting is_expensive on their FunctionDescriptor. When a
+// call has two or more arguments that call an expensive function, all but the
+// first of them are started on the executor and the rest are evaluated on the
+// calling thread. Results, including errors, match sequential evaluation.
+//
+// The operands of '&&' and '||' are only forked when short-circuiting is
+// disabled (see RuntimeOptions::short_circuiting), so a guard such as
+// `has(x.y) && expensive(x.y)` never runs the expensive call needlessly.
+//
+// Only applies to recursively planned programs (see
+// RuntimeOptions::max_recursion_depth), and never inside comprehensions.
+//
+// Forked evaluations use a value manager of their own, allocating from the
+// memory manager of the one passed to Evaluate. Expensive functions and the
+// activation must be safe to use from multiple threads concurrently.
+absl::Status EnableParallelEvaluation(RuntimeBuilder& builder,
+                                      std::shared_ptr<Executor> executor);
+
+}  // namespace cel::extensions
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_PARALLEL_EVALUATION_H_
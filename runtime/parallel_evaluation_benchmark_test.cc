@@ -0,0 +1,164 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares sequential and parallel evaluation of independent calls to an
+// expensive function.
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/log/absl_check.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "base/function_descriptor.h"
+#include "common/kind.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/benchmark.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/executor.h"
+#include "runtime/function_adapter.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/parallel_evaluation.h"
+#include "runtime/runtime.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+
+namespace cel {
+namespace {
+
+using ::cel::extensions::EnableParallelEvaluation;
+using ::cel::extensions::ProtobufRuntimeAdapter;
+using ::google::api::expr::parser::Parse;
+
+constexpr char kExpression[] =
+    "slow(1) + slow(2) + slow(3) + slow(4) == 10 && slow(5) == 5";
+
+// Fixed size thread pool.
+class ThreadPoolExecutor : public Executor {
+ public:
+  explicit ThreadPoolExecutor(int num_threads) {
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this]() { Work(); });
+    }
+  }
+
+  ~ThreadPoolExecutor() override {
+    {
+      absl::MutexLock lock(&mutex_);
+      done_ = true;
+    }
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Schedule(absl::AnyInvocable<void() &&> task) override {
+    absl::MutexLock lock(&mutex_);
+    tasks_.push_back(std::move(task));
+  }
+
+ private:
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return done_ || !tasks_.empty();
+  }
+
+  void Work() {
+    while (true) {
+      absl::AnyInvocable<void() &&> task;
+      {
+        absl::MutexLock lock(&mutex_);
+        mutex_.Await(absl::Condition(this, &ThreadPoolExecutor::HasWork));
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      std::move(task)();
+    }
+  }
+
+  absl::Mutex mutex_;
+  std::deque<absl::AnyInvocable<void() &&>> tasks_ ABSL_GUARDED_BY(mutex_);
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+  std::vector<std::thread> threads_;
+};
+
+std::unique_ptr<Program> MakeProgram(std::shared_ptr<Executor> executor) {
+  RuntimeOptions options;
+  options.max_recursion_depth = -1;
+  auto builder = CreateStandardRuntimeBuilder(options);
+  ABSL_CHECK_OK(builder.status());
+
+  using AdapterT = UnaryFunctionAdapter<int64_t, int64_t>;
+  ABSL_CHECK_OK(builder->function_registry().Register(
+      FunctionDescriptor("slow", /*receiver_style=*/false, {Kind::kInt},
+                         /*is_strict=*/true, /*is_expensive=*/true),
+      AdapterT::WrapFunction([](ValueManager&, int64_t x) {
+        absl::SleepFor(absl::Milliseconds(1));
+        return x;
+      })));
+  if (executor != nullptr) {
+    ABSL_CHECK_OK(EnableParallelEvaluation(*builder, std::move(executor)));
+  }
+
+  auto runtime = std::move(builder).value().Build();
+  ABSL_CHECK_OK(runtime.status());
+
+  auto expr = Parse(kExpression);
+  ABSL_CHECK_OK(expr.status());
+
+  auto program = ProtobufRuntimeAdapter::CreateProgram(**runtime, *expr);
+  ABSL_CHECK_OK(program.status());
+  return *std::move(program);
+}
+
+void RunBenchmark(benchmark::State& state, std::unique_ptr<Program> program) {
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+
+  for (auto _ : state) {
+    auto result = program->Evaluate(activation, value_factory.get());
+    ABSL_CHECK_OK(result.status());
+    ABSL_CHECK((*result)->Is<BoolValue>() &&
+               (*result)->As<BoolValue>().NativeValue());
+  }
+}
+
+void BM_Sequential(benchmark::State& state) {
+  RunBenchmark(state, MakeProgram(nullptr));
+}
+
+void BM_Parallel(benchmark::State& state) {
+  RunBenchmark(state, MakeProgram(std::make_shared<ThreadPoolExecutor>(4)));
+}
+
+BENCHMARK(BM_Sequential)->UseRealTime();
+BENCHMARK(BM_Parallel)->UseRealTime();
+
+}  // namespace
+}  // namespace cel
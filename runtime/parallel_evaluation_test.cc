@@ -0,0 +1,255 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/parallel_evaluation.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "base/function_descriptor.h"
+#include "common/kind.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/status_macros.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/executor.h"
+#include "runtime/function_adapter.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/runtime_builder.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::cel::internal::StatusIs;
+using ::google::api::expr::parser::Parse;
+using ::google::api::expr::v1alpha1::ParsedExpr;
+using testing::HasSubstr;
+
+using ValueMatcher = testing::Matcher<Value>;
+
+// Runs every task on a new thread.
+class ThreadPerTaskExecutor : public Executor {
+ public:
+  ~ThreadPerTaskExecutor() override {
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Schedule(absl::AnyInvocable<void() &&> task) override {
+    absl::MutexLock lock(&mutex_);
+    threads_.emplace_back(
+        [task = std::move(task)]() mutable { std::move(task)(); });
+  }
+
+  int scheduled() {
+    absl::MutexLock lock(&mutex_);
+    return threads_.size();
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::thread> threads_ ABSL_GUARDED_BY(mutex_);
+};
+
+struct TestCase {
+  std::string name;
+  std::string expression;
+  ValueMatcher result_matcher;
+  int scheduled;
+  bool short_circuiting = true;
+};
+
+MATCHER_P(IsIntValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<IntValue>() &&
+         value->As<IntValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsBoolValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<BoolValue>() &&
+         value->As<BoolValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsErrorValue, expected_substr, "") {
+  const Value& value = arg;
+  return value->Is<ErrorValue>() &&
+         absl::StrContains(value->As<ErrorValue>().NativeValue().message(),
+                           expected_substr);
+}
+
+// Registers slow(int) -> int, an expensive identity function that fails for
+// negative inputs.
+absl::Status RegisterSlowFunction(RuntimeBuilder& builder) {
+  using AdapterT = UnaryFunctionAdapter<Value, int64_t>;
+  return builder.function_registry().Register(
+      FunctionDescriptor("slow", /*receiver_style=*/false, {Kind::kInt},
+                         /*is_strict=*/true, /*is_expensive=*/true),
+      AdapterT::WrapFunction([](ValueManager& factory, int64_t x) -> Value {
+        if (x < 0) {
+          return factory.CreateErrorValue(
+              absl::InvalidArgumentError(absl::StrCat("negative: ", x)));
+        }
+        return factory.CreateIntValue(x);
+      }));
+}
+
+class ParallelEvaluationTest : public testing::TestWithParam<TestCase> {};
+
+TEST_P(ParallelEvaluationTest, Runner) {
+  const TestCase& test_case = GetParam();
+  RuntimeOptions options;
+  options.max_recursion_depth = -1;
+  options.short_circuiting = test_case.short_circuiting;
+  ASSERT_OK_AND_ASSIGN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+  ASSERT_OK(RegisterSlowFunction(builder));
+
+  auto executor = std::make_shared<ThreadPerTaskExecutor>();
+  ASSERT_OK(EnableParallelEvaluation(builder, executor));
+
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse(test_case.expression));
+  ASSERT_OK_AND_ASSIGN(auto program, ProtobufRuntimeAdapter::CreateProgram(
+                                         *runtime, parsed_expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+
+  ASSERT_OK_AND_ASSIGN(Value value,
+                       program->Evaluate(activation, value_factory.get()));
+  EXPECT_THAT(value, test_case.result_matcher);
+  EXPECT_EQ(executor->scheduled(), test_case.scheduled);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Cases, ParallelEvaluationTest,
+    testing::ValuesIn(std::vector<TestCase>{
+        {"single_expensive_call", "slow(1) + 1", IsIntValue(2), 0},
+        {"call_args", "slow(1) + slow(2)", IsIntValue(3), 1},
+        {"nested_call_args", "slow(1) + slow(2) + slow(3)", IsIntValue(6), 2},
+        {"and", "slow(1) == 1 && slow(2) == 2", IsBoolValue(true), 0},
+        {"and_shortcircuit", "slow(1) == 0 && slow(2) == 2",
+         IsBoolValue(false), 0},
+        {"and_call_args", "slow(1) + slow(2) == 3 && slow(3) == 3",
+         IsBoolValue(true), 1},
+        {"or_shortcircuit", "slow(1) == 1 || slow(-2) == 2",
+         IsBoolValue(true), 0},
+        {"or_error", "slow(1) == 0 || slow(-2) == 2",
+         IsErrorValue("negative: -2"), 0},
+        {"and_no_shortcircuit", "slow(1) == 0 && slow(2) == 2",
+         IsBoolValue(false), 1, /*short_circuiting=*/false},
+        {"or_error_no_shortcircuit", "slow(1) == 0 || slow(-2) == 2",
+         IsErrorValue("negative: -2"), 1, /*short_circuiting=*/false},
+        {"first_error_wins", "slow(-1) + slow(-2)",
+         IsErrorValue("negative: -1"), 1},
+        {"comprehension", "[1, 2].map(x, slow(x) + slow(x))[1]",
+         IsIntValue(4), 0}}),
+    [](const testing::TestParamInfo<TestCase>& info) {
+      return info.param.name;
+    });
+
+TEST(ParallelEvaluationTest, ForkedCallsUseTheirOwnValueManager) {
+  RuntimeOptions options;
+  options.max_recursion_depth = -1;
+  ASSERT_OK_AND_ASSIGN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+
+  // Registers range(int) -> list(int), an expensive function that builds its
+  // result with the value manager it is called with.
+  absl::Mutex mutex;
+  std::vector<const ValueManager*> managers;
+  using AdapterT = UnaryFunctionAdapter<absl::StatusOr<Value>, int64_t>;
+  ASSERT_OK(builder.function_registry().Register(
+      FunctionDescriptor("range", /*receiver_style=*/false, {Kind::kInt},
+                         /*is_strict=*/true, /*is_expensive=*/true),
+      AdapterT::WrapFunction(
+          [&](ValueManager& factory, int64_t n) -> absl::StatusOr<Value> {
+            {
+              absl::MutexLock lock(&mutex);
+              managers.push_back(&factory);
+            }
+            CEL_ASSIGN_OR_RETURN(
+                auto list_builder,
+                factory.NewListValueBuilder(factory.GetDynListType()));
+            for (int64_t i = 0; i < n; ++i) {
+              CEL_RETURN_IF_ERROR(list_builder->Add(IntValue(i)));
+            }
+            return std::move(*list_builder).Build();
+          })));
+
+  auto executor = std::make_shared<ThreadPerTaskExecutor>();
+  ASSERT_OK(EnableParallelEvaluation(builder, executor));
+
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr,
+                       Parse("range(1).size() + range(2).size()"));
+  ASSERT_OK_AND_ASSIGN(auto program, ProtobufRuntimeAdapter::CreateProgram(
+                                         *runtime, parsed_expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+
+  ASSERT_OK_AND_ASSIGN(Value value,
+                       program->Evaluate(activation, value_factory.get()));
+  EXPECT_THAT(value, IsIntValue(3));
+  EXPECT_EQ(executor->scheduled(), 1);
+  absl::MutexLock lock(&mutex);
+  ASSERT_EQ(managers.size(), 2);
+  EXPECT_NE(managers[0], managers[1]);
+}
+
+TEST(ParallelEvaluationTest, RequiresRecursivePlanning) {
+  RuntimeOptions options;
+  ASSERT_OK_AND_ASSIGN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+
+  EXPECT_THAT(EnableParallelEvaluation(
+                  builder, std::make_shared<ThreadPerTaskExecutor>()),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("max_recursion_depth")));
+}
+
+TEST(ParallelEvaluationTest, RequiresExecutor) {
+  RuntimeOptions options;
+  options.max_recursion_depth = -1;
+  ASSERT_OK_AND_ASSIGN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+
+  EXPECT_THAT(EnableParallelEvaluation(builder, nullptr),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace cel::extensions
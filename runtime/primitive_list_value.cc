@@ -0,0 +1,194 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/primitive_list_value.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/base/nullability.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/optional.h"
+#include "absl/types/variant.h"
+#include "common/casting.h"
+#include "common/json.h"
+#include "common/memory.h"
+#include "common/native_type.h"
+#include "common/type.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "internal/casts.h"
+#include "internal/status_macros.h"
+
+namespace cel {
+namespace {
+
+IntValueView ToValueView(int64_t value) { return IntValueView(value); }
+UintValueView ToValueView(uint64_t value) { return UintValueView(value); }
+DoubleValueView ToValueView(double value) { return DoubleValueView(value); }
+
+// Appends the elements of `list` to `out` if they are all of the value type
+// `V`. Returns false otherwise.
+template <typename V, typename T>
+absl::StatusOr<bool> CollectElements(ValueManager& value_manager,
+                                     const ListValue& list,
+                                     std::vector<T>& out) {
+  out.reserve(list.Size());
+  bool homogeneous = true;
+  CEL_RETURN_IF_ERROR(list.ForEach(
+      value_manager,
+      [&out, &homogeneous](ValueView element) -> absl::StatusOr<bool> {
+        auto value = As<V>(element);
+        if (!value.has_value()) {
+          homogeneous = false;
+          return false;
+        }
+        out.push_back(value->NativeValue());
+        return true;
+      }));
+  return homogeneous;
+}
+
+template <typename V, typename T>
+absl::StatusOr<ListValue> ToPrimitiveList(ValueManager& value_manager,
+                                          const ListValue& list) {
+  std::vector<T> elements;
+  CEL_ASSIGN_OR_RETURN(bool homogeneous, CollectElements<V>(value_manager,
+                                                            list, elements));
+  if (!homogeneous) {
+    return list;
+  }
+  return NewPrimitiveListValue(value_manager.GetMemoryManager(),
+                               std::move(elements));
+}
+
+}  // namespace
+
+absl::Nullable<const PrimitiveListValue*> PrimitiveListValue::From(
+    const ListValue& list) {
+  if (NativeTypeId::Of(list) != NativeTypeId::For<PrimitiveListValue>()) {
+    return nullptr;
+  }
+  return &internal::down_cast<const PrimitiveListValue&>(
+      *Cast<ParsedListValue>(list));
+}
+
+std::string PrimitiveListValue::DebugString() const {
+  return absl::visit(
+      [](const auto& elements) {
+        std::string out = "[";
+        for (size_t i = 0; i < elements.size(); ++i) {
+          if (i > 0) {
+            out.append(", ");
+          }
+          out.append(ToValueView(elements[i]).DebugString());
+        }
+        out.push_back(']');
+        return out;
+      },
+      elements_);
+}
+
+size_t PrimitiveListValue::Size() const {
+  return absl::visit([](const auto& elements) { return elements.size(); },
+                     elements_);
+}
+
+absl::StatusOr<JsonArray> PrimitiveListValue::ConvertToJsonArray(
+    AnyToJsonConverter& converter) const {
+  return absl::visit(
+      [&converter](const auto& elements) -> absl::StatusOr<JsonArray> {
+        JsonArrayBuilder builder;
+        builder.reserve(elements.size());
+        for (const auto element : elements) {
+          CEL_ASSIGN_OR_RETURN(Json json,
+                               ToValueView(element).ConvertToJson(converter));
+          builder.push_back(std::move(json));
+        }
+        return std::move(builder).Build();
+      },
+      elements_);
+}
+
+absl::StatusOr<ValueView> PrimitiveListValue::Contains(
+    ValueManager& value_manager, ValueView other, Value& scratch) const {
+  // Elements of the same kind compare equal exactly when their native values
+  // do. Anything else follows the generic (heterogeneous) equality.
+  absl::optional<bool> contains = absl::visit(
+      [other](const auto& elements) -> absl::optional<bool> {
+        using ViewType = decltype(ToValueView(elements.front()));
+        auto value = As<ViewType>(other);
+        if (!value.has_value()) {
+          return absl::nullopt;
+        }
+        return absl::c_linear_search(elements, value->NativeValue());
+      },
+      elements_);
+  if (!contains.has_value()) {
+    return ParsedListValueInterface::Contains(value_manager, other, scratch);
+  }
+  return BoolValueView{*contains};
+}
+
+Type PrimitiveListValue::GetTypeImpl(TypeManager& type_manager) const {
+  switch (elements_.index()) {
+    case 0:
+      return type_manager.CreateListType(IntTypeView());
+    case 1:
+      return type_manager.CreateListType(UintTypeView());
+    default:
+      return type_manager.CreateListType(DoubleTypeView());
+  }
+}
+
+absl::StatusOr<ValueView> PrimitiveListValue::GetImpl(ValueManager&,
+                                                      size_t index,
+                                                      Value&) const {
+  return absl::visit(
+      [index](const auto& elements) -> ValueView {
+        return ToValueView(elements[index]);
+      },
+      elements_);
+}
+
+ListValue NewPrimitiveListValue(MemoryManagerRef memory_manager,
+                                PrimitiveListValue::Elements elements) {
+  return ParsedListValue(
+      memory_manager.MakeShared<PrimitiveListValue>(std::move(elements)));
+}
+
+absl::StatusOr<ListValue> ToPrimitiveListValue(ValueManager& value_manager,
+                                               const ListValue& list) {
+  if (list.IsEmpty() || PrimitiveListValue::From(list) != nullptr) {
+    return list;
+  }
+  CEL_ASSIGN_OR_RETURN(Value first, list.Get(value_manager, 0));
+  switch (first->kind()) {
+    case ValueKind::kInt:
+      return ToPrimitiveList<IntValueView, int64_t>(value_manager, list);
+    case ValueKind::kUint:
+      return ToPrimitiveList<UintValueView, uint64_t>(value_manager, list);
+    case ValueKind::kDouble:
+      return ToPrimitiveList<DoubleValueView, double>(value_manager, list);
+    default:
+      return list;
+  }
+}
+
+}  // namespace cel
@@ -0,0 +1,93 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_PRIMITIVE_LIST_VALUE_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_PRIMITIVE_LIST_VALUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/nullability.h"
+#include "absl/status/statusor.h"
+#include "absl/types/variant.h"
+#include "common/json.h"
+#include "common/memory.h"
+#include "common/native_type.h"
+#include "common/type.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+
+namespace cel {
+
+// A list of ints, uints or doubles stored in one contiguous buffer.
+//
+// Elements are only boxed into `cel::Value` when accessed through the
+// `ListValue` interface. Evaluator extensions such as vectorized
+// comprehensions (see runtime/vectorized_comprehensions.h) operate on the
+// buffer directly.
+class PrimitiveListValue final : public ParsedListValueInterface {
+ public:
+  using Elements = absl::variant<std::vector<int64_t>, std::vector<uint64_t>,
+                                 std::vector<double>>;
+
+  // Returns the primitive list backing `list`, or nullptr if `list` is any
+  // other kind of list.
+  static absl::Nullable<const PrimitiveListValue*> From(const ListValue& list);
+
+  explicit PrimitiveListValue(Elements elements)
+      : elements_(std::move(elements)) {}
+
+  const Elements& elements() const { return elements_; }
+
+  std::string DebugString() const override;
+
+  size_t Size() const override;
+
+  absl::StatusOr<JsonArray> ConvertToJsonArray(
+      AnyToJsonConverter& converter) const override;
+
+  absl::StatusOr<ValueView> Contains(
+      ValueManager& value_manager, ValueView other,
+      Value& scratch ABSL_ATTRIBUTE_LIFETIME_BOUND) const override;
+
+ protected:
+  Type GetTypeImpl(TypeManager& type_manager) const override;
+
+ private:
+  absl::StatusOr<ValueView> GetImpl(ValueManager& value_manager, size_t index,
+                                    Value& scratch) const override;
+
+  NativeTypeId GetNativeTypeId() const noexcept override {
+    return NativeTypeId::For<PrimitiveListValue>();
+  }
+
+  const Elements elements_;
+};
+
+// Returns a primitive list holding `elements`.
+ListValue NewPrimitiveListValue(MemoryManagerRef memory_manager,
+                                PrimitiveListValue::Elements elements);
+
+// Returns a primitive list with the elements of `list` if they are all ints,
+// all uints or all doubles. Otherwise, including for empty lists, returns
+// `list` unchanged.
+absl::StatusOr<ListValue> ToPrimitiveListValue(ValueManager& value_manager,
+                                               const ListValue& list);
+
+}  // namespace cel
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_PRIMITIVE_LIST_VALUE_H_
@@ -0,0 +1,151 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/primitive_list_value.h"
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "base/type_provider.h"
+#include "common/json.h"
+#include "common/memory.h"
+#include "common/type.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "common/values/legacy_value_manager.h"
+#include "internal/status_macros.h"
+#include "internal/testing.h"
+
+namespace cel {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsNull;
+using testing::NotNull;
+
+class PrimitiveListValueTest : public testing::Test {
+ public:
+  PrimitiveListValueTest()
+      : value_factory_(MemoryManagerRef::ReferenceCounting(),
+                       TypeProvider::Builtin()) {}
+
+  absl::StatusOr<ListValue> MakeList(std::vector<Value> elements) {
+    CEL_ASSIGN_OR_RETURN(auto builder, value_factory_.NewListValueBuilder(
+                                           value_factory_.GetDynListType()));
+    for (Value& element : elements) {
+      CEL_RETURN_IF_ERROR(builder->Add(std::move(element)));
+    }
+    return std::move(*builder).Build();
+  }
+
+  bool Contains(const ListValue& list, const Value& value) {
+    auto result = list.Contains(value_factory_, value);
+    return result.ok() && (*result)->Is<BoolValue>() &&
+           (*result)->As<BoolValue>().NativeValue();
+  }
+
+ protected:
+  common_internal::LegacyValueManager value_factory_;
+};
+
+TEST_F(PrimitiveListValueTest, Elements) {
+  ListValue list = NewPrimitiveListValue(value_factory_.GetMemoryManager(),
+                                         std::vector<int64_t>{1, -2, 3});
+  EXPECT_FALSE(list.IsEmpty());
+  EXPECT_EQ(list.Size(), 3);
+  EXPECT_EQ(list.DebugString(), "[1, -2, 3]");
+  ASSERT_OK_AND_ASSIGN(Value element, list.Get(value_factory_, 1));
+  ASSERT_TRUE(element->Is<IntValue>());
+  EXPECT_EQ(element->As<IntValue>().NativeValue(), -2);
+
+  std::vector<int64_t> elements;
+  ASSERT_OK(list.ForEach(
+      value_factory_, [&elements](ValueView element) -> absl::StatusOr<bool> {
+        elements.push_back(Cast<IntValueView>(element).NativeValue());
+        return true;
+      }));
+  EXPECT_THAT(elements, ElementsAre(1, -2, 3));
+
+  ASSERT_OK_AND_ASSIGN(ListValue same, MakeList({IntValue(1), IntValue(-2),
+                                                 IntValue(3)}));
+  ASSERT_OK_AND_ASSIGN(Value equal, list.Equal(value_factory_, same));
+  EXPECT_TRUE(equal->Is<BoolValue>() && equal->As<BoolValue>().NativeValue());
+}
+
+TEST_F(PrimitiveListValueTest, Types) {
+  EXPECT_EQ(NewPrimitiveListValue(value_factory_.GetMemoryManager(),
+                                  std::vector<int64_t>{})
+                .GetType(value_factory_)
+                .element(),
+            IntType());
+  EXPECT_EQ(NewPrimitiveListValue(value_factory_.GetMemoryManager(),
+                                  std::vector<uint64_t>{1})
+                .GetType(value_factory_)
+                .element(),
+            UintType());
+  EXPECT_EQ(NewPrimitiveListValue(value_factory_.GetMemoryManager(),
+                                  std::vector<double>{1.5})
+                .GetType(value_factory_)
+                .element(),
+            DoubleType());
+}
+
+TEST_F(PrimitiveListValueTest, ConvertToJson) {
+  ListValue list = NewPrimitiveListValue(value_factory_.GetMemoryManager(),
+                                         std::vector<double>{1.5, -2});
+  ASSERT_OK_AND_ASSIGN(JsonArray json, list.ConvertToJsonArray(value_factory_));
+  EXPECT_EQ(json, MakeJsonArray({JsonNumber(1.5), JsonNumber(-2)}));
+}
+
+TEST_F(PrimitiveListValueTest, Membership) {
+  ListValue list = NewPrimitiveListValue(
+      value_factory_.GetMemoryManager(),
+      std::vector<double>{-1.0, 2.5,
+                          std::numeric_limits<double>::quiet_NaN()});
+
+  EXPECT_TRUE(Contains(list, DoubleValue(2.5)));
+  EXPECT_FALSE(Contains(list, DoubleValue(2.0)));
+  EXPECT_FALSE(
+      Contains(list, DoubleValue(std::numeric_limits<double>::quiet_NaN())));
+  // Other kinds follow heterogeneous equality.
+  EXPECT_TRUE(Contains(list, IntValue(-1)));
+  EXPECT_FALSE(Contains(list, UintValue(2)));
+  EXPECT_FALSE(Contains(list, BoolValue(true)));
+}
+
+TEST_F(PrimitiveListValueTest, ToPrimitiveListValue) {
+  ASSERT_OK_AND_ASSIGN(ListValue ints,
+                       MakeList({UintValue(1), UintValue(2)}));
+  ASSERT_OK_AND_ASSIGN(ListValue list,
+                       ToPrimitiveListValue(value_factory_, ints));
+  const PrimitiveListValue* primitive_list = PrimitiveListValue::From(list);
+  ASSERT_THAT(primitive_list, NotNull());
+  EXPECT_EQ(primitive_list->elements(),
+            PrimitiveListValue::Elements(std::vector<uint64_t>{1, 2}));
+  EXPECT_THAT(PrimitiveListValue::From(ints), IsNull());
+
+  ASSERT_OK_AND_ASSIGN(ListValue mixed, MakeList({IntValue(1), UintValue(2)}));
+  ASSERT_OK_AND_ASSIGN(list, ToPrimitiveListValue(value_factory_, mixed));
+  EXPECT_THAT(PrimitiveListValue::From(list), IsNull());
+
+  ASSERT_OK_AND_ASSIGN(ListValue empty, MakeList({}));
+  ASSERT_OK_AND_ASSIGN(list, ToPrimitiveListValue(value_factory_, empty));
+  EXPECT_THAT(PrimitiveListValue::From(list), IsNull());
+}
+
+}  // namespace
+}  // namespace cel
@@ -0,0 +1,32 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/regex_cache.h"
+
+#include "runtime/internal/regex_cache.h"
+
+namespace cel {
+
+RegexCacheStats GetRegexCacheStats() {
+  const auto& cache = runtime_internal::RegexCache::Global();
+  RegexCacheStats stats;
+  stats.hits = cache.hits();
+  stats.misses = cache.misses();
+  stats.evictions = cache.evictions();
+  stats.size = cache.size();
+  stats.capacity = cache.capacity();
+  return stats;
+}
+
+}  // namespace cel
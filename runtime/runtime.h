@@ -19,13 +19,16 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "base/ast.h"
+#include "base/function.h"
 #include "base/type_provider.h"
 #include "common/native_type.h"
 #include "common/value.h"
@@ -39,6 +42,52 @@ namespace runtime_internal {
 class RuntimeFriendAccess;
 }  // namespace runtime_internal
 
+// Reusable working memory for evaluating a Program.
+//
+// Holds the interpreter scaffolding (value stack, comprehension slots) so that
+// repeated evaluations can reuse it instead of allocating it on every call.
+//
+// Instances are created by Program::CreateEvaluationState and may only be used
+// with the Program that created them. Not thread-safe: a server would
+// typically keep one instance per worker thread.
+class EvaluationState {
+ public:
+  virtual ~EvaluationState() = default;
+
+ private:
+  friend class runtime_internal::RuntimeFriendAccess;
+
+  virtual NativeTypeId GetNativeTypeId() const = 0;
+};
+
+// An evaluation that can be suspended while a function result is pending.
+//
+// Created by Program::EvaluateAsync. While suspended, the evaluation holds no
+// thread: the caller waits for pending() to become ready (e.g. with
+// ValueFuture::OnReady) and then calls Resume, possibly from another thread.
+// Not thread-safe.
+class AsyncEvaluation {
+ public:
+  virtual ~AsyncEvaluation() = default;
+
+  // Whether the evaluation finished, either with a result or with a
+  // non-recoverable error.
+  virtual bool done() const = 0;
+
+  // The function result the evaluation is waiting for. Requires !done().
+  virtual ValueFuture& pending() const = 0;
+
+  // Continue the evaluation with the pending function result, until it
+  // finishes or is suspended again. Requires pending().IsReady().
+  //
+  // Non-recoverable errors are returned as for Program::Evaluate.
+  virtual absl::Status Resume() = 0;
+
+  // The result of the evaluation. Requires done() and that evaluation
+  // finished without a non-recoverable error.
+  virtual const Value& result() const = 0;
+};
+
 // Representation of an evaluable CEL expression.
 //
 // See Runtime below for creating new programs.
@@ -75,6 +124,79 @@ class Program {
   virtual absl::StatusOr<Value> Evaluate(const ActivationInterface& activation,
                                          ValueManager& value_factory) const = 0;
 
+  // Evaluate the program using caller-owned evaluation state.
+  //
+  // The state must have been created by this program's CreateEvaluationState.
+  // The value factory may differ between calls. Results are the same as for
+  // Evaluate(activation, value_factory).
+  virtual absl::StatusOr<Value> Evaluate(const ActivationInterface& activation,
+                                         ValueManager& value_factory,
+                                         EvaluationState& state) const {
+    return Evaluate(activation, value_factory);
+  }
+
+  // Create reusable evaluation state for this program.
+  //
+  // Returns an Unimplemented error if the implementation does not support
+  // caller-owned state.
+  virtual absl::StatusOr<std::unique_ptr<EvaluationState>>
+  CreateEvaluationState() const {
+    return absl::UnimplementedError(
+        "Program does not support reusable evaluation state");
+  }
+
+  // Start an evaluation that is suspended, rather than blocking the calling
+  // thread, when a function awaits a pending result (see
+  // Function::InvokeContext::Await).
+  //
+  // Evaluation runs until it finishes or suspends. The program, activation and
+  // value factory must outlive the returned evaluation.
+  //
+  // Returns an Unimplemented error if the implementation does not support
+  // suspending evaluations.
+  virtual absl::StatusOr<std::unique_ptr<AsyncEvaluation>> EvaluateAsync(
+      const ActivationInterface& activation,
+      ValueManager& value_factory) const {
+    return absl::UnimplementedError(
+        "Program does not support asynchronous evaluation");
+  }
+
+  // Evaluate the program once for each of the given activations.
+  //
+  // Results are returned in the same order as the activations. Semantics match
+  // calling Evaluate in a loop, except that implementations may reuse
+  // evaluator state (value stack, comprehension slots) across the batch. The
+  // runtime's programs take that state from the pool configured by
+  // RuntimeOptions::evaluation_state_pool_size, if any.
+  //
+  // A non-recoverable error for any activation stops evaluation of the batch
+  // and is returned as the overall status.
+  virtual absl::StatusOr<std::vector<Value>> EvaluateBatch(
+      absl::Span<const ActivationInterface* const> activations,
+      ValueManager& value_factory) const {
+    std::vector<Value> results;
+    results.reserve(activations.size());
+    for (const ActivationInterface* activation : activations) {
+      absl::StatusOr<Value> result = Evaluate(*activation, value_factory);
+      if (!result.ok()) {
+        return std::move(result).status();
+      }
+      results.push_back(*std::move(result));
+    }
+    return results;
+  }
+
+  // Free variables referenced by the program, ordered by the index assigned to
+  // each at plan time.
+  //
+  // An activation that binds variables by these indices (e.g.
+  // cel::IndexedActivation) is read with an array access instead of a lookup
+  // by name. Other activations are queried by name. Empty if the
+  // implementation does not assign indices.
+  virtual absl::Span<const std::string> GetDeclaredVariables() const {
+    return {};
+  }
+
   virtual const TypeProvider& GetTypeProvider() const = 0;
 };
 
@@ -94,6 +94,12 @@ struct RuntimeOptions {
   // upper bound.
   int regex_max_program_size = 0;
 
+  // Number of compiled regular expressions to keep for regex functions called
+  // with patterns that are not constant at plan time. The cache is shared by
+  // all runtimes in the process and sized to the largest requested capacity.
+  // Use value 0 to compile the pattern on every call.
+  int regex_cache_size = 0;
+
   // Enable string() overloads.
   bool enable_string_conversion = true;
 
@@ -134,6 +140,46 @@ struct RuntimeOptions {
   // This is now always enabled. Setting this option has no effect. It will be
   // removed in a later update.
   bool enable_lazy_bind_initialization = true;
+
+  // Enable the direct dispatch evaluation loop.
+  //
+  // When enabled, core program steps (constants, variables, field selections,
+  // jumps, logical operators, ternaries and comprehension loop conditions) are
+  // lowered into a compact instruction array that the evaluator executes
+  // inline. Other steps, including function calls, and any case the inline
+  // handlers don't cover (e.g. errors, unknowns and presence tests) are
+  // evaluated through the ExpressionStep interface.
+  bool enable_direct_dispatch = false;
+
+  // Maximum depth of recursively planned subexpressions.
+  //
+  // When non-zero, the planner evaluates supported subexpressions (identifiers,
+  // field selection, function calls, logical operators and ternaries) as a
+  // tree of directly evaluated steps that return their results instead of
+  // passing them through the value stack. Subexpressions deeper than the limit
+  // (and unsupported nodes such as comprehensions) fall back to the flat stack
+  // machine plan.
+  //
+  // 0 disables recursive planning, a negative value means no limit.
+  //
+  // Note: the evaluation trace only reports values for the roots of
+  // recursively planned subexpressions.
+  int max_recursion_depth = 0;
+
+  // Number of idle evaluator states each Program keeps for reuse.
+  //
+  // When positive, Program::Evaluate takes its interpreter scaffolding (value
+  // stack, comprehension slots) from a lock-free per-program pool instead of
+  // allocating it on every call. 0 disables pooling.
+  int evaluation_state_pool_size = 0;
+
+  // Build map literals as compact map values.
+  //
+  // Entries are stored in flat arrays allocated from the evaluation's memory
+  // manager (the arena when pooling) with cached key hashes, instead of a
+  // node based hash map per map. Maps passed to legacy CelValue APIs are
+  // converted to a CelMap on access.
+  bool enable_compact_map_values = false;
 };
 // LINT.ThenChange(//depot/google3/eval/public/cel_options.h)
 
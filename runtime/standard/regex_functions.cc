@@ -13,6 +13,8 @@
 // limitations under the License.
 #include "runtime/standard/regex_functions.h"
 
+#include <string>
+
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "base/builtins.h"
@@ -21,28 +23,41 @@
 #include "common/value_manager.h"
 #include "internal/status_macros.h"
 #include "re2/re2.h"
+#include "runtime/internal/regex_cache.h"
 
 namespace cel {
-namespace {}  // namespace
+namespace {
+
+using ::cel::runtime_internal::RegexCache;
+using ::cel::runtime_internal::RegexProgram;
+
+}  // namespace
 
 absl::Status RegisterRegexFunctions(FunctionRegistry& registry,
                                     const RuntimeOptions& options) {
   if (options.enable_regex) {
-    auto regex_matches = [max_size = options.regex_max_program_size](
+    RegexCache* cache = nullptr;
+    if (options.regex_cache_size > 0) {
+      cache = &RegexCache::Global();
+      cache->Reserve(options.regex_cache_size);
+    }
+    auto regex_matches = [max_size = options.regex_max_program_size, cache](
                              ValueManager& value_factory,
                              const StringValue& target,
                              const StringValue& regex) -> Value {
-      RE2 re2(regex.ToString());
-      if (max_size > 0 && re2.ProgramSize() > max_size) {
+      std::string pattern_scratch;
+      RegexProgram re2(cache, regex.NativeString(pattern_scratch));
+      if (max_size > 0 && re2->ProgramSize() > max_size) {
         return value_factory.CreateErrorValue(
             absl::InvalidArgumentError("exceeded RE2 max program size"));
       }
-      if (!re2.ok()) {
+      if (!re2->ok()) {
         return value_factory.CreateErrorValue(
             absl::InvalidArgumentError("invalid regex for match"));
       }
+      std::string target_scratch;
       return value_factory.CreateBoolValue(
-          RE2::PartialMatch(target.ToString(), re2));
+          RE2::PartialMatch(target.NativeString(target_scratch), *re2));
     };
 
     // bind str.matches(re) and matches(str, re)
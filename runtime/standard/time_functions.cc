@@ -14,158 +14,94 @@
 
 #include "runtime/standard/time_functions.h"
 
-#include <functional>
 #include <string>
+#include <utility>
 
 #include "absl/status/status.h"
-#include "absl/strings/match.h"
-#include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "base/builtins.h"
 #include "base/function_adapter.h"
 #include "common/value.h"
 #include "common/value_manager.h"
 #include "internal/overflow.h"
 #include "internal/status_macros.h"
+#include "runtime/internal/time_zone_cache.h"
+#include "runtime/internal/timestamp_accessors.h"
 
 namespace cel {
 namespace {
 
 // Timestamp
-absl::Status FindTimeBreakdown(absl::Time timestamp, absl::string_view tz,
-                               absl::TimeZone::CivilInfo* breakdown) {
-  absl::TimeZone time_zone;
-
-  // Early return if there is no timezone.
-  if (tz.empty()) {
-    *breakdown = time_zone.At(timestamp);
-    return absl::OkStatus();
+Value GetTimeBreakdownPart(ValueManager& value_factory, absl::Time timestamp,
+                           absl::string_view tz,
+                           runtime_internal::TimestampAccessor accessor) {
+  auto time_zone = runtime_internal::ResolveTimeZone(tz);
+  if (!time_zone.ok()) {
+    return value_factory.CreateErrorValue(std::move(time_zone).status());
   }
 
-  // Check to see whether the timezone is an IANA timezone.
-  if (absl::LoadTimeZone(tz, &time_zone)) {
-    *breakdown = time_zone.At(timestamp);
-    return absl::OkStatus();
-  }
-
-  // Check for times of the format: [+-]HH:MM and convert them into durations
-  // specified as [+-]HHhMMm.
-  if (absl::StrContains(tz, ":")) {
-    std::string dur = absl::StrCat(tz, "m");
-    absl::StrReplaceAll({{":", "h"}}, &dur);
-    absl::Duration d;
-    if (absl::ParseDuration(dur, &d)) {
-      timestamp += d;
-      *breakdown = time_zone.At(timestamp);
-      return absl::OkStatus();
-    }
-  }
-
-  // Otherwise, error.
-  return absl::InvalidArgumentError("Invalid timezone");
-}
-
-Value GetTimeBreakdownPart(
-    ValueManager& value_factory, absl::Time timestamp, absl::string_view tz,
-    const std::function<int64_t(const absl::TimeZone::CivilInfo&)>&
-        extractor_func) {
-  absl::TimeZone::CivilInfo breakdown;
-  auto status = FindTimeBreakdown(timestamp, tz, &breakdown);
-
-  if (!status.ok()) {
-    return value_factory.CreateErrorValue(status);
-  }
-
-  return value_factory.CreateIntValue(extractor_func(breakdown));
+  return value_factory.CreateIntValue(accessor(time_zone->At(timestamp)));
 }
 
 Value GetFullYear(ValueManager& value_factory, absl::Time timestamp,
                   absl::string_view tz) {
   return GetTimeBreakdownPart(value_factory, timestamp, tz,
-                              [](const absl::TimeZone::CivilInfo& breakdown) {
-                                return breakdown.cs.year();
-                              });
+                              &runtime_internal::TimestampFullYear);
 }
 
 Value GetMonth(ValueManager& value_factory, absl::Time timestamp,
                absl::string_view tz) {
   return GetTimeBreakdownPart(value_factory, timestamp, tz,
-                              [](const absl::TimeZone::CivilInfo& breakdown) {
-                                return breakdown.cs.month() - 1;
-                              });
+                              &runtime_internal::TimestampMonth);
 }
 
 Value GetDayOfYear(ValueManager& value_factory, absl::Time timestamp,
                    absl::string_view tz) {
-  return GetTimeBreakdownPart(
-      value_factory, timestamp, tz,
-      [](const absl::TimeZone::CivilInfo& breakdown) {
-        return absl::GetYearDay(absl::CivilDay(breakdown.cs)) - 1;
-      });
+  return GetTimeBreakdownPart(value_factory, timestamp, tz,
+                              &runtime_internal::TimestampDayOfYear);
 }
 
 Value GetDayOfMonth(ValueManager& value_factory, absl::Time timestamp,
                     absl::string_view tz) {
   return GetTimeBreakdownPart(value_factory, timestamp, tz,
-                              [](const absl::TimeZone::CivilInfo& breakdown) {
-                                return breakdown.cs.day() - 1;
-                              });
+                              &runtime_internal::TimestampDayOfMonth);
 }
 
 Value GetDate(ValueManager& value_factory, absl::Time timestamp,
               absl::string_view tz) {
   return GetTimeBreakdownPart(value_factory, timestamp, tz,
-                              [](const absl::TimeZone::CivilInfo& breakdown) {
-                                return breakdown.cs.day();
-                              });
+                              &runtime_internal::TimestampDate);
 }
 
 Value GetDayOfWeek(ValueManager& value_factory, absl::Time timestamp,
                    absl::string_view tz) {
-  return GetTimeBreakdownPart(
-      value_factory, timestamp, tz,
-      [](const absl::TimeZone::CivilInfo& breakdown) {
-        absl::Weekday weekday = absl::GetWeekday(breakdown.cs);
-
-        // get day of week from the date in UTC, zero-based, zero for Sunday,
-        // based on GetDayOfWeek CEL function definition.
-        int weekday_num = static_cast<int>(weekday);
-        weekday_num = (weekday_num == 6) ? 0 : weekday_num + 1;
-        return weekday_num;
-      });
+  return GetTimeBreakdownPart(value_factory, timestamp, tz,
+                              &runtime_internal::TimestampDayOfWeek);
 }
 
 Value GetHours(ValueManager& value_factory, absl::Time timestamp,
                absl::string_view tz) {
   return GetTimeBreakdownPart(value_factory, timestamp, tz,
-                              [](const absl::TimeZone::CivilInfo& breakdown) {
-                                return breakdown.cs.hour();
-                              });
+                              &runtime_internal::TimestampHours);
 }
 
 Value GetMinutes(ValueManager& value_factory, absl::Time timestamp,
                  absl::string_view tz) {
   return GetTimeBreakdownPart(value_factory, timestamp, tz,
-                              [](const absl::TimeZone::CivilInfo& breakdown) {
-                                return breakdown.cs.minute();
-                              });
+                              &runtime_internal::TimestampMinutes);
 }
 
 Value GetSeconds(ValueManager& value_factory, absl::Time timestamp,
                  absl::string_view tz) {
   return GetTimeBreakdownPart(value_factory, timestamp, tz,
-                              [](const absl::TimeZone::CivilInfo& breakdown) {
-                                return breakdown.cs.second();
-                              });
+                              &runtime_internal::TimestampSeconds);
 }
 
 Value GetMilliseconds(ValueManager& value_factory, absl::Time timestamp,
                       absl::string_view tz) {
-  return GetTimeBreakdownPart(
-      value_factory, timestamp, tz,
-      [](const absl::TimeZone::CivilInfo& breakdown) {
-        return absl::ToInt64Milliseconds(breakdown.subsecond);
-      });
+  return GetTimeBreakdownPart(value_factory, timestamp, tz,
+                              &runtime_internal::TimestampMilliseconds);
 }
 
 absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
@@ -176,7 +112,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetFullYear(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetFullYear(value_factory, ts, tz.NativeString(scratch));
           })));
 
   CEL_RETURN_IF_ERROR(registry.Register(
@@ -193,7 +130,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetMonth(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetMonth(value_factory, ts, tz.NativeString(scratch));
           })));
 
   CEL_RETURN_IF_ERROR(registry.Register(
@@ -210,7 +148,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetDayOfYear(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetDayOfYear(value_factory, ts, tz.NativeString(scratch));
           })));
 
   CEL_RETURN_IF_ERROR(registry.Register(
@@ -227,7 +166,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetDayOfMonth(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetDayOfMonth(value_factory, ts, tz.NativeString(scratch));
           })));
 
   CEL_RETURN_IF_ERROR(registry.Register(
@@ -244,7 +184,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetDate(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetDate(value_factory, ts, tz.NativeString(scratch));
           })));
 
   CEL_RETURN_IF_ERROR(registry.Register(
@@ -261,7 +202,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetDayOfWeek(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetDayOfWeek(value_factory, ts, tz.NativeString(scratch));
           })));
 
   CEL_RETURN_IF_ERROR(registry.Register(
@@ -278,7 +220,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetHours(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetHours(value_factory, ts, tz.NativeString(scratch));
           })));
 
   CEL_RETURN_IF_ERROR(registry.Register(
@@ -295,7 +238,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetMinutes(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetMinutes(value_factory, ts, tz.NativeString(scratch));
           })));
 
   CEL_RETURN_IF_ERROR(registry.Register(
@@ -312,7 +256,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetSeconds(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetSeconds(value_factory, ts, tz.NativeString(scratch));
           })));
 
   CEL_RETURN_IF_ERROR(registry.Register(
@@ -329,7 +274,8 @@ absl::Status RegisterTimestampFunctions(FunctionRegistry& registry,
       BinaryFunctionAdapter<Value, absl::Time, const StringValue&>::
           WrapFunction([](ValueManager& value_factory, absl::Time ts,
                           const StringValue& tz) -> Value {
-            return GetMilliseconds(value_factory, ts, tz.ToString());
+            std::string scratch;
+            return GetMilliseconds(value_factory, ts, tz.NativeString(scratch));
           })));
 
   return registry.Register(
@@ -14,6 +14,7 @@
 
 #include "runtime/standard_runtime_builder_factory.h"
 
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -24,7 +25,14 @@
 #include "google/api/expr/v1alpha1/syntax.pb.h"
 #include "absl/algorithm/container.h"
 #include "absl/base/no_destructor.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "base/function.h"
+#include "base/function_descriptor.h"
+#include "common/kind.h"
 #include "common/memory.h"
 #include "common/type_factory.h"
 #include "common/type_manager.h"
@@ -34,10 +42,12 @@
 #include "extensions/bindings_ext.h"
 #include "extensions/protobuf/memory_manager.h"
 #include "extensions/protobuf/runtime_adapter.h"
+#include "internal/status_macros.h"
 #include "internal/testing.h"
 #include "parser/macro.h"
 #include "parser/parser.h"
 #include "runtime/activation.h"
+#include "runtime/indexed_activation.h"
 #include "runtime/managed_value_factory.h"
 #include "runtime/runtime.h"
 #include "runtime/runtime_issue.h"
@@ -49,9 +59,11 @@ namespace {
 
 using ::cel::extensions::ProtobufRuntimeAdapter;
 using ::cel::extensions::ProtoMemoryManagerRef;
+using ::cel::internal::StatusIs;
 using ::google::api::expr::v1alpha1::ParsedExpr;
 using ::google::api::expr::parser::ParseWithMacros;
 using testing::ElementsAre;
+using testing::SizeIs;
 using testing::Truly;
 
 struct EvaluateResultTestCase {
@@ -137,6 +149,112 @@ TEST_P(StandardRuntimeTest, DefaultsArena) {
       << test_case.expression;
 }
 
+TEST_P(StandardRuntimeTest, DirectDispatch) {
+  RuntimeOptions opts;
+  opts.enable_direct_dispatch = true;
+  const EvaluateResultTestCase& test_case = GetParam();
+  google::protobuf::Arena arena;
+  auto memory_manager = ProtoMemoryManagerRef(&arena);
+
+  ASSERT_OK_AND_ASSIGN(auto builder, CreateStandardRuntimeBuilder(opts));
+
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr expr,
+                       ParseWithMacros(test_case.expression, GetMacros()));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+
+  common_internal::LegacyValueManager value_factory(memory_manager,
+                                                    runtime->GetTypeProvider());
+
+  Activation activation;
+  if (test_case.activation_builder != nullptr) {
+    ASSERT_OK(test_case.activation_builder(value_factory, activation));
+  }
+
+  ASSERT_OK_AND_ASSIGN(Value result,
+                       program->Evaluate(activation, value_factory));
+
+  ASSERT_TRUE(result->Is<BoolValue>()) << result->DebugString();
+  EXPECT_EQ(result->As<BoolValue>().NativeValue(), test_case.expected_result)
+      << test_case.expression;
+}
+
+TEST_P(StandardRuntimeTest, EvaluationStatePool) {
+  RuntimeOptions opts;
+  opts.evaluation_state_pool_size = 1;
+  const EvaluateResultTestCase& test_case = GetParam();
+  google::protobuf::Arena arena;
+  auto memory_manager = ProtoMemoryManagerRef(&arena);
+
+  ASSERT_OK_AND_ASSIGN(auto builder, CreateStandardRuntimeBuilder(opts));
+
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr expr,
+                       ParseWithMacros(test_case.expression, GetMacros()));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+
+  common_internal::LegacyValueManager value_factory(memory_manager,
+                                                    runtime->GetTypeProvider());
+
+  Activation activation;
+  if (test_case.activation_builder != nullptr) {
+    ASSERT_OK(test_case.activation_builder(value_factory, activation));
+  }
+
+  // Evaluate repeatedly so later runs use the pooled state.
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_OK_AND_ASSIGN(Value result,
+                         program->Evaluate(activation, value_factory));
+
+    ASSERT_TRUE(result->Is<BoolValue>()) << result->DebugString();
+    EXPECT_EQ(result->As<BoolValue>().NativeValue(), test_case.expected_result)
+        << test_case.expression;
+  }
+}
+
+TEST_P(StandardRuntimeTest, Recursive) {
+  const EvaluateResultTestCase& test_case = GetParam();
+  // Unlimited, and a limit that forces deeper subtrees onto the flat plan.
+  for (int max_recursion_depth : {-1, 2}) {
+    SCOPED_TRACE(max_recursion_depth);
+    RuntimeOptions opts;
+    opts.max_recursion_depth = max_recursion_depth;
+    google::protobuf::Arena arena;
+    auto memory_manager = ProtoMemoryManagerRef(&arena);
+
+    ASSERT_OK_AND_ASSIGN(auto builder, CreateStandardRuntimeBuilder(opts));
+
+    ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+    ASSERT_OK_AND_ASSIGN(ParsedExpr expr,
+                         ParseWithMacros(test_case.expression, GetMacros()));
+
+    ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> program,
+                         ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+
+    common_internal::LegacyValueManager value_factory(
+        memory_manager, runtime->GetTypeProvider());
+
+    Activation activation;
+    if (test_case.activation_builder != nullptr) {
+      ASSERT_OK(test_case.activation_builder(value_factory, activation));
+    }
+
+    ASSERT_OK_AND_ASSIGN(Value result,
+                         program->Evaluate(activation, value_factory));
+
+    ASSERT_TRUE(result->Is<BoolValue>()) << result->DebugString();
+    EXPECT_EQ(result->As<BoolValue>().NativeValue(), test_case.expected_result)
+        << test_case.expression;
+  }
+}
+
 std::string TestCaseName(
     const testing::TestParamInfo<EvaluateResultTestCase>& info) {
   return info.param.name;
@@ -449,6 +567,77 @@ INSTANTIATE_TEST_SUITE_P(
         {"list_in_numeric", "3u in [1.1, 2.3, 3.0, 4.4]", true}}),
     TestCaseName);
 
+struct RecursivePlanTestCase {
+  std::string name;
+  std::string expression;
+  int max_recursion_depth;
+  // Number of trace callbacks. Tracing reports each node planned on the flat
+  // plan, but only the root of a recursively planned subtree.
+  int traced_nodes;
+};
+
+class RecursivePlanTest
+    : public ::testing::TestWithParam<RecursivePlanTestCase> {};
+
+TEST_P(RecursivePlanTest, PlanShape) {
+  const RecursivePlanTestCase& test_case = GetParam();
+  RuntimeOptions opts;
+  opts.max_recursion_depth = test_case.max_recursion_depth;
+  google::protobuf::Arena arena;
+  auto memory_manager = ProtoMemoryManagerRef(&arena);
+
+  ASSERT_OK_AND_ASSIGN(auto builder, CreateStandardRuntimeBuilder(opts));
+
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr expr,
+                       ParseWithMacros(test_case.expression, GetMacros()));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<TraceableProgram> program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+
+  common_internal::LegacyValueManager value_factory(memory_manager,
+                                                    runtime->GetTypeProvider());
+
+  Activation activation;
+  activation.InsertOrAssignValue("x", value_factory.CreateIntValue(1));
+  activation.InsertOrAssignValue("s", value_factory.CreateUncheckedStringValue(
+                                          "xyz"));
+
+  int traced_nodes = 0;
+  ASSERT_OK_AND_ASSIGN(
+      Value result,
+      program->Trace(
+          activation,
+          [&traced_nodes](int64_t, const Value&, ValueManager&) {
+            ++traced_nodes;
+            return absl::OkStatus();
+          },
+          value_factory));
+
+  ASSERT_TRUE(result->Is<BoolValue>()) << result->DebugString();
+  EXPECT_TRUE(result->As<BoolValue>().NativeValue()) << test_case.expression;
+  EXPECT_EQ(traced_nodes, test_case.traced_nodes) << test_case.expression;
+}
+
+// `x + 1 == 2` is 3 levels deep and `s.startsWith('x')` is 2 levels deep.
+// Subtrees within the limit are planned recursively; constants under a flat
+// parent stay flat.
+INSTANTIATE_TEST_SUITE_P(
+    RecursivePlanTest, RecursivePlanTest,
+    testing::ValuesIn(std::vector<RecursivePlanTestCase>{
+        {"disabled", "x + 1 == 2", 0, 5},
+        {"unlimited", "x + 1 == 2", -1, 1},
+        {"at_limit", "x + 1 == 2", 3, 1},
+        {"one_over_limit", "x + 1 == 2", 2, 3},
+        {"leaves_only", "x + 1 == 2", 1, 5},
+        {"receiver_call_at_limit", "s.startsWith('x')", 2, 1},
+        {"receiver_call_one_over_limit", "s.startsWith('x')", 1, 3},
+    }),
+    [](const testing::TestParamInfo<RecursivePlanTestCase>& info) {
+      return info.param.name;
+    });
+
 TEST(StandardRuntimeTest, RuntimeIssueSupport) {
   RuntimeOptions options;
   options.fail_on_warnings = false;
@@ -540,5 +729,319 @@ TEST(StandardRuntimeTest, RuntimeIssueSupport) {
   }
 }
 
+TEST(StandardRuntimeTest, EvaluateBatch) {
+  RuntimeOptions options;
+
+  google::protobuf::Arena arena;
+  auto memory_manager = ProtoMemoryManagerRef(&arena);
+
+  ASSERT_OK_AND_ASSIGN(auto builder, CreateStandardRuntimeBuilder(options));
+
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(
+      ParsedExpr expr,
+      ParseWithMacros("x * 2 + [1, 2].filter(y, y > x).size()", GetMacros()));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    memory_manager);
+
+  std::vector<Activation> activations(3);
+  std::vector<const ActivationInterface*> activation_ptrs;
+  for (int i = 0; i < activations.size(); ++i) {
+    activations[i].InsertOrAssignValue("x",
+                                       value_factory.get().CreateIntValue(i));
+    activation_ptrs.push_back(&activations[i]);
+  }
+
+  ASSERT_OK_AND_ASSIGN(
+      std::vector<Value> results,
+      program->EvaluateBatch(activation_ptrs, value_factory.get()));
+
+  ASSERT_THAT(results, SizeIs(3));
+  for (int i = 0; i < results.size(); ++i) {
+    ASSERT_TRUE(results[i]->Is<IntValue>()) << results[i]->DebugString();
+    EXPECT_EQ(results[i]->As<IntValue>().NativeValue(), i * 2 + (2 - i));
+  }
+}
+
+TEST(StandardRuntimeTest, EvaluateBatchPooledState) {
+  RuntimeOptions options;
+  options.evaluation_state_pool_size = 1;
+
+  google::protobuf::Arena arena;
+  auto memory_manager = ProtoMemoryManagerRef(&arena);
+
+  ASSERT_OK_AND_ASSIGN(auto builder, CreateStandardRuntimeBuilder(options));
+
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(
+      ParsedExpr expr,
+      ParseWithMacros("[1, 2, 3].exists(y, y == 4 / x)", GetMacros()));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    memory_manager);
+
+  // Division by zero is an error value, not a failure of the batch.
+  std::vector<Activation> activations(5);
+  std::vector<const ActivationInterface*> activation_ptrs;
+  for (int i = 0; i < activations.size(); ++i) {
+    activations[i].InsertOrAssignValue("x",
+                                       value_factory.get().CreateIntValue(i));
+    activation_ptrs.push_back(&activations[i]);
+  }
+
+  // Evaluate repeatedly so later batches use the pooled state.
+  for (int run = 0; run < 3; ++run) {
+    ASSERT_OK_AND_ASSIGN(
+        std::vector<Value> results,
+        program->EvaluateBatch(activation_ptrs, value_factory.get()));
+
+    ASSERT_THAT(results, SizeIs(5));
+    EXPECT_TRUE(results[0]->Is<ErrorValue>()) << results[0]->DebugString();
+    for (int i = 1; i < results.size(); ++i) {
+      ASSERT_TRUE(results[i]->Is<BoolValue>()) << results[i]->DebugString();
+      EXPECT_EQ(results[i]->As<BoolValue>().NativeValue(), i >= 2) << i;
+    }
+  }
+}
+
+TEST(StandardRuntimeTest, CallerOwnedEvaluationState) {
+  RuntimeOptions options;
+
+  ASSERT_OK_AND_ASSIGN(auto builder, CreateStandardRuntimeBuilder(options));
+
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(
+      ParsedExpr expr,
+      ParseWithMacros("[1, 2, 3].exists(y, y == x)", GetMacros()));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EvaluationState> state,
+                       program->CreateEvaluationState());
+
+  // Each evaluation uses a fresh arena, as a server would per request.
+  for (int i = 0; i < 5; ++i) {
+    google::protobuf::Arena arena;
+    ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                      ProtoMemoryManagerRef(&arena));
+    Activation activation;
+    activation.InsertOrAssignValue("x", value_factory.get().CreateIntValue(i));
+
+    ASSERT_OK_AND_ASSIGN(Value result, program->Evaluate(
+                                           activation, value_factory.get(),
+                                           *state));
+    ASSERT_TRUE(result->Is<BoolValue>()) << result->DebugString();
+    EXPECT_EQ(result->As<BoolValue>().NativeValue(), i >= 1 && i <= 3);
+  }
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> other_program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+  EXPECT_THAT(
+      other_program->Evaluate(activation, value_factory.get(), *state),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(StandardRuntimeTest, DeclaredVariables) {
+  RuntimeOptions options;
+
+  google::protobuf::Arena arena;
+  auto memory_manager = ProtoMemoryManagerRef(&arena);
+
+  ASSERT_OK_AND_ASSIGN(auto builder, CreateStandardRuntimeBuilder(options));
+
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(
+      ParsedExpr expr,
+      ParseWithMacros("a + [1, 2].map(x, x * b)[1] + a", GetMacros()));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+
+  // Comprehension variables are not free variables.
+  EXPECT_THAT(program->GetDeclaredVariables(), ElementsAre("a", "b"));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    memory_manager);
+
+  IndexedActivation activation(program->GetDeclaredVariables());
+  activation.SetValue(0, value_factory.get().CreateIntValue(1));
+  activation.SetValue(1, value_factory.get().CreateIntValue(10));
+
+  ASSERT_OK_AND_ASSIGN(Value result,
+                       program->Evaluate(activation, value_factory.get()));
+  ASSERT_TRUE(result->Is<IntValue>()) << result->DebugString();
+  EXPECT_EQ(result->As<IntValue>().NativeValue(), 22);
+
+  // Name-based activations are still supported.
+  Activation name_activation;
+  name_activation.InsertOrAssignValue("a",
+                                      value_factory.get().CreateIntValue(2));
+  name_activation.InsertOrAssignValue("b",
+                                      value_factory.get().CreateIntValue(1));
+
+  ASSERT_OK_AND_ASSIGN(
+      result, program->Evaluate(name_activation, value_factory.get()));
+  ASSERT_TRUE(result->Is<IntValue>()) << result->DebugString();
+  EXPECT_EQ(result->As<IntValue>().NativeValue(), 6);
+}
+
+// In-process stand-in for an asynchronous lookup, completed by the test.
+class FakeValueFuture : public ValueFuture {
+ public:
+  explicit FakeValueFuture(int64_t key) : key_(key) {}
+
+  bool IsReady() const override { return result_.has_value(); }
+
+  void OnReady(absl::AnyInvocable<void() &&> callback) override {
+    if (IsReady()) {
+      std::move(callback)();
+      return;
+    }
+    callbacks_.push_back(std::move(callback));
+  }
+
+  absl::StatusOr<Value> Get() override { return *result_; }
+
+  // Completes the lookup with key * 10.
+  void Complete() {
+    result_ = IntValue(key_ * 10);
+    for (auto& callback : callbacks_) {
+      std::move(callback)();
+    }
+    callbacks_.clear();
+  }
+
+ private:
+  int64_t key_;
+  absl::optional<Value> result_;
+  std::vector<absl::AnyInvocable<void() &&>> callbacks_;
+};
+
+using FakeLookups = std::vector<std::shared_ptr<FakeValueFuture>>;
+
+// lookup(int) -> int, answered asynchronously through FakeValueFutures.
+class FakeLookupFunction : public Function {
+ public:
+  FakeLookupFunction(std::shared_ptr<FakeLookups> lookups,
+                     bool complete_immediately)
+      : lookups_(std::move(lookups)),
+        complete_immediately_(complete_immediately) {}
+
+  absl::StatusOr<Value> Invoke(const InvokeContext& context,
+                               absl::Span<const Value> args) const override {
+    auto future = std::make_shared<FakeValueFuture>(
+        args[0].As<IntValue>().NativeValue());
+    lookups_->push_back(future);
+    if (complete_immediately_) {
+      future->Complete();
+    }
+    return context.Await(std::move(future));
+  }
+
+ private:
+  std::shared_ptr<FakeLookups> lookups_;
+  bool complete_immediately_;
+};
+
+absl::StatusOr<std::unique_ptr<const Runtime>> CreateRuntimeWithLookup(
+    const RuntimeOptions& options, std::shared_ptr<FakeLookups> lookups,
+    bool complete_immediately) {
+  CEL_ASSIGN_OR_RETURN(auto builder, CreateStandardRuntimeBuilder(options));
+  CEL_RETURN_IF_ERROR(builder.function_registry().Register(
+      FunctionDescriptor("lookup", /*receiver_style=*/false, {Kind::kInt}),
+      std::make_unique<FakeLookupFunction>(std::move(lookups),
+                                           complete_immediately)));
+  return std::move(builder).Build();
+}
+
+TEST(StandardRuntimeTest, EvaluateAsync) {
+  RuntimeOptions options;
+  auto lookups = std::make_shared<FakeLookups>();
+  ASSERT_OK_AND_ASSIGN(
+      auto runtime,
+      CreateRuntimeWithLookup(options, lookups,
+                              /*complete_immediately=*/false));
+
+  ASSERT_OK_AND_ASSIGN(
+      ParsedExpr expr,
+      ParseWithMacros("lookup(1) + [2, 3].map(x, lookup(x))[1] == 40",
+                      GetMacros()));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<AsyncEvaluation> evaluation,
+                       program->EvaluateAsync(activation, value_factory.get()));
+
+  // Each lookup suspends the evaluation until the test completes it.
+  int suspensions = 0;
+  while (!evaluation->done()) {
+    ++suspensions;
+    ASSERT_THAT(*lookups, SizeIs(suspensions));
+    EXPECT_FALSE(evaluation->pending().IsReady());
+    EXPECT_THAT(evaluation->Resume(),
+                StatusIs(absl::StatusCode::kFailedPrecondition));
+
+    bool resumable = false;
+    evaluation->pending().OnReady([&resumable]() { resumable = true; });
+    lookups->back()->Complete();
+    EXPECT_TRUE(resumable);
+    ASSERT_OK(evaluation->Resume());
+  }
+
+  EXPECT_EQ(suspensions, 3);
+  const Value& result = evaluation->result();
+  ASSERT_TRUE(result->Is<BoolValue>()) << result->DebugString();
+  EXPECT_TRUE(result->As<BoolValue>().NativeValue());
+}
+
+TEST(StandardRuntimeTest, AwaitWithoutSuspension) {
+  RuntimeOptions options;
+  auto lookups = std::make_shared<FakeLookups>();
+  ASSERT_OK_AND_ASSIGN(
+      auto runtime,
+      CreateRuntimeWithLookup(options, lookups,
+                              /*complete_immediately=*/true));
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr expr,
+                       ParseWithMacros("lookup(1) + lookup(2)", GetMacros()));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Program> program,
+                       ProtobufRuntimeAdapter::CreateProgram(*runtime, expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+
+  // Ready results don't suspend.
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<AsyncEvaluation> evaluation,
+                       program->EvaluateAsync(activation, value_factory.get()));
+  ASSERT_TRUE(evaluation->done());
+  ASSERT_TRUE(evaluation->result()->Is<IntValue>());
+  EXPECT_EQ(evaluation->result()->As<IntValue>().NativeValue(), 30);
+
+  // Synchronous evaluation waits for the result.
+  ASSERT_OK_AND_ASSIGN(Value result,
+                       program->Evaluate(activation, value_factory.get()));
+  ASSERT_TRUE(result->Is<IntValue>()) << result->DebugString();
+  EXPECT_EQ(result->As<IntValue>().NativeValue(), 30);
+}
+
 }  // namespace
 }  // namespace cel
@@ -0,0 +1,132 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for the timestamp accessors with a time zone argument, over a
+// list of events as in policies iterating over event logs.
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/log/absl_check.h"
+#include "absl/time/time.h"
+#include "common/value.h"
+#include "extensions/protobuf/memory_manager.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/benchmark.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/runtime.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+#include "runtime/time_zone_precompilation.h"
+#include "google/protobuf/arena.h"
+
+namespace cel {
+namespace {
+
+using ::cel::extensions::EnableTimeZonePrecompilation;
+using ::cel::extensions::ProtobufRuntimeAdapter;
+using ::cel::extensions::ProtoMemoryManagerRef;
+using ::google::api::expr::parser::Parse;
+
+std::unique_ptr<Program> MakeProgram(const char* expression,
+                                     bool precompile_time_zones) {
+  RuntimeOptions options;
+  options.comprehension_max_iterations = 0;
+  auto builder = CreateStandardRuntimeBuilder(options);
+  ABSL_CHECK_OK(builder.status());
+  if (precompile_time_zones) {
+    ABSL_CHECK_OK(EnableTimeZonePrecompilation(*builder));
+  }
+  auto runtime = std::move(builder).value().Build();
+  ABSL_CHECK_OK(runtime.status());
+
+  auto expr = Parse(expression);
+  ABSL_CHECK_OK(expr.status());
+
+  auto program = ProtobufRuntimeAdapter::CreateProgram(**runtime, *expr);
+  ABSL_CHECK_OK(program.status());
+  return *std::move(program);
+}
+
+void RunBenchmark(benchmark::State& state, const char* expression,
+                  bool precompile_time_zones) {
+  google::protobuf::Arena arena;
+  std::unique_ptr<Program> program =
+      MakeProgram(expression, precompile_time_zones);
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    ProtoMemoryManagerRef(&arena));
+
+  auto builder = value_factory.get().NewListValueBuilder(
+      value_factory.get().GetDynListType());
+  ABSL_CHECK_OK(builder.status());
+  const int size = state.range(0);
+  for (int i = 0; i < size; ++i) {
+    ABSL_CHECK_OK((*builder)->Add(TimestampValue(
+        absl::FromUnixSeconds(1700000000 + 3607 * static_cast<int64_t>(i)))));
+  }
+  Activation activation;
+  activation.InsertOrAssignValue("events", std::move(**builder).Build());
+  activation.InsertOrAssignValue(
+      "tz", value_factory.get().CreateUncheckedStringValue("America/New_York"));
+
+  for (auto _ : state) {
+    auto result = program->Evaluate(activation, value_factory.get());
+    ABSL_CHECK_OK(result.status());
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+constexpr char kConstantTimeZone[] =
+    "events.filter(e, e.getHours('America/New_York') >= 9 && "
+    "e.getHours('America/New_York') < 17).size()";
+constexpr char kOffsetTimeZone[] =
+    "events.filter(e, e.getHours('+05:30') >= 9 && "
+    "e.getHours('+05:30') < 17).size()";
+constexpr char kVariableTimeZone[] =
+    "events.filter(e, e.getHours(tz) >= 9 && e.getHours(tz) < 17).size()";
+
+void BM_ConstantTimeZone(benchmark::State& state) {
+  RunBenchmark(state, kConstantTimeZone, /*precompile_time_zones=*/false);
+}
+
+void BM_ConstantTimeZonePrecompiled(benchmark::State& state) {
+  RunBenchmark(state, kConstantTimeZone, /*precompile_time_zones=*/true);
+}
+
+void BM_OffsetTimeZone(benchmark::State& state) {
+  RunBenchmark(state, kOffsetTimeZone, /*precompile_time_zones=*/false);
+}
+
+void BM_OffsetTimeZonePrecompiled(benchmark::State& state) {
+  RunBenchmark(state, kOffsetTimeZone, /*precompile_time_zones=*/true);
+}
+
+void BM_VariableTimeZone(benchmark::State& state) {
+  RunBenchmark(state, kVariableTimeZone, /*precompile_time_zones=*/false);
+}
+
+BENCHMARK(BM_ConstantTimeZone)->Range(1, 1024);
+BENCHMARK(BM_ConstantTimeZonePrecompiled)->Range(1, 1024);
+BENCHMARK(BM_OffsetTimeZone)->Range(1, 1024);
+BENCHMARK(BM_OffsetTimeZonePrecompiled)->Range(1, 1024);
+BENCHMARK(BM_VariableTimeZone)->Range(1, 1024);
+
+}  // namespace
+}  // namespace cel
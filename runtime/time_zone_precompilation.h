@@ -0,0 +1,36 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_TIME_ZONE_PRECOMPILATION_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_TIME_ZONE_PRECOMPILATION_H_
+
+#include "absl/status/status.h"
+#include "runtime/runtime_builder.h"
+
+namespace cel::extensions {
+
+// Enable plan-time resolution of constant time zone arguments in the runtime
+// being built.
+//
+// Calls to the standard timestamp accessors with a constant time zone, e.g.
+// `ts.getHours('America/New_York')` or `ts.getDate('+05:30')`, are planned as
+// dedicated steps holding the resolved time zone instead of resolving it on
+// each call. Invalid time zones are still reported at evaluation.
+//
+// Only applies to the flat plan (RuntimeOptions::max_recursion_depth == 0).
+absl::Status EnableTimeZonePrecompilation(RuntimeBuilder& builder);
+
+}  // namespace cel::extensions
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_TIME_ZONE_PRECOMPILATION_H_
@@ -0,0 +1,149 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/time_zone_precompilation.h"
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/civil_time.h"
+#include "absl/time/time.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/constant_folding.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/runtime_builder.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::google::api::expr::parser::Parse;
+using ::google::api::expr::v1alpha1::ParsedExpr;
+
+using ValueMatcher = testing::Matcher<Value>;
+
+MATCHER_P(IsIntValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<IntValue>() &&
+         value->As<IntValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsErrorValue, expected_substr, "") {
+  const Value& value = arg;
+  return value->Is<ErrorValue>() &&
+         absl::StrContains(value->As<ErrorValue>().NativeValue().message(),
+                           expected_substr);
+}
+
+struct TestCase {
+  std::string name;
+  // Expression over the variable 'x'.
+  std::string expression;
+  Value x;
+  ValueMatcher result_matcher;
+};
+
+class TimeZonePrecompilationTest
+    : public testing::TestWithParam<std::tuple<TestCase, bool>> {
+ public:
+  const TestCase& test_case() const { return std::get<0>(GetParam()); }
+  bool enable_constant_folding() const { return std::get<1>(GetParam()); }
+};
+
+TEST_P(TimeZonePrecompilationTest, Basic) {
+  RuntimeOptions options;
+  ASSERT_OK_AND_ASSIGN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+  if (enable_constant_folding()) {
+    ASSERT_OK(
+        EnableConstantFolding(builder, MemoryManagerRef::ReferenceCounting()));
+  }
+  ASSERT_OK(EnableTimeZonePrecompilation(builder));
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse(test_case().expression));
+  ASSERT_OK_AND_ASSIGN(auto program, ProtobufRuntimeAdapter::CreateProgram(
+                                         *runtime, parsed_expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+  activation.InsertOrAssignValue("x", test_case().x);
+
+  ASSERT_OK_AND_ASSIGN(Value value,
+                       program->Evaluate(activation, value_factory.get()));
+  EXPECT_THAT(value, test_case().result_matcher);
+}
+
+// 2024-01-15T14:45:30.250Z, a Monday.
+const absl::Time kTimestamp =
+    absl::FromCivil(absl::CivilSecond(2024, 1, 15, 14, 45, 30),
+                    absl::UTCTimeZone()) +
+    absl::Milliseconds(250);
+
+INSTANTIATE_TEST_SUITE_P(
+    Cases, TimeZonePrecompilationTest,
+    testing::Combine(
+        testing::ValuesIn(std::vector<TestCase>{
+            {"iana", "x.getHours('America/New_York')",
+             TimestampValue(kTimestamp), IsIntValue(9)},
+            {"iana_folded", "x.getHours('America/' + 'New_York')",
+             TimestampValue(kTimestamp), IsIntValue(9)},
+            {"positive_offset", "x.getHours('+05:30')",
+             TimestampValue(kTimestamp), IsIntValue(20)},
+            {"positive_offset_minutes", "x.getMinutes('+05:30')",
+             TimestampValue(kTimestamp), IsIntValue(15)},
+            {"negative_offset", "x.getDayOfWeek('-15:00')",
+             TimestampValue(kTimestamp), IsIntValue(0)},
+            {"utc", "x.getFullYear('UTC')", TimestampValue(kTimestamp),
+             IsIntValue(2024)},
+            {"milliseconds", "x.getMilliseconds('Asia/Kolkata')",
+             TimestampValue(kTimestamp), IsIntValue(250)},
+            {"day_of_year", "x.getDayOfYear('Pacific/Kiritimati')",
+             TimestampValue(kTimestamp), IsIntValue(15)},
+            {"invalid_time_zone", "x.getHours('Not/A_Zone')",
+             TimestampValue(kTimestamp), IsErrorValue("Invalid timezone")},
+            {"non_timestamp_fallback", "x.getHours('UTC')",
+             DurationValue(absl::Hours(2)),
+             IsErrorValue("No matching overloads")},
+            {"non_constant_time_zone",
+             "x.getHours(x.getHours() > 12 ? 'Asia/Tokyo' : 'UTC')",
+             TimestampValue(kTimestamp), IsIntValue(23)},
+            // With constant folding, the literal call is planned as a single
+            // constant and must not be rewritten.
+            {"constant_call",
+             "x.getHours('UTC') * 100 + "
+             "timestamp('2024-01-15T14:45:30Z').getHours('America/New_York')",
+             TimestampValue(kTimestamp), IsIntValue(1409)},
+        }),
+        testing::Bool()),
+    [](const testing::TestParamInfo<std::tuple<TestCase, bool>>& info) {
+      return absl::StrCat(std::get<0>(info.param).name,
+                          std::get<1>(info.param) ? "_folded" : "");
+    });
+
+}  // namespace
+}  // namespace cel::extensions
@@ -0,0 +1,39 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_TYPED_OPERATORS_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_TYPED_OPERATORS_H_
+
+#include "absl/status/status.h"
+#include "runtime/runtime_builder.h"
+
+namespace cel::extensions {
+
+// Enable specialized arithmetic and comparison steps in the runtime being
+// built.
+//
+// For checked expressions, calls to the standard arithmetic ('+', '-', '*',
+// '/', '%') and ordering ('<', '<=', '>', '>=') operators whose overload is
+// resolved to int, uint or double operands are planned as dedicated steps
+// that compute the result inline instead of searching the function registry.
+// Semantics, including overflow errors, are unchanged.
+//
+// Operators with user provided or lazily bound overloads are left to the
+// generic function step. Only applies to the flat plan
+// (RuntimeOptions::max_recursion_depth == 0).
+absl::Status EnableTypedOperators(RuntimeBuilder& builder);
+
+}  // namespace cel::extensions
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_TYPED_OPERATORS_H_
@@ -0,0 +1,248 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runtime/typed_operators.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/api/expr/v1alpha1/checked.pb.h"
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/strings/match.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "common/value_manager.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/constant_folding.h"
+#include "runtime/function_adapter.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/runtime_builder.h"
+#include "runtime/runtime_builder_factory.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::google::api::expr::parser::Parse;
+using ::google::api::expr::v1alpha1::CheckedExpr;
+using ::google::api::expr::v1alpha1::ParsedExpr;
+
+using ValueMatcher = testing::Matcher<Value>;
+
+struct TestCase {
+  std::string name;
+  // Binary operator expression over the variables 'x' and 'y'.
+  std::string expression;
+  std::string overload_id;
+  Value x;
+  Value y;
+  ValueMatcher result_matcher;
+};
+
+MATCHER_P(IsIntValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<IntValue>() &&
+         value->As<IntValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsUintValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<UintValue>() &&
+         value->As<UintValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsDoubleValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<DoubleValue>() &&
+         value->As<DoubleValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsBoolValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<BoolValue>() &&
+         value->As<BoolValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsErrorValue, expected_substr, "") {
+  const Value& value = arg;
+  return value->Is<ErrorValue>() &&
+         absl::StrContains(value->As<ErrorValue>().NativeValue().message(),
+                           expected_substr);
+}
+
+class TypedOperatorsTest : public testing::TestWithParam<TestCase> {};
+
+TEST_P(TypedOperatorsTest, Basic) {
+  const TestCase& test_case = GetParam();
+  RuntimeOptions options;
+  ASSERT_OK_AND_ASSIGN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+  ASSERT_OK(EnableTypedOperators(builder));
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse(test_case.expression));
+
+  // Fake reference information for the operator call (x is 1, call is 2,
+  // y is 3).
+  CheckedExpr checked_expr;
+  checked_expr.mutable_expr()->Swap(parsed_expr.mutable_expr());
+  checked_expr.mutable_source_info()->Swap(parsed_expr.mutable_source_info());
+  (*checked_expr.mutable_reference_map())[2].add_overload_id(
+      test_case.overload_id);
+
+  ASSERT_OK_AND_ASSIGN(
+      auto program,
+      ProtobufRuntimeAdapter::CreateProgram(*runtime, checked_expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+  activation.InsertOrAssignValue("x", test_case.x);
+  activation.InsertOrAssignValue("y", test_case.y);
+
+  ASSERT_OK_AND_ASSIGN(Value value,
+                       program->Evaluate(activation, value_factory.get()));
+  EXPECT_THAT(value, test_case.result_matcher);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Cases, TypedOperatorsTest,
+    testing::ValuesIn(std::vector<TestCase>{
+        {"add_int", "x + y", "add_int64", IntValue(1), IntValue(2),
+         IsIntValue(3)},
+        {"add_int_overflow", "x + y", "add_int64",
+         IntValue(std::numeric_limits<int64_t>::max()), IntValue(1),
+         IsErrorValue("overflow")},
+        {"subtract_uint", "x - y", "subtract_uint64", UintValue(5),
+         UintValue(3), IsUintValue(2)},
+        {"subtract_uint_overflow", "x - y", "subtract_uint64", UintValue(1),
+         UintValue(2), IsErrorValue("overflow")},
+        {"multiply_double", "x * y", "multiply_double", DoubleValue(1.5),
+         DoubleValue(2.0), IsDoubleValue(3.0)},
+        {"divide_int", "x / y", "divide_int64", IntValue(7), IntValue(2),
+         IsIntValue(3)},
+        {"divide_int_by_zero", "x / y", "divide_int64", IntValue(7),
+         IntValue(0), IsErrorValue("divide by zero")},
+        {"divide_double_by_zero", "x / y", "divide_double", DoubleValue(1.0),
+         DoubleValue(0.0),
+         IsDoubleValue(std::numeric_limits<double>::infinity())},
+        {"modulo_uint", "x % y", "modulo_uint64", UintValue(7), UintValue(3),
+         IsUintValue(1)},
+        {"modulo_int_by_zero", "x % y", "modulo_int64", IntValue(7),
+         IntValue(0), IsErrorValue("modulus by zero")},
+        {"less_int", "x < y", "less_int64", IntValue(1), IntValue(2),
+         IsBoolValue(true)},
+        {"less_equals_uint", "x <= y", "less_equals_uint64", UintValue(3),
+         UintValue(2), IsBoolValue(false)},
+        {"greater_double", "x > y", "greater_double", DoubleValue(2.5),
+         DoubleValue(2.0), IsBoolValue(true)},
+        {"greater_equals_int", "x >= y", "greater_equals_int64", IntValue(2),
+         IntValue(2), IsBoolValue(true)},
+        // The reference doesn't match the runtime operands (e.g. dyn typed
+        // variables), so the generic function step is used.
+        {"mismatched_operands_fallback", "x + y", "add_int64",
+         DoubleValue(1.5), DoubleValue(2.0), IsDoubleValue(3.5)},
+        {"heterogeneous_fallback", "x < y", "less_int64", IntValue(1),
+         UintValue(2), IsBoolValue(true)},
+    }),
+    [](const testing::TestParamInfo<TestCase>& info) {
+      return info.param.name;
+    });
+
+TEST(TypedOperatorsTest, ConstantFoldedOperands) {
+  RuntimeOptions options;
+  ASSERT_OK_AND_ASSIGN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+  ASSERT_OK(EnableConstantFolding(builder,
+                                  MemoryManagerRef::ReferenceCounting()));
+  ASSERT_OK(EnableTypedOperators(builder));
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse("[x, y, 3 + 4]"));
+  CheckedExpr checked_expr;
+  checked_expr.mutable_expr()->Swap(parsed_expr.mutable_expr());
+  checked_expr.mutable_source_info()->Swap(parsed_expr.mutable_source_info());
+  // The folded call is planned as a single constant with the call's id.
+  (*checked_expr.mutable_reference_map())[checked_expr.expr()
+                                              .list_expr()
+                                              .elements(2)
+                                              .id()]
+      .add_overload_id("add_int64");
+
+  ASSERT_OK_AND_ASSIGN(
+      auto program,
+      ProtobufRuntimeAdapter::CreateProgram(*runtime, checked_expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+  activation.InsertOrAssignValue("x", IntValue(1));
+  activation.InsertOrAssignValue("y", IntValue(2));
+
+  ASSERT_OK_AND_ASSIGN(Value value,
+                       program->Evaluate(activation, value_factory.get()));
+  ASSERT_TRUE(value->Is<ListValue>());
+  ListValue list = value->As<ListValue>();
+  ASSERT_EQ(list.Size(), 3u);
+  ASSERT_OK_AND_ASSIGN(Value first, list.Get(value_factory.get(), 0));
+  ASSERT_OK_AND_ASSIGN(Value second, list.Get(value_factory.get(), 1));
+  ASSERT_OK_AND_ASSIGN(Value third, list.Get(value_factory.get(), 2));
+  EXPECT_THAT(first, IsIntValue(1));
+  EXPECT_THAT(second, IsIntValue(2));
+  EXPECT_THAT(third, IsIntValue(7));
+}
+
+TEST(TypedOperatorsTest, UserOverloadsAreNotBypassed) {
+  RuntimeOptions options;
+  // Only the user overload of '+' is registered, no builtins.
+  cel::RuntimeBuilder builder = CreateRuntimeBuilder(options);
+  ASSERT_OK((BinaryFunctionAdapter<int64_t, int64_t, int64_t>::
+                 RegisterGlobalOverload(
+                     "_+_",
+                     [](ValueManager&, int64_t x, int64_t y) -> int64_t {
+                       return x * 10 + y;
+                     },
+                     builder.function_registry())));
+  ASSERT_OK(EnableTypedOperators(builder));
+  ASSERT_OK_AND_ASSIGN(auto runtime, std::move(builder).Build());
+
+  ASSERT_OK_AND_ASSIGN(ParsedExpr parsed_expr, Parse("x + y"));
+  CheckedExpr checked_expr;
+  checked_expr.mutable_expr()->Swap(parsed_expr.mutable_expr());
+  checked_expr.mutable_source_info()->Swap(parsed_expr.mutable_source_info());
+  (*checked_expr.mutable_reference_map())[2].add_overload_id("add_int64");
+
+  ASSERT_OK_AND_ASSIGN(
+      auto program,
+      ProtobufRuntimeAdapter::CreateProgram(*runtime, checked_expr));
+
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  Activation activation;
+  activation.InsertOrAssignValue("x", IntValue(1));
+  activation.InsertOrAssignValue("y", IntValue(2));
+
+  ASSERT_OK_AND_ASSIGN(Value value,
+                       program->Evaluate(activation, value_factory.get()));
+  EXPECT_THAT(value, IsIntValue(12));
+}
+
+}  // namespace
+}  // namespace cel::extensions
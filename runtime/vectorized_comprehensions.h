@@ -0,0 +1,43 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_CEL_CPP_RUNTIME_VECTORIZED_COMPREHENSIONS_H_
+#define THIRD_PARTY_CEL_CPP_RUNTIME_VECTORIZED_COMPREHENSIONS_H_
+
+#include "absl/status/status.h"
+#include "runtime/runtime_builder.h"
+
+namespace cel::extensions {
+
+// Enable data parallel evaluation of simple numeric comprehensions over
+// primitive lists (see runtime/primitive_list_value.h) in the runtime being
+// built.
+//
+// Applies to the standard macros with a lambda comparing the element with a
+// constant or a variable, or for `map` combining them arithmetically, e.g.
+// `xs.all(x, x > 0)`, `xs.filter(x, x < limit).size()` or `xs.map(x, x * 2)`.
+// When the range is a primitive list of the operand's kind, the comprehension
+// is computed over the list's buffer without boxing elements. Otherwise, and
+// for results that would be errors, the regular plan is evaluated.
+//
+// Assumes the standard definitions of the comparison and arithmetic
+// operators. Only applies to the flat plan
+// (RuntimeOptions::max_recursion_depth == 0) without unknown processing. If
+// also using EnableComprehensionFusion, call this first: fused comprehensions
+// are not vectorized.
+absl::Status EnableVectorizedComprehensions(RuntimeBuilder& builder);
+
+}  // namespace cel::extensions
+
+#endif  // THIRD_PARTY_CEL_CPP_RUNTIME_VECTORIZED_COMPREHENSIONS_H_
@@ -0,0 +1,234 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/vectorized_comprehensions.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "google/api/expr/v1alpha1/syntax.pb.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/memory.h"
+#include "common/value.h"
+#include "extensions/protobuf/runtime_adapter.h"
+#include "internal/status_macros.h"
+#include "internal/testing.h"
+#include "parser/parser.h"
+#include "runtime/activation.h"
+#include "runtime/comprehension_fusion.h"
+#include "runtime/managed_value_factory.h"
+#include "runtime/primitive_list_value.h"
+#include "runtime/runtime.h"
+#include "runtime/runtime_builder.h"
+#include "runtime/runtime_options.h"
+#include "runtime/standard_runtime_builder_factory.h"
+
+namespace cel::extensions {
+namespace {
+
+using ::cel::internal::StatusIs;
+using ::google::api::expr::parser::Parse;
+using ::google::api::expr::v1alpha1::ParsedExpr;
+using testing::HasSubstr;
+
+using ValueMatcher = testing::Matcher<Value>;
+
+MATCHER_P(IsBoolValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<BoolValue>() &&
+         value->As<BoolValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsIntValue, expected, "") {
+  const Value& value = arg;
+  return value->Is<IntValue>() &&
+         value->As<IntValue>().NativeValue() == expected;
+}
+
+MATCHER_P(IsErrorValue, expected_substr, "") {
+  const Value& value = arg;
+  return value->Is<ErrorValue>() &&
+         absl::StrContains(value->As<ErrorValue>().NativeValue().message(),
+                           expected_substr);
+}
+
+struct TestCase {
+  std::string name;
+  // Expression over the list 'xs' and the int 'limit'.
+  std::string expression;
+  PrimitiveListValue::Elements xs;
+  ValueMatcher result_matcher;
+};
+
+struct Config {
+  bool primitive_list;
+  bool comprehension_fusion;
+};
+
+absl::StatusOr<std::unique_ptr<TraceableProgram>> MakeProgram(
+    const RuntimeOptions& options, bool comprehension_fusion,
+    absl::string_view expression) {
+  CEL_ASSIGN_OR_RETURN(cel::RuntimeBuilder builder,
+                       CreateStandardRuntimeBuilder(options));
+  CEL_RETURN_IF_ERROR(EnableVectorizedComprehensions(builder));
+  if (comprehension_fusion) {
+    CEL_RETURN_IF_ERROR(EnableComprehensionFusion(builder));
+  }
+  CEL_ASSIGN_OR_RETURN(auto runtime, std::move(builder).Build());
+
+  CEL_ASSIGN_OR_RETURN(ParsedExpr parsed_expr, Parse(expression));
+  return ProtobufRuntimeAdapter::CreateProgram(*runtime, parsed_expr);
+}
+
+// Evaluates `expression` with 'xs' bound to a primitive list of `xs`, or to a
+// regular list with the same elements.
+absl::StatusOr<Value> Evaluate(const RuntimeOptions& options, Config config,
+                               absl::string_view expression,
+                               const PrimitiveListValue::Elements& xs) {
+  CEL_ASSIGN_OR_RETURN(
+      auto program,
+      MakeProgram(options, config.comprehension_fusion, expression));
+  ManagedValueFactory value_factory(program->GetTypeProvider(),
+                                    MemoryManagerRef::ReferenceCounting());
+  ListValue list = NewPrimitiveListValue(
+      value_factory.get().GetMemoryManager(), xs);
+  if (!config.primitive_list) {
+    CEL_ASSIGN_OR_RETURN(auto builder,
+                         value_factory.get().NewListValueBuilder(
+                             value_factory.get().GetDynListType()));
+    CEL_RETURN_IF_ERROR(list.ForEach(
+        value_factory.get(),
+        [&builder](ValueView element) -> absl::StatusOr<bool> {
+          CEL_RETURN_IF_ERROR(builder->Add(Value(element)));
+          return true;
+        }));
+    list = std::move(*builder).Build();
+  }
+
+  Activation activation;
+  activation.InsertOrAssignValue("xs", std::move(list));
+  activation.InsertOrAssignValue("limit", IntValue(3));
+  return program->Evaluate(activation, value_factory.get());
+}
+
+class VectorizedComprehensionsTest
+    : public testing::TestWithParam<std::tuple<TestCase, bool, bool>> {
+ public:
+  const TestCase& test_case() const { return std::get<0>(GetParam()); }
+  Config config() const {
+    return Config{std::get<1>(GetParam()), std::get<2>(GetParam())};
+  }
+};
+
+TEST_P(VectorizedComprehensionsTest, MatchesRegularEvaluation) {
+  RuntimeOptions options;
+  ASSERT_OK_AND_ASSIGN(Value value, Evaluate(options, config(),
+                                             test_case().expression,
+                                             test_case().xs));
+  EXPECT_THAT(value, test_case().result_matcher);
+}
+
+const PrimitiveListValue::Elements kInts = std::vector<int64_t>{1, 2, 3};
+
+INSTANTIATE_TEST_SUITE_P(
+    Cases, VectorizedComprehensionsTest,
+    testing::Combine(
+        testing::ValuesIn(std::vector<TestCase>{
+            {"all", "xs.all(x, x > 0)", kInts, IsBoolValue(true)},
+            {"all_false", "xs.all(x, x < limit)", kInts, IsBoolValue(false)},
+            {"all_operand_left", "xs.all(x, 0 < x)", kInts,
+             IsBoolValue(true)},
+            {"all_empty", "xs.all(x, x > 0)", std::vector<int64_t>{},
+             IsBoolValue(true)},
+            {"exists", "xs.exists(x, x == limit)", kInts, IsBoolValue(true)},
+            {"exists_false", "xs.exists(x, x > 10)", kInts,
+             IsBoolValue(false)},
+            {"exists_one", "xs.exists_one(x, x >= limit)", kInts,
+             IsBoolValue(true)},
+            {"exists_one_false", "xs.exists_one(x, x != limit)", kInts,
+             IsBoolValue(false)},
+            {"filter", "xs.filter(x, x != 2) == [1, 3]", kInts,
+             IsBoolValue(true)},
+            {"filter_size", "xs.filter(x, x < limit).size()", kInts,
+             IsIntValue(2)},
+            {"map", "xs.map(x, x * 2) == [2, 4, 6]", kInts,
+             IsBoolValue(true)},
+            {"map_operand_left", "xs.map(x, 10 - x) == [9, 8, 7]", kInts,
+             IsBoolValue(true)},
+            {"map_int_division", "xs.map(x, 7 / x) == [7, 3, 2]", kInts,
+             IsBoolValue(true)},
+            {"map_overflow", "xs.map(x, x + 1)",
+             std::vector<int64_t>{1, std::numeric_limits<int64_t>::max()},
+             IsErrorValue("overflow")},
+            {"map_division_by_zero", "xs.map(x, 6 / x)",
+             std::vector<int64_t>{1, 0}, IsErrorValue("divide by zero")},
+            {"uint", "xs.all(x, x > 0u) && xs.map(x, x - 1u) == [0u, 1u]",
+             std::vector<uint64_t>{1, 2}, IsBoolValue(true)},
+            {"uint_underflow", "xs.map(x, x - 2u)",
+             std::vector<uint64_t>{1, 2}, IsErrorValue("overflow")},
+            {"double",
+             "xs.filter(x, x <= 2.0) == [0.5, 2.0] && "
+             "xs.map(x, x / 0.0)[0] > 1e308",
+             std::vector<double>{0.5, 2.0, 4.0}, IsBoolValue(true)},
+            {"double_nan", "xs.exists(x, x == x)",
+             std::vector<double>{std::numeric_limits<double>::quiet_NaN()},
+             IsBoolValue(false)},
+            {"heterogeneous_operand", "xs.exists(x, x == 2u)", kInts,
+             IsBoolValue(true)},
+            {"unevaluated_operand", "xs.all(x, x > missing)",
+             std::vector<int64_t>{}, IsBoolValue(true)},
+            {"missing_operand", "xs.all(x, x > missing)", kInts,
+             IsErrorValue("missing")},
+            {"nested", "[1, 2].all(y, xs.exists(x, x > y))", kInts,
+             IsBoolValue(true)},
+            {"nested_filter",
+             "[0, 1].map(y, xs.filter(x, x > y).size()) == [3, 2]", kInts,
+             IsBoolValue(true)},
+        }),
+        testing::Bool(), testing::Bool()),
+    [](const testing::TestParamInfo<std::tuple<TestCase, bool, bool>>& info) {
+      return absl::StrCat(std::get<0>(info.param).name,
+                          std::get<1>(info.param) ? "_primitive" : "",
+                          std::get<2>(info.param) ? "_fused" : "");
+    });
+
+TEST(VectorizedComprehensions, IterationBudget) {
+  RuntimeOptions options;
+  options.comprehension_max_iterations = 5;
+  const PrimitiveListValue::Elements xs =
+      std::vector<int64_t>{1, 2, 3, 4, 5, 6, 7, 8};
+
+  // Short-circuits after the first element, as the regular plan.
+  ASSERT_OK_AND_ASSIGN(Value value,
+                       Evaluate(options, Config{true, false},
+                                "xs.exists(x, x == 1)", xs));
+  EXPECT_THAT(value, IsBoolValue(true));
+
+  EXPECT_THAT(
+      Evaluate(options, Config{true, false}, "xs.filter(x, x > 0)", xs),
+      StatusIs(absl::StatusCode::kInternal,
+               HasSubstr("Iteration budget exceeded")));
+}
+
+}  // namespace
+}  // namespace cel::extensions